@@ -495,8 +495,14 @@ struct QDumper
     void putCommaIfNeeded();
     // convienience function for writing the last item of an abbreviated list
     void putEllipsis();
+    void putChildrenOffset(int offset, int end, int count);
+    void putChildrenEnd(int end, int count);
     void disarm();
 
+    // memory the dumped value depends on, reported as checksum on request
+    void addCheckRange(const void *addr, int size);
+    void putCheckRanges();
+
     void putBase64Encoded(const char *buf, int n);
     void checkFill();
 
@@ -509,6 +515,10 @@ struct QDumper
     const char *innerType; // 'inner type' for class templates
     const void *data;      // pointer to raw data
     bool dumpChildren;     // do we want to see children?
+    int childrenOffset;    // first child to dump in paged containers
+    int childrenLimit;     // maximum number of children to dump
+    bool childrenPaged;    // does the frontend fetch the remaining children?
+    bool wantsChecksum;    // report checksum over the inspected memory?
 
     // handling of nested templates
     void setupTemplateParameters();
@@ -524,6 +534,12 @@ struct QDumper
 
     const char *currentChildType;
     const char *currentChildNumChild;
+
+    enum { maxCheckRanges = 4, maxCheckBytes = 4096 };
+    int checkRangeCount;   // -1 if the value cannot be checked cheaply
+    int checkBytes;
+    const void *checkRangeAddr[maxCheckRanges];
+    int checkRangeSize[maxCheckRanges];
 };
 
 
@@ -533,8 +549,14 @@ QDumper::QDumper()
     full = false;
     outBuffer[0] = 'f'; // marks output as 'wrong'
     pos = 1;
+    childrenOffset = 0;
+    childrenLimit = 1000;
+    childrenPaged = false;
+    wantsChecksum = false;
     currentChildType = 0;
     currentChildNumChild = 0;
+    checkRangeCount = 0;
+    checkBytes = 0;
 }
 
 QDumper::~QDumper()
@@ -744,6 +766,65 @@ void QDumper::putEllipsis()
     put("{name=\"<incomplete>\",value=\"\",type=\"").put(innerType).put("\"}");
 }
 
+// Tells the frontend that only the children from offset to end of a paged
+// container are dumped. Nothing is written for complete dumps.
+void QDumper::putChildrenOffset(int offset, int end, int count)
+{
+    if (childrenPaged && (offset > 0 || end < count))
+        putItem("childrenoffset", offset);
+}
+
+// Frontends that cannot fetch further pages get the old ellipsis instead.
+void QDumper::putChildrenEnd(int end, int count)
+{
+    if (!childrenPaged && end < count)
+        putEllipsis();
+}
+
+// Dumpers call this for each piece of memory the displayed value and its
+// children are computed from. If the frontend reads the same bytes again
+// after a step, it can re-use the previous result instead of calling us.
+void QDumper::addCheckRange(const void *addr, int size)
+{
+    if (!wantsChecksum || checkRangeCount < 0)
+        return;
+    if (!addr || size < 0 || checkRangeCount == maxCheckRanges
+            || checkBytes + size > maxCheckBytes) {
+        checkRangeCount = -1;
+        return;
+    }
+    checkRangeAddr[checkRangeCount] = addr;
+    checkRangeSize[checkRangeCount] = size;
+    ++checkRangeCount;
+    checkBytes += size;
+}
+
+// FNV-1a over all check ranges, the frontend computes the same.
+void QDumper::putCheckRanges()
+{
+    if (checkRangeCount <= 0)
+        return;
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i != checkRangeCount; ++i) {
+        const unsigned char *p =
+            reinterpret_cast<const unsigned char *>(checkRangeAddr[i]);
+        for (int j = 0; j != checkRangeSize[i]; ++j) {
+            hash ^= p[j];
+            hash *= 16777619u;
+        }
+    }
+    putItem("checksum", hash);
+    putCommaIfNeeded();
+    put("checkranges=[");
+    for (int i = 0; i != checkRangeCount; ++i) {
+        if (i)
+            put(',');
+        put("{addr=\"").put(checkRangeAddr[i]).put("\",size=\"")
+            .put(checkRangeSize[i]).put("\"}");
+    }
+    put(']');
+}
+
 void QDumper::putItemCount(const char *name, int count)
 {
     putCommaIfNeeded();
@@ -1217,6 +1298,9 @@ static void qDumpQByteArray(QDumper &d)
         }
         d.endChildren();
     }
+    d.addCheckRange(d.data, sizeof(QByteArray));
+    d.addCheckRange(deref(d.data), 3 * sizeof(int)); // ref, alloc, size
+    d.addCheckRange(ba.constData(), ba.size() + 1);
     d.disarm();
 }
 
@@ -1628,7 +1712,8 @@ static void qDumpQList(QDumper &d)
     if (nn < 0)
         return;
     const bool innerTypeIsPointer = isPointerType(d.innerType);
-    const int n = qMin(nn, 1000);
+    const int offset = qMin(d.childrenOffset, nn);
+    const int end = offset + qMin(nn - offset, d.childrenLimit);
     if (nn > 0) {
         if (pdata.d->begin < 0)
             return;
@@ -1641,14 +1726,16 @@ static void qDumpQList(QDumper &d)
         qCheckAccess(pdata.d->array);
         // Additional checks on pointer arrays
         if (innerTypeIsPointer)
-            for (int i = 0; i != n; ++i)
+            for (int i = offset; i != end; ++i)
                 if (const void *p = pdata.d->array + i + pdata.d->begin)
                     qCheckPointer(deref(p));
     }
 
     d.putItemCount("value", nn);
     d.putItem("valueeditable", "false");
-    d.putItem("numchild", n);
+    d.putItem("numchild", nn);
+    d.addCheckRange(d.data, sizeof(void *));
+    d.addCheckRange(deref(d.data), 4 * sizeof(int)); // ref, alloc, begin, end
     if (d.dumpChildren) {
         const unsigned innerSize = d.extraInt[0];
         QByteArray strippedInnerType = stripPointerType(d.innerType);
@@ -1661,8 +1748,9 @@ static void qDumpQList(QDumper &d)
         bool isInternal = innerSize <= int(sizeof(void*))
             && isMovableType(d.innerType);
         d.putItem("internal", (int)isInternal);
-        d.beginChildren(n ? d.innerType : 0);
-        for (int i = 0; i != n; ++i) {
+        d.putChildrenOffset(offset, end, nn);
+        d.beginChildren(end != offset ? d.innerType : 0);
+        for (int i = offset; i != end; ++i) {
             d.beginHash();
             if (innerTypeIsPointer) {
                 void *p = pdata.d->array + i + pdata.d->begin;
@@ -1688,9 +1776,14 @@ static void qDumpQList(QDumper &d)
             }
             d.endHash();
         }
-        if (n < nn)
-            d.putEllipsis();
+        d.putChildrenEnd(end, nn);
         d.endChildren();
+        // Items stored in the list array itself need no further memory.
+        if (isInternal && isSimpleType(d.innerType))
+            d.addCheckRange(pdata.d->array + pdata.d->begin + offset,
+                (end - offset) * sizeof(void *));
+        else
+            d.addCheckRange(0, 0); // not verifiable
     }
     d.disarm();
 }
@@ -2865,6 +2958,9 @@ static void qDumpQString(QDumper &d)
     //d.putItem("editvalue", str);  // handled generically below
     d.putItem("numchild", "0");
 
+    d.addCheckRange(d.data, sizeof(QString));
+    d.addCheckRange(deref(d.data), 3 * sizeof(int)); // ref, alloc, size
+    d.addCheckRange(str.unicode(), 2 * (size + 1));
     d.disarm();
 }
 
@@ -2931,28 +3027,29 @@ static void qDumpQVector(QDumper &d)
         return;
     const bool innerIsPointerType = isPointerType(d.innerType);
     const unsigned innersize = d.extraInt[0];
-    const int n = qMin(nn, 1000);
+    const int offset = qMin(d.childrenOffset, nn);
+    const int end = offset + qMin(nn - offset, d.childrenLimit);
     // Check pointers
     if (innerIsPointerType && nn > 0)
-        for (int i = 0; i != n; ++i)
+        for (int i = offset; i != end; ++i)
             if (const void *p = addOffset(v, i * innersize + typeddatasize))
                 qCheckPointer(deref(p));
 
-    d.putItemCount("value", n);
+    d.putItemCount("value", nn);
     d.putItem("valueeditable", "false");
     d.putItem("numchild", nn);
     if (d.dumpChildren) {
         QByteArray strippedInnerType = stripPointerType(d.innerType);
         const char *stripped = innerIsPointerType ? strippedInnerType.data() : 0;
+        d.putChildrenOffset(offset, end, nn);
         d.beginChildren(d.innerType);
-        for (int i = 0; i != n; ++i) {
+        for (int i = offset; i != end; ++i) {
             d.beginHash();
             qDumpInnerValueOrPointer(d, d.innerType, stripped,
                 addOffset(v, i * innersize + typeddatasize));
             d.endHash();
         }
-        if (n < nn)
-            d.putEllipsis();
+        d.putChildrenEnd(end, nn);
         d.endChildren();
     }
     d.disarm();
@@ -3373,26 +3470,25 @@ static void qDumpStdVector(QDumper &d)
         qCheckAccess(v->end_of_storage);
     }
 
-    int n = nn;
-    d.putItemCount("value", n);
+    d.putItemCount("value", nn);
     d.putItem("valueeditable", "false");
-    d.putItem("numchild", n);
+    d.putItem("numchild", nn);
     if (d.dumpChildren) {
         unsigned innersize = d.extraInt[0];
         QByteArray strippedInnerType = stripPointerType(d.innerType);
         const char *stripped =
             isPointerType(d.innerType) ? strippedInnerType.data() : 0;
-        if (n > 1000)
-            n = 1000;
-        d.beginChildren(n ? d.innerType : 0);
-        for (int i = 0; i != n; ++i) {
+        const int offset = qMin(d.childrenOffset, nn);
+        const int end = offset + qMin(nn - offset, d.childrenLimit);
+        d.putChildrenOffset(offset, end, nn);
+        d.beginChildren(end != offset ? d.innerType : 0);
+        for (int i = offset; i != end; ++i) {
             d.beginHash();
             qDumpInnerValueOrPointer(d, d.innerType, stripped,
                 addOffset(v->start, i * innersize));
             d.endHash();
         }
-        if (n < nn)
-            d.putEllipsis();
+        d.putChildrenEnd(end, nn);
         d.endChildren();
     }
     d.disarm();
@@ -3625,6 +3721,8 @@ static void handleProtocolVersion2and3(QDumper &d)
 
     if (!d.success)
         qDumpUnknown(d);
+    else if (d.wantsChecksum)
+        d.putCheckRanges();
 #ifdef Q_CC_MSVC // Catch exceptions with MSVC/CDB
     } __except(EXCEPTION_EXECUTE_HANDLER) {
         qDumpUnknown(d, DUMPUNKNOWN_MESSAGE" <exception>");
@@ -3758,6 +3856,33 @@ static inline void dumpSizes(QDumper &d)
     d.put("]]");    
 }
 
+// The optional sixth input parameter is the window of children to dump
+// for paged containers, "offset,limit", optionally followed by ",1" if
+// a checksum of the inspected memory is wanted. Frontends not passing it
+// leave arbitrary old data there, so anything else is ignored.
+static bool parseChildrenRange(const char *range, int *offset, int *limit,
+    bool *wantsChecksum)
+{
+    int values[3] = { 0, 0, 0 };
+    int i = 0;
+    const char *p = range;
+    for (; *p; ++p) {
+        if (*p >= '0' && *p <= '9' && values[i] < 100000000) {
+            values[i] = values[i] * 10 + (*p - '0');
+        } else if (*p == ',' && i < 2 && p != range && p[-1] != ',') {
+            ++i;
+        } else {
+            return false;
+        }
+    }
+    if (i == 0 || p[-1] == ',' || values[1] <= 0)
+        return false;
+    *offset = values[0];
+    *limit = values[1];
+    *wantsChecksum = values[2] != 0;
+    return true;
+}
+
 extern "C" Q_DECL_EXPORT
 void *qDumpObjectData440(
     int protocolVersion,
@@ -3896,6 +4021,8 @@ void *qDumpObjectData440(
         d.exp       = inbuffer; while (*inbuffer) ++inbuffer; ++inbuffer;
         d.innerType = inbuffer; while (*inbuffer) ++inbuffer; ++inbuffer;
         d.iname     = inbuffer; while (*inbuffer) ++inbuffer; ++inbuffer;
+        d.childrenPaged = parseChildrenRange(inbuffer, &d.childrenOffset,
+            &d.childrenLimit, &d.wantsChecksum);
 #if 0
         qDebug() << "data=" << d.data << "dumpChildren=" << d.dumpChildren
                 << " extra=" << d.extraInt[0] << d.extraInt[1]  << d.extraInt[2]  << d.extraInt[3]
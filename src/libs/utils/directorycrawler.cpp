@@ -0,0 +1,613 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+#include "directorycrawler.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QFutureInterface>
+#include <QtCore/QMutex>
+#include <QtCore/QPair>
+#include <QtCore/QRegExp>
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+#include <QtCore/QWaitCondition>
+
+#ifdef Q_OS_UNIX
+#  include <sys/types.h>
+#  include <sys/stat.h>
+#  include <dirent.h>
+#  include <time.h>
+#endif
+
+namespace Utils {
+
+namespace {
+
+// Matches names against wildcards. Patterns of the "*.cpp" kind,
+// which is almost all of them, are checked without QRegExp.
+class NameMatcher
+{
+public:
+    NameMatcher() : m_caseSensitivity(Qt::CaseSensitive) {}
+
+    NameMatcher(const QStringList &patterns, Qt::CaseSensitivity caseSensitivity)
+        : m_caseSensitivity(caseSensitivity)
+    {
+        const QRegExp wildcards(QLatin1String("[*?\\[]"));
+        foreach (const QString &pattern, patterns) {
+            if (pattern.isEmpty())
+                continue;
+            const int wildcard = pattern.indexOf(wildcards);
+            if (wildcard == -1)
+                m_names.append(pattern);
+            else if (wildcard == 0 && pattern.indexOf(wildcards, 1) == -1)
+                m_suffixes.append(pattern.mid(1));
+            else
+                m_regExps.append(QRegExp(pattern, caseSensitivity, QRegExp::Wildcard));
+        }
+    }
+
+    bool isEmpty() const
+    {
+        return m_names.isEmpty() && m_suffixes.isEmpty() && m_regExps.isEmpty();
+    }
+
+    bool matches(const QString &name) const
+    {
+        foreach (const QString &suffix, m_suffixes) {
+            if (name.endsWith(suffix, m_caseSensitivity))
+                return true;
+        }
+        foreach (const QString &other, m_names) {
+            if (!name.compare(other, m_caseSensitivity))
+                return true;
+        }
+        for (int i = 0; i < m_regExps.size(); ++i) {
+            if (m_regExps.at(i).exactMatch(name))
+                return true;
+        }
+        return false;
+    }
+
+private:
+    Qt::CaseSensitivity m_caseSensitivity;
+    QStringList m_names;
+    QStringList m_suffixes;
+    QList<QRegExp> m_regExps;
+};
+
+#ifdef Q_OS_UNIX
+typedef QPair<quint64, quint64> DirectoryId;
+#else
+typedef QString DirectoryId; // the canonical path
+#endif
+
+// A directory waiting to be read, with the directories it was reached
+// through, which must not be read again below it.
+struct QueuedDirectory
+{
+    QueuedDirectory() {}
+    explicit QueuedDirectory(const QString &path) : path(path) {}
+
+    QString path;
+    QVector<DirectoryId> ancestors;
+};
+
+QStringList matchingNames(const QStringList &names, const NameMatcher &nameMatcher,
+                          const NameMatcher &ignoreMatcher)
+{
+    QStringList matching;
+    foreach (const QString &name, names) {
+        if (!ignoreMatcher.matches(name) && (nameMatcher.isEmpty() || nameMatcher.matches(name)))
+            matching.append(name);
+    }
+    return matching;
+}
+
+} // anonymous namespace
+
+class DirectoryCrawlerPrivate
+{
+public:
+    DirectoryCrawlerPrivate(DirectoryCrawler *crawler);
+
+    void work(int worker);
+    bool takeDirectory(int worker, QueuedDirectory *directory);
+    void finishDirectory(int worker, const QList<QueuedDirectory> &directories,
+                         const QString &path, const QStringList &files);
+    bool readDirectory(const QueuedDirectory &directory, DirectorySnapshot::Entry *entry,
+                       DirectoryId *id, bool *reused);
+    bool checkCanceled();
+
+    DirectoryCrawler *q;
+
+    QStringList rootDirectories;
+    QStringList nameFilters;
+    QStringList ignoredNames;
+    Qt::CaseSensitivity caseSensitivity;
+    bool followSymLinks;
+    int threadCount;
+    DirectorySnapshot snapshot;
+
+    // State of a running crawl, guarded by mutex
+    QMutex mutex;
+    QWaitCondition workAvailable;
+    QVector<QList<QueuedDirectory> > queues;
+    int pending;    // directories queued or being read
+    bool canceled;
+    QFutureInterfaceBase *future;
+    qint64 crawlStarted;
+    DirectorySnapshot newSnapshot;
+    QStringList results;
+    int directoriesDone;
+    int directoriesFound;
+    int directoriesRead;
+    int directoriesReused;
+};
+
+namespace {
+
+class CrawlWorker : public QRunnable
+{
+public:
+    CrawlWorker(DirectoryCrawlerPrivate *d, int worker) : m_d(d), m_worker(worker) {}
+    void run() { m_d->work(m_worker); }
+
+private:
+    DirectoryCrawlerPrivate *m_d;
+    int m_worker;
+};
+
+} // anonymous namespace
+
+DirectoryCrawlerPrivate::DirectoryCrawlerPrivate(DirectoryCrawler *crawler)
+    : q(crawler),
+      caseSensitivity(Qt::CaseInsensitive),
+      followSymLinks(true),
+      threadCount(QThread::idealThreadCount()),
+      pending(0),
+      canceled(false),
+      future(0),
+      crawlStarted(0),
+      directoriesDone(0),
+      directoriesFound(0),
+      directoriesRead(0),
+      directoriesReused(0)
+{
+}
+
+bool DirectoryCrawlerPrivate::checkCanceled()
+{
+    if (!canceled && future && future->isCanceled()) {
+        canceled = true;
+        workAvailable.wakeAll();
+    }
+    return canceled;
+}
+
+// Workers take the newest directory from their own queue, which keeps them
+// inside one subtree, and steal the oldest, likely biggest, one from the
+// fullest queue of the others when theirs is empty.
+bool DirectoryCrawlerPrivate::takeDirectory(int worker, QueuedDirectory *directory)
+{
+    QMutexLocker locker(&mutex);
+    forever {
+        if (checkCanceled() || pending == 0)
+            return false;
+
+        QList<QueuedDirectory> &own = queues[worker];
+        if (!own.isEmpty()) {
+            *directory = own.takeLast();
+            return true;
+        }
+
+        int victim = -1;
+        for (int i = 0; i < queues.size(); ++i) {
+            if (!queues.at(i).isEmpty() && (victim == -1 || queues.at(i).size() > queues.at(victim).size()))
+                victim = i;
+        }
+        if (victim != -1) {
+            *directory = queues[victim].takeFirst();
+            return true;
+        }
+
+        // Wake up now and then to notice cancellation
+        workAvailable.wait(&mutex, 100);
+    }
+}
+
+void DirectoryCrawlerPrivate::finishDirectory(int worker, const QList<QueuedDirectory> &directories,
+                                              const QString &path, const QStringList &files)
+{
+    int done;
+    int found;
+    int filesFound;
+    {
+        QMutexLocker locker(&mutex);
+        queues[worker] += directories;
+        pending += directories.size() - 1;
+        directoriesFound += directories.size();
+        done = ++directoriesDone;
+        found = directoriesFound;
+        results += files;
+        filesFound = results.size();
+        if (!directories.isEmpty() || pending == 0)
+            workAvailable.wakeAll();
+    }
+
+    if (!files.isEmpty())
+        q->filesFound(path, files);
+    q->progress(done, found, filesFound);
+}
+
+void DirectoryCrawlerPrivate::work(int worker)
+{
+    const NameMatcher nameMatcher(nameFilters, caseSensitivity);
+    const NameMatcher ignoreMatcher(ignoredNames, caseSensitivity);
+
+    QueuedDirectory directory;
+    while (takeDirectory(worker, &directory)) {
+        const QString &path = directory.path;
+        DirectorySnapshot::Entry entry;
+        DirectoryId id;
+        bool reused = false;
+        QList<QueuedDirectory> directories;
+        QStringList files;
+        if (readDirectory(directory, &entry, &id, &reused)) {
+            // Only what passes the filters is kept, which also keeps the snapshot small
+            if (!reused) {
+                entry.files = matchingNames(entry.files, nameMatcher, ignoreMatcher);
+                entry.linkedFiles = matchingNames(entry.linkedFiles, nameMatcher, ignoreMatcher);
+                entry.directories = matchingNames(entry.directories, NameMatcher(), ignoreMatcher);
+                entry.linkedDirectories = matchingNames(entry.linkedDirectories, NameMatcher(), ignoreMatcher);
+            }
+            const QString prefix = path + QLatin1Char('/');
+            QueuedDirectory subdirectory;
+            subdirectory.ancestors = directory.ancestors;
+            subdirectory.ancestors.append(id);
+            foreach (const QString &name, entry.files)
+                files.append(prefix + name);
+            foreach (const QString &name, entry.directories) {
+                subdirectory.path = prefix + name;
+                directories.append(subdirectory);
+            }
+            if (followSymLinks) {
+                foreach (const QString &name, entry.linkedFiles)
+                    files.append(prefix + name);
+                foreach (const QString &name, entry.linkedDirectories) {
+                    subdirectory.path = prefix + name;
+                    directories.append(subdirectory);
+                }
+            }
+
+            QMutexLocker locker(&mutex);
+            newSnapshot.m_entries.insert(path, entry);
+            if (reused)
+                ++directoriesReused;
+            else
+                ++directoriesRead;
+        }
+        finishDirectory(worker, directories, path, files);
+    }
+}
+
+// Fills entry from the snapshot if the directory did not change since,
+// or from the file system, and id with what identifies the directory.
+// Returns false for directories to skip.
+bool DirectoryCrawlerPrivate::readDirectory(const QueuedDirectory &directory, DirectorySnapshot::Entry *entry,
+                                            DirectoryId *id, bool *reused)
+{
+    const QString &path = directory.path;
+#ifdef Q_OS_UNIX
+    const QByteArray encodedPath = QFile::encodeName(path);
+    struct stat st;
+    if (::stat(encodedPath.constData(), &st) != 0 || !S_ISDIR(st.st_mode))
+        return false;
+    const qint64 modified = st.st_mtime;
+    *id = DirectoryId(st.st_dev, st.st_ino);
+#else
+    const QFileInfo info(path);
+    if (!info.isDir())
+        return false;
+    const qint64 modified = info.lastModified().toTime_t();
+    *id = info.canonicalFilePath();
+#endif
+    // A link back to a directory above would be followed forever. Other
+    // directories reached twice are read under each of their paths, which
+    // does not depend on which path happens to get there first.
+    if (directory.ancestors.contains(*id))
+        return false;
+
+    const QHash<QString, DirectorySnapshot::Entry>::const_iterator it = snapshot.m_entries.constFind(path);
+    if (it != snapshot.m_entries.constEnd() && it.value().modified == modified) {
+        *entry = it.value();
+        *reused = true;
+        return true;
+    }
+
+    // A directory changed in the same second as it was read could change
+    // again without a new time stamp, so such entries are not reused
+    entry->modified = modified < crawlStarted - 1 ? modified : qint64(-1);
+
+#ifdef Q_OS_UNIX
+    DIR *dir = ::opendir(encodedPath.constData());
+    if (!dir)
+        return false;
+    while (struct dirent *dirEntry = ::readdir(dir)) {
+        const char *name = dirEntry->d_name;
+        if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0)))
+            continue;
+
+        bool isDir = false;
+        bool isFile = false;
+        bool isLink = false;
+#ifdef DT_UNKNOWN
+        // Most file systems tell the type right away, saving a stat per entry
+        switch (dirEntry->d_type) {
+        case DT_DIR:
+            isDir = true;
+            break;
+        case DT_REG:
+            isFile = true;
+            break;
+        case DT_LNK:
+            isLink = true;
+            break;
+        case DT_UNKNOWN:
+            break;
+        default:
+            continue;
+        }
+#endif
+        if (!isDir && !isFile) {
+            const QByteArray entryPath = encodedPath + '/' + name;
+            struct stat entryStat;
+            if (!isLink) {
+                if (::lstat(entryPath.constData(), &entryStat) != 0)
+                    continue;
+                isLink = S_ISLNK(entryStat.st_mode);
+            }
+            if (isLink && ::stat(entryPath.constData(), &entryStat) != 0)
+                continue; // dangling link
+            isDir = S_ISDIR(entryStat.st_mode);
+            isFile = S_ISREG(entryStat.st_mode);
+        }
+
+        const QString fileName = QFile::decodeName(name);
+        if (isFile && isLink)
+            entry->linkedFiles.append(fileName);
+        else if (isFile)
+            entry->files.append(fileName);
+        else if (isDir && isLink)
+            entry->linkedDirectories.append(fileName);
+        else if (isDir)
+            entry->directories.append(fileName);
+    }
+    ::closedir(dir);
+#else
+    const QFileInfoList infos = QDir(path).entryInfoList(QDir::AllEntries | QDir::Hidden
+                                                         | QDir::System | QDir::NoDotAndDotDot);
+    foreach (const QFileInfo &info, infos) {
+        if (info.isFile() && info.isSymLink())
+            entry->linkedFiles.append(info.fileName());
+        else if (info.isFile())
+            entry->files.append(info.fileName());
+        else if (info.isDir() && info.isSymLink())
+            entry->linkedDirectories.append(info.fileName());
+        else if (info.isDir())
+            entry->directories.append(info.fileName());
+    }
+#endif
+    return true;
+}
+
+QDataStream &operator<<(QDataStream &out, const DirectorySnapshot &snapshot)
+{
+    out << snapshot.m_filters << qint32(snapshot.m_entries.size());
+    QHashIterator<QString, DirectorySnapshot::Entry> it(snapshot.m_entries);
+    while (it.hasNext()) {
+        it.next();
+        const DirectorySnapshot::Entry &entry = it.value();
+        out << it.key() << entry.modified << entry.files << entry.linkedFiles
+            << entry.directories << entry.linkedDirectories;
+    }
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, DirectorySnapshot &snapshot)
+{
+    snapshot.clear();
+    qint32 count;
+    in >> snapshot.m_filters >> count;
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString path;
+        DirectorySnapshot::Entry entry;
+        in >> path >> entry.modified >> entry.files >> entry.linkedFiles
+           >> entry.directories >> entry.linkedDirectories;
+        snapshot.m_entries.insert(path, entry);
+    }
+    return in;
+}
+
+DirectoryCrawler::DirectoryCrawler()
+    : d(new DirectoryCrawlerPrivate(this))
+{
+}
+
+DirectoryCrawler::~DirectoryCrawler()
+{
+    delete d;
+}
+
+void DirectoryCrawler::setRootDirectories(const QStringList &directories)
+{
+    d->rootDirectories = directories;
+}
+
+void DirectoryCrawler::setNameFilters(const QStringList &filters)
+{
+    d->nameFilters = filters;
+}
+
+void DirectoryCrawler::setIgnoredNames(const QStringList &patterns)
+{
+    d->ignoredNames = patterns;
+}
+
+void DirectoryCrawler::setCaseSensitivity(Qt::CaseSensitivity caseSensitivity)
+{
+    d->caseSensitivity = caseSensitivity;
+}
+
+void DirectoryCrawler::setFollowSymLinks(bool follow)
+{
+    d->followSymLinks = follow;
+}
+
+void DirectoryCrawler::setThreadCount(int count)
+{
+    d->threadCount = count;
+}
+
+void DirectoryCrawler::setSnapshot(const DirectorySnapshot &snapshot)
+{
+    d->snapshot = snapshot;
+}
+
+DirectorySnapshot DirectoryCrawler::snapshot() const
+{
+    return d->snapshot;
+}
+
+int DirectoryCrawler::directoriesRead() const
+{
+    return d->directoriesRead;
+}
+
+int DirectoryCrawler::directoriesReused() const
+{
+    return d->directoriesReused;
+}
+
+QStringList DirectoryCrawler::crawl(QFutureInterfaceBase *future)
+{
+    const int threadCount = qMax(1, d->threadCount);
+    d->queues = QVector<QStringList>(threadCount);
+    d->pending = 0;
+    d->canceled = false;
+    d->future = future;
+#ifdef Q_OS_UNIX
+    d->crawlStarted = ::time(0);
+#else
+    d->crawlStarted = QDateTime::currentDateTime().toTime_t();
+#endif
+    // The snapshot only holds names that passed the filters it was taken with
+    QStringList filters = d->nameFilters;
+    filters << QLatin1String("/") << d->ignoredNames
+            << QString::number(int(d->caseSensitivity));
+    if (d->snapshot.m_filters != filters)
+        d->snapshot.clear();
+    d->newSnapshot.clear();
+    d->newSnapshot.m_filters = filters;
+    d->results.clear();
+    d->directoriesDone = 0;
+    d->directoriesFound = 0;
+    d->directoriesRead = 0;
+    d->directoriesReused = 0;
+
+    // Roots inside other roots would be crawled twice
+    QStringList roots;
+    foreach (const QString &directory, d->rootDirectories) {
+        if (!directory.isEmpty())
+            roots.append(QDir::cleanPath(QDir::fromNativeSeparators(directory)));
+    }
+    qSort(roots);
+    QStringList outerRoots;
+    foreach (const QString &root, roots) {
+        bool inside = false;
+        foreach (const QString &outer, outerRoots) {
+            const QString prefix = outer.endsWith(QLatin1Char('/')) ? outer : outer + QLatin1Char('/');
+            if (root == outer || root.startsWith(prefix)) {
+                inside = true;
+                break;
+            }
+        }
+        if (!inside)
+            outerRoots.append(root);
+    }
+
+    // Spread the roots over the workers
+    int worker = 0;
+    foreach (const QString &root, outerRoots) {
+        d->queues[worker].append(QueuedDirectory(root));
+        worker = (worker + 1) % threadCount;
+        ++d->pending;
+        ++d->directoriesFound;
+    }
+
+    // The calling thread is the first worker
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, threadCount - 1));
+    for (int i = 1; i < threadCount; ++i)
+        pool.start(new CrawlWorker(d, i));
+    d->work(0);
+    pool.waitForDone();
+
+    QStringList results;
+    if (!d->canceled) {
+        d->snapshot = d->newSnapshot;
+        results = d->results;
+        qSort(results);
+    }
+    d->newSnapshot.clear();
+    d->results.clear();
+    d->future = 0;
+    return results;
+}
+
+void DirectoryCrawler::filesFound(const QString &directory, const QStringList &files)
+{
+    Q_UNUSED(directory)
+    Q_UNUSED(files)
+}
+
+void DirectoryCrawler::progress(int directoriesDone, int directoriesFound, int filesFound)
+{
+    Q_UNUSED(directoriesDone)
+    Q_UNUSED(directoriesFound)
+    Q_UNUSED(filesFound)
+}
+
+} // namespace Utils
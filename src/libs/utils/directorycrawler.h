@@ -0,0 +1,130 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+#ifndef DIRECTORYCRAWLER_H
+#define DIRECTORYCRAWLER_H
+
+#include "utils_global.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QStringList>
+
+QT_BEGIN_NAMESPACE
+class QDataStream;
+class QFutureInterfaceBase;
+QT_END_NAMESPACE
+
+namespace Utils {
+
+class DirectoryCrawlerPrivate;
+
+// The entries of crawled directories that passed the filters, keyed by
+// directory modification time. A directory whose time did not change is
+// not read again. A crawl with different filters starts from scratch.
+class QTCREATOR_UTILS_EXPORT DirectorySnapshot
+{
+public:
+    struct Entry
+    {
+        Entry() : modified(-1) {}
+
+        qint64 modified;       // -1 if the entry must not be reused
+        QStringList files;
+        QStringList linkedFiles;
+        QStringList directories;
+        QStringList linkedDirectories;
+    };
+
+    bool isEmpty() const { return m_entries.isEmpty(); }
+    void clear() { m_entries.clear(); m_filters.clear(); }
+
+private:
+    friend class DirectoryCrawler;
+    friend class DirectoryCrawlerPrivate;
+    friend QTCREATOR_UTILS_EXPORT QDataStream &operator<<(QDataStream &out, const DirectorySnapshot &snapshot);
+    friend QTCREATOR_UTILS_EXPORT QDataStream &operator>>(QDataStream &in, DirectorySnapshot &snapshot);
+
+    QHash<QString, Entry> m_entries;
+    QStringList m_filters;
+};
+
+QTCREATOR_UTILS_EXPORT QDataStream &operator<<(QDataStream &out, const DirectorySnapshot &snapshot);
+QTCREATOR_UTILS_EXPORT QDataStream &operator>>(QDataStream &in, DirectorySnapshot &snapshot);
+
+/*!
+  Collects the files below a set of directories.
+
+  Directories are read by a number of worker threads, each of which takes
+  the next directory from its own queue and steals from the others when that
+  runs dry. Symbolic links are followed unless disabled, in which case linked
+  files and directories are skipped. A directory reached through several
+  paths is listed under each of them, except for links back to a directory
+  above, which are not followed.
+  */
+class QTCREATOR_UTILS_EXPORT DirectoryCrawler
+{
+    Q_DISABLE_COPY(DirectoryCrawler)
+public:
+    DirectoryCrawler();
+    virtual ~DirectoryCrawler();
+
+    void setRootDirectories(const QStringList &directories);
+    // Wildcards matched against file names, all files if empty
+    void setNameFilters(const QStringList &filters);
+    // Wildcards matched against file and directory names, matches are skipped
+    void setIgnoredNames(const QStringList &patterns);
+    void setCaseSensitivity(Qt::CaseSensitivity caseSensitivity);
+    void setFollowSymLinks(bool follow);
+    void setThreadCount(int count);
+
+    void setSnapshot(const DirectorySnapshot &snapshot);
+    // The snapshot of the last crawl, to be passed to the next one
+    DirectorySnapshot snapshot() const;
+
+    // Blocks until all directories are read, or until the future is canceled.
+    // Returns the matching files, sorted.
+    QStringList crawl(QFutureInterfaceBase *future = 0);
+
+    int directoriesRead() const;
+    int directoriesReused() const;
+
+protected:
+    // Called from the worker threads for each directory containing matching files
+    virtual void filesFound(const QString &directory, const QStringList &files);
+    // Called from the worker threads whenever a directory is done
+    virtual void progress(int directoriesDone, int directoriesFound, int filesFound);
+
+private:
+    friend class DirectoryCrawlerPrivate;
+    DirectoryCrawlerPrivate *d;
+};
+
+} // namespace Utils
+
+#endif // DIRECTORYCRAWLER_H
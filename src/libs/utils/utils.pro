@@ -7,6 +7,7 @@ include(../../qtcreatorlibrary.pri)
 SOURCES += reloadpromptutils.cpp \
     settingsutils.cpp \
     filesearch.cpp \
+    directorycrawler.cpp \
     pathchooser.cpp \
     pathlisteditor.cpp \
     filewizardpage.cpp \
@@ -48,6 +49,7 @@ HEADERS += utils_global.h \
     reloadpromptutils.h \
     settingsutils.h \
     filesearch.h \
+    directorycrawler.h \
     listutils.h \
     pathchooser.h \
     pathlisteditor.h \
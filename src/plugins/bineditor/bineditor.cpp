@@ -32,9 +32,13 @@
 #include <texteditor/fontsettings.h>
 #include <texteditor/texteditorconstants.h>
 
+#include <qtconcurrent/runextensions.h>
+
 #include <QtCore/QByteArrayMatcher>
 #include <QtCore/QFile>
+#include <QtCore/QPair>
 #include <QtCore/QTemporaryFile>
+#include <QtCore/QVector>
 
 #include <QtGui/QApplication>
 #include <QtGui/QClipboard>
@@ -80,8 +84,12 @@ BinEditor::BinEditor(QWidget *parent)
 {
     m_ieditor = 0;
     m_inLazyMode = false;
+    m_mappedData = 0;
     m_baseAddr = 0;
     m_blockSize = 4096;
+    m_lazyDataClock = 0;
+    m_lazyDataCacheSize = 64 * 1024 * 1024;
+    m_readAheadDirection = 1;
     m_size = 0;
     m_addressBytes = 4;
     init();
@@ -93,11 +101,13 @@ BinEditor::BinEditor(QWidget *parent)
     m_lowNibble = false;
     m_cursorVisible = false;
     m_caseSensitiveSearch = false;
+    m_backgroundSearchFrom = 0;
     setFocusPolicy(Qt::WheelFocus);
 }
 
 BinEditor::~BinEditor()
 {
+    cancelBackgroundSearch();
 }
 
 void BinEditor::init()
@@ -155,18 +165,61 @@ void BinEditor::addLazyData(quint64 block, const QByteArray &data)
     Q_ASSERT(data.size() == m_blockSize);
     const quint64 addr = block * m_blockSize;
     if (addr >= m_baseAddr && addr <= m_baseAddr + m_size - 1) {
-        if (m_lazyData.size() * m_blockSize >= 64 * 1024 * 1024)
-            m_lazyData.clear();
+        if (m_lazyData.size() * m_blockSize >= m_lazyDataCacheSize)
+            evictLazyData();
         const int translatedBlock = (addr - m_baseAddr) / m_blockSize;
         m_lazyData.insert(translatedBlock, data);
+        m_lazyDataLastUse.insert(translatedBlock, ++m_lazyDataClock);
         m_lazyRequests.remove(translatedBlock);
         viewport()->update();
     }
 }
 
-bool BinEditor::requestDataAt(int pos, bool synchronous) const
+void BinEditor::invalidateLazyData()
 {
     if (!m_inLazyMode)
+        return;
+    m_lazyData.clear();
+    m_lazyDataLastUse.clear();
+    m_lazyRequests.clear();
+    viewport()->update();
+}
+
+void BinEditor::setLazyDataCacheSize(int bytes)
+{
+    m_lazyDataCacheSize = qMax(bytes, 16 * m_blockSize);
+    while (m_lazyData.size() * m_blockSize > m_lazyDataCacheSize)
+        evictLazyData();
+}
+
+// Drops the least recently used quarter of the cached blocks. Visible
+// blocks have just been touched by painting, so they survive.
+void BinEditor::evictLazyData()
+{
+    typedef QPair<quint64, int> UseAndBlock;
+    QVector<UseAndBlock> uses;
+    uses.reserve(m_lazyDataLastUse.size());
+    QHash<int, quint64>::const_iterator it = m_lazyDataLastUse.constBegin();
+    for ( ; it != m_lazyDataLastUse.constEnd(); ++it)
+        uses.append(UseAndBlock(it.value(), it.key()));
+    qSort(uses);
+    const int count = qMax(1, uses.size() / 4);
+    for (int i = 0; i < count && i < uses.size(); ++i) {
+        m_lazyData.remove(uses.at(i).second);
+        m_lazyDataLastUse.remove(uses.at(i).second);
+    }
+}
+
+void BinEditor::requestBlock(int block, bool synchronous) const
+{
+    m_lazyRequests.insert(block);
+    emit const_cast<BinEditor*>(this)->
+        lazyDataRequested(m_baseAddr / m_blockSize + block, synchronous);
+}
+
+bool BinEditor::requestDataAt(int pos, bool synchronous) const
+{
+    if (!m_inLazyMode || m_mappedData)
         return true;
 
     int block = pos / m_blockSize;
@@ -176,15 +229,26 @@ bool BinEditor::requestDataAt(int pos, bool synchronous) const
     it = m_lazyData.find(block);
     if (it == m_lazyData.end()) {
         if (!m_lazyRequests.contains(block)) {
-            m_lazyRequests.insert(block);
-            emit const_cast<BinEditor*>(this)->
-                lazyDataRequested(m_baseAddr / m_blockSize + block, synchronous);
+            requestBlock(block, synchronous);
             if (!m_lazyRequests.contains(block))
                 return true; // synchronous data source
+            // Asynchronous data source: ask for the blocks the user is
+            // likely to see next as well, so the source can fetch them
+            // in one go.
+            const int lastBlock = (m_size - 1) / m_blockSize;
+            for (int i = 1; i <= ReadAheadBlocks; ++i) {
+                const int next = block + i * m_readAheadDirection;
+                if (next < 0 || next > lastBlock)
+                    break;
+                if (!m_lazyData.contains(next) && !m_modifiedData.contains(next)
+                        && !m_lazyRequests.contains(next))
+                    requestBlock(next, false);
+            }
         }
         return false;
     }
 
+    m_lazyDataLastUse[block] = ++m_lazyDataClock;
     return true;
 }
 
@@ -208,8 +272,9 @@ void BinEditor::changeDataAt(int pos, char c)
         it.value()[pos - (block*m_blockSize)] = c;
     } else {
         it = m_lazyData.find(block);
-        if (it != m_lazyData.end()) {
-            QByteArray data = it.value();
+        if (it != m_lazyData.end() || m_mappedData) {
+            // Copy on write, the mapping itself stays untouched.
+            QByteArray data = blockData(block);
             data[pos - (block*m_blockSize)] = c;
             m_modifiedData.insert(block, data);
         }
@@ -241,8 +306,18 @@ QByteArray BinEditor::blockData(int block) const
         return data;
     }
     QMap<int, QByteArray>::const_iterator it = m_modifiedData.find(block);
-    return it != m_modifiedData.constEnd()
-            ? it.value() : m_lazyData.value(block, m_emptyBlock);
+    if (it != m_modifiedData.constEnd())
+        return it.value();
+    if (m_mappedData) {
+        const char *data = reinterpret_cast<const char *>(m_mappedData);
+        const int offset = block * m_blockSize;
+        if (offset + m_blockSize <= m_size)
+            return QByteArray::fromRawData(data + offset, m_blockSize);
+        QByteArray last(data + offset, m_size - offset);
+        last.append(QByteArray(m_blockSize - last.size(), '\0'));
+        return last;
+    }
+    return m_lazyData.value(block, m_emptyBlock);
 }
 
 
@@ -332,9 +407,12 @@ bool BinEditor::isReadOnly() const
 
 void BinEditor::setData(const QByteArray &data)
 {
+    cancelBackgroundSearch();
     m_inLazyMode = false;
+    m_mappedData = 0;
     m_baseAddr = 0;
     m_lazyData.clear();
+    m_lazyDataLastUse.clear();
     m_modifiedData.clear();
     m_lazyRequests.clear();
     m_data = data;
@@ -402,12 +480,15 @@ bool BinEditor::save(const QString &oldFileName, const QString &newFileName)
 
 void BinEditor::setLazyData(quint64 startAddr, int range, int blockSize)
 {
+    cancelBackgroundSearch();
     m_inLazyMode = true;
+    m_mappedData = 0;
     m_blockSize = blockSize;
     Q_ASSERT((blockSize/16) * 16 == blockSize);
     m_emptyBlock = QByteArray(blockSize, '\0');
     m_data.clear();
     m_lazyData.clear();
+    m_lazyDataLastUse.clear();
     m_modifiedData.clear();
     m_lazyRequests.clear();
 
@@ -434,6 +515,24 @@ void BinEditor::setLazyData(quint64 startAddr, int range, int blockSize)
     viewport()->update();
 }
 
+void BinEditor::setMappedData(const uchar *data, int size)
+{
+    setLazyData(0, size);
+    m_mappedData = data;
+}
+
+void BinEditor::unmapData()
+{
+    if (!m_mappedData)
+        return;
+    cancelBackgroundSearch();
+    m_mappedData = 0;
+    m_lazyData.clear();
+    m_lazyDataLastUse.clear();
+    m_lazyRequests.clear();
+    viewport()->update();
+}
+
 void BinEditor::resizeEvent(QResizeEvent *)
 {
     init();
@@ -441,6 +540,8 @@ void BinEditor::resizeEvent(QResizeEvent *)
 
 void BinEditor::scrollContentsBy(int dx, int dy)
 {
+    if (dy)
+        m_readAheadDirection = dy < 0 ? 1 : -1;
     viewport()->scroll(isRightToLeft() ? -dx : dx, dy * m_lineHeight);
 }
 
@@ -535,12 +636,162 @@ void BinEditor::updateLines(int fromPosition, int toPosition)
     viewport()->update(0, y, viewport()->width(), h);
 }
 
+int BinEditor::searchStride() const
+{
+    return searchesMapping() ? 0 : SearchStride;
+}
+
+// Searching the mapping directly is only possible as long as no block
+// has been edited, otherwise the overlay has to be taken into account.
+bool BinEditor::searchesMapping() const
+{
+    return m_mappedData && m_modifiedData.isEmpty();
+}
+
+namespace {
+
+struct MappedSearch
+{
+    const char *data;
+    int size;
+    QByteArray pattern; // lower case unless the search is case sensitive
+    QByteArray hexPattern;
+    int from;
+    bool backward;
+    bool caseSensitive;
+};
+
+enum { MappedSearchChunk = 1024 * 1024 };
+
+} // anonymous namespace
+
+// Returns the match closest to the start in search direction, among
+// matches starting in [chunkStart, chunkEnd).
+static int searchChunk(const MappedSearch &search, int chunkStart, int chunkEnd,
+                       QByteArray *buffer)
+{
+    const int maxPatternSize = qMax(search.pattern.size(), search.hexPattern.size());
+    const int length = qMin<qint64>(static_cast<qint64>(chunkEnd) + maxPatternSize - 1,
+                                    search.size) - chunkStart;
+    const QByteArray raw = QByteArray::fromRawData(search.data + chunkStart, length);
+    const QByteArray *text = &raw;
+    if (!search.caseSensitive) {
+        *buffer = QByteArray(search.data + chunkStart, length);
+        ::lower(*buffer);
+        text = buffer;
+    }
+    int best = -1;
+    const int last = chunkEnd - chunkStart - 1;
+    if (search.backward) {
+        best = text->lastIndexOf(search.pattern, last);
+        if (!search.hexPattern.isEmpty())
+            best = qMax(best, raw.lastIndexOf(search.hexPattern, last));
+    } else {
+        int pos = text->indexOf(search.pattern);
+        if (pos > last)
+            pos = -1;
+        best = pos;
+        if (!search.hexPattern.isEmpty()) {
+            pos = raw.indexOf(search.hexPattern);
+            if (pos > last)
+                pos = -1;
+            if (pos >= 0 && (best < 0 || pos < best))
+                best = pos;
+        }
+    }
+    return best < 0 ? -1 : chunkStart + best;
+}
+
+static void searchMappedData(QFutureInterface<int> &future, const MappedSearch &search)
+{
+    future.setProgressRange(0, 1000);
+    const qint64 total = search.backward ? search.from + 1 : search.size - search.from;
+    QByteArray buffer;
+    int pos = search.from;
+    while (search.backward ? pos >= 0 : pos < search.size) {
+        if (future.isCanceled())
+            return;
+        int found;
+        if (search.backward) {
+            const int chunkStart = qMax(0, pos - MappedSearchChunk + 1);
+            found = searchChunk(search, chunkStart, pos + 1, &buffer);
+            pos = chunkStart - 1;
+        } else {
+            const int chunkEnd = qMin<qint64>(static_cast<qint64>(pos) + MappedSearchChunk,
+                                              search.size);
+            found = searchChunk(search, pos, chunkEnd, &buffer);
+            pos = chunkEnd;
+        }
+        if (found >= 0) {
+            future.reportResult(found);
+            return;
+        }
+        const qint64 done = qAbs(static_cast<qint64>(pos) - search.from);
+        if (total > 0)
+            future.setProgressValue(qMin<qint64>(1000, done * 1000 / total));
+    }
+    future.reportResult(-1);
+}
+
+void BinEditor::cancelBackgroundSearch()
+{
+    m_backgroundSearchPattern.clear();
+    m_backgroundSearch.cancel();
+    m_backgroundSearch.waitForFinished();
+}
+
+// The mapping is searched as a whole in a worker thread, so the GUI stays
+// responsive. find() is called again with the same arguments to pick up
+// the result.
+int BinEditor::findInBackground(const QByteArray &pattern, int from,
+                                QTextDocument::FindFlags findFlags)
+{
+    if (pattern != m_backgroundSearchPattern || from != m_backgroundSearchFrom
+            || findFlags != m_backgroundSearchFlags) {
+        cancelBackgroundSearch();
+        MappedSearch search;
+        search.data = reinterpret_cast<const char *>(m_mappedData);
+        search.size = m_size;
+        search.caseSensitive = findFlags & QTextDocument::FindCaseSensitively;
+        search.pattern = pattern;
+        if (!search.caseSensitive)
+            ::lower(search.pattern);
+        search.hexPattern = calculateHexPattern(pattern);
+        search.backward = findFlags & QTextDocument::FindBackward;
+        search.from = search.backward ? qMin(from, m_size - 1) : from;
+        m_backgroundSearchPattern = pattern;
+        m_backgroundSearchFrom = from;
+        m_backgroundSearchFlags = findFlags;
+        m_backgroundSearch = QtConcurrent::run(searchMappedData, search);
+        return -2;
+    }
+    if (!m_backgroundSearch.isFinished())
+        return -2;
+    m_backgroundSearchPattern.clear();
+    if (m_backgroundSearch.isCanceled() || m_backgroundSearch.resultCount() == 0)
+        return -1;
+    const int pos = m_backgroundSearch.result();
+    if (pos < 0)
+        return -1;
+
+    QByteArray text = dataMid(pos, pattern.size());
+    QByteArray lowerPattern = pattern;
+    if (!(findFlags & QTextDocument::FindCaseSensitively)) {
+        ::lower(text);
+        ::lower(lowerPattern);
+    }
+    const int length = text == lowerPattern ? pattern.size()
+                                            : calculateHexPattern(pattern).size();
+    setCursorPosition(pos);
+    setCursorPosition(pos + length, KeepAnchor);
+    return pos;
+}
+
 int BinEditor::dataIndexOf(const QByteArray &pattern, int from, bool caseSensitive) const
 {
     if (!m_inLazyMode && caseSensitive) {
         return m_data.indexOf(pattern, from);
     }
-
     int trailing = pattern.size();
     if (trailing > m_blockSize)
         return -1;
@@ -576,7 +827,6 @@ int BinEditor::dataLastIndexOf(const QByteArray &pattern, int from, bool caseSen
 {
     if (!m_inLazyMode && caseSensitive)
         return m_data.lastIndexOf(pattern, from);
-
     int trailing = pattern.size();
     if (trailing > m_blockSize)
         return -1;
@@ -613,6 +863,11 @@ int BinEditor::find(const QByteArray &pattern_arg, int from,
     if (pattern_arg.isEmpty())
         return 0;
 
+    if (searchesMapping())
+        return findInBackground(pattern_arg, from, findFlags);
+    if (!m_backgroundSearchPattern.isEmpty())
+        cancelBackgroundSearch();
+
     QByteArray pattern = pattern_arg;
 
     bool caseSensitiveSearch = (findFlags & QTextDocument::FindCaseSensitively);
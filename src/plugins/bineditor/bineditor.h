@@ -31,6 +31,8 @@
 #define BINEDITOR_H
 
 #include <QtCore/QBasicTimer>
+#include <QtCore/QFuture>
+#include <QtCore/QHash>
 #include <QtCore/QMap>
 #include <QtCore/QSet>
 #include <QtCore/QStack>
@@ -69,6 +71,19 @@ public:
     Q_INVOKABLE void setLazyData(quint64 startAddr, int range, int blockSize = 4096);
     inline int lazyDataBlockSize() const { return m_blockSize; }
     Q_INVOKABLE void addLazyData(quint64 block, const QByteArray &data);
+    // Drops all unmodified lazy blocks, e.g. after the data source changed.
+    Q_INVOKABLE void invalidateLazyData();
+    // Shows size bytes starting at data, e.g. a memory mapped file. Edits
+    // are kept in copies of the affected blocks. The memory must stay
+    // valid until other data is set.
+    void setMappedData(const uchar *data, int size);
+    inline bool inMappedMode() const { return m_mappedData != 0; }
+    // Stops using the mapped memory, e.g. because the file may have been
+    // truncated. Blocks are requested through lazyDataRequested() instead.
+    void unmapData();
+    // Upper bound for the cached lazy blocks. Least recently used ones
+    // are evicted first.
+    void setLazyDataCacheSize(int bytes);
     bool save(const QString &oldFileName, const QString &newFileName);
 
     void zoomIn(int range = 1);
@@ -112,6 +127,14 @@ public:
     QString addressString(quint64 address);
 
     static const int SearchStride = 1024 * 1024;
+    // Number of blocks requested ahead in scroll direction.
+    static const int ReadAheadBlocks = 4;
+    // Bytes to search per find() call before returning -2. Mapped data is
+    // searched in a worker thread instead, find() returns -2 until that is
+    // done and repeating the call with the same arguments gives the result.
+    int searchStride() const;
+    QFuture<int> backgroundSearch() const { return m_backgroundSearch; }
+    void cancelBackgroundSearch();
 
 public Q_SLOTS:
     void setFontSettings(const TextEditor::FontSettings &fs);
@@ -144,18 +167,33 @@ protected:
 private:
     bool m_inLazyMode;
     QByteArray m_data;
+    const uchar *m_mappedData;
     QMap <int, QByteArray> m_lazyData;
     int m_blockSize;
     QMap <int, QByteArray> m_modifiedData;
     mutable QSet<int> m_lazyRequests;
+    mutable QHash<int, quint64> m_lazyDataLastUse;
+    mutable quint64 m_lazyDataClock;
+    int m_lazyDataCacheSize;
+    int m_readAheadDirection;
     QByteArray m_emptyBlock;
     QByteArray m_lowerBlock;
     int m_size;
 
     int dataIndexOf(const QByteArray &pattern, int from, bool caseSensitive = true) const;
     int dataLastIndexOf(const QByteArray &pattern, int from, bool caseSensitive = true) const;
+    bool searchesMapping() const;
+    int findInBackground(const QByteArray &pattern, int from,
+                         QTextDocument::FindFlags findFlags);
+
+    QFuture<int> m_backgroundSearch;
+    QByteArray m_backgroundSearchPattern;
+    int m_backgroundSearchFrom;
+    QTextDocument::FindFlags m_backgroundSearchFlags;
 
     bool requestDataAt(int pos, bool synchronous = false) const;
+    void requestBlock(int block, bool synchronous) const;
+    void evictLazyData();
     char dataAt(int pos) const;
     void changeDataAt(int pos, char c);
     QByteArray dataMid(int from, int length) const;
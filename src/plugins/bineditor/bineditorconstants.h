@@ -35,6 +35,7 @@ namespace Constants {
 
 const char * const C_BINEDITOR          = "Binary Editor";
 const char * const C_BINEDITOR_MIMETYPE = "application/octet-stream";
+const char * const TASK_SEARCH          = "BinEditor.Task.Search";
 
 } // namespace Constants
 } // namespace BINEditor
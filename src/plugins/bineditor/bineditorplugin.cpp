@@ -33,6 +33,7 @@
 
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
+#include <QtCore/QFutureInterface>
 #include <QtCore/QDebug>
 #include <QtGui/QMenu>
 #include <QtGui/QAction>
@@ -46,6 +47,7 @@
 #include <coreplugin/editormanager/ieditor.h>
 #include <coreplugin/icore.h>
 #include <coreplugin/mimedatabase.h>
+#include <coreplugin/progressmanager/progressmanager.h>
 #include <coreplugin/uniqueidmanager.h>
 #include <extensionsystem/pluginmanager.h>
 #include <find/ifindsupport.h>
@@ -66,8 +68,10 @@ public:
     {
         m_editor = editor;
         m_incrementalStartPos = m_contPos = -1;
+        m_searchProgress = 0;
+        m_searchStartPos = 0;
     }
-    ~BinEditorFind() {}
+    ~BinEditorFind() { finishSearchProgress(); }
 
     bool supportsReplace() const { return false; }
     IFindSupport::FindFlags supportedFindFlags() const
@@ -90,8 +94,54 @@ public:
             m_editor->setCursorPosition(pos);
             return pos;
         }
+        if (m_searchProgress && m_searchProgress->isCanceled()) {
+            m_editor->cancelBackgroundSearch();
+            finishSearchProgress();
+            return -1;
+        }
+
+        const int found = m_editor->find(pattern, pos, Find::IFindSupport::textDocumentFlagsForFindFlags(findFlags));
+        if (found == -2)
+            reportSearchProgress(pos, findFlags & Find::IFindSupport::FindBackward);
+        else
+            finishSearchProgress();
+        return found;
+    }
 
-        return m_editor->find(pattern, pos, Find::IFindSupport::textDocumentFlagsForFindFlags(findFlags));
+    // Searches spanning several steps show up in the progress bar
+    // and can be canceled from there.
+    void reportSearchProgress(int pos, bool backward)
+    {
+        if (!m_searchProgress) {
+            m_searchStartPos = pos;
+            m_searchProgress = new QFutureInterface<void>;
+            m_searchProgress->setProgressRange(0, 1000);
+            Core::ICore::instance()->progressManager()->addTask(
+                m_searchProgress->future(), tr("Searching"),
+                QLatin1String(Constants::TASK_SEARCH),
+                Core::ProgressManager::CloseOnSuccess);
+            m_searchProgress->reportStarted();
+        }
+        // Mapped files are searched in a worker thread, which reports itself.
+        if (!m_editor->searchStride()) {
+            m_searchProgress->setProgressValue(m_editor->backgroundSearch().progressValue());
+            return;
+        }
+        const qint64 total = backward ? m_searchStartPos + 1
+            : m_editor->dataSize() - m_searchStartPos;
+        const qint64 done = qAbs(qint64(pos) - m_searchStartPos)
+            + m_editor->searchStride();
+        if (total > 0)
+            m_searchProgress->setProgressValue(qMin<qint64>(1000, done * 1000 / total));
+    }
+
+    void finishSearchProgress()
+    {
+        if (!m_searchProgress)
+            return;
+        m_searchProgress->reportFinished();
+        delete m_searchProgress;
+        m_searchProgress = 0;
     }
 
     Result findIncremental(const QString &txt, Find::IFindSupport::FindFlags findFlags) {
@@ -115,7 +165,7 @@ public:
                 result = NotYetFound;
                 m_contPos +=
                         findFlags & Find::IFindSupport::FindBackward
-                        ? -BinEditor::SearchStride : BinEditor::SearchStride;
+                        ? -m_editor->searchStride() : m_editor->searchStride();
             } else {
                 result = NotFound;
                 m_contPos = -1;
@@ -144,7 +194,7 @@ public:
         } else if (found == -2) {
             result = NotYetFound;
             m_contPos += findFlags & Find::IFindSupport::FindBackward
-                         ? -BinEditor::SearchStride : BinEditor::SearchStride;
+                         ? -m_editor->searchStride() : m_editor->searchStride();
         } else {
             result = NotFound;
             m_contPos = -1;
@@ -163,6 +213,8 @@ private:
     int m_incrementalStartPos;
     int m_contPos; // Only valid if last result was NotYetFound.
     QByteArray m_lastPattern;
+    QFutureInterface<void> *m_searchProgress;
+    int m_searchStartPos;
 };
 
 
@@ -175,9 +227,10 @@ public:
         m_mimeType(QLatin1String(BINEditor::Constants::C_BINEDITOR_MIMETYPE))
     {
         m_editor = parent;
+        m_mappedFile = 0;
         connect(m_editor, SIGNAL(lazyDataRequested(quint64, bool)), this, SLOT(provideData(quint64)));
     }
-    ~BinEditorFile() {}
+    ~BinEditorFile() { delete m_mappedFile; }
 
     virtual QString mimeType() const { return m_mimeType; }
 
@@ -194,6 +247,8 @@ public:
     }
 
     bool open(const QString &fileName) {
+        if (openMapped(fileName))
+            return true;
         QFile file(fileName);
         if (file.open(QIODevice::ReadOnly)) {
             m_fileName = fileName;
@@ -206,11 +261,43 @@ public:
                         setDisplayName(QFileInfo(fileName).fileName());
             }
             file.close();
+            delete m_mappedFile;
+            m_mappedFile = 0;
             return true;
         }
         return false;
     }
 
+    // Local files are mapped into memory, so opening them is instant
+    // regardless of their size and blocks don't need to be read.
+    bool openMapped(const QString &fileName) {
+        QFile *file = new QFile(fileName);
+        uchar *data = 0;
+        const qint64 size = qMin(file->size(), static_cast<qint64>(INT_MAX-16));
+        if (size > 0 && file->open(QIODevice::ReadOnly) && !file->isSequential())
+            data = file->map(0, size);
+        if (!data) {
+            delete file;
+            return false;
+        }
+        m_fileName = fileName;
+        m_editor->setMappedData(data, size);
+        m_editor->editorInterface()->
+                setDisplayName(QFileInfo(fileName).fileName());
+        // Only now the editor has stopped using the previous mapping.
+        delete m_mappedFile;
+        m_mappedFile = file;
+        return true;
+    }
+
+    void unmap() {
+        if (!m_mappedFile)
+            return;
+        m_editor->unmapData();
+        delete m_mappedFile;
+        m_mappedFile = 0;
+    }
+
 private slots:
     void provideData(quint64 block) {
         QFile file(m_fileName);
@@ -252,6 +339,11 @@ public:
     void modified(ReloadBehavior *behavior) {
         const QString fileName = m_fileName;
 
+        // Accessing a mapping beyond the end of a truncated file crashes,
+        // so whatever happened to the file, it is read from now on.
+        if (*behavior != Core::IFile::ReloadPermissions)
+            unmap();
+
         switch (*behavior) {
         case  Core::IFile::ReloadNone:
             return;
@@ -291,6 +383,7 @@ private:
     const QString m_mimeType;
     BinEditor *m_editor;
     QString m_fileName;
+    QFile *m_mappedFile;
 };
 
 class BinEditorInterface : public Core::IEditor
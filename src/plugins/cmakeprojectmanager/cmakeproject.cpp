@@ -41,6 +41,7 @@
 #include <utils/qtcassert.h>
 #include <coreplugin/icore.h>
 
+#include <QtCore/QHash>
 #include <QtCore/QMap>
 #include <QtCore/QDebug>
 #include <QtCore/QDir>
@@ -181,9 +182,9 @@ void CMakeProject::slotActiveBuildConfiguration()
     parseCMakeLists();
 }
 
-void CMakeProject::fileChanged(const QString &fileName)
+void CMakeProject::filesChanged(const QStringList &fileNames)
 {
-    Q_UNUSED(fileName)
+    Q_UNUSED(fileNames)
     if (m_insideFileChanged== true)
         return;
     m_insideFileChanged = true;
@@ -430,64 +431,58 @@ void CMakeProject::buildTree(CMakeProjectNode *rootNode, QList<ProjectExplorer::
     // Gather old list
     QList<ProjectExplorer::FileNode *> oldList;
     gatherFileNodes(rootNode, oldList);
-    qSort(oldList.begin(), oldList.end(), ProjectExplorer::ProjectNode::sortNodesByPath);
-    qSort(newList.begin(), newList.end(), ProjectExplorer::ProjectNode::sortNodesByPath);
 
-    // generate added and deleted list
-    QList<ProjectExplorer::FileNode *>::const_iterator oldIt  = oldList.constBegin();
-    QList<ProjectExplorer::FileNode *>::const_iterator oldEnd = oldList.constEnd();
-    QList<ProjectExplorer::FileNode *>::const_iterator newIt  = newList.constBegin();
-    QList<ProjectExplorer::FileNode *>::const_iterator newEnd = newList.constEnd();
+    QHash<QString, ProjectExplorer::FileNode *> newNodes;
+    foreach (ProjectExplorer::FileNode *fn, newList) {
+        if (newNodes.contains(fn->path()))
+            delete fn;
+        else
+            newNodes.insert(fn->path(), fn);
+    }
 
-    QList<ProjectExplorer::FileNode *> added;
+    // generate added and deleted list
     QList<ProjectExplorer::FileNode *> deleted;
-
-
-    while(oldIt != oldEnd && newIt != newEnd) {
-        if ( (*oldIt)->path() == (*newIt)->path()) {
-            delete *newIt;
-            ++oldIt;
-            ++newIt;
-        } else if ((*oldIt)->path() < (*newIt)->path()) {
-            deleted.append(*oldIt);
-            ++oldIt;
-        } else {
-            added.append(*newIt);
-            ++newIt;
+    QStringList addedPaths;
+    ProjectExplorer::ProjectNode::compareFilePaths(oldList, newNodes.keys(), &deleted, &addedPaths);
+
+    // add added nodes, one notification per folder
+    QHash<QString, ProjectExplorer::FolderNode *> folderByDirectory;
+    QHash<ProjectExplorer::FolderNode *, QList<ProjectExplorer::FileNode *> > addedByFolder;
+    foreach (const QString &path, addedPaths) {
+        ProjectExplorer::FileNode *fn = newNodes.take(path);
+        // Get relative path to rootNode
+        QString parentDir = QFileInfo(path).absolutePath();
+        ProjectExplorer::FolderNode *folder = folderByDirectory.value(parentDir);
+        if (!folder) {
+            folder = findOrCreateFolder(rootNode, parentDir);
+            folderByDirectory.insert(parentDir, folder);
         }
+        addedByFolder[folder].append(fn);
     }
+    // the remaining new nodes duplicate existing ones
+    qDeleteAll(newNodes);
 
-    while (oldIt != oldEnd) {
-        deleted.append(*oldIt);
-        ++oldIt;
-    }
-
-    while (newIt != newEnd) {
-        added.append(*newIt);
-        ++newIt;
-    }
-
-    // add added nodes
-    foreach (ProjectExplorer::FileNode *fn, added) {
-//        qDebug()<<"added"<<fn->path();
-        // Get relative path to rootNode
-        QString parentDir = QFileInfo(fn->path()).absolutePath();
-        ProjectExplorer::FolderNode *folder = findOrCreateFolder(rootNode, parentDir);
-        rootNode->addFileNodes(QList<ProjectExplorer::FileNode *>()<< fn, folder);
+    QHashIterator<ProjectExplorer::FolderNode *, QList<ProjectExplorer::FileNode *> > addIt(addedByFolder);
+    while (addIt.hasNext()) {
+        addIt.next();
+        rootNode->addFileNodes(addIt.value(), addIt.key());
     }
 
     // remove old file nodes and check wheter folder nodes can be removed
-    foreach (ProjectExplorer::FileNode *fn, deleted) {
-        ProjectExplorer::FolderNode *parent = fn->parentFolderNode();
-//        qDebug()<<"removed"<<fn->path();
-        rootNode->removeFileNodes(QList<ProjectExplorer::FileNode *>() << fn, parent);
+    QHash<ProjectExplorer::FolderNode *, QList<ProjectExplorer::FileNode *> > deletedByFolder;
+    foreach (ProjectExplorer::FileNode *fn, deleted)
+        deletedByFolder[fn->parentFolderNode()].append(fn);
+
+    QHashIterator<ProjectExplorer::FolderNode *, QList<ProjectExplorer::FileNode *> > removeIt(deletedByFolder);
+    while (removeIt.hasNext()) {
+        removeIt.next();
+        ProjectExplorer::FolderNode *parent = removeIt.key();
+        rootNode->removeFileNodes(removeIt.value(), parent);
         // Check for empty parent
-        while (parent->subFolderNodes().isEmpty() && parent->fileNodes().isEmpty()) {
+        while (parent != rootNode && parent->subFolderNodes().isEmpty() && parent->fileNodes().isEmpty()) {
             ProjectExplorer::FolderNode *grandparent = parent->parentFolderNode();
             rootNode->removeFolderNodes(QList<ProjectExplorer::FolderNode *>() << parent, grandparent);
             parent = grandparent;
-            if (parent == rootNode)
-                break;
         }
     }
 }
@@ -701,7 +696,7 @@ bool CMakeProject::restoreSettingsImpl(ProjectExplorer::PersistentSettingsReader
         makeStep->setBuildTarget("all", "all", true);
 
     m_watcher = new ProjectExplorer::FileWatcher(this);
-    connect(m_watcher, SIGNAL(fileChanged(QString)), this, SLOT(fileChanged(QString)));
+    connect(m_watcher, SIGNAL(filesChanged(QStringList)), this, SLOT(filesChanged(QStringList)));
     bool result = parseCMakeLists(); // Gets the directory from the active buildconfiguration
     if (!result)
         return false;
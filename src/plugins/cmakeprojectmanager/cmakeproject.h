@@ -130,7 +130,7 @@ protected:
     void changeBuildDirectory(ProjectExplorer::BuildConfiguration *configuration, const QString &newBuildDirectory);
 
 private slots:
-    void fileChanged(const QString &fileName);
+    void filesChanged(const QStringList &fileNames);
     void slotActiveBuildConfiguration();
 
 private:
@@ -27,6 +27,7 @@ SOURCES += mainwindow.cpp \
     flowlayout.cpp \
     generalsettings.cpp \
     filemanager.cpp \
+    filechangewatcher.cpp \
     uniqueidmanager.cpp \
     messagemanager.cpp \
     messageoutputwindow.cpp \
@@ -87,6 +88,7 @@ HEADERS += mainwindow.h \
     flowlayout.h \
     generalsettings.h \
     filemanager.h \
+    filechangewatcher.h \
     uniqueidmanager.h \
     messagemanager.h \
     messageoutputwindow.h \
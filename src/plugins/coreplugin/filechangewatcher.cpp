@@ -0,0 +1,712 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+#include "filechangewatcher.h"
+
+#include <utils/qtcassert.h>
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QDirIterator>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QPair>
+#include <QtCore/QPointer>
+#include <QtCore/QSet>
+#include <QtCore/QSocketNotifier>
+#include <QtCore/QTime>
+#include <QtCore/QTimer>
+
+#ifdef Q_OS_LINUX
+#  include <sys/inotify.h>
+#  include <errno.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+enum { debug = 0 };
+
+// Changes are delivered once nothing happened for this long...
+enum { QuietInterval = 100 };
+// ...but never later than this after the first change of a burst
+enum { MaximumDelay = 1000 };
+// The window over which the event rate is averaged, in seconds
+enum { RateWindow = 10 };
+
+namespace Core {
+namespace Internal {
+
+static QString cleanPath(const QString &path)
+{
+    return QDir::cleanPath(QDir::fromNativeSeparators(path));
+}
+
+/*!
+  The process wide service behind all FileChangeWatcher instances.
+
+  On Linux, inotify watches the directories containing the subscribed
+  files, so a project with thousands of files in a few dozen directories
+  needs only a few dozen watches. Everywhere else, and for directories
+  inotify refuses to watch, QFileSystemWatcher is used. Files in such
+  directories are handed to it individually, since it reports only
+  added and removed entries for a directory.
+
+  Watched paths that are deleted are watched again once they reappear,
+  e.g. after a branch switch or "rm -rf build; mkdir build".
+  */
+class FileChangeManager : public QObject
+{
+    Q_OBJECT
+public:
+    static FileChangeManager *instance();
+    static FileChangeManager *existingInstance() { return m_instance; }
+
+    void addWatcher(FileChangeWatcher *watcher);
+    void removeWatcher(FileChangeWatcher *watcher);
+
+    void subscribeFile(FileChangeWatcher *watcher, const QString &path);
+    void unsubscribeFile(FileChangeWatcher *watcher, const QString &path);
+    void subscribeDirectory(FileChangeWatcher *watcher, const QString &path, bool recursive);
+    void unsubscribeDirectory(FileChangeWatcher *watcher, const QString &path, bool recursive);
+
+    FileChangeWatcher::Statistics statistics() const;
+
+private slots:
+    void readInotifyEvents();
+    void pathChanged(const QString &path);
+    void deliverChanges();
+
+private:
+    FileChangeManager();
+    ~FileChangeManager();
+
+    bool watchesDirectoriesOfFiles() const;
+    void addWatch(const QString &path);
+    void removeWatch(const QString &path);
+    bool installWatch(const QString &path);
+    void watchLost(const QString &path);
+    void restoreWatches(const QString &directory);
+    void addSubdirectoryWatches(const QString &root, const QString &directory);
+    void directoryCreated(const QString &path);
+    void scheduleDelivery();
+    void countEvents(int count);
+
+    static FileChangeManager *m_instance;
+
+    int m_watcherCount;
+    QHash<QString, QList<FileChangeWatcher *> > m_fileSubscribers;
+    QHash<QString, QList<FileChangeWatcher *> > m_directorySubscribers;
+    QHash<QString, int> m_watchCount;               // path -> number of reasons to watch it
+    QHash<QString, int> m_recursiveCount;           // recursively subscribed directories
+    QHash<QString, QSet<QString> > m_subdirectoryWatches;
+    QHash<QString, QString> m_lostWatches;          // deleted path -> ancestor watched meanwhile
+    QSet<QString> m_polledFiles;                    // files watched themselves, not via their directory
+
+    QSet<QString> m_pendingPaths;
+    QTimer m_deliveryTimer;
+    QTime m_firstPendingChange;
+
+    qint64 m_eventsReceived;
+    qint64 m_batchesDelivered;
+    QList<QPair<uint, int> > m_recentEvents;        // events per second
+
+    QFileSystemWatcher *m_fallbackWatcher;
+    int m_inotifyFd;
+    QHash<int, QString> m_pathByDescriptor;
+    QHash<QString, int> m_descriptorByPath;
+    bool m_warnedAboutLimit;
+};
+
+FileChangeManager *FileChangeManager::m_instance = 0;
+
+FileChangeManager *FileChangeManager::instance()
+{
+    if (!m_instance)
+        m_instance = new FileChangeManager;
+    return m_instance;
+}
+
+FileChangeManager::FileChangeManager()
+    : m_watcherCount(0),
+      m_eventsReceived(0),
+      m_batchesDelivered(0),
+      m_fallbackWatcher(new QFileSystemWatcher(this)),
+      m_inotifyFd(-1),
+      m_warnedAboutLimit(false)
+{
+    m_deliveryTimer.setSingleShot(true);
+    m_deliveryTimer.setInterval(QuietInterval);
+    connect(&m_deliveryTimer, SIGNAL(timeout()), this, SLOT(deliverChanges()));
+
+    connect(m_fallbackWatcher, SIGNAL(fileChanged(QString)),
+            this, SLOT(pathChanged(QString)));
+    connect(m_fallbackWatcher, SIGNAL(directoryChanged(QString)),
+            this, SLOT(pathChanged(QString)));
+
+#ifdef Q_OS_LINUX
+    m_inotifyFd = ::inotify_init();
+    if (m_inotifyFd >= 0) {
+        ::fcntl(m_inotifyFd, F_SETFD, FD_CLOEXEC);
+        ::fcntl(m_inotifyFd, F_SETFL, ::fcntl(m_inotifyFd, F_GETFL) | O_NONBLOCK);
+        QSocketNotifier *notifier = new QSocketNotifier(m_inotifyFd, QSocketNotifier::Read, this);
+        connect(notifier, SIGNAL(activated(int)), this, SLOT(readInotifyEvents()));
+    }
+#endif
+}
+
+FileChangeManager::~FileChangeManager()
+{
+#ifdef Q_OS_LINUX
+    if (m_inotifyFd >= 0)
+        ::close(m_inotifyFd);
+#endif
+}
+
+void FileChangeManager::addWatcher(FileChangeWatcher *watcher)
+{
+    Q_UNUSED(watcher)
+    ++m_watcherCount;
+}
+
+void FileChangeManager::removeWatcher(FileChangeWatcher *watcher)
+{
+    Q_UNUSED(watcher)
+    if (--m_watcherCount == 0) {
+        // The last watcher may go away while we are delivering changes to it
+        m_instance = 0;
+        deleteLater();
+    }
+}
+
+// With inotify a file is watched through its directory, which also
+// notices files that are replaced by renaming a new version over them
+bool FileChangeManager::watchesDirectoriesOfFiles() const
+{
+    return m_inotifyFd >= 0;
+}
+
+void FileChangeManager::subscribeFile(FileChangeWatcher *watcher, const QString &path)
+{
+    QList<FileChangeWatcher *> &subscribers = m_fileSubscribers[path];
+    subscribers.append(watcher);
+    if (!watchesDirectoriesOfFiles()) {
+        addWatch(path);
+        return;
+    }
+    const QString directory = QFileInfo(path).path();
+    addWatch(directory);
+    // inotify refused the directory, so watch the file itself
+    if (subscribers.size() == 1 && !m_descriptorByPath.contains(directory)) {
+        m_polledFiles.insert(path);
+        addWatch(path);
+    }
+}
+
+void FileChangeManager::unsubscribeFile(FileChangeWatcher *watcher, const QString &path)
+{
+    QHash<QString, QList<FileChangeWatcher *> >::iterator it = m_fileSubscribers.find(path);
+    QTC_ASSERT(it != m_fileSubscribers.end(), return);
+    it.value().removeOne(watcher);
+    if (it.value().isEmpty()) {
+        m_fileSubscribers.erase(it);
+        if (m_polledFiles.remove(path))
+            removeWatch(path);
+    }
+    if (watchesDirectoriesOfFiles())
+        removeWatch(QFileInfo(path).path());
+    else
+        removeWatch(path);
+}
+
+void FileChangeManager::subscribeDirectory(FileChangeWatcher *watcher, const QString &path, bool recursive)
+{
+    m_directorySubscribers[path].append(watcher);
+    addWatch(path);
+    if (recursive && m_recursiveCount[path]++ == 0)
+        addSubdirectoryWatches(path, path);
+}
+
+void FileChangeManager::unsubscribeDirectory(FileChangeWatcher *watcher, const QString &path, bool recursive)
+{
+    QHash<QString, QList<FileChangeWatcher *> >::iterator it = m_directorySubscribers.find(path);
+    QTC_ASSERT(it != m_directorySubscribers.end(), return);
+    it.value().removeOne(watcher);
+    if (it.value().isEmpty())
+        m_directorySubscribers.erase(it);
+    removeWatch(path);
+    if (recursive && --m_recursiveCount[path] == 0) {
+        m_recursiveCount.remove(path);
+        foreach (const QString &subdirectory, m_subdirectoryWatches.take(path))
+            removeWatch(subdirectory);
+    }
+}
+
+void FileChangeManager::addWatch(const QString &path)
+{
+    if (m_watchCount[path]++ > 0)
+        return;
+    if (!installWatch(path))
+        watchLost(path);
+}
+
+void FileChangeManager::removeWatch(const QString &path)
+{
+    QHash<QString, int>::iterator it = m_watchCount.find(path);
+    if (it == m_watchCount.end() || --it.value() > 0)
+        return;
+    m_watchCount.erase(it);
+
+    QHash<QString, QString>::iterator lostIt = m_lostWatches.find(path);
+    if (lostIt != m_lostWatches.end()) {
+        const QString ancestor = lostIt.value();
+        m_lostWatches.erase(lostIt);
+        if (!ancestor.isEmpty())
+            removeWatch(ancestor);
+        return;
+    }
+
+#ifdef Q_OS_LINUX
+    QHash<QString, int>::iterator descriptorIt = m_descriptorByPath.find(path);
+    if (descriptorIt != m_descriptorByPath.end()) {
+        ::inotify_rm_watch(m_inotifyFd, descriptorIt.value());
+        m_pathByDescriptor.remove(descriptorIt.value());
+        m_descriptorByPath.erase(descriptorIt);
+        return;
+    }
+#endif
+
+    m_fallbackWatcher->removePath(path);
+}
+
+// Returns whether the path is watched now, by inotify or the fallback
+bool FileChangeManager::installWatch(const QString &path)
+{
+#ifdef Q_OS_LINUX
+    if (m_inotifyFd >= 0) {
+        const uint mask = IN_MODIFY | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | IN_CREATE
+                          | IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF;
+        const int descriptor = ::inotify_add_watch(m_inotifyFd, QFile::encodeName(path).constData(), mask);
+        if (descriptor >= 0) {
+            m_pathByDescriptor.insert(descriptor, path);
+            m_descriptorByPath.insert(path, descriptor);
+            return true;
+        }
+        if (errno == ENOSPC && !m_warnedAboutLimit) {
+            qWarning("FileChangeWatcher: inotify watch limit reached, falling back to polling. "
+                     "Consider raising /proc/sys/fs/inotify/max_user_watches.");
+            m_warnedAboutLimit = true;
+        }
+    }
+#endif
+
+    if (!QFileInfo(path).exists())
+        return false;
+    m_fallbackWatcher->addPath(path);
+    return true;
+}
+
+// The path is still wanted, but deleted. Watch the closest existing
+// ancestor until it comes back.
+void FileChangeManager::watchLost(const QString &path)
+{
+    if (m_lostWatches.contains(path))
+        return;
+    QString ancestor = QFileInfo(path).path();
+    while (ancestor != path && !QFileInfo(ancestor).exists())
+        ancestor = QFileInfo(ancestor).path();
+    if (ancestor == path)
+        ancestor.clear();
+    m_lostWatches.insert(path, ancestor);
+    if (!ancestor.isEmpty())
+        addWatch(ancestor);
+    // It may be back already, before the ancestor watch could notice
+    if (QFileInfo(path).exists())
+        restoreWatches(path);
+}
+
+// Watches again whatever was lost at or below directory and exists now.
+// Files may have been created in there before we noticed, so their
+// subscribers are told. What is still missing below directory moves on to
+// its closest existing ancestor, so that it notices being created too.
+void FileChangeManager::restoreWatches(const QString &directory)
+{
+    const QString prefix = directory + QLatin1Char('/');
+    QStringList restored;
+    QStringList missing;
+    QHash<QString, QString>::const_iterator it = m_lostWatches.constBegin();
+    for ( ; it != m_lostWatches.constEnd(); ++it) {
+        if (it.key() != directory && !it.key().startsWith(prefix))
+            continue;
+        if (QFileInfo(it.key()).exists())
+            restored.append(it.key());
+        else
+            missing.append(it.key());
+    }
+
+    foreach (const QString &path, missing) {
+        // Add the new ancestor watch before dropping the old one, which
+        // may well be the same
+        const QString ancestor = m_lostWatches.take(path);
+        watchLost(path);
+        if (!ancestor.isEmpty())
+            removeWatch(ancestor);
+    }
+    if (restored.isEmpty())
+        return;
+
+    QStringList ancestors;
+    foreach (const QString &path, restored) {
+        ancestors.append(m_lostWatches.take(path));
+        if (!installWatch(path))
+            watchLost(path);
+        m_pendingPaths.insert(path);
+        if (m_recursiveCount.contains(path))
+            addSubdirectoryWatches(path, path);
+    }
+    foreach (const QString &ancestor, ancestors) {
+        if (!ancestor.isEmpty())
+            removeWatch(ancestor);
+    }
+
+    const QSet<QString> restoredPaths = restored.toSet();
+    foreach (const QString &file, m_fileSubscribers.keys()) {
+        if (restoredPaths.contains(QFileInfo(file).path()))
+            m_pendingPaths.insert(file);
+    }
+}
+
+// Watches directory (unless it is the root itself) and everything below it
+// on behalf of the recursively subscribed root
+void FileChangeManager::addSubdirectoryWatches(const QString &root, const QString &directory)
+{
+    QSet<QString> &watched = m_subdirectoryWatches[root];
+    if (directory != root && !watched.contains(directory)) {
+        addWatch(directory);
+        watched.insert(directory);
+    }
+    QDirIterator it(directory, QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString subdirectory = it.next();
+        if (watched.contains(subdirectory))
+            continue;
+        addWatch(subdirectory);
+        watched.insert(subdirectory);
+    }
+}
+
+void FileChangeManager::directoryCreated(const QString &path)
+{
+    if (!m_lostWatches.isEmpty())
+        restoreWatches(path);
+    QString directory = path;
+    for (int slash = directory.lastIndexOf(QLatin1Char('/')); slash > 0;
+         slash = directory.lastIndexOf(QLatin1Char('/'))) {
+        directory.truncate(slash);
+        if (m_recursiveCount.contains(directory))
+            addSubdirectoryWatches(directory, path);
+    }
+}
+
+void FileChangeManager::readInotifyEvents()
+{
+#ifdef Q_OS_LINUX
+    char buffer[16384];
+    forever {
+        const ssize_t size = ::read(m_inotifyFd, buffer, sizeof(buffer));
+        if (size <= 0)
+            break;
+
+        int count = 0;
+        for (const char *at = buffer; at < buffer + size; ++count) {
+            const inotify_event *event = reinterpret_cast<const inotify_event *>(at);
+            at += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                // We lost track, so report everything anybody is interested in
+                foreach (const QString &path, m_fileSubscribers.keys())
+                    m_pendingPaths.insert(path);
+                foreach (const QString &path, m_directorySubscribers.keys())
+                    m_pendingPaths.insert(path);
+                continue;
+            }
+
+            const QString directory = m_pathByDescriptor.value(event->wd);
+            if (directory.isEmpty())
+                continue;
+            if (event->mask & (IN_IGNORED | IN_MOVE_SELF)) {
+                // The directory is gone, and so is the watch. A moved one
+                // keeps its watch, which would report the new location
+                // under the old path, so drop it ourselves; the
+                // IN_IGNORED that follows then finds no mapping.
+                if (event->mask & IN_MOVE_SELF) {
+                    ::inotify_rm_watch(m_inotifyFd, event->wd);
+                    m_pendingPaths.insert(directory);
+                    // Its files left with it, without events of their own
+                    foreach (const QString &file, m_fileSubscribers.keys()) {
+                        if (QFileInfo(file).path() == directory)
+                            m_pendingPaths.insert(file);
+                    }
+                }
+                m_pathByDescriptor.remove(event->wd);
+                m_descriptorByPath.remove(directory);
+                if (m_watchCount.contains(directory))
+                    watchLost(directory);
+                continue;
+            }
+
+            QString path = directory;
+            if (event->len > 0) {
+                path += QLatin1Char('/');
+                path += QFile::decodeName(event->name);
+            }
+            if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)))
+                directoryCreated(path);
+            m_pendingPaths.insert(path);
+        }
+        countEvents(count);
+    }
+    scheduleDelivery();
+#endif
+}
+
+void FileChangeManager::pathChanged(const QString &changedPath)
+{
+    countEvents(1);
+    const QString path = cleanPath(changedPath);
+    // QFileSystemWatcher silently drops deleted paths
+    if (m_watchCount.contains(path) && !QFileInfo(path).exists())
+        watchLost(path);
+    else if (!m_lostWatches.isEmpty())
+        restoreWatches(path);
+    m_pendingPaths.insert(path);
+    scheduleDelivery();
+}
+
+void FileChangeManager::countEvents(int count)
+{
+    m_eventsReceived += count;
+    const uint now = QDateTime::currentDateTime().toTime_t();
+    if (!m_recentEvents.isEmpty() && m_recentEvents.last().first == now)
+        m_recentEvents.last().second += count;
+    else
+        m_recentEvents.append(qMakePair(now, count));
+    while (m_recentEvents.first().first + RateWindow <= now)
+        m_recentEvents.removeFirst();
+}
+
+// Coalesces bursts like a branch switch into a single delivery
+void FileChangeManager::scheduleDelivery()
+{
+    if (m_pendingPaths.isEmpty())
+        return;
+    if (!m_deliveryTimer.isActive()) {
+        m_firstPendingChange.start();
+        m_deliveryTimer.start();
+    } else if (m_firstPendingChange.elapsed() < MaximumDelay - QuietInterval) {
+        m_deliveryTimer.start();
+    }
+}
+
+void FileChangeManager::deliverChanges()
+{
+    const QSet<QString> changedPaths = m_pendingPaths;
+    m_pendingPaths.clear();
+
+    QHash<FileChangeWatcher *, QStringList> changesByWatcher;
+    foreach (const QString &path, changedPaths) {
+        foreach (FileChangeWatcher *watcher, m_fileSubscribers.value(path))
+            changesByWatcher[watcher].append(watcher->m_files.value(path));
+
+        if (m_directorySubscribers.isEmpty())
+            continue;
+        foreach (FileChangeWatcher *watcher, m_directorySubscribers.value(path))
+            changesByWatcher[watcher].append(path);
+        // The direct parent reports to everybody, the directories above it
+        // only to recursive subscribers
+        bool isParent = true;
+        QString directory = path;
+        for (int slash = directory.lastIndexOf(QLatin1Char('/')); slash > 0;
+             slash = directory.lastIndexOf(QLatin1Char('/'))) {
+            directory.truncate(slash);
+            foreach (FileChangeWatcher *watcher, m_directorySubscribers.value(directory)) {
+                if (isParent || watcher->m_recursive.value(directory))
+                    changesByWatcher[watcher].append(path);
+            }
+            isParent = false;
+        }
+    }
+
+    if (changesByWatcher.isEmpty())
+        return;
+    ++m_batchesDelivered;
+    if (debug)
+        qDebug() << "FileChangeManager: delivering" << changedPaths.size() << "changes to"
+                 << changesByWatcher.size() << "watchers";
+
+    // Slots may delete other watchers
+    QList<QPair<QPointer<FileChangeWatcher>, QStringList> > deliveries;
+    QHashIterator<FileChangeWatcher *, QStringList> it(changesByWatcher);
+    while (it.hasNext()) {
+        it.next();
+        QStringList files = it.value();
+        files.removeDuplicates();
+        files.sort();
+        deliveries.append(qMakePair(QPointer<FileChangeWatcher>(it.key()), files));
+    }
+    for (int i = 0; i < deliveries.size(); ++i) {
+        if (FileChangeWatcher *watcher = deliveries.at(i).first)
+            emit watcher->filesChanged(deliveries.at(i).second);
+    }
+}
+
+FileChangeWatcher::Statistics FileChangeManager::statistics() const
+{
+    FileChangeWatcher::Statistics result;
+    result.watchedPaths = m_watchCount.size();
+    result.subscribedFiles = m_fileSubscribers.size();
+    result.subscribedDirectories = m_directorySubscribers.size();
+    result.watchers = m_watcherCount;
+    result.eventsReceived = m_eventsReceived;
+    result.batchesDelivered = m_batchesDelivered;
+
+    const uint now = QDateTime::currentDateTime().toTime_t();
+    int recentEvents = 0;
+    for (int i = 0; i < m_recentEvents.size(); ++i) {
+        if (m_recentEvents.at(i).first + RateWindow > now)
+            recentEvents += m_recentEvents.at(i).second;
+    }
+    result.eventsPerSecond = double(recentEvents) / RateWindow;
+    return result;
+}
+
+} // namespace Internal
+
+using namespace Core::Internal;
+
+FileChangeWatcher::Statistics::Statistics()
+    : watchedPaths(0),
+      subscribedFiles(0),
+      subscribedDirectories(0),
+      watchers(0),
+      eventsReceived(0),
+      batchesDelivered(0),
+      eventsPerSecond(0)
+{
+}
+
+FileChangeWatcher::FileChangeWatcher(QObject *parent)
+    : QObject(parent)
+{
+    FileChangeManager::instance()->addWatcher(this);
+}
+
+FileChangeWatcher::~FileChangeWatcher()
+{
+    removeFiles(files());
+    foreach (const QString &directory, directories())
+        removeDirectory(directory);
+    FileChangeManager::instance()->removeWatcher(this);
+}
+
+void FileChangeWatcher::addFile(const QString &file)
+{
+    const QString path = cleanPath(file);
+    if (file.isEmpty() || m_files.contains(path))
+        return;
+    m_files.insert(path, file);
+    FileChangeManager::instance()->subscribeFile(this, path);
+}
+
+void FileChangeWatcher::addFiles(const QStringList &files)
+{
+    foreach (const QString &file, files)
+        addFile(file);
+}
+
+void FileChangeWatcher::removeFile(const QString &file)
+{
+    const QString path = cleanPath(file);
+    if (!m_files.remove(path))
+        return;
+    FileChangeManager::instance()->unsubscribeFile(this, path);
+}
+
+void FileChangeWatcher::removeFiles(const QStringList &files)
+{
+    foreach (const QString &file, files)
+        removeFile(file);
+}
+
+QStringList FileChangeWatcher::files() const
+{
+    return m_files.values();
+}
+
+void FileChangeWatcher::addDirectory(const QString &directory, bool recursive)
+{
+    const QString path = cleanPath(directory);
+    if (directory.isEmpty())
+        return;
+    if (m_directories.contains(path)) {
+        if (m_recursive.value(path) == recursive)
+            return;
+        removeDirectory(directory);
+    }
+    m_directories.insert(path, directory);
+    m_recursive.insert(path, recursive);
+    FileChangeManager::instance()->subscribeDirectory(this, path, recursive);
+}
+
+void FileChangeWatcher::removeDirectory(const QString &directory)
+{
+    const QString path = cleanPath(directory);
+    if (!m_directories.remove(path))
+        return;
+    const bool recursive = m_recursive.take(path);
+    FileChangeManager::instance()->unsubscribeDirectory(this, path, recursive);
+}
+
+QStringList FileChangeWatcher::directories() const
+{
+    return m_directories.values();
+}
+
+FileChangeWatcher::Statistics FileChangeWatcher::statistics()
+{
+    if (FileChangeManager *manager = FileChangeManager::existingInstance())
+        return manager->statistics();
+    return Statistics();
+}
+
+} // namespace Core
+
+#include "filechangewatcher.moc"
@@ -0,0 +1,101 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+#ifndef FILECHANGEWATCHER_H
+#define FILECHANGEWATCHER_H
+
+#include <coreplugin/core_global.h>
+
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QStringList>
+
+namespace Core {
+
+namespace Internal {
+class FileChangeManager;
+}
+
+/*!
+  Subscribes to changes of files and directories.
+
+  All watchers share one process wide service that watches directories
+  rather than single files where the platform allows it, and that collects
+  bursts of changes before delivering them.
+  */
+class CORE_EXPORT FileChangeWatcher : public QObject
+{
+    Q_DISABLE_COPY(FileChangeWatcher)
+    Q_OBJECT
+public:
+    struct Statistics
+    {
+        Statistics();
+
+        int watchedPaths;          // paths registered with the operating system
+        int subscribedFiles;
+        int subscribedDirectories;
+        int watchers;
+        qint64 eventsReceived;     // raw events since the service was started
+        qint64 batchesDelivered;
+        double eventsPerSecond;    // averaged over the last ten seconds
+    };
+
+    explicit FileChangeWatcher(QObject *parent = 0);
+    virtual ~FileChangeWatcher();
+
+    void addFile(const QString &file);
+    void addFiles(const QStringList &files);
+    void removeFile(const QString &file);
+    void removeFiles(const QStringList &files);
+    QStringList files() const;
+
+    // Reports changes of the entries of a directory, and of all
+    // directories below it if recursive is set
+    void addDirectory(const QString &directory, bool recursive = false);
+    void removeDirectory(const QString &directory);
+    QStringList directories() const;
+
+    static Statistics statistics();
+
+signals:
+    // Emitted once per burst of changes, with the paths as they were added
+    void filesChanged(const QStringList &files);
+
+private:
+    friend class Internal::FileChangeManager;
+
+    QHash<QString, QString> m_files;        // clean path -> path as added
+    QHash<QString, QString> m_directories;
+    QHash<QString, bool> m_recursive;
+};
+
+} // namespace Core
+
+#endif // FILECHANGEWATCHER_H
@@ -30,6 +30,7 @@
 #include "filemanager.h"
 
 #include "editormanager.h"
+#include "filechangewatcher.h"
 #include "ieditor.h"
 #include "icore.h"
 #include "ifile.h"
@@ -47,7 +48,6 @@
 #include <QtCore/QFile>
 #include <QtCore/QDir>
 #include <QtCore/QTimer>
-#include <QtCore/QFileSystemWatcher>
 #include <QtGui/QFileDialog>
 #include <QtGui/QMessageBox>
 
@@ -85,11 +85,11 @@ static const char *filesKey = "Files";
 FileManager::FileManager(MainWindow *mw)
   : QObject(mw),
     m_mainWindow(mw),
-    m_fileWatcher(new QFileSystemWatcher(this)),
+    m_fileWatcher(new FileChangeWatcher(this)),
     m_blockActivated(false)
 {
-    connect(m_fileWatcher, SIGNAL(fileChanged(QString)),
-        this, SLOT(changedFile(QString)));
+    connect(m_fileWatcher, SIGNAL(filesChanged(QStringList)),
+        this, SLOT(changedFiles(QStringList)));
     connect(m_mainWindow, SIGNAL(windowActivated()),
         this, SLOT(mainWindowActivated()));
     connect(Core::ICore::instance(), SIGNAL(contextChanged(Core::IContext*)),
@@ -177,13 +177,13 @@ bool FileManager::removeFile(IFile *file)
 void FileManager::addWatch(const QString &filename)
 {
     if (!filename.isEmpty() && managedFiles(filename).isEmpty())
-        m_fileWatcher->addPath(filename);
+        m_fileWatcher->addFile(filename);
 }
 
 void FileManager::removeWatch(const QString &filename)
 {
     if (!filename.isEmpty() && managedFiles(filename).isEmpty())
-        m_fileWatcher->removePath(filename);
+        m_fileWatcher->removeFile(filename);
 }
 
 void FileManager::checkForNewFileName()
@@ -250,7 +250,7 @@ QList<IFile *> FileManager::modifiedFiles() const
 void FileManager::blockFileChange(IFile *file)
 {
     if (!file->fileName().isEmpty())
-        m_fileWatcher->removePath(file->fileName());
+        m_fileWatcher->removeFile(file->fileName());
 }
 
 /*!
@@ -263,7 +263,7 @@ void FileManager::unblockFileChange(IFile *file)
     foreach (IFile *managedFile, managedFiles(file->fileName()))
         updateFileInfo(managedFile);
     if (!file->fileName().isEmpty())
-        m_fileWatcher->addPath(file->fileName());
+        m_fileWatcher->addFile(file->fileName());
 }
 
 void FileManager::updateFileInfo(IFile *file)
@@ -460,11 +460,13 @@ QString FileManager::getSaveAsFileName(IFile *file)
     return absoluteFilePath;
 }
 
-void FileManager::changedFile(const QString &file)
+void FileManager::changedFiles(const QStringList &files)
 {
     const bool wasempty = m_changedFiles.isEmpty();
-    foreach (IFile *fileinterface, managedFiles(file))
-        m_changedFiles << fileinterface;
+    foreach (const QString &file, files) {
+        foreach (IFile *fileinterface, managedFiles(file))
+            m_changedFiles << fileinterface;
+    }
     if (wasempty && !m_changedFiles.isEmpty()) {
         QTimer::singleShot(200, this, SLOT(checkForReload()));
     }
@@ -503,8 +505,8 @@ void FileManager::checkForReload()
                 updateFileInfo(f);
 
                 // the file system watchers loses inodes when a file is removed/renamed. Work around it.
-                m_fileWatcher->removePath(f->fileName());
-                m_fileWatcher->addPath(f->fileName());
+                m_fileWatcher->removeFile(f->fileName());
+                m_fileWatcher->addFile(f->fileName());
             }
         }
         m_blockActivated = false;
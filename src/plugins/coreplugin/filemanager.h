@@ -39,12 +39,9 @@
 #include <QtCore/QStringList>
 #include <QtCore/QPointer>
 
-QT_BEGIN_NAMESPACE
-class QFileSystemWatcher;
-QT_END_NAMESPACE
-
 namespace Core {
 
+class FileChangeWatcher;
 class ICore;
 class IContext;
 class IFile;
@@ -108,7 +105,7 @@ private slots:
     void fileDestroyed(QObject *obj);
     void checkForNewFileName();
     void checkForReload();
-    void changedFile(const QString &file);
+    void changedFiles(const QStringList &files);
     void mainWindowActivated();
     void syncWithEditor(Core::IContext *context);
 
@@ -131,7 +128,7 @@ private:
     QString m_currentFile;
 
     Internal::MainWindow *m_mainWindow;
-    QFileSystemWatcher *m_fileWatcher;
+    FileChangeWatcher *m_fileWatcher;
     QList<QPointer<IFile> > m_changedFiles;
     bool m_blockActivated;
 };
@@ -82,6 +82,9 @@
 #include <QtCore/QTimer>
 #include <QtCore/QStack>
 #include <QtCore/QSettings>
+#include <QtCore/QSet>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
 #include <QtGui/QAction>
 #include <QtGui/QApplication>
 #include <QtGui/QHeaderView>
@@ -554,7 +557,6 @@ CPPEditor::CPPEditor(QWidget *parent)
     qRegisterMetaType<SemanticInfo>("SemanticInfo");
 
     m_semanticHighlighter = new SemanticHighlighter(this);
-    m_semanticHighlighter->start();
 
     setParenthesesMatchingEnabled(true);
     setMarksVisible(true);
@@ -1887,6 +1889,24 @@ void CPPEditor::semanticRehighlight()
     m_semanticHighlighter->rehighlight(currentSource());
 }
 
+static bool sameSelections(const QList<QTextEdit::ExtraSelection> &a,
+                           const QList<QTextEdit::ExtraSelection> &b)
+{
+    if (a.size() != b.size())
+        return false;
+
+    for (int i = 0; i < a.size(); ++i) {
+        const QTextEdit::ExtraSelection &sa = a.at(i);
+        const QTextEdit::ExtraSelection &sb = b.at(i);
+        if (sa.cursor.anchor() != sb.cursor.anchor()
+                || sa.cursor.position() != sb.cursor.position()
+                || sa.format != sb.format)
+            return false;
+    }
+
+    return true;
+}
+
 void CPPEditor::updateSemanticInfo(const SemanticInfo &semanticInfo)
 {
     if (semanticInfo.revision != document()->revision()) {
@@ -1930,7 +1950,10 @@ void CPPEditor::updateSemanticInfo(const SemanticInfo &semanticInfo)
         }
     }
 
-    setExtraSelections(CodeSemanticsSelection, allSelections);
+    // Only touch the editor when the uses actually changed, re-applying the
+    // same selections would repaint the whole viewport.
+    if (! sameSelections(allSelections, extraSelections(CodeSemanticsSelection)))
+        setExtraSelections(CodeSemanticsSelection, allSelections);
 }
 
 SemanticHighlighter::Source CPPEditor::currentSource(bool force)
@@ -1952,28 +1975,102 @@ SemanticHighlighter::Source CPPEditor::currentSource(bool force)
     return source;
 }
 
+namespace {
+
+// The highlighters that can still be served by a job.
+QMutex highlighterRegistryMutex;
+QSet<SemanticHighlighter *> highlighterRegistry;
+
+class SemanticHighlighterPool: public QThreadPool
+{
+public:
+    SemanticHighlighterPool()
+    {
+        // leave some room for the code model and the GUI thread
+        setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+    }
+};
+
+Q_GLOBAL_STATIC(SemanticHighlighterPool, semanticHighlighterPool)
+
+} // anonymous namespace
+
+class SemanticHighlighter::Job: public QRunnable
+{
+public:
+    Job(SemanticHighlighter *highlighter)
+        : m_highlighter(highlighter)
+    { }
+
+    virtual void run()
+    {
+        {
+            // The highlighter may have been destroyed while the job was queued.
+            QMutexLocker registryLocker(&highlighterRegistryMutex);
+            if (! highlighterRegistry.contains(m_highlighter))
+                return;
+
+            QMutexLocker locker(&m_highlighter->m_mutex);
+            m_highlighter->m_jobQueued = false;
+            m_highlighter->m_running = true;
+        }
+
+        m_highlighter->run();
+    }
+
+private:
+    SemanticHighlighter *m_highlighter;
+};
+
 SemanticHighlighter::SemanticHighlighter(QObject *parent)
-        : QThread(parent),
-          m_done(false)
+        : QObject(parent),
+          m_done(false),
+          m_jobQueued(false),
+          m_running(false)
 {
+    QMutexLocker locker(&highlighterRegistryMutex);
+    highlighterRegistry.insert(this);
 }
 
 SemanticHighlighter::~SemanticHighlighter()
 {
+    abort();
+    wait();
 }
 
 void SemanticHighlighter::abort()
 {
+    {
+        QMutexLocker registryLocker(&highlighterRegistryMutex);
+        highlighterRegistry.remove(this);
+    }
+
     QMutexLocker locker(&m_mutex);
     m_done = true;
-    m_condition.wakeOne();
+}
+
+void SemanticHighlighter::wait()
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_running)
+        m_condition.wait(&m_mutex);
 }
 
 void SemanticHighlighter::rehighlight(const Source &source)
 {
     QMutexLocker locker(&m_mutex);
     m_source = source;
-    m_condition.wakeOne();
+
+    // A queued job picks up the newest source, and a running one queues
+    // a new job when it is done.
+    if (! (m_jobQueued || m_running || m_done))
+        startJob();
+}
+
+void SemanticHighlighter::startJob()
+{
+    m_jobQueued = true;
+    semanticHighlighterPool()->start(new Job(this));
 }
 
 bool SemanticHighlighter::isOutdated()
@@ -1985,23 +2082,14 @@ bool SemanticHighlighter::isOutdated()
 
 void SemanticHighlighter::run()
 {
-    setPriority(QThread::IdlePriority);
+    QThread::currentThread()->setPriority(QThread::IdlePriority);
 
-    forever {
-        m_mutex.lock();
-
-        while (! (m_done || ! m_source.fileName.isEmpty()))
-            m_condition.wait(&m_mutex);
-
-        const bool done = m_done;
-        const Source source = m_source;
-        m_source.clear();
-
-        m_mutex.unlock();
-
-        if (done)
-            break;
+    m_mutex.lock();
+    const Source source = m_source;
+    m_source.clear();
+    m_mutex.unlock();
 
+    if (! source.fileName.isEmpty()) {
         const SemanticInfo info = semanticInfo(source);
 
         if (! isOutdated()) {
@@ -2012,6 +2100,17 @@ void SemanticHighlighter::run()
             emit changed(info);
         }
     }
+
+    QThread::currentThread()->setPriority(QThread::NormalPriority);
+
+    QMutexLocker locker(&m_mutex);
+    m_running = false;
+
+    // go to the end of the queue, so the other editors get their turn
+    if (! m_done && ! m_source.fileName.isEmpty())
+        startJob();
+
+    m_condition.wakeAll();
 }
 
 SemanticInfo SemanticHighlighter::semanticInfo(const Source &source)
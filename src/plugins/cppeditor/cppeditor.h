@@ -34,7 +34,6 @@
 #include <cplusplus/CppDocument.h>
 #include <texteditor/basetexteditor.h>
 
-#include <QtCore/QThread>
 #include <QtCore/QMutex>
 #include <QtCore/QWaitCondition>
 
@@ -87,7 +86,13 @@ public:
     LocalUseMap localUses;
 };
 
-class SemanticHighlighter: public QThread
+/*
+ * Computes the semantic info of an editor in a thread pool shared by all
+ * the C++ editors. Requests are coalesced: a queued request always works
+ * on the newest source, and results that got outdated while computing
+ * are dropped.
+ */
+class SemanticHighlighter: public QObject
 {
     Q_OBJECT
 
@@ -96,6 +101,7 @@ public:
     virtual ~SemanticHighlighter();
 
     void abort();
+    void wait();
 
     struct Source
     {
@@ -140,16 +146,20 @@ public:
 Q_SIGNALS:
     void changed(const SemanticInfo &semanticInfo);
 
-protected:
-    virtual void run();
-
 private:
+    class Job;
+    friend class Job;
+
+    void run();
     bool isOutdated();
+    void startJob();
 
 private:
     QMutex m_mutex;
     QWaitCondition m_condition;
     bool m_done;
+    bool m_jobQueued;
+    bool m_running;
     Source m_source;
     SemanticInfo m_lastSemanticInfo;
 };
@@ -63,6 +63,10 @@
 #include <QtCore/QDebug>
 #include <QtCore/QMap>
 #include <QtCore/QFile>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+#include <QtCore/QtConcurrentRun>
+#include <qtconcurrent/runextensions.h>
 #include <QtGui/QAction>
 #include <QtGui/QApplication>
 #include <QtGui/QDesktopWidget>
@@ -533,6 +537,17 @@ CppCodeCompletion::CppCodeCompletion(CppModelManager *manager)
       m_forcedCompletion(false),
       m_completionOperator(T_EOF_SYMBOL)
 {
+    m_updateGlobalCompletionsTimer = new QTimer(this);
+    m_updateGlobalCompletionsTimer->setInterval(500);
+    m_updateGlobalCompletionsTimer->setSingleShot(true);
+    connect(m_updateGlobalCompletionsTimer, SIGNAL(timeout()),
+            this, SLOT(updateGlobalCompletions()));
+
+    connect(&m_globalCompletionsWatcher, SIGNAL(resultReadyAt(int)),
+            this, SLOT(globalCompletionsReadyAt(int)));
+
+    connect(manager, SIGNAL(documentUpdated(CPlusPlus::Document::Ptr)),
+            this, SLOT(onDocumentUpdated(CPlusPlus::Document::Ptr)));
 }
 
 QIcon CppCodeCompletion::iconForSymbol(Symbol *symbol) const
@@ -845,6 +860,16 @@ int CppCodeCompletion::startCompletion(TextEditor::ITextEditable *editor)
 
     if (Document::Ptr thisDocument = snapshot.value(fileName)) {
         Symbol *lastVisibleSymbol = thisDocument->findSymbolAt(line, column);
+
+        if (expression.isEmpty() && (! m_completionOperator ||
+                                     m_completionOperator == T_COLON_COLON)) {
+            const GlobalCompletions globals = m_globalCompletions.value(fileName);
+            if (globals.document == thisDocument && globals.isValid(snapshot)) {
+                completeGlobals(globals, lastVisibleSymbol);
+                return m_startPosition;
+            }
+        }
+
         typeOfExpression.setSnapshot(m_manager->snapshot());
 
         QList<TypeOfExpression::Result> resolvedTypes = typeOfExpression(expression, thisDocument, lastVisibleSymbol,
@@ -1250,6 +1275,201 @@ void CppCodeCompletion::addCompletionItem(Symbol *symbol)
         m_completions.append(item);
 }
 
+void CppCodeCompletion::completeGlobals(const GlobalCompletions &globals, Symbol *lastVisibleSymbol)
+{
+    if (! m_completionOperator) {
+        addKeywords();
+        m_completions += globals.macros;
+    }
+
+    // The local scopes depend on the cursor position, so they are never cached.
+    QList<Scope *> localScopes;
+    if (lastVisibleSymbol) {
+        Scope *scope = lastVisibleSymbol->scope();
+
+        if (Function *fun = lastVisibleSymbol->asFunction())
+            scope = fun->members(); // handle ctor initializers.
+
+        for (; scope; scope = scope->enclosingScope()) {
+            if (scope == globals.document->globalSymbols())
+                break;
+
+            localScopes.append(scope);
+        }
+    }
+
+    if (! localScopes.isEmpty()) {
+        const QList<Scope *> globalScopes = globals.context.visibleScopes();
+        const QList<Scope *> visibleScopes = localScopes + globalScopes;
+
+        // Seed the expansion with the global scopes, so only the scopes
+        // reachable from the local ones are left to visit.
+        QList<Scope *> expandedScopes = globalScopes;
+        foreach (Scope *scope, localScopes)
+            globals.context.expand(scope, visibleScopes, &expandedScopes);
+
+        for (int i = globalScopes.size(); i < expandedScopes.size(); ++i) {
+            Scope *scope = expandedScopes.at(i);
+            for (unsigned j = 0; j < scope->symbolCount(); ++j)
+                addCompletionItem(scope->symbolAt(j));
+        }
+    }
+
+    m_completions += globals.symbols;
+}
+
+static void includeClosure_helper(const Snapshot &snapshot, Document::Ptr doc,
+                                  QList<Document::Ptr> *closure, QSet<QString> *processed)
+{
+    if (! doc || processed->contains(doc->fileName()))
+        return;
+
+    processed->insert(doc->fileName());
+    closure->append(doc);
+
+    foreach (const Document::Include &incl, doc->includes())
+        includeClosure_helper(snapshot, snapshot.value(incl.fileName()), closure, processed);
+}
+
+bool GlobalCompletions::isValid(const Snapshot &snapshot) const
+{
+    if (! document)
+        return false;
+
+    QList<Document::Ptr> currentClosure;
+    QSet<QString> processed;
+    includeClosure_helper(snapshot, snapshot.value(document->fileName()), &currentClosure, &processed);
+
+    // Documents are never modified in place, a reparsed file always
+    // gets a new Document with a new revision.
+    return currentClosure == includeClosure;
+}
+
+void CppCodeCompletion::buildGlobalCompletions(QFutureInterface<GlobalCompletions> &future,
+                                               CppCodeCompletion *collector,
+                                               QList<Document::Ptr> documents,
+                                               Snapshot snapshot)
+{
+    QThread::currentThread()->setPriority(QThread::IdlePriority);
+
+    future.setProgressRange(0, documents.size());
+
+    for (int i = 0; i < documents.size(); ++i) {
+        if (future.isCanceled())
+            break;
+
+        Document::Ptr doc = documents.at(i);
+
+        GlobalCompletions globals;
+        globals.document = doc;
+
+        QSet<QString> processed;
+        includeClosure_helper(snapshot, doc, &globals.includeClosure, &processed);
+        globals.includedFiles = processed;
+
+        globals.context = LookupContext(0, doc, doc, snapshot);
+
+        ConvertToCompletionItem toCompletionItem(collector);
+        foreach (Scope *scope, globals.context.visibleScopes()) {
+            for (unsigned j = 0; j < scope->symbolCount(); ++j) {
+                if (TextEditor::CompletionItem item = toCompletionItem(scope->symbolAt(j)))
+                    globals.symbols.append(item);
+            }
+        }
+
+        QSet<QString> processedMacroFiles;
+        QSet<QString> definedMacros;
+        addMacros_helper(globals.context, doc->fileName(), &processedMacroFiles, &definedMacros);
+
+        foreach (const QString &macroName, definedMacros) {
+            TextEditor::CompletionItem item(collector);
+            item.text = macroName;
+            item.icon = collector->m_icons.macroIcon();
+            globals.macros.append(item);
+        }
+
+        future.reportResult(globals);
+        future.setProgressValue(i + 1);
+    }
+
+    QThread::currentThread()->setPriority(QThread::NormalPriority);
+}
+
+void CppCodeCompletion::onDocumentUpdated(Document::Ptr doc)
+{
+    const QString fileName = doc->fileName();
+
+    bool affected = ! m_manager->core()->editorManager()->editorsForFileName(fileName).isEmpty();
+
+    if (! affected) {
+        QHashIterator<QString, GlobalCompletions> it(m_globalCompletions);
+        while (it.hasNext()) {
+            it.next();
+            if (it.value().includedFiles.contains(fileName)) {
+                m_pendingGlobalCompletions.insert(it.key());
+                affected = true;
+            }
+        }
+    } else {
+        m_pendingGlobalCompletions.insert(fileName);
+    }
+
+    if (affected)
+        m_updateGlobalCompletionsTimer->start();
+}
+
+void CppCodeCompletion::updateGlobalCompletions()
+{
+    if (m_globalCompletionsWatcher.isRunning()) {
+        // try again once the current build is done
+        m_updateGlobalCompletionsTimer->start();
+        return;
+    }
+
+    Core::EditorManager *editorManager = m_manager->core()->editorManager();
+
+    // drop the entries of the documents that are no longer opened
+    QMutableHashIterator<QString, GlobalCompletions> it(m_globalCompletions);
+    while (it.hasNext()) {
+        it.next();
+        if (editorManager->editorsForFileName(it.key()).isEmpty())
+            it.remove();
+    }
+
+    const Snapshot snapshot = m_manager->snapshot();
+
+    QList<Document::Ptr> documents;
+    foreach (const QString &fileName, m_pendingGlobalCompletions) {
+        if (editorManager->editorsForFileName(fileName).isEmpty())
+            continue;
+
+        Document::Ptr doc = snapshot.value(fileName);
+        if (! doc)
+            continue;
+
+        const GlobalCompletions &globals = m_globalCompletions.value(fileName);
+        if (globals.document == doc && globals.isValid(snapshot))
+            continue;
+
+        documents.append(doc);
+    }
+
+    m_pendingGlobalCompletions.clear();
+
+    if (documents.isEmpty())
+        return;
+
+    QFuture<GlobalCompletions> future = QtConcurrent::run(&CppCodeCompletion::buildGlobalCompletions,
+                                                          this, documents, snapshot);
+    m_globalCompletionsWatcher.setFuture(future);
+}
+
+void CppCodeCompletion::globalCompletionsReadyAt(int index)
+{
+    const GlobalCompletions globals = m_globalCompletionsWatcher.future().resultAt(index);
+    m_globalCompletions.insert(globals.document->fileName(), globals);
+}
+
 bool CppCodeCompletion::completeInclude(const QTextCursor &cursor)
 {
     QString directoryPrefix;
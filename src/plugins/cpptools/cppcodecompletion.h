@@ -33,6 +33,7 @@
 #include <ASTfwd.h>
 #include <FullySpecifiedType.h>
 #include <cplusplus/Icons.h>
+#include <cplusplus/LookupContext.h>
 #include <cplusplus/Overview.h>
 #include <cplusplus/TypeOfExpression.h>
 
@@ -40,9 +41,13 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QPointer>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QtCore/QFutureWatcher>
 
 QT_BEGIN_NAMESPACE
 class QTextCursor;
+class QTimer;
 QT_END_NAMESPACE
 
 namespace TextEditor {
@@ -76,6 +81,25 @@ private:
     QList<TextEditor::CompletionItem> _completions;
 };
 
+/*
+ * The completion candidates coming from the global scopes visible in a
+ * document. They are computed in the background after the code model
+ * updates the document and stay valid as long as no document of its
+ * include closure is replaced in the snapshot.
+ */
+class GlobalCompletions
+{
+public:
+    bool isValid(const CPlusPlus::Snapshot &snapshot) const;
+
+    CPlusPlus::Document::Ptr document;
+    QList<CPlusPlus::Document::Ptr> includeClosure; // document and all the files it includes
+    QSet<QString> includedFiles;
+    CPlusPlus::LookupContext context;
+    QList<TextEditor::CompletionItem> symbols;
+    QList<TextEditor::CompletionItem> macros;
+};
+
 class CppCodeCompletion : public TextEditor::ICompletionCollector
 {
     Q_OBJECT
@@ -102,15 +126,27 @@ public:
     bool isPartialCompletionEnabled() const;
     void setPartialCompletionEnabled(bool partialCompletionEnabled);
 
+private Q_SLOTS:
+    void onDocumentUpdated(CPlusPlus::Document::Ptr doc);
+    void updateGlobalCompletions();
+    void globalCompletionsReadyAt(int index);
+
 private:
     void addKeywords();
     void addMacros(const CPlusPlus::LookupContext &context);
-    void addMacros_helper(const CPlusPlus::LookupContext &context,
-                          const QString &fileName,
-                          QSet<QString> *processed,
-                          QSet<QString> *definedMacros);
+    static void addMacros_helper(const CPlusPlus::LookupContext &context,
+                                 const QString &fileName,
+                                 QSet<QString> *processed,
+                                 QSet<QString> *definedMacros);
     void addCompletionItem(CPlusPlus::Symbol *symbol);
 
+    void completeGlobals(const GlobalCompletions &globals, CPlusPlus::Symbol *lastVisibleSymbol);
+
+    static void buildGlobalCompletions(QFutureInterface<GlobalCompletions> &future,
+                                       CppCodeCompletion *collector,
+                                       QList<CPlusPlus::Document::Ptr> documents,
+                                       CPlusPlus::Snapshot snapshot);
+
     bool completeInclude(const QTextCursor &cursor);
 
     bool completeConstructorOrFunction(const QList<CPlusPlus::TypeOfExpression::Result> &,
@@ -162,6 +198,12 @@ private:
     CPlusPlus::TypeOfExpression typeOfExpression;
     QPointer<FunctionArgumentWidget> m_functionArgumentWidget;
     QList<TextEditor::CompletionItem> m_completions;
+
+    // global completion cache, one entry per document opened in an editor
+    QHash<QString, GlobalCompletions> m_globalCompletions;
+    QSet<QString> m_pendingGlobalCompletions;
+    QTimer *m_updateGlobalCompletionsTimer;
+    QFutureWatcher<GlobalCompletions> m_globalCompletionsWatcher;
 };
 
 } // namespace Internal
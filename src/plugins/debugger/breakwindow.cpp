@@ -42,10 +42,12 @@
 #include <QtCore/QFileInfoList>
 
 #include <QtGui/QAction>
+#include <QtGui/QCompleter>
 #include <QtGui/QHeaderView>
 #include <QtGui/QKeyEvent>
 #include <QtGui/QMenu>
 #include <QtGui/QResizeEvent>
+#include <QtGui/QStringListModel>
 #include <QtGui/QItemSelectionModel>
 #include <QtGui/QToolButton>
 #include <QtGui/QTreeView>
@@ -61,6 +63,8 @@ using Debugger::Internal::BreakWindow;
 
 class BreakByFunctionDialog : public QDialog, Ui::BreakByFunctionDialog
 {
+    Q_OBJECT
+
 public:
     explicit BreakByFunctionDialog(QWidget *parent)
       : QDialog(parent)
@@ -68,8 +72,27 @@ public:
         setupUi(this);
         connect(buttonBox, SIGNAL(accepted()), this, SLOT(accept()));
         connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject()));
+
+        // Complete from the symbols of the modules already loaded.
+        m_completionModel = new QStringListModel(this);
+        QCompleter *completer = new QCompleter(m_completionModel, this);
+        completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+        functionLineEdit->setCompleter(completer);
+        connect(functionLineEdit, SIGNAL(textEdited(QString)),
+            this, SLOT(updateCompletions(QString)));
     }
     QString functionName() const { return functionLineEdit->text(); }
+
+private slots:
+    void updateCompletions(const QString &text)
+    {
+        m_completionModel->setStringList(
+            Debugger::DebuggerManager::instance()->functionNameCompletions(text));
+        functionLineEdit->completer()->complete();
+    }
+
+private:
+    QStringListModel *m_completionModel;
 };
 
 
@@ -329,3 +352,4 @@ void BreakWindow::rowActivated(const QModelIndex &idx)
     emit breakpointActivated(idx.row());
 }
 
+#include "breakwindow.moc"
@@ -27,10 +27,12 @@ HEADERS += breakhandler.h \
     debuggerrunner.h \
     debuggertooltip.h \
     debuggerstringutils.h \
+    disassemblercache.h \
     watchutils.h \
     idebuggerengine.h \
     imports.h \
     moduleshandler.h \
+    modulesymbolcache.h \
     moduleswindow.h \
     outputcollector.h \
     procinterrupt.h \
@@ -54,8 +56,10 @@ SOURCES += breakhandler.cpp \
     debuggerplugin.cpp \
     debuggerrunner.cpp \
     debuggertooltip.cpp \
+    disassemblercache.cpp \
     watchutils.cpp \
     moduleshandler.cpp \
+    modulesymbolcache.cpp \
     moduleswindow.cpp \
     outputcollector.cpp \
     procinterrupt.cpp \
@@ -30,6 +30,7 @@
 #include "debuggeragents.h"
 #include "debuggerstringutils.h"
 #include "idebuggerengine.h"
+#include "moduleshandler.h"
 
 #include <coreplugin/coreconstants.h>
 #include <coreplugin/editormanager/editormanager.h>
@@ -44,10 +45,13 @@
 #include <utils/qtcassert.h>
 
 #include <QtCore/QDebug>
+#include <QtCore/QTimer>
 
 #include <QtGui/QMessageBox>
 #include <QtGui/QPlainTextEdit>
+#include <QtGui/QTextBlock>
 #include <QtGui/QTextCursor>
+#include <QtGui/QTextDocument>
 #include <QtGui/QSyntaxHighlighter>
 
 #include <limits.h>
@@ -67,6 +71,11 @@ namespace Internal {
     Objects form this class are created in response to user actions in
     the Gui for showing raw memory from the inferior. After creation
     it handles communication between the engine and the bineditor.
+
+    Block requests from the editor are collected until control returns
+    to the event loop and adjacent blocks are then fetched with a single
+    engine command. The editor's block cache is dropped whenever the
+    inferior stops again, as the memory may have changed meanwhile.
 */
 
 MemoryViewAgent::MemoryViewAgent(DebuggerManager *manager, quint64 addr)
@@ -76,7 +85,7 @@ MemoryViewAgent::MemoryViewAgent(DebuggerManager *manager, quint64 addr)
 }
 
 MemoryViewAgent::MemoryViewAgent(DebuggerManager *manager, const QString &addr)
-    : QObject(manager), m_engine(manager->currentEngine()), m_manager(manager) 
+    : QObject(manager), m_engine(manager->currentEngine()), m_manager(manager)
 {
     bool ok = true;
     init(addr.toULongLong(&ok, 0));
@@ -91,6 +100,13 @@ MemoryViewAgent::~MemoryViewAgent()
 
 void MemoryViewAgent::init(quint64 addr)
 {
+    m_fetchTimer = new QTimer(this);
+    m_fetchTimer->setSingleShot(true);
+    m_fetchTimer->setInterval(0);
+    connect(m_fetchTimer, SIGNAL(timeout()), this, SLOT(fetchPendingBlocks()));
+    connect(m_manager, SIGNAL(stateChanged(int)),
+        this, SLOT(handleStateChanged(int)));
+
     Core::EditorManager *editorManager = Core::EditorManager::instance();
     QString titlePattern = tr("Memory $");
     m_editor = editorManager->openEditorWithContents(
@@ -113,16 +129,54 @@ void MemoryViewAgent::init(quint64 addr)
 
 void MemoryViewAgent::fetchLazyData(quint64 block, bool sync)
 {
-    Q_UNUSED(sync); // FIXME: needed support for incremental searching
-    if (m_engine)
-        m_engine->fetchMemory(this, BinBlockSize * block, BinBlockSize);
+    // FIXME: needed support for incremental searching
+    m_pendingBlocks.insert(block);
+    if (sync)
+        fetchPendingBlocks();
+    else if (!m_fetchTimer->isActive())
+        m_fetchTimer->start();
+}
+
+void MemoryViewAgent::fetchPendingBlocks()
+{
+    m_fetchTimer->stop();
+    if (!m_engine) {
+        m_pendingBlocks.clear();
+        return;
+    }
+    QList<quint64> blocks = m_pendingBlocks.toList();
+    m_pendingBlocks.clear();
+    qSort(blocks);
+    for (int i = 0; i != blocks.size(); ) {
+        const quint64 first = blocks.at(i);
+        int count = 1;
+        while (i + count < blocks.size() && count < MaxFetchBlocks
+                && blocks.at(i + count) == first + count)
+            ++count;
+        m_engine->fetchMemory(this, BinBlockSize * first, BinBlockSize * count);
+        i += count;
+    }
 }
 
 void MemoryViewAgent::addLazyData(quint64 addr, const QByteArray &ba)
 {
-    if (m_editor && m_editor->widget())
+    if (!m_editor || !m_editor->widget())
+        return;
+    // Engines may deliver several blocks at once, the editor wants
+    // them one by one.
+    for (int pos = 0; pos + BinBlockSize <= ba.size(); pos += BinBlockSize)
         QMetaObject::invokeMethod(m_editor->widget(), "addLazyData",
-            Q_ARG(quint64, addr / BinBlockSize), Q_ARG(QByteArray, ba));
+            Q_ARG(quint64, (addr + pos) / BinBlockSize),
+            Q_ARG(QByteArray, ba.mid(pos, BinBlockSize)));
+}
+
+void MemoryViewAgent::handleStateChanged(int state)
+{
+    if (state != InferiorStopped)
+        return;
+    m_pendingBlocks.clear();
+    if (m_editor && m_editor->widget())
+        QMetaObject::invokeMethod(m_editor->widget(), "invalidateLazyData");
 }
 
 
@@ -157,7 +211,7 @@ struct DisassemblerViewAgentPrivate
     StackFrame frame;
     QPointer<DebuggerManager> manager;
     LocationMark2 *locationMark;
-    QHash<QString, QString> cache;
+    DisassemblerCache cache;
 };
 
 /*!
@@ -225,36 +279,61 @@ void DisassemblerViewAgent::resetLocation()
         d->editor->markableInterface()->removeMark(d->locationMark);
 }
 
-QString frameKey(const StackFrame &frame)
+// The binary the code of the frame lives in. Frames with debug information
+// do not name it, the shared library whose range contains the address does.
+// Addresses outside of all known libraries belong to the executable, unless
+// no library is known yet.
+static QString frameBinary(DebuggerManager *manager, const StackFrame &frame)
 {
-    return _("%1:%2:%3").arg(frame.function).arg(frame.file).arg(frame.from);
+    if (!frame.from.isEmpty())
+        return frame.from;
+    bool ok = false;
+    const quint64 address = frame.address.toULongLong(&ok, 0);
+    if (!ok)
+        return QString();
+    const QList<Module> modules = manager->modulesHandler()->modules();
+    bool haveRanges = false;
+    foreach (const Module &module, modules) {
+        bool startOk = false, endOk = false;
+        const quint64 start = module.startAddress.toULongLong(&startOk, 0);
+        const quint64 end = module.endAddress.toULongLong(&endOk, 0);
+        if (!startOk || !endOk)
+            continue;
+        haveRanges = true;
+        if (address >= start && address < end)
+            return module.moduleName;
+    }
+    return haveRanges ? manager->startParameters()->executable : QString();
 }
 
 void DisassemblerViewAgent::setFrame(const StackFrame &frame)
 {
     d->frame = frame;
-    if (!frame.function.isEmpty() && frame.function != _("??")) {
-        QHash<QString, QString>::ConstIterator it = d->cache.find(frameKey(frame));
-        if (it != d->cache.end()) {
-            QString msg = _("Use cache dissassembler for '%1' in '%2'")
-                .arg(frame.function).arg(frame.file);
-            d->manager->showDebuggerOutput(msg);
-            setContents(*it);
-            return;
-        }
-    } 
+    DisassemblerLines lines;
+    if (d->cache.find(frameBinary(d->manager, frame), frame, &lines)) {
+        QString msg = _("Use cache dissassembler for '%1' in '%2'")
+            .arg(frame.function).arg(frame.file);
+        d->manager->showDebuggerOutput(msg);
+        setContents(lines);
+        return;
+    }
     IDebuggerEngine *engine = d->manager->currentEngine();
     QTC_ASSERT(engine, return);
     engine->fetchDisassembler(this, frame);
 }
 
 void DisassemblerViewAgent::setContents(const QString &contents)
+{
+    setContents(disassemblerLinesFromString(contents));
+}
+
+void DisassemblerViewAgent::setContents(const DisassemblerLines &lines)
 {
     QTC_ASSERT(d, return);
     using namespace Core;
     using namespace TextEditor;
 
-    d->cache.insert(frameKey(d->frame), contents);
+    d->cache.insert(frameBinary(d->manager, d->frame), d->frame, lines);
     QPlainTextEdit *plainTextEdit = 0;
     EditorManager *editorManager = EditorManager::instance();
     if (!d->editor) {
@@ -272,38 +351,29 @@ void DisassemblerViewAgent::setContents(const QString &contents)
 
     plainTextEdit = qobject_cast<QPlainTextEdit *>(d->editor->widget());
     if (plainTextEdit)
-        plainTextEdit->setPlainText(contents);
+        plainTextEdit->setPlainText(disassemblerLinesToString(lines));
 
     d->editor->markableInterface()->removeMark(d->locationMark);
     d->editor->setDisplayName(_("Disassembler (%1)").arg(d->frame.function));
 
-    for (int pos = 0, line = 0; ; ++line, ++pos) {
-        if (contents.midRef(pos, d->frame.address.size()) == d->frame.address) {
-            d->editor->markableInterface()->addMark(d->locationMark, line + 1);
-            if (plainTextEdit) {
-                QTextCursor tc = plainTextEdit->textCursor();
-                tc.setPosition(pos);
-                plainTextEdit->setTextCursor(tc);
-            }
-            break;
+    bool ok = false;
+    const quint64 address = d->frame.address.toULongLong(&ok, 0);
+    const int line = ok ? disassemblerLineForAddress(lines, address) : -1;
+    if (line != -1) {
+        d->editor->markableInterface()->addMark(d->locationMark, line + 1);
+        if (plainTextEdit) {
+            QTextCursor tc(plainTextEdit->document()->findBlockByNumber(line));
+            plainTextEdit->setTextCursor(tc);
         }
-        pos = contents.indexOf('\n', pos + 1);
-        if (pos == -1)
-            break;
     }
 }
 
-bool DisassemblerViewAgent::contentsCoversAddress(const QString &contents) const
+bool DisassemblerViewAgent::contentsCoversAddress(const DisassemblerLines &lines) const
 {
     QTC_ASSERT(d, return false);
-    for (int pos = 0, line = 0; ; ++line, ++pos) { 
-        if (contents.midRef(pos, d->frame.address.size()) == d->frame.address)
-            return true;
-        pos = contents.indexOf('\n', pos + 1);
-        if (pos == -1)
-            break;
-    }
-    return false;
+    bool ok = false;
+    const quint64 address = d->frame.address.toULongLong(&ok, 0);
+    return ok && disassemblerLineForAddress(lines, address) != -1;
 }
 
 QString DisassemblerViewAgent::address() const
@@ -31,6 +31,7 @@
 #define DEBUGGER_AGENTS_H
 
 #include "debuggermanager.h"
+#include "disassemblercache.h"
 #include "stackframe.h"
 
 #include <coreplugin/editormanager/ieditor.h>
@@ -38,9 +39,14 @@
 #include <QtCore/QObject>
 #include <QtCore/QDebug>
 #include <QtCore/QPointer>
+#include <QtCore/QSet>
 #include <QtGui/QAction>
 
 
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
 namespace Debugger {
 class DebuggerManager;
 namespace Internal {
@@ -58,6 +64,8 @@ public:
     ~MemoryViewAgent();
 
     enum { BinBlockSize = 1024 };
+    // Adjacent block requests are merged into reads of at most this size.
+    enum { MaxFetchBlocks = 16 };
 
 public slots:
     // Called from Engine
@@ -65,12 +73,18 @@ public slots:
     // Called from Editor
     void fetchLazyData(quint64 block, bool sync);
 
+private slots:
+    void fetchPendingBlocks();
+    void handleStateChanged(int state);
+
 private:
     void init(quint64 startaddr);
 
     QPointer<IDebuggerEngine> m_engine;
     QPointer<Core::IEditor> m_editor;
     QPointer<DebuggerManager> m_manager;
+    QSet<quint64> m_pendingBlocks;
+    QTimer *m_fetchTimer;
 };
 
 
@@ -86,8 +100,9 @@ public:
     void setFrame(const StackFrame &frame);
     void resetLocation();
     Q_SLOT void setContents(const QString &contents);
+    void setContents(const DisassemblerLines &lines);
     QString address() const;
-    bool contentsCoversAddress(const QString &contents) const;
+    bool contentsCoversAddress(const DisassemblerLines &lines) const;
     void cleanup();
 
 private:
@@ -48,6 +48,7 @@
 
 #include "breakhandler.h"
 #include "moduleshandler.h"
+#include "modulesymbolcache.h"
 #include "registerhandler.h"
 #include "stackhandler.h"
 #include "stackframe.h"
@@ -1098,6 +1099,11 @@ QList<Symbol> DebuggerManager::moduleSymbols(const QString &moduleName)
     return d->m_engine->moduleSymbols(moduleName);
 }
 
+QStringList DebuggerManager::functionNameCompletions(const QString &text) const
+{
+    return d->m_modulesHandler->symbolCache()->completions(text);
+}
+
 void DebuggerManager::stepExec()
 {
     QTC_ASSERT(d->m_engine, return);
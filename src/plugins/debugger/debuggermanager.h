@@ -311,6 +311,7 @@ public:
     // stuff in this block should be made private by moving it to
     // one of the interfaces
     QList<Internal::Symbol> moduleSymbols(const QString &moduleName);
+    QStringList functionNameCompletions(const QString &text) const;
 
 signals:
     void debuggingFinished();
@@ -0,0 +1,250 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+#include "disassemblercache.h"
+#include "stackframe.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QStringList>
+
+#include <QtGui/QDesktopServices>
+
+using namespace Debugger;
+using namespace Debugger::Internal;
+
+enum { CacheFileMagic = 0x51434441, CacheFileVersion = 1 };
+
+static QDataStream &operator<<(QDataStream &str, const DisassemblerLine &line)
+{
+    str << line.address << line.function << qint32(line.offset)
+        << line.instruction;
+    return str;
+}
+
+static QDataStream &operator>>(QDataStream &str, DisassemblerLine &line)
+{
+    qint32 offset;
+    str >> line.address >> line.function >> offset >> line.instruction;
+    line.offset = offset;
+    return str;
+}
+
+static quint64 addressFromString(const QString &address, bool *ok)
+{
+    QString str = address;
+    str.remove(QLatin1Char('`')); // cdb separates 32 bit halves
+    return str.toULongLong(ok, 16);
+}
+
+//////////////////////////////////////////////////////////////////
+//
+// DisassemblerLine
+//
+//////////////////////////////////////////////////////////////////
+
+QString DisassemblerLine::toString() const
+{
+    if (isSource())
+        return QLatin1String("    ") + instruction;
+    const QString addressString = QLatin1String("0x") + QString::number(address, 16);
+    return addressString.leftJustified(15) + instruction;
+}
+
+DisassemblerLines Debugger::Internal::disassemblerLinesFromString(const QString &contents)
+{
+    DisassemblerLines lines;
+    foreach (const QString &text, contents.split(QLatin1Char('\n'))) {
+        DisassemblerLine line;
+        const int end = text.indexOf(QLatin1Char(' '));
+        if (!text.isEmpty() && !text.at(0).isSpace() && end != 0) {
+            bool ok = false;
+            const quint64 address = addressFromString(text.left(end), &ok);
+            if (ok && address) {
+                line.address = address;
+                line.instruction = end == -1 ? QString() : text.mid(end).trimmed();
+                lines.append(line);
+                continue;
+            }
+        }
+        line.instruction = text.startsWith(QLatin1String("    ")) ? text.mid(4) : text;
+        lines.append(line);
+    }
+    while (!lines.isEmpty() && lines.last().isSource()
+            && lines.last().instruction.isEmpty())
+        lines.removeLast();
+    return lines;
+}
+
+QString Debugger::Internal::disassemblerLinesToString(const DisassemblerLines &lines)
+{
+    QString contents;
+    contents.reserve(lines.size() * 60);
+    foreach (const DisassemblerLine &line, lines) {
+        contents += line.toString();
+        contents += QLatin1Char('\n');
+    }
+    return contents;
+}
+
+int Debugger::Internal::disassemblerLineForAddress(const DisassemblerLines &lines,
+    quint64 address)
+{
+    for (int i = 0; i != lines.size(); ++i)
+        if (lines.at(i).address == address)
+            return i;
+    return -1;
+}
+
+//////////////////////////////////////////////////////////////////
+//
+// DisassemblerCache
+//
+//////////////////////////////////////////////////////////////////
+
+DisassemblerCache::DisassemblerCache()
+  : m_entries(MaxMemoryEntries), m_diskWrites(0)
+{
+    m_cacheDirectory =
+        QDesktopServices::storageLocation(QDesktopServices::CacheLocation)
+            + QLatin1String("/debugger-disassembly");
+}
+
+QString DisassemblerCache::cacheKey(const QString &binary,
+    const StackFrame &frame, bool *persistent) const
+{
+    // Without a binary to check against there is no way to tell whether
+    // the function changed, so such entries do not outlive the session.
+    const QFileInfo fi(binary);
+    if (binary.isEmpty() || !fi.exists()) {
+        *persistent = false;
+        return QLatin1String("?:") + frame.function + QLatin1Char(':')
+            + frame.file + QLatin1Char(':') + frame.address;
+    }
+    *persistent = true;
+    return fi.absoluteFilePath() + QLatin1Char(':')
+        + QString::number(fi.size()) + QLatin1Char(':')
+        + QString::number(fi.lastModified().toTime_t()) + QLatin1Char(':')
+        + frame.function + QLatin1Char(':') + frame.file;
+}
+
+QString DisassemblerCache::cacheFileName(const QString &key) const
+{
+    return m_cacheDirectory + QLatin1Char('/')
+        + QString::number(qHash(key), 16) + QLatin1String(".disasm");
+}
+
+bool DisassemblerCache::find(const QString &binary, const StackFrame &frame,
+    DisassemblerLines *lines)
+{
+    if (frame.function.isEmpty() || frame.function == QLatin1String("??"))
+        return false;
+    bool ok = false;
+    const quint64 address = addressFromString(frame.address, &ok);
+    if (!ok)
+        return false;
+    bool persistent = false;
+    const QString key = cacheKey(binary, frame, &persistent);
+
+    if (const DisassemblerLines *cached = m_entries.object(key)) {
+        if (disassemblerLineForAddress(*cached, address) == -1)
+            return false;
+        *lines = *cached;
+        return true;
+    }
+    if (!persistent)
+        return false;
+
+    QFile file(cacheFileName(key));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream str(&file);
+    quint32 magic, version;
+    QString fileKey;
+    DisassemblerLines fileLines;
+    str >> magic >> version;
+    if (magic != quint32(CacheFileMagic) || version != quint32(CacheFileVersion))
+        return false;
+    str >> fileKey;
+    // A different function with the same hash.
+    if (fileKey != key)
+        return false;
+    str >> fileLines;
+    if (str.status() != QDataStream::Ok)
+        return false;
+    m_entries.insert(key, new DisassemblerLines(fileLines));
+    if (disassemblerLineForAddress(fileLines, address) == -1)
+        return false;
+    *lines = fileLines;
+    return true;
+}
+
+void DisassemblerCache::insert(const QString &binary, const StackFrame &frame,
+    const DisassemblerLines &lines)
+{
+    if (frame.function.isEmpty() || frame.function == QLatin1String("??"))
+        return;
+    if (lines.isEmpty())
+        return;
+    bool persistent = false;
+    const QString key = cacheKey(binary, frame, &persistent);
+    m_entries.insert(key, new DisassemblerLines(lines));
+    if (!persistent)
+        return;
+
+    QDir().mkpath(m_cacheDirectory);
+    QFile file(cacheFileName(key));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return;
+    QDataStream str(&file);
+    str << quint32(CacheFileMagic) << quint32(CacheFileVersion) << key << lines;
+    file.close();
+
+    // Looking at the directory is not for free, so do it only now and then.
+    if (++m_diskWrites % 100 == 1)
+        pruneDiskCache();
+}
+
+void DisassemblerCache::pruneDiskCache()
+{
+    QDir dir(m_cacheDirectory);
+    const QFileInfoList files = dir.entryInfoList(
+        QStringList(QLatin1String("*.disasm")), QDir::Files, QDir::Time);
+    // Sorted by time, newest first.
+    for (int i = MaxDiskEntries; i < files.size(); ++i)
+        QFile::remove(files.at(i).absoluteFilePath());
+}
+
+void DisassemblerCache::clear()
+{
+    m_entries.clear();
+}
@@ -0,0 +1,112 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+#ifndef DEBUGGER_DISASSEMBLERCACHE_H
+#define DEBUGGER_DISASSEMBLERCACHE_H
+
+#include <QtCore/QCache>
+#include <QtCore/QList>
+#include <QtCore/QString>
+
+namespace Debugger {
+namespace Internal {
+
+struct StackFrame;
+
+//////////////////////////////////////////////////////////////////
+//
+// DisassemblerLine
+//
+//////////////////////////////////////////////////////////////////
+
+class DisassemblerLine
+{
+public:
+    DisassemblerLine() : address(0), offset(0) {}
+    bool isSource() const { return address == 0; }
+    QString toString() const;
+
+    quint64 address;     // 0 for source lines in mixed mode
+    QString function;
+    int offset;          // relative to the start of function
+    QString instruction; // the source code for source lines
+};
+
+typedef QList<DisassemblerLine> DisassemblerLines;
+
+// Parses plain disassembler output, one instruction per line with the
+// address in front. Lines not starting with an address are source lines.
+DisassemblerLines disassemblerLinesFromString(const QString &contents);
+QString disassemblerLinesToString(const DisassemblerLines &lines);
+// Returns the index of the line of the instruction at address, or -1.
+int disassemblerLineForAddress(const DisassemblerLines &lines, quint64 address);
+
+//////////////////////////////////////////////////////////////////
+//
+// DisassemblerCache
+//
+//////////////////////////////////////////////////////////////////
+
+/*
+ * Disassembled functions, kept in memory and on disk so they survive
+ * the debugging session. Entries are keyed by the binary containing the
+ * function, including its size and modification time, and the function
+ * name. A lookup only succeeds if the cached lines cover the address of
+ * the frame. Frames whose binary is not known are only kept in memory,
+ * keyed by their address as well.
+ */
+class DisassemblerCache
+{
+public:
+    DisassemblerCache();
+
+    bool find(const QString &binary, const StackFrame &frame,
+        DisassemblerLines *lines);
+    void insert(const QString &binary, const StackFrame &frame,
+        const DisassemblerLines &lines);
+    // Drops the entries held in memory, the disk cache stays.
+    void clear();
+
+    enum { MaxMemoryEntries = 200, MaxDiskEntries = 2000 };
+
+private:
+    QString cacheKey(const QString &binary, const StackFrame &frame,
+        bool *persistent) const;
+    QString cacheFileName(const QString &key) const;
+    void pruneDiskCache();
+
+    QCache<QString, DisassemblerLines> m_entries;
+    QString m_cacheDirectory;
+    int m_diskWrites;
+};
+
+} // namespace Internal
+} // namespace Debugger
+
+#endif // DEBUGGER_DISASSEMBLERCACHE_H
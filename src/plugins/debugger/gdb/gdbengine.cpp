@@ -52,6 +52,7 @@
 
 #include "breakhandler.h"
 #include "moduleshandler.h"
+#include "modulesymbolcache.h"
 #include "registerhandler.h"
 #include "stackhandler.h"
 #include "watchhandler.h"
@@ -89,6 +90,7 @@
 #include <dlfcn.h>
 #endif
 #include <ctype.h>
+#include <string.h>
 
 namespace Debugger {
 namespace Internal {
@@ -200,8 +202,14 @@ GdbEngine::GdbEngine(DebuggerManager *manager) :
     // Needs no resetting in initializeVariables()
     m_busy = false;
 
+    m_inbufferStart = 0;
+    m_inbufferEnd = 0;
+    m_inbufferScan = 0;
+
     connect(theDebuggerAction(AutoDerefPointers), SIGNAL(valueChanged(QVariant)),
             this, SLOT(setAutoDerefPointers(QVariant)));
+    connect(manager->modulesHandler()->symbolCache(), SIGNAL(symbolsLoaded(QString)),
+            this, SLOT(handleModuleSymbolsLoaded(QString)));
 }
 
 void GdbEngine::connectDebuggingHelperActions()
@@ -283,7 +291,9 @@ void GdbEngine::initializeVariables()
     m_pendingConsoleStreamOutput.clear();
     m_pendingLogStreamOutput.clear();
 
-    m_inbuffer.clear();
+    m_inbufferStart = 0;
+    m_inbufferEnd = 0;
+    m_inbufferScan = 0;
 
     m_commandTimer->stop();
 
@@ -294,6 +304,15 @@ void GdbEngine::initializeVariables()
     m_currentFunctionArgs.clear();
     m_currentFrame.clear();
     m_dumperHelper.clear();
+    m_debuggingHelperCache.clear();
+    m_watchUpdateTime = QTime();
+    m_stopTime = QTime();
+    m_stopTimeline.clear();
+    m_coalescedCommands = 0;
+    m_localsListedTime = 0;
+    m_helperCallCount = 0;
+    m_helperCacheHits = 0;
+    m_helperCacheMisses = 0;
 #ifdef Q_OS_LINUX
     m_entryPoint.clear();
 #endif
@@ -408,23 +427,11 @@ void GdbEngine::handleResponse(const QByteArray &buff)
             }
             //qDebug() << "ASYNCCLASS" << asyncClass;
 
+            // Archer may send results without a leading comma,
+            // they end up as an empty tuple.
             GdbMi result;
-            while (from != to) {
-                GdbMi data;
-                if (*from != ',') {
-                    // happens on archer where we get 
-                    // 23^running <NL> *running,thread-id="all" <NL> (gdb) 
-                    result.m_type = GdbMi::Tuple;
-                    break;
-                }
-                ++from; // skip ','
-                data.parseResultOrValue(from, to);
-                if (data.isValid()) {
-                    //qDebug() << "parsed result:" << data.toString();
-                    result.m_children += data;
-                    result.m_type = GdbMi::Tuple;
-                }
-            }
+            if (from != to)
+                result.fromResults(from, to, 0);
             if (asyncClass == "stopped") {
                 handleStopResponse(result);
                 m_pendingLogStreamOutput.clear();
@@ -573,18 +580,10 @@ void GdbEngine::handleResponse(const QByteArray &buff)
             }
 
             from = inner;
-            if (from != to) {
-                if (*from == ',') {
-                    ++from;
-                    response.data.parseTuple_helper(from, to);
-                    response.data.m_type = GdbMi::Tuple;
-                    response.data.m_name = "data";
-                } else {
-                    // Archer has this
-                    response.data.m_type = GdbMi::Tuple;
-                    response.data.m_name = "data";
-                }
-            }
+            // Archer has results without a leading comma,
+            // they end up as an empty tuple.
+            if (from != to)
+                response.data.fromResults(from, to, "data");
 
             //qDebug() << "\nLOG STREAM:" + m_pendingLogStreamOutput;
             //qDebug() << "\nCONSOLE STREAM:" + m_pendingConsoleStreamOutput;
@@ -618,38 +617,60 @@ void GdbEngine::readGdbStandardOutput()
     if (m_commandTimer->isActive()) 
         m_commandTimer->start(); // Retrigger
 
-    int newstart = 0;
-    int scan = m_inbuffer.size();
-
-    m_inbuffer.append(m_gdbProc.readAllStandardOutput());
-
-    // This can trigger when a dialog starts a nested event loop
+    // This can trigger when a dialog starts a nested event loop. The
+    // output stays with the process until the current line is handled.
     if (m_busy)
         return;
 
-    while (newstart < m_inbuffer.size()) {
-        int start = newstart;
-        int end = m_inbuffer.indexOf('\n', scan);
-        if (end < 0) {
-            m_inbuffer.remove(0, start);
+    // Output is read straight into a buffer that is kept across calls,
+    // each complete line is handled in place as soon as it is seen.
+    forever {
+        const int available = int(m_gdbProc.bytesAvailable());
+        if (available <= 0)
             return;
+        if (m_inbufferEnd + available > m_inbuffer.size()) {
+            if (m_inbufferStart > 0) {
+                ::memmove(m_inbuffer.data(), m_inbuffer.constData() + m_inbufferStart,
+                    m_inbufferEnd - m_inbufferStart);
+                m_inbufferEnd -= m_inbufferStart;
+                m_inbufferScan -= m_inbufferStart;
+                m_inbufferStart = 0;
+            }
+            if (m_inbufferEnd + available > m_inbuffer.size())
+                m_inbuffer.resize(qMax(2 * m_inbuffer.size(), m_inbufferEnd + available));
         }
-        newstart = end + 1;
-        scan = newstart;
-        if (end == start)
-            continue;
-        #if defined(Q_OS_WIN)
-        if (m_inbuffer.at(end - 1) == '\r') {
-            --end;
+        const qint64 read = m_gdbProc.read(m_inbuffer.data() + m_inbufferEnd, available);
+        if (read <= 0)
+            return;
+        m_inbufferEnd += read;
+
+        forever {
+            const char *data = m_inbuffer.constData();
+            const char *nl = static_cast<const char *>(::memchr(data + m_inbufferScan,
+                '\n', m_inbufferEnd - m_inbufferScan));
+            if (!nl) {
+                m_inbufferScan = m_inbufferEnd;
+                break;
+            }
+            const int start = m_inbufferStart;
+            int end = nl - data;
+            m_inbufferStart = m_inbufferScan = end + 1;
             if (end == start)
                 continue;
+            #if defined(Q_OS_WIN)
+            if (data[end - 1] == '\r') {
+                --end;
+                if (end == start)
+                    continue;
+            }
+            #endif
+            m_busy = true;
+            handleResponse(QByteArray::fromRawData(data + start, end - start));
+            m_busy = false;
         }
-        #endif
-        m_busy = true;
-        handleResponse(QByteArray::fromRawData(m_inbuffer.constData() + start, end - start));
-        m_busy = false;
+        if (m_inbufferStart == m_inbufferEnd)
+            m_inbufferStart = m_inbufferScan = m_inbufferEnd = 0;
     }
-    m_inbuffer.clear();
 }
 
 void GdbEngine::interruptInferior()
@@ -736,6 +757,13 @@ void GdbEngine::postCommandHelper(const GdbCommand &cmd)
         return;
     }
 
+    if ((cmd.flags & Coalescable) && hasPendingCommand(cmd)) {
+        // The answer to the earlier command will do for this one, too.
+        debugMessage(_("COALESCING COMMAND ") + cmd.command);
+        ++m_coalescedCommands;
+        return;
+    }
+
     if (cmd.flags & RebuildModel) {
         ++m_pendingRequests;
         PENDING_DEBUG("   MODEL:" << cmd.command << "=>" << cmd.callbackName
@@ -778,6 +806,27 @@ void GdbEngine::postCommandHelper(const GdbCommand &cmd)
     }
 }
 
+bool GdbEngine::hasPendingCommand(const GdbCommand &cmd) const
+{
+    // Commands are answered in order, so a pending command was sent while
+    // the inferior was in the state the new one would see.
+    foreach (const GdbCommand &other, m_commandsToRunOnTemporaryBreak)
+        if (other.command == cmd.command && other.callback == cmd.callback
+                && other.adapterCallback == cmd.adapterCallback)
+            return true;
+    // Answers to commands sent before the last token barrier are
+    // discarded in handleResultRecord(), so they cannot stand in.
+    QHash<int, GdbCommand>::const_iterator it = m_cookieForToken.constBegin();
+    for ( ; it != m_cookieForToken.constEnd(); ++it) {
+        if (it.key() < m_oldestAcceptableToken && (it->flags & Discardable))
+            continue;
+        if (it->command == cmd.command && it->callback == cmd.callback
+                && it->adapterCallback == cmd.adapterCallback)
+            return true;
+    }
+    return false;
+}
+
 void GdbEngine::flushQueuedCommands()
 {
     showStatusMessage(tr("Processing queued commands."), 1000);
@@ -923,6 +972,7 @@ void GdbEngine::handleResultRecord(GdbResponse *response)
     }
 
     GdbCommand cmd = m_cookieForToken.take(token);
+    recordCommandTiming(cmd);
     if (theDebuggerBoolSetting(LogTimeStamps)) {
         gdbOutputAvailable(LogTime, _("Response time: %1: %2 s")
             .arg(cmd.command)
@@ -985,8 +1035,55 @@ void GdbEngine::handleResultRecord(GdbResponse *response)
         PENDING_DEBUG("MISSING TOKENS: " << m_cookieForToken.keys());
     }
 
-    if (m_cookieForToken.isEmpty())
+    if (m_cookieForToken.isEmpty()) {
         m_commandTimer->stop();
+        if (m_commandsToRunOnTemporaryBreak.isEmpty())
+            finishStopTimeline();
+    }
+}
+
+void GdbEngine::startStopTimeline()
+{
+    m_stopTime.start();
+    m_stopTimeline.clear();
+    m_coalescedCommands = 0;
+}
+
+void GdbEngine::recordCommandTiming(const GdbCommand &cmd)
+{
+    if (!m_stopTime.isValid())
+        return;
+    CommandTiming timing;
+    timing.command = cmd.command;
+    timing.sentAt = m_stopTime.msecsTo(cmd.postTime);
+    timing.elapsed = cmd.postTime.msecsTo(QTime::currentTime());
+    m_stopTimeline.append(timing);
+}
+
+void GdbEngine::finishStopTimeline()
+{
+    if (!m_stopTime.isValid())
+        return;
+    int slowest = -1;
+    for (int i = 0; i != m_stopTimeline.size(); ++i)
+        if (slowest == -1 || m_stopTimeline.at(i).elapsed
+                > m_stopTimeline.at(slowest).elapsed)
+            slowest = i;
+    QString msg = _("<Stop handled in %1 ms: %2 commands, %3 coalesced")
+        .arg(m_stopTime.elapsed()).arg(m_stopTimeline.size())
+        .arg(m_coalescedCommands);
+    if (slowest != -1)
+        msg += _(", slowest %1 (%2 ms)").arg(m_stopTimeline.at(slowest).command)
+            .arg(m_stopTimeline.at(slowest).elapsed);
+    gdbInputAvailable(LogStatus, msg + QLatin1Char('>'));
+    if (theDebuggerBoolSetting(LogTimeStamps)) {
+        foreach (const CommandTiming &timing, m_stopTimeline)
+            gdbOutputAvailable(LogTime, _("  sent at +%1 ms, answered after "
+                "%2 ms: %3").arg(timing.sentAt, 5).arg(timing.elapsed, 5)
+                .arg(timing.command));
+    }
+    m_stopTime = QTime();
+    m_stopTimeline.clear();
 }
 
 void GdbEngine::executeDebuggerCommand(const QString &command)
@@ -1132,6 +1229,8 @@ void GdbEngine::handleStopResponse(const GdbMi &data)
     if (state() == InferiorStarting)
         return;
 
+    startStopTimeline();
+
     const QByteArray reason = data.findChild("reason").data();
 
     if (isExitedReason(reason)) {
@@ -2264,36 +2363,7 @@ void GdbEngine::loadAllSymbols()
 
 QList<Symbol> GdbEngine::moduleSymbols(const QString &moduleName)
 {
-    QList<Symbol> rc;
-    bool success = false;
-    QString errorMessage;
-    do {
-        const QString nmBinary = _("nm");
-        QProcess proc;
-        proc.start(nmBinary, QStringList() << _("-D") << moduleName);
-        if (!proc.waitForFinished()) {
-            errorMessage = tr("Unable to run '%1': %2").arg(nmBinary, proc.errorString());
-            break;
-        }
-        const QString contents = QString::fromLocal8Bit(proc.readAllStandardOutput());
-        const QRegExp re(_("([0-9a-f]+)?\\s+([^\\s]+)\\s+([^\\s]+)"));
-        Q_ASSERT(re.isValid());
-        foreach (const QString &line, contents.split(_c('\n'))) {
-            if (re.indexIn(line) != -1) {
-                Symbol symbol;
-                symbol.address = re.cap(1);
-                symbol.state = re.cap(2);
-                symbol.name = re.cap(3);
-                rc.push_back(symbol);
-            } else {
-                qWarning("moduleSymbols: unhandled: %s", qPrintable(line));
-            }
-        }
-        success = true;
-    } while (false);
-    if (!success)
-        qWarning("moduleSymbols: %s\n", qPrintable(errorMessage));
-    return rc;
+    return manager()->modulesHandler()->symbolCache()->symbols(moduleName);
 }
 
 void GdbEngine::reloadModules()
@@ -2356,6 +2426,9 @@ void GdbEngine::handleModulesList(const GdbResponse &response)
         }
     }
     manager()->modulesHandler()->setModules(modules);
+
+    // Have the symbols ready for lookups by the time they are needed.
+    manager()->modulesHandler()->symbolCache()->loadSymbols(modules);
 }
 
 
@@ -2440,7 +2513,10 @@ void GdbEngine::reloadStack(bool forceGotoLocation)
     // of waiting for the first request to fail.
     if (m_gdbAdapter->isTrkAdapter())
         postCommand(cmd, WatchUpdate);
-    postCommand(cmd, WatchUpdate, CB(handleStackListFrames),
+    // A pending request that jumps to the location serves one that doesn't.
+    const GdbCommandFlags flags = forceGotoLocation
+        ? GdbCommandFlags(WatchUpdate) : GdbCommandFlags(WatchUpdate | Coalescable);
+    postCommand(cmd, flags, CB(handleStackListFrames),
         QVariant::fromValue<StackCookie>(StackCookie(false, forceGotoLocation)));
 }
 
@@ -2458,9 +2534,42 @@ StackFrame GdbEngine::parseStackFrame(const GdbMi &frameMi, int level)
     frame.from = _(frameMi.findChild("from").data());
     frame.line = frameMi.findChild("line").data().toInt();
     frame.address = _(frameMi.findChild("addr").data());
+    resolveFrameFunction(&frame);
     return frame;
 }
 
+// Names frames in libraries gdb has no symbols for from the symbol cache.
+bool GdbEngine::resolveFrameFunction(StackFrame *frame) const
+{
+    if (frame->from.isEmpty()
+            || (!frame->function.isEmpty() && frame->function != __("??")))
+        return false;
+    bool ok;
+    const quint64 address = frame->address.toULongLong(&ok, 16);
+    if (!ok)
+        return false;
+    QString name;
+    quint64 offset;
+    if (!manager()->modulesHandler()->symbolCache()->findFunction(
+            frame->from, address, &name, &offset))
+        return false;
+    frame->function = offset
+        ? name + _("+0x") + QString::number(offset, 16) : name;
+    return true;
+}
+
+void GdbEngine::handleModuleSymbolsLoaded(const QString &fileName)
+{
+    StackHandler *stackHandler = manager()->stackHandler();
+    QList<StackFrame> frames = stackHandler->frames();
+    bool changed = false;
+    for (int i = 0; i != frames.size(); ++i)
+        if (frames.at(i).from == fileName && resolveFrameFunction(&frames[i]))
+            changed = true;
+    if (changed)
+        stackHandler->setFrames(frames, stackHandler->canExpand());
+}
+
 void GdbEngine::handleStackListFrames(const GdbResponse &response)
 {
     bool handleIt = (m_isMacGdb || response.resultClass == GdbResultDone);
@@ -2625,7 +2734,7 @@ void GdbEngine::reloadRegisters()
                     Discardable, CB(handleRegisterListValues));
     } else {
         postCommand(_("-data-list-register-values x"),
-                    Discardable, CB(handleRegisterListValues));
+                    Discardable | Coalescable, CB(handleRegisterListValues));
     }
 }
 
@@ -2715,7 +2824,7 @@ bool GdbEngine::showToolTip()
     WatchHandler *handler = manager()->watchHandler();
     WatchModel *model = handler->model(TooltipsWatch);
     QString iname = tooltipINameForExpression(m_toolTipExpression);
-    WatchItem *item = model->findItem(iname, model->rootItem());
+    WatchItem *item = model->findItem(iname);
     if (!item) {
         hideDebuggerToolTip();
         return false;
@@ -2948,7 +3057,8 @@ void GdbEngine::runDebuggingHelper(const WatchData &data0, bool dumpChildren)
     WatchData data = data0;
 
     // Avoid endless loops created by faulty dumpers.
-    QString processedName = QString(_("%1-%2").arg(dumpChildren).arg(data.iname));
+    QString processedName = QString(_("%1-%2-%3").arg(dumpChildren)
+        .arg(data.iname).arg(data.childrenOffset));
     if (m_processedNames.contains(processedName)) {
         gdbInputAvailable(LogStatus,
             _("<Breaking endless loop for %1>").arg(data.iname));
@@ -2960,10 +3070,23 @@ void GdbEngine::runDebuggingHelper(const WatchData &data0, bool dumpChildren)
     }
     m_processedNames.insert(processedName);
 
+    if (!checkDebuggingHelperCache(data, dumpChildren))
+        callDebuggingHelper(data, dumpChildren);
+}
+
+void GdbEngine::callDebuggingHelper(const WatchData &data, bool dumpChildren)
+{
+    ++m_helperCallCount;
+
+    // Paged containers: either the next page, or everything retrieved so far.
+    const int childrenLimit = manager()->watchHandler()->childrenLimit(data.iname)
+        - data.childrenOffset;
+
     QByteArray params;
     QStringList extraArgs;
-    const QtDumperHelper::TypeData td = m_dumperHelper.typeData(data0.type);
-    m_dumperHelper.evaluationParameters(data, td, QtDumperHelper::GdbDebugger, &params, &extraArgs);
+    const QtDumperHelper::TypeData td = m_dumperHelper.typeData(data.type);
+    m_dumperHelper.evaluationParameters(data, td, QtDumperHelper::GdbDebugger,
+        &params, &extraArgs, qMax(1, childrenLimit), true);
 
     //int protocol = (data.iname.startsWith("watch") && data.type == "QImage") ? 3 : 2;
     //int protocol = data.iname.startsWith("watch") ? 3 : 2;
@@ -3203,6 +3326,8 @@ void GdbEngine::updateWatchData(const WatchData &data)
         updateLocals();
 #endif
     } else {
+        if (!m_watchUpdateTime.isValid())
+            startWatchUpdateTiming();
         // Bump requests to avoid model rebuilding during the nested
         // updateWatchModel runs.
         ++m_pendingRequests;
@@ -3243,10 +3368,30 @@ void GdbEngine::rebuildModel()
     PENDING_DEBUG("REBUILDING MODEL" << count);
     gdbInputAvailable(LogStatus, _("<Rebuild Watchmodel %1>").arg(count));
     showStatusMessage(tr("Finished retrieving data."), 400);
+    QTime modelTime;
+    modelTime.start();
     manager()->watchHandler()->endCycle();
+    if (m_watchUpdateTime.isValid()) {
+        gdbInputAvailable(LogStatus, _("<Watch update took %1 ms: locals %2 ms, "
+                "model %3 ms, %4 debugging helper calls, %5 cached values "
+                "unchanged, %6 changed>")
+            .arg(m_watchUpdateTime.elapsed()).arg(m_localsListedTime)
+            .arg(modelTime.elapsed()).arg(m_helperCallCount)
+            .arg(m_helperCacheHits).arg(m_helperCacheMisses));
+        m_watchUpdateTime = QTime();
+    }
     showToolTip();
 }
 
+void GdbEngine::startWatchUpdateTiming()
+{
+    m_watchUpdateTime.start();
+    m_localsListedTime = 0;
+    m_helperCallCount = 0;
+    m_helperCacheHits = 0;
+    m_helperCacheMisses = 0;
+}
+
 static inline double getDumperVersion(const GdbMi &contents)
 {
     const GdbMi dumperVersionG = contents.findChild("dumperversion");
@@ -3430,6 +3575,7 @@ void GdbEngine::handleDebuggingHelperValue2(const GdbResponse &response)
     //qDebug() << "FOR DATA:" << data.toString() << response.resultClass;
     if (response.resultClass != GdbResultDone) {
         qDebug() << "STRANGE CUSTOM DUMPER RESULT DATA:" << data.toString();
+        manager()->watchHandler()->cancelPage(data.iname);
         return;
     }
 
@@ -3439,6 +3585,7 @@ void GdbEngine::handleDebuggingHelperValue2(const GdbResponse &response)
         insertData(data);
         return;
     }
+    cacheDebuggingHelperResult(data, contents);
 
     setWatchDataType(data, response.data.findChild("type"));
     setWatchDataDisplayedType(data, response.data.findChild("displaytype"));
@@ -3449,11 +3596,140 @@ void GdbEngine::handleDebuggingHelperValue2(const GdbResponse &response)
     manager()->watchHandler()->insertBulkData(list);
 }
 
+// Must match QDumper::putCheckRanges().
+static const uint checksumOffsetBasis = 2166136261u;
+static const uint checksumPrime = 16777619u;
+
+enum { MaxDebuggingHelperCacheSize = 2000 };
+
+static QString debuggingHelperCacheKey(const WatchData &data)
+{
+    if (data.childrenOffset)
+        return data.iname + _c('#') + QString::number(data.childrenOffset);
+    return data.iname;
+}
+
+GdbEngine::DebuggingHelperCacheEntry::DebuggingHelperCacheEntry()
+  : addr(0), checksum(0), childrenLimit(0), childrenDumped(false),
+    dumpChildren(false), checkedRanges(0), checkedHash(0), checkFailed(false)
+{
+}
+
+void GdbEngine::cacheDebuggingHelperResult(const WatchData &data,
+    const GdbMi &contents)
+{
+    // Only dumpers knowing all memory their output depends on report it.
+    const GdbMi checksum = contents.findChild("checksum");
+    if (!checksum.isValid())
+        return;
+
+    DebuggingHelperCacheEntry entry;
+    entry.type = data.type;
+    entry.addr = contents.findChild("addr").data().toULongLong(0, 16);
+    foreach (const GdbMi &range, contents.findChild("checkranges").children()) {
+        const int size = range.findChild("size").data().toInt();
+        if (size > 0)
+            entry.ranges.append(qMakePair(
+                range.findChild("addr").data().toULongLong(0, 16), size));
+    }
+    // The object itself comes first, see checkDebuggingHelperCache().
+    if (entry.ranges.isEmpty() || entry.ranges.first().first != entry.addr)
+        return;
+    entry.checksum = checksum.data().toUInt();
+    entry.childrenDumped = contents.findChild("children").isValid()
+        || contents.findChild("numchild").data() == "0";
+    entry.childrenLimit = manager()->watchHandler()->childrenLimit(data.iname);
+    entry.contents = contents;
+
+    if (m_debuggingHelperCache.size() >= MaxDebuggingHelperCacheSize)
+        m_debuggingHelperCache.clear();
+    m_debuggingHelperCache.insert(debuggingHelperCacheKey(data), entry);
+}
+
+// Starts reading the memory a cached value was computed from. Returns
+// false if there is no usable cache entry for the item.
+bool GdbEngine::checkDebuggingHelperCache(const WatchData &data,
+    bool dumpChildren)
+{
+    const QHash<QString, DebuggingHelperCacheEntry>::iterator it =
+        m_debuggingHelperCache.find(debuggingHelperCacheKey(data));
+    if (it == m_debuggingHelperCache.end())
+        return false;
+
+    DebuggingHelperCacheEntry &entry = it.value();
+    const bool hasAddress = data.addr.startsWith(__("0x"));
+    if (entry.type != data.type
+            || (dumpChildren && !entry.childrenDumped)
+            || entry.childrenLimit
+                != manager()->watchHandler()->childrenLimit(data.iname)
+            || (hasAddress && data.addr.toULongLong(0, 16) != entry.addr)
+            || (!hasAddress && (data.exp.isEmpty() || data.exp.contains(_c('"'))))) {
+        m_debuggingHelperCache.erase(it);
+        return false;
+    }
+
+    entry.dumpChildren = dumpChildren;
+    entry.checkedRanges = 0;
+    entry.checkedHash = checksumOffsetBasis;
+    entry.checkFailed = false;
+    for (int i = 0; i != entry.ranges.size(); ++i) {
+        // Reading the object through its expression also tells whether
+        // it still lives at the same address.
+        const QPair<quint64, int> &range = entry.ranges.at(i);
+        const QString addr = (i == 0 && !hasAddress)
+            ? _("&(") + data.exp + _c(')')
+            : _("0x") + QString::number(range.first, 16);
+        postCommand(_("-data-read-memory \"%1\" x 1 1 %2").arg(addr).arg(range.second),
+            WatchUpdate, CB(handleDebuggingHelperCheck), qVariantFromValue(data));
+    }
+    return true;
+}
+
+void GdbEngine::handleDebuggingHelperCheck(const GdbResponse &response)
+{
+    const WatchData data = response.cookie.value<WatchData>();
+    const QHash<QString, DebuggingHelperCacheEntry>::iterator it =
+        m_debuggingHelperCache.find(debuggingHelperCacheKey(data));
+    if (it == m_debuggingHelperCache.end())
+        return;
+
+    // 5^done,addr="0x0804a008",nr-bytes="4",total-bytes="4",...,
+    //   memory=[{addr="0x0804a008",data=["0x38","0xa0","0x04","0x08"]}]
+    DebuggingHelperCacheEntry &entry = it.value();
+    if (response.resultClass == GdbResultDone) {
+        const GdbMi memory = response.data.findChild("memory").children().value(0);
+        if (entry.checkedRanges == 0
+                && memory.findChild("addr").data().toULongLong(0, 16) != entry.addr)
+            entry.checkFailed = true;
+        foreach (const GdbMi &byte, memory.findChild("data").children()) {
+            entry.checkedHash ^= byte.data().toUInt(0, 16);
+            entry.checkedHash *= checksumPrime;
+        }
+    } else {
+        entry.checkFailed = true;
+    }
+    if (++entry.checkedRanges < entry.ranges.size())
+        return;
+
+    if (!entry.checkFailed && entry.checkedHash == entry.checksum) {
+        ++m_helperCacheHits;
+        QList<WatchData> list;
+        handleChildren(data, entry.contents, &list);
+        manager()->watchHandler()->insertBulkData(list);
+    } else {
+        ++m_helperCacheMisses;
+        const bool dumpChildren = entry.dumpChildren;
+        m_debuggingHelperCache.erase(it);
+        callDebuggingHelper(data, dumpChildren);
+    }
+}
+
 void GdbEngine::handleChildren(const WatchData &data0, const GdbMi &item,
     QList<WatchData> *list)
 {
     //qDebug() << "HANDLE CHILDREN: " << data0.toString() << item.toString();
     WatchData data = data0;
+    data.childrenOffset = 0;
     if (!manager()->watchHandler()->isExpandedIName(data.iname))
         data.setChildrenUnneeded();
 
@@ -3472,6 +3748,10 @@ void GdbEngine::handleChildren(const WatchData &data0, const GdbMi &item,
     setWatchDataEditValue(data, item.findChild("editvalue"));
     setWatchDataExpression(data, item.findChild("exp"));
     setWatchDataChildCount(data, item.findChild("numchild"));
+    // Only part of the children of big containers are dumped.
+    const GdbMi childrenOffset = item.findChild("childrenoffset");
+    data.childCount = childrenOffset.isValid()
+        ? item.findChild("numchild").data().toInt() : -1;
     setWatchDataValue(data, item.findChild("value"),
         item.findChild("valueencoded").data().toInt());
     setWatchDataAddress(data, item.findChild("addr"));
@@ -3489,7 +3769,7 @@ void GdbEngine::handleChildren(const WatchData &data0, const GdbMi &item,
     setWatchDataChildCount(childtemplate, item.findChild("childnumchild"));
     //qDebug() << "CHILD TEMPLATE:" << childtemplate.toString();
 
-    int i = 0;
+    int i = childrenOffset.data().toInt();
     foreach (GdbMi child, children.children()) {
         WatchData data1 = childtemplate;
         GdbMi name = child.findChild("name");
@@ -3603,6 +3883,7 @@ void GdbEngine::updateLocals(const QVariant &cookie)
             CB(handleStackFrame));
     } else {
         m_processedNames.clear();
+        startWatchUpdateTiming();
 
         PENDING_DEBUG("\nRESET PENDING");
         //m_toolTipCache.clear();
@@ -3726,6 +4007,7 @@ void GdbEngine::handleStackListLocals(const GdbResponse &response)
                                       frame.function, frame.file, frame.line,
                                       &uninitializedVariables);
     }
+    m_localsListedTime = m_watchUpdateTime.elapsed();
     QList<WatchData> list;
     foreach (const GdbMi &item, locals) {
         const WatchData data = localVariable(item, uninitializedVariables, &seen);
@@ -3940,7 +4222,7 @@ void GdbEngine::handleVarListChildren(const GdbResponse &response)
         foreach (const GdbMi &child, children.children())
             handleVarListChildrenHelper(child, data);
 
-        if (children.children().isEmpty()) {
+        if (!children.childCount()) {
             // happens e.g. if no debug information is present or
             // if the class really has no children
             WatchData data1;
@@ -4009,6 +4291,7 @@ bool GdbEngine::checkDebuggingHelpers()
 void GdbEngine::setDebuggingHelperState(DebuggingHelperState s)
 {
     m_debuggingHelperState = s;
+    m_debuggingHelperCache.clear();
 }
 
 void GdbEngine::tryLoadDebuggingHelpers()
@@ -4130,12 +4413,13 @@ void GdbEngine::handleWatchPoint(const GdbResponse &response)
 
 struct MemoryAgentCookie
 {
-    MemoryAgentCookie() : agent(0), address(0) {}
-    MemoryAgentCookie(MemoryViewAgent *agent_, quint64 address_)
-        : agent(agent_), address(address_)
+    MemoryAgentCookie() : agent(0), address(0), length(0) {}
+    MemoryAgentCookie(MemoryViewAgent *agent_, quint64 address_, quint64 length_)
+        : agent(agent_), address(address_), length(length_)
     {}
     QPointer<MemoryViewAgent> agent;
     quint64 address;
+    quint64 length;
 };
 
 void GdbEngine::fetchMemory(MemoryViewAgent *agent, quint64 addr, quint64 length)
@@ -4143,7 +4427,7 @@ void GdbEngine::fetchMemory(MemoryViewAgent *agent, quint64 addr, quint64 length
     //qDebug() << "GDB MEMORY FETCH" << agent << addr << length;
     postCommand(_("-data-read-memory %1 x 1 1 %2").arg(addr).arg(length),
         NeedsStop, CB(handleFetchMemory),
-        QVariant::fromValue(MemoryAgentCookie(agent, addr)));
+        QVariant::fromValue(MemoryAgentCookie(agent, addr, length)));
 }
 
 void GdbEngine::handleFetchMemory(const GdbResponse &response)
@@ -4154,12 +4438,21 @@ void GdbEngine::handleFetchMemory(const GdbResponse &response)
     // data=["1","0","0","0","5","0","0","0","0","0","0","0","0","0","0","0"]}]
     MemoryAgentCookie ac = response.cookie.value<MemoryAgentCookie>();
     QTC_ASSERT(ac.agent, return);
+    if (response.resultClass != GdbResultDone) {
+        // A merged request fails as a whole if any part of the range is
+        // not accessible. Retry block by block to get the readable parts.
+        const quint64 blockSize = MemoryViewAgent::BinBlockSize;
+        if (ac.length > blockSize)
+            for (quint64 offset = 0; offset < ac.length; offset += blockSize)
+                fetchMemory(ac.agent, ac.address + offset, blockSize);
+        return;
+    }
     QByteArray ba;
     GdbMi memory = response.data.findChild("memory");
-    QTC_ASSERT(memory.children().size() <= 1, return);
-    if (memory.children().isEmpty())
+    QTC_ASSERT(memory.childCount() <= 1, return);
+    if (!memory.childCount())
         return;
-    GdbMi memory0 = memory.children().at(0); // we asked for only one 'row'
+    GdbMi memory0 = memory.childAt(0); // we asked for only one 'row'
     GdbMi data = memory0.findChild("data");
     foreach (const GdbMi &child, data.children()) {
         bool ok = true;
@@ -4216,23 +4509,17 @@ void GdbEngine::fetchDisassemblerByAddress(DisassemblerViewAgent *agent,
             QVariant::fromValue(DisassemblerAgentCookie(agent)));
 }
 
-static QByteArray parseLine(const GdbMi &line)
+static DisassemblerLine parseLine(const GdbMi &line)
 {
-    QByteArray ba;
-    ba.reserve(200);
-    QByteArray address = line.findChild("address").data();
-    //QByteArray funcName = line.findChild("func-name").data();
-    //QByteArray offset = line.findChild("offset").data();
-    QByteArray inst = line.findChild("inst").data();
-    ba += address + QByteArray(15 - address.size(), ' ');
-    //ba += funcName + "+" + offset + "  ";
-    //ba += QByteArray(30 - funcName.size() - offset.size(), ' ');
-    ba += inst;
-    ba += '\n';
-    return ba;
+    DisassemblerLine dl;
+    dl.address = line.findChild("address").data().toULongLong(0, 0);
+    dl.function = _(line.findChild("func-name").data());
+    dl.offset = line.findChild("offset").data().toInt();
+    dl.instruction = _(line.findChild("inst").data());
+    return dl;
 }
 
-QString GdbEngine::parseDisassembler(const GdbMi &lines)
+DisassemblerLines GdbEngine::parseDisassembler(const GdbMi &lines)
 {
     // ^done,data={asm_insns=[src_and_asm_line={line="1243",file=".../app.cpp",
     // line_asm_insn=[{address="0x08054857",func-name="main",offset="27",
@@ -4247,10 +4534,8 @@ QString GdbEngine::parseDisassembler(const GdbMi &lines)
 
     QList<QByteArray> fileContents;
     bool fileLoaded = false;
-    QByteArray ba;
-    ba.reserve(200 * lines.children().size());
+    DisassemblerLines result;
 
-    // FIXME: Performance?
     foreach (const GdbMi &child, lines.children()) {
         if (child.hasName("src_and_asm_line")) {
             // mixed mode
@@ -4263,17 +4548,20 @@ QString GdbEngine::parseDisassembler(const GdbMi &lines)
                 fileLoaded = true;
             }
             int line = child.findChild("line").data().toInt();
-            if (line >= 0 && line < fileContents.size())
-                ba += "    " + fileContents.at(line) + '\n';
+            if (line >= 0 && line < fileContents.size()) {
+                DisassemblerLine dl;
+                dl.instruction = QString::fromLocal8Bit(fileContents.at(line));
+                result.append(dl);
+            }
             GdbMi insn = child.findChild("line_asm_insn");
-            foreach (const GdbMi &line, insn.children()) 
-                ba += parseLine(line);
+            foreach (const GdbMi &line, insn.children())
+                result.append(parseLine(line));
         } else {
             // the non-mixed version
-            ba += parseLine(child);
+            result.append(parseLine(child));
         }
     }
-    return _(ba);
+    return result;
 }
 
 void GdbEngine::handleFetchDisassemblerByLine(const GdbResponse &response)
@@ -4283,9 +4571,9 @@ void GdbEngine::handleFetchDisassemblerByLine(const GdbResponse &response)
 
     if (response.resultClass == GdbResultDone) {
         GdbMi lines = response.data.findChild("asm_insns");
-        if (lines.children().isEmpty())
+        if (!lines.childCount())
             fetchDisassemblerByAddress(ac.agent, true);
-        else if (lines.children().size() == 1
+        else if (lines.childCount() == 1
                     && lines.childAt(0).findChild("line").data() == "0")
             fetchDisassemblerByAddress(ac.agent, true);
         else
@@ -4307,12 +4595,12 @@ void GdbEngine::handleFetchDisassemblerByAddress1(const GdbResponse &response)
 
     if (response.resultClass == GdbResultDone) {
         GdbMi lines = response.data.findChild("asm_insns");
-        if (lines.children().isEmpty())
+        if (!lines.childCount())
             fetchDisassemblerByAddress(ac.agent, false);
         else {
-            QString contents = parseDisassembler(lines);
+            DisassemblerLines contents = parseDisassembler(lines);
             if (ac.agent->contentsCoversAddress(contents)) {
-                ac.agent->setContents(parseDisassembler(lines));
+                ac.agent->setContents(contents);
             } else {
                 debugMessage(_("FALL BACK TO NON-MIXED"));
                 fetchDisassemblerByAddress(ac.agent, false);
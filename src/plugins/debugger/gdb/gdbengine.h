@@ -32,6 +32,7 @@
 
 #include "idebuggerengine.h"
 #include "debuggermanager.h" // only for StartParameters
+#include "disassemblercache.h"
 #include "gdbmi.h"
 #include "watchutils.h"
 
@@ -39,6 +40,7 @@
 #include <QtCore/QHash>
 #include <QtCore/QMap>
 #include <QtCore/QObject>
+#include <QtCore/QPair>
 #include <QtCore/QProcess>
 #include <QtCore/QPoint>
 #include <QtCore/QSet>
@@ -158,11 +160,16 @@ private slots:
 
     void handleAdapterCrashed(const QString &msg);
 
+    void handleModuleSymbolsLoaded(const QString &fileName);
+
 private:
     QTextCodec *m_outputCodec;
     QTextCodec::ConverterState m_outputCodecState;
 
-    QByteArray m_inbuffer;
+    QByteArray m_inbuffer; // never shrinks, holds unhandled output
+    int m_inbufferStart;   // first unhandled byte
+    int m_inbufferEnd;     // end of the output read so far
+    int m_inbufferScan;    // where to continue looking for a newline
     bool m_busy;
 
     QProcess m_gdbProc;
@@ -181,7 +188,8 @@ private: ////////// Gdb Command Management //////////
         RunRequest = 16,  // Callback expects GdbResultRunning instead of GdbResultDone
         ExitRequest = 32, // Callback expects GdbResultExit instead of GdbResultDone
         LosesChild = 64,   // Auto-set inferior shutdown related states
-        EmbedToken = 128   // Expand %1 in the command to the command token
+        EmbedToken = 128,  // Expand %1 in the command to the command token
+        Coalescable = 256  // Drop if an identical command is still unanswered
     };
     Q_DECLARE_FLAGS(GdbCommandFlags, GdbCommandFlag)
     private:
@@ -211,6 +219,7 @@ private: ////////// Gdb Command Management //////////
     // send and decrements on receipt, effectively preventing
     // watch model updates before everything is finished.
     void flushCommand(const GdbCommand &cmd);
+    bool hasPendingCommand(const GdbCommand &cmd) const;
     void postCommand(const QString &command,
                      GdbCommandFlags flags,
                      GdbCommandCallback callback = 0,
@@ -262,6 +271,7 @@ private: ////////// Gdb Output, State & Capability Handling //////////
     void handleStop1(const GdbResponse &response);
     void handleStop1(const GdbMi &data);
     StackFrame parseStackFrame(const GdbMi &mi, int level);
+    bool resolveFrameFunction(StackFrame *frame) const;
 
     virtual bool isSynchroneous() const;
     bool supportsThreads() const;
@@ -362,7 +372,7 @@ private: ////////// View & Data Stuff //////////
     void handleFetchDisassemblerByLine(const GdbResponse &response);
     void handleFetchDisassemblerByAddress1(const GdbResponse &response);
     void handleFetchDisassemblerByAddress0(const GdbResponse &response);
-    QString parseDisassembler(const GdbMi &lines);
+    DisassemblerLines parseDisassembler(const GdbMi &lines);
 
     //
     // Source file specific stuff
@@ -431,6 +441,7 @@ private: ////////// View & Data Stuff //////////
     void createGdbVariable(const WatchData &data);
 
     void runDebuggingHelper(const WatchData &data, bool dumpChildren);
+    void callDebuggingHelper(const WatchData &data, bool dumpChildren);
     void runDirectDebuggingHelper(const WatchData &data, bool dumpChildren);
     bool hasDebuggingHelperForType(const QString &type) const;
 
@@ -443,6 +454,7 @@ private: ////////// View & Data Stuff //////////
     //void handleToolTip(const GdbResponse &response);
     void handleQueryDebuggingHelper(const GdbResponse &response);
     void handleDebuggingHelperValue2(const GdbResponse &response);
+    void handleDebuggingHelperCheck(const GdbResponse &response);
     void handleDebuggingHelperValue3(const GdbResponse &response);
     void handleDebuggingHelperEditValue(const GdbResponse &response);
     void handleDebuggingHelperSetup(const GdbResponse &response);
@@ -460,6 +472,54 @@ private: ////////// View & Data Stuff //////////
     QSet<QString> m_processedNames;
     QMap<QString, QString> m_varToType;
 
+    // Debugging helper results of previous steps. They are re-used as long
+    // as the memory the dumper looked at is unchanged, which is much cheaper
+    // to verify than calling the dumper in the inferior again.
+    struct DebuggingHelperCacheEntry
+    {
+        DebuggingHelperCacheEntry();
+
+        QString type;
+        quint64 addr;
+        QList<QPair<quint64, int> > ranges;
+        uint checksum;
+        int childrenLimit;
+        bool childrenDumped;
+        GdbMi contents;
+
+        // State of a running check.
+        bool dumpChildren;
+        int checkedRanges;
+        uint checkedHash;
+        bool checkFailed;
+    };
+    bool checkDebuggingHelperCache(const WatchData &data, bool dumpChildren);
+    void cacheDebuggingHelperResult(const WatchData &data, const GdbMi &contents);
+    QHash<QString, DebuggingHelperCacheEntry> m_debuggingHelperCache;
+
+    // Timing of the current watch update, logged by rebuildModel().
+    void startWatchUpdateTiming();
+    QTime m_watchUpdateTime;
+    int m_localsListedTime;
+    int m_helperCallCount;
+    int m_helperCacheHits;
+    int m_helperCacheMisses;
+
+    // Round trip times of the commands answered while handling a stop,
+    // logged once all answers are in.
+    struct CommandTiming
+    {
+        QString command;
+        int sentAt;  // ms after the stop
+        int elapsed; // ms between sending and receiving the answer
+    };
+    void startStopTimeline();
+    void recordCommandTiming(const GdbCommand &cmd);
+    void finishStopTimeline();
+    QTime m_stopTime;
+    QList<CommandTiming> m_stopTimeline;
+    int m_coalescedCommands;
+
 private: ////////// Dumper Management //////////
     QString qtDumperLibraryName() const;
     bool checkDebuggingHelpers();
@@ -31,10 +31,13 @@
 
 #include <utils/qtcassert.h>
 
+#include <QtCore/QAtomicInt>
 #include <QtCore/QByteArray>
 #include <QtCore/QTextStream>
+#include <QtCore/QVector>
 
 #include <ctype.h>
+#include <string.h>
 
 namespace Debugger {
 namespace Internal {
@@ -44,191 +47,467 @@ QTextStream &operator<<(QTextStream &os, const GdbMi &mi)
     return os << mi.toString();
 }
 
-void GdbMi::parseResultOrValue(const char *&from, const char *to)
+//////////////////////////////////////////////////////////////////////////////////
+//
+// GdbMiRecord
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+class GdbMiRecord
 {
-    while (from != to && isspace(*from))
-        ++from;
+public:
+    struct Node
+    {
+        int type;
+        int name;       // position of the name in text
+        int nameSize;
+        int data;       // position of the unquoted value in text
+        int dataSize;
+        int children;   // position of the first child in children
+        int childCount;
+    };
 
-    //qDebug() << "parseResultOrValue: " << QByteArray(from, to - from);
-    parseValue(from, to);
-    if (isValid()) {
-        //qDebug() << "no valid result in " << QByteArray(from, to - from);
-        return;
+    GdbMiRecord() : ref(0) {}
+
+    int addNode(GdbMi::Type type)
+    {
+        const Node node = { type, 0, 0, 0, 0, 0, 0 };
+        nodes.append(node);
+        return nodes.size() - 1;
     }
-    if (from == to || *from == '(')
-        return;
-    const char *ptr = from;
-    while (ptr < to && *ptr != '=') {
-        //qDebug() << "adding" << QChar(*ptr) << "to name";
-        ++ptr;
+
+    int appendText(const QByteArray &ba)
+    {
+        const int pos = text.size();
+        text += ba;
+        return pos;
     }
-    m_name = QByteArray(from, ptr - from);
-    from = ptr;
-    if (from < to && *from == '=') {
-        ++from;
-        parseValue(from, to);
+
+    QByteArray bytes(int pos, int size) const
+    {
+        return QByteArray(text.constData() + pos, size);
     }
-}
 
-QByteArray GdbMi::parseCString(const char *&from, const char *to)
+    QAtomicInt ref;
+    QByteArray text;
+    QVector<Node> nodes;
+    QVector<int> children; // the children of a node are consecutive
+};
+
+// Finds the C string starting at from, which is moved past it.
+static bool scanCString(const char *&from, const char *to,
+    const char **begin, int *size)
 {
-    QByteArray result;
-    //qDebug() << "parseCString: " << QByteArray(from, to - from);
     if (*from != '"') {
         qDebug() << "MI Parse Error, double quote expected";
         ++from; // So we don't hang
-        return QByteArray();
+        return false;
     }
     const char *ptr = from;
     ++ptr;
     while (ptr < to) {
         if (*ptr == '"') {
             ++ptr;
-            result = QByteArray(from + 1, ptr - from - 2);
-            break;
+            *begin = from + 1;
+            *size = ptr - from - 2;
+            from = ptr;
+            return true;
         }
         if (*ptr == '\\') {
             ++ptr;
             if (ptr == to) {
                 qDebug() << "MI Parse Error, unterminated backslash escape";
                 from = ptr; // So we don't hang
-                return QByteArray();
+                return false;
             }
         }
         ++ptr;
     }
     from = ptr;
+    return false;
+}
 
-    int idx = result.indexOf('\\');
-    if (idx >= 0) {
-        char *dst = result.data() + idx;
-        const char *src = dst + 1, *end = result.data() + result.length();
-        do {
-            char c = *src++;
-            switch (c) {
-                case 'a': *dst++ = '\a'; break;
-                case 'b': *dst++ = '\b'; break;
-                case 'f': *dst++ = '\f'; break;
-                case 'n': *dst++ = '\n'; break;
-                case 'r': *dst++ = '\r'; break;
-                case 't': *dst++ = '\t'; break;
-                case 'v': *dst++ = '\v'; break;
-                case '"': *dst++ = '"'; break;
-                case '\\': *dst++ = '\\'; break;
-                default:
-                    {
-                        int chars = 0;
-                        uchar prod = 0;
-                        forever {
-                            if (c < '0' || c > '7') {
-                                --src;
-                                break;
-                            }
-                            prod = prod * 8 + c - '0';
-                            if (++chars == 3 || src == end)
-                                break;
-                            c = *src++;
-                        }
-                        if (!chars) {
-                            qDebug() << "MI Parse Error, unrecognized backslash escape";
-                            return QByteArray();
+// Resolves the escapes of a C string in place. Returns the new size,
+// or -1 for invalid escapes.
+static int unescapeCString(char *data, int size)
+{
+    char *dst = static_cast<char *>(::memchr(data, '\\', size));
+    if (!dst)
+        return size;
+    const char *src = dst + 1, *end = data + size;
+    do {
+        char c = *src++;
+        switch (c) {
+            case 'a': *dst++ = '\a'; break;
+            case 'b': *dst++ = '\b'; break;
+            case 'f': *dst++ = '\f'; break;
+            case 'n': *dst++ = '\n'; break;
+            case 'r': *dst++ = '\r'; break;
+            case 't': *dst++ = '\t'; break;
+            case 'v': *dst++ = '\v'; break;
+            case '"': *dst++ = '"'; break;
+            case '\\': *dst++ = '\\'; break;
+            default:
+                {
+                    int chars = 0;
+                    uchar prod = 0;
+                    forever {
+                        if (c < '0' || c > '7') {
+                            --src;
+                            break;
                         }
-                        *dst++ = prod;
+                        prod = prod * 8 + c - '0';
+                        if (++chars == 3 || src == end)
+                            break;
+                        c = *src++;
                     }
-            }
-            while (src != end) {
-                char c = *src++;
-                if (c == '\\')
-                    break;
-                *dst++ = c;
-            }
-        } while (src != end);
-        *dst = 0;
-        result.truncate(dst - result.data());
-    }
+                    if (!chars) {
+                        qDebug() << "MI Parse Error, unrecognized backslash escape";
+                        return -1;
+                    }
+                    *dst++ = prod;
+                }
+        }
+        while (src != end) {
+            char c = *src++;
+            if (c == '\\')
+                break;
+            *dst++ = c;
+        }
+    } while (src != end);
+    return dst - data;
+}
 
-    return result;
+//////////////////////////////////////////////////////////////////////////////////
+//
+// GdbMiParser
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+// Fills the node table of a record. Names and strings are not copied,
+// strings are unquoted where they are.
+class GdbMiParser
+{
+public:
+    explicit GdbMiParser(GdbMiRecord *record)
+        : m_record(record), m_base(record->text.data())
+    {}
+
+    char *begin() const { return m_base; }
+    char *end() const { return m_base + m_record->text.size(); }
+
+    int parseResultOrValue(char *&from, char *to);
+    void parseResults(int node, char *&from, char *to);
+
+private:
+    GdbMiRecord::Node &node(int index) { return m_record->nodes[index]; }
+    bool isValid(int index) const
+        { return m_record->nodes.at(index).type != GdbMi::Invalid; }
+
+    void parseValue(int index, char *&from, char *to);
+    void parseTuple(int index, char *&from, char *to);
+    void parseList(int index, char *&from, char *to);
+    void endChildren(int index, int mark);
+
+    GdbMiRecord *m_record;
+    char *m_base;
+    QVector<int> m_pending; // children of the open tuples and lists
+};
+
+int GdbMiParser::parseResultOrValue(char *&from, char *to)
+{
+    while (from != to && isspace(*from))
+        ++from;
+
+    const int index = m_record->addNode(GdbMi::Invalid);
+    parseValue(index, from, to);
+    if (isValid(index) || from == to || *from == '(')
+        return index;
+    char *ptr = from;
+    while (ptr < to && *ptr != '=')
+        ++ptr;
+    node(index).name = from - m_base;
+    node(index).nameSize = ptr - from;
+    from = ptr;
+    if (from < to && *from == '=') {
+        ++from;
+        parseValue(index, from, to);
+    }
+    return index;
 }
 
-void GdbMi::parseValue(const char *&from, const char *to)
+void GdbMiParser::parseValue(int index, char *&from, char *to)
 {
-    //qDebug() << "parseValue: " << QByteArray(from, to - from);
     switch (*from) {
         case '{':
-            parseTuple(from, to);
+            ++from;
+            parseTuple(index, from, to);
             break;
         case '[':
-            parseList(from, to);
+            ++from;
+            parseList(index, from, to);
             break;
-        case '"':
-            m_type = Const;
-            m_data = parseCString(from, to);
+        case '"': {
+            const char *pos = from;
+            const char *begin = 0;
+            int size = 0;
+            node(index).type = GdbMi::Const;
+            const bool ok = scanCString(pos, to, &begin, &size);
+            from = m_base + (pos - m_base);
+            if (ok) {
+                const int data = begin - m_base;
+                size = unescapeCString(m_base + data, size);
+                if (size >= 0) {
+                    node(index).data = data;
+                    node(index).dataSize = size;
+                }
+            }
             break;
+        }
         default:
             break;
     }
 }
 
-
-void GdbMi::parseTuple(const char *&from, const char *to)
+void GdbMiParser::parseTuple(int index, char *&from, char *to)
 {
-    //qDebug() << "parseTuple: " << QByteArray(from, to - from);
-    QTC_ASSERT(*from == '{', /**/);
-    ++from;
-    parseTuple_helper(from, to);
-}
-
-void GdbMi::parseTuple_helper(const char *&from, const char *to)
-{
-    //qDebug() << "parseTuple_helper: " << QByteArray(from, to - from);
-    m_type = Tuple;
+    node(index).type = GdbMi::Tuple;
+    const int mark = m_pending.size();
     while (from < to) {
         if (*from == '}') {
             ++from;
             break;
         }
-        GdbMi child;
-        child.parseResultOrValue(from, to);
-        //qDebug() << "\n=======\n" << qPrintable(child.toString()) << "\n========\n";
-        if (!child.isValid())
-            return;
-        m_children += child;
+        const int child = parseResultOrValue(from, to);
+        if (!isValid(child))
+            break;
+        m_pending.append(child);
         if (*from == ',')
             ++from;
     }
+    endChildren(index, mark);
 }
 
-void GdbMi::parseList(const char *&from, const char *to)
+void GdbMiParser::parseList(int index, char *&from, char *to)
 {
-    //qDebug() << "parseList: " << QByteArray(from, to - from);
-    QTC_ASSERT(*from == '[', /**/);
-    ++from;
-    m_type = List;
+    node(index).type = GdbMi::List;
+    const int mark = m_pending.size();
     while (from < to) {
         if (*from == ']') {
             ++from;
             break;
         }
-        GdbMi child;
-        child.parseResultOrValue(from, to);
-        if (child.isValid())
-            m_children += child;
+        const int child = parseResultOrValue(from, to);
+        if (isValid(child))
+            m_pending.append(child);
         if (*from == ',')
             ++from;
     }
+    endChildren(index, mark);
+}
+
+// The results of a result or async record: ( "," result )*
+void GdbMiParser::parseResults(int index, char *&from, char *to)
+{
+    node(index).type = GdbMi::Tuple;
+    const int mark = m_pending.size();
+    while (from < to && *from == ',') {
+        ++from;
+        const int child = parseResultOrValue(from, to);
+        if (isValid(child))
+            m_pending.append(child);
+    }
+    endChildren(index, mark);
+}
+
+void GdbMiParser::endChildren(int index, int mark)
+{
+    const int count = m_pending.size() - mark;
+    node(index).children = m_record->children.size();
+    node(index).childCount = count;
+    for (int i = mark; i < m_pending.size(); ++i)
+        m_record->children.append(m_pending.at(i));
+    m_pending.resize(mark);
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+//
+// GdbMi
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+GdbMi::GdbMi()
+    : m_record(0), m_index(-1)
+{}
+
+GdbMi::GdbMi(const QByteArray &str)
+    : m_record(0), m_index(-1)
+{
+    fromString(str);
+}
+
+GdbMi::GdbMi(GdbMiRecord *record, int index)
+    : m_record(record), m_index(index)
+{
+    m_record->ref.ref();
+}
+
+GdbMi::GdbMi(const GdbMi &other)
+    : m_record(other.m_record), m_index(other.m_index)
+{
+    if (m_record)
+        m_record->ref.ref();
+}
+
+GdbMi::~GdbMi()
+{
+    if (m_record && !m_record->ref.deref())
+        delete m_record;
+}
+
+GdbMi &GdbMi::operator=(const GdbMi &other)
+{
+    if (other.m_record)
+        other.m_record->ref.ref();
+    if (m_record && !m_record->ref.deref())
+        delete m_record;
+    m_record = other.m_record;
+    m_index = other.m_index;
+    return *this;
+}
+
+GdbMi::Type GdbMi::type() const
+{
+    return m_record ? Type(m_record->nodes.at(m_index).type) : Invalid;
+}
+
+QByteArray GdbMi::name() const
+{
+    if (!m_record)
+        return QByteArray();
+    const GdbMiRecord::Node &node = m_record->nodes.at(m_index);
+    return m_record->bytes(node.name, node.nameSize);
+}
+
+bool GdbMi::hasName(const char *name) const
+{
+    if (!m_record)
+        return !*name;
+    const GdbMiRecord::Node &node = m_record->nodes.at(m_index);
+    return int(qstrlen(name)) == node.nameSize
+        && !::memcmp(m_record->text.constData() + node.name, name, node.nameSize);
+}
+
+QByteArray GdbMi::data() const
+{
+    if (!m_record)
+        return QByteArray();
+    const GdbMiRecord::Node &node = m_record->nodes.at(m_index);
+    return m_record->bytes(node.data, node.dataSize);
+}
+
+QList<GdbMi> GdbMi::children() const
+{
+    QList<GdbMi> children;
+    const int count = childCount();
+    for (int i = 0; i < count; ++i)
+        children.append(childAt(i));
+    return children;
+}
+
+int GdbMi::childCount() const
+{
+    return m_record ? m_record->nodes.at(m_index).childCount : 0;
+}
+
+GdbMi GdbMi::childAt(int index) const
+{
+    QTC_ASSERT(index >= 0 && index < childCount(), return GdbMi());
+    const GdbMiRecord::Node &node = m_record->nodes.at(m_index);
+    return GdbMi(m_record, m_record->children.at(node.children + index));
+}
+
+GdbMi GdbMi::findChild(const char *name) const
+{
+    const int count = childCount();
+    for (int i = 0; i < count; ++i) {
+        const GdbMi child = childAt(i);
+        if (child.hasName(name))
+            return child;
+    }
+    return GdbMi();
+}
+
+void GdbMi::fromString(const QByteArray &ba)
+{
+    GdbMiRecord *record = new GdbMiRecord;
+    record->text = ba;
+    GdbMiParser parser(record);
+    char *from = parser.begin();
+    *this = GdbMi(record, parser.parseResultOrValue(from, parser.end()));
+}
+
+void GdbMi::fromResults(const char *from, const char *to, const char *name)
+{
+    // The name goes in front, the parser relies on the terminating 0.
+    const int nameSize = name ? int(qstrlen(name)) : 0;
+    GdbMiRecord *record = new GdbMiRecord;
+    record->text.reserve(nameSize + int(to - from));
+    record->text.append(QByteArray::fromRawData(name, nameSize));
+    record->text.append(QByteArray::fromRawData(from, to - from));
+    const int index = record->addNode(Tuple);
+    record->nodes[index].nameSize = nameSize;
+    GdbMiParser parser(record);
+    char *pos = parser.begin() + nameSize;
+    parser.parseResults(index, pos, parser.end());
+    *this = GdbMi(record, index);
 }
 
 void GdbMi::setStreamOutput(const QByteArray &name, const QByteArray &content)
 {
     if (content.isEmpty())
         return;
-    GdbMi child;
-    child.m_type = Const;
-    child.m_name = name;
-    child.m_data = content;
-    m_children += child;
-    if (m_type == Invalid)
-        m_type = Tuple;
+    GdbMiRecord *record = new GdbMiRecord;
+    int index;
+    if (m_record) {
+        record->text = m_record->text;
+        record->nodes = m_record->nodes;
+        record->children = m_record->children;
+        index = m_index;
+        if (record->nodes.at(index).type == Invalid)
+            record->nodes[index].type = Tuple;
+    } else {
+        index = record->addNode(Tuple);
+    }
+    const int child = record->addNode(Const);
+    record->nodes[child].nameSize = name.size();
+    record->nodes[child].name = record->appendText(name);
+    record->nodes[child].dataSize = content.size();
+    record->nodes[child].data = record->appendText(content);
+
+    // The children of the node get a new, longer range.
+    GdbMiRecord::Node &node = record->nodes[index];
+    const int first = record->children.size();
+    for (int i = 0; i < node.childCount; ++i)
+        record->children.append(record->children.at(node.children + i));
+    record->children.append(child);
+    node.children = first;
+    ++node.childCount;
+    *this = GdbMi(record, index);
+}
+
+QByteArray GdbMi::parseCString(const char *&from, const char *to)
+{
+    const char *begin = 0;
+    int size = 0;
+    if (!scanCString(from, to, &begin, &size))
+        return QByteArray();
+    QByteArray result(begin, size);
+    size = unescapeCString(result.data(), size);
+    if (size < 0)
+        return QByteArray();
+    result.truncate(size);
+    return result;
 }
 
 static QByteArray ind(int indent)
@@ -238,7 +517,8 @@ static QByteArray ind(int indent)
 
 void GdbMi::dumpChildren(QByteArray * str, bool multiline, int indent) const
 {
-    for (int i = 0; i < m_children.size(); ++i) {
+    const int count = childCount();
+    for (int i = 0; i < count; ++i) {
         if (i != 0) {
             *str += ',';
             if (multiline)
@@ -246,7 +526,7 @@ void GdbMi::dumpChildren(QByteArray * str, bool multiline, int indent) const
         }
         if (multiline)
             *str += ind(indent);
-        *str += m_children.at(i).toString(multiline, indent);
+        *str += childAt(i).toString(multiline, indent);
     }
 }
 
@@ -299,7 +579,8 @@ QByteArray GdbMi::escapeCString(const QByteArray &ba)
 QByteArray GdbMi::toString(bool multiline, int indent) const
 {
     QByteArray result;
-    switch (m_type) {
+    const QByteArray name = this->name();
+    switch (type()) {
         case Invalid:
             if (multiline)
                 result += ind(indent) + "Invalid\n";
@@ -307,13 +588,13 @@ QByteArray GdbMi::toString(bool multiline, int indent) const
                 result += "Invalid";
             break;
         case Const: 
-            if (!m_name.isEmpty())
-                result += m_name + "=";
-            result += "\"" + escapeCString(m_data) + "\"";
+            if (!name.isEmpty())
+                result += name + "=";
+            result += "\"" + escapeCString(data()) + "\"";
             break;
         case Tuple:
-            if (!m_name.isEmpty())
-                result += m_name + "=";
+            if (!name.isEmpty())
+                result += name + "=";
             if (multiline) {
                 result += "{\n";
                 dumpChildren(&result, multiline, indent + 1);
@@ -325,8 +606,8 @@ QByteArray GdbMi::toString(bool multiline, int indent) const
             }
             break;
         case List:
-            if (!m_name.isEmpty())
-                result += m_name + "=";
+            if (!name.isEmpty())
+                result += name + "=";
             if (multiline) {
                 result += "[\n";
                 dumpChildren(&result, multiline, indent + 1);
@@ -341,21 +622,6 @@ QByteArray GdbMi::toString(bool multiline, int indent) const
     return result;
 }
 
-void GdbMi::fromString(const QByteArray &ba)
-{
-    const char *from = ba.constBegin();
-    const char *to = ba.constEnd();
-    parseResultOrValue(from, to);
-}
-
-GdbMi GdbMi::findChild(const char *name) const
-{
-    for (int i = 0; i < m_children.size(); ++i)
-        if (m_children.at(i).m_name == name)
-            return m_children.at(i);
-    return GdbMi();
-}
-
 //////////////////////////////////////////////////////////////////////////////////
 //
 // GdbResponse
@@ -86,16 +86,23 @@ token ==>
 
  */
 
+class GdbMiRecord;
+
 // FIXME: rename into GdbMiValue
+/*
+ * A value of a gdb/MI record. All values parsed from one record share a
+ * copy of its text and a flat table of nodes, names and unquoted strings
+ * are kept as positions in that text. A GdbMi is a cheap handle to one of
+ * these nodes and keeps the record alive.
+ */
 class GdbMi
 {
 public:
-    GdbMi() : m_type(Invalid) {}
-    explicit GdbMi(const QByteArray &str) { fromString(str); }
-
-    QByteArray m_name;
-    QByteArray m_data;
-    QList<GdbMi> m_children;
+    GdbMi();
+    explicit GdbMi(const QByteArray &str);
+    GdbMi(const GdbMi &other);
+    ~GdbMi();
+    GdbMi &operator=(const GdbMi &other);
 
     enum Type {
         Invalid,
@@ -104,24 +111,20 @@ public:
         List,
     };
 
-    Type m_type;
-
-    inline Type type() const { return m_type; }
-    inline QByteArray name() const { return m_name; }
-    inline bool hasName(const char *name) const { return m_name == name; }
+    Type type() const;
+    QByteArray name() const;
+    bool hasName(const char *name) const;
 
-    inline bool isValid() const { return m_type != Invalid; }
-    inline bool isConst() const { return m_type == Const; }
-    inline bool isTuple() const { return m_type == Tuple; }
-    inline bool isList() const { return m_type == List; }
+    inline bool isValid() const { return type() != Invalid; }
+    inline bool isConst() const { return type() == Const; }
+    inline bool isTuple() const { return type() == Tuple; }
+    inline bool isList() const { return type() == List; }
 
+    QByteArray data() const;
+    QList<GdbMi> children() const;
+    int childCount() const;
 
-    inline QByteArray data() const { return m_data; }
-    inline const QList<GdbMi> &children() const { return m_children; }
-    inline int childCount() const { return m_children.size(); }
-
-    const GdbMi &childAt(int index) const { return m_children[index]; } 
-    GdbMi &childAt(int index) { return m_children[index]; }
+    GdbMi childAt(int index) const;
     GdbMi findChild(const char *name) const;
 
     QByteArray toString(bool multiline = false, int indent = 0) const;
@@ -129,19 +132,23 @@ public:
     void setStreamOutput(const QByteArray &name, const QByteArray &content);
 
 private:
-    friend class GdbResponse;
     friend class GdbEngine;
+    friend class GdbMiParser;
+
+    GdbMi(GdbMiRecord *record, int index);
+
+    // Parses the comma separated results following the class of a result
+    // or async record into a tuple with the given name.
+    void fromResults(const char *from, const char *to, const char *name);
 
     static QByteArray parseCString(const char *&from, const char *to);
     static QByteArray escapeCString(const QByteArray &ba);
     static QString escapeCString(const QString &ba);
-    void parseResultOrValue(const char *&from, const char *to);
-    void parseValue(const char *&from, const char *to);
-    void parseTuple(const char *&from, const char *to);
-    void parseTuple_helper(const char *&from, const char *to);
-    void parseList(const char *&from, const char *to);
 
     void dumpChildren(QByteArray *str, bool multiline, int indent) const;
+
+    GdbMiRecord *m_record;
+    int m_index;
 };
 
 enum GdbResultClass
@@ -28,6 +28,7 @@
 **************************************************************************/
 
 #include "moduleshandler.h"
+#include "modulesymbolcache.h"
 
 #include <utils/qtcassert.h>
 
@@ -146,6 +147,7 @@ ModulesHandler::ModulesHandler()
     m_model = new ModulesModel(this);
     m_proxyModel = new QSortFilterProxyModel(this);
     m_proxyModel->setSourceModel(m_model);
+    m_symbolCache = new ModuleSymbolCache(this);
 }
 
 QAbstractItemModel *ModulesHandler::model() const
@@ -43,6 +43,7 @@ namespace Debugger {
 namespace Internal {
 
 class ModulesModel;
+class ModuleSymbolCache;
 
 enum ModulesModelRoles
 {
@@ -103,9 +104,12 @@ public:
     QList<Module> modules() const;
     void removeAll();
 
+    ModuleSymbolCache *symbolCache() const { return m_symbolCache; }
+
 private:
     ModulesModel *m_model;
     QSortFilterProxyModel *m_proxyModel;
+    ModuleSymbolCache *m_symbolCache;
 };
 
 } // namespace Internal
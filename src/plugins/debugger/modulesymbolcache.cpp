@@ -0,0 +1,512 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+#include "modulesymbolcache.h"
+#include "name_demangler.h"
+
+#include <qtconcurrent/runextensions.h>
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutex>
+#include <QtCore/QProcess>
+#include <QtCore/QSet>
+
+#include <QtGui/QDesktopServices>
+
+#include <algorithm>
+
+using namespace Debugger;
+using namespace Debugger::Internal;
+
+enum { CacheFileMagic = 0x51434d53, CacheFileVersion = 3 };
+enum { MaxCacheSize = 256 * 1024 * 1024 };
+
+// Serializes access to the cache files of all instances and threads.
+Q_GLOBAL_STATIC(QMutex, cacheFileMutex)
+
+static QString cacheFileName(const QString &cacheDirectory, const QString &fileName)
+{
+    return cacheDirectory + QLatin1Char('/')
+        + QString::number(qHash(fileName), 16) + QLatin1String(".symbols");
+}
+
+static bool readCacheFile(const QString &cacheFile, const QFileInfo &fi,
+    ModuleSymbols *module)
+{
+    QFile file(cacheFile);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream str(&file);
+    quint32 magic, version;
+    QString fileName;
+    qint64 size;
+    QDateTime lastModified;
+    quint64 textAddress;
+    qint32 count;
+    str >> magic >> version;
+    if (magic != quint32(CacheFileMagic) || version != quint32(CacheFileVersion))
+        return false;
+    str >> fileName >> size >> lastModified >> textAddress >> count;
+    // A different module with the same hash, or the module was rebuilt.
+    if (fileName != module->fileName || size != fi.size()
+            || lastModified != fi.lastModified() || count < 0)
+        return false;
+    module->sizes.reserve(count);
+    for (int i = 0; i != count && str.status() == QDataStream::Ok; ++i) {
+        Symbol symbol;
+        QString name;
+        quint64 symbolSize;
+        str >> symbol.address >> symbolSize >> symbol.state >> symbol.name >> name;
+        module->symbols.append(symbol);
+        module->names.append(name);
+        module->sizes.append(symbolSize);
+    }
+    if (str.status() == QDataStream::Ok) {
+        module->textAddress = textAddress;
+        return true;
+    }
+    module->symbols.clear();
+    module->names.clear();
+    module->sizes.clear();
+    return false;
+}
+
+// Drops the modules written least recently once the cache is too big.
+static void trimCache(const QString &cacheDirectory)
+{
+    const QFileInfoList files = QDir(cacheDirectory).entryInfoList(
+        QStringList(QLatin1String("*.symbols")), QDir::Files, QDir::Time);
+    qint64 size = 0;
+    foreach (const QFileInfo &fi, files) {
+        size += fi.size();
+        if (size > MaxCacheSize)
+            QFile::remove(fi.absoluteFilePath());
+    }
+}
+
+// Writes to a temporary file first, readers never see a partial module.
+static void writeCacheFile(const QString &cacheFile, const QFileInfo &fi,
+    const ModuleSymbols &module)
+{
+    const QString cacheDirectory = QFileInfo(cacheFile).absolutePath();
+    QDir().mkpath(cacheDirectory);
+    const QString tempFile = cacheFile + QLatin1String(".tmp");
+    QFile file(tempFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return;
+    QDataStream str(&file);
+    str << quint32(CacheFileMagic) << quint32(CacheFileVersion)
+        << module.fileName << qint64(fi.size()) << fi.lastModified()
+        << module.textAddress << qint32(module.symbols.size());
+    for (int i = 0; i != module.symbols.size(); ++i) {
+        const Symbol &symbol = module.symbols.at(i);
+        str << symbol.address << module.sizes.at(i) << symbol.state << symbol.name
+            << module.names.at(i);
+    }
+    file.close();
+    if (str.status() != QDataStream::Ok || file.error() != QFile::NoError) {
+        QFile::remove(tempFile);
+        return;
+    }
+    QFile::remove(cacheFile);
+    if (!QFile::rename(tempFile, cacheFile)) {
+        QFile::remove(tempFile);
+        return;
+    }
+    trimCache(cacheDirectory);
+}
+
+static quint64 elfValue(const QByteArray &data, int offset, int size, bool bigEndian)
+{
+    quint64 value = 0;
+    for (int i = 0; i != size; ++i)
+        value = (value << 8) | uchar(data.at(offset + (bigEndian ? i : size - 1 - i)));
+    return value;
+}
+
+// The address .text is linked at in an ELF file. Together with the address
+// it is loaded at it maps addresses of the process to the ones nm reports.
+static quint64 readTextAddress(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return 0;
+    const QByteArray header = file.read(64);
+    if (header.size() < 52 || !header.startsWith("\x7f" "ELF"))
+        return 0;
+    const bool is64 = header.at(4) == 2;
+    const bool bigEndian = header.at(5) == 2;
+    if (is64 && header.size() < 64)
+        return 0;
+    const int wordSize = is64 ? 8 : 4;
+    const quint64 sectionsOffset =
+        elfValue(header, is64 ? 0x28 : 0x20, wordSize, bigEndian);
+    const int sectionSize = elfValue(header, is64 ? 0x3a : 0x2e, 2, bigEndian);
+    const int sectionCount = elfValue(header, is64 ? 0x3c : 0x30, 2, bigEndian);
+    const int namesIndex = elfValue(header, is64 ? 0x3e : 0x32, 2, bigEndian);
+    // Offsets of sh_addr, sh_offset and sh_size in a section header.
+    const int addressField = is64 ? 0x10 : 0x0c;
+    const int offsetField = is64 ? 0x18 : 0x10;
+    const int sizeField = is64 ? 0x20 : 0x14;
+    if (sectionSize < sizeField + wordSize || namesIndex >= sectionCount
+            || !file.seek(sectionsOffset))
+        return 0;
+    const QByteArray sections = file.read(qint64(sectionSize) * sectionCount);
+    if (sections.size() != sectionSize * sectionCount)
+        return 0;
+
+    const int namesSection = namesIndex * sectionSize;
+    if (!file.seek(elfValue(sections, namesSection + offsetField, wordSize, bigEndian)))
+        return 0;
+    const QByteArray names = file.read(qMin<quint64>(1 << 20,
+        elfValue(sections, namesSection + sizeField, wordSize, bigEndian)));
+    for (int i = 0; i != sectionCount; ++i) {
+        const int section = i * sectionSize;
+        const quint64 name = elfValue(sections, section, 4, bigEndian);
+        if (name < quint64(names.size())
+                && qstrcmp(names.constData() + name, ".text") == 0)
+            return elfValue(sections, section + addressField, wordSize, bigEndian);
+    }
+    return 0;
+}
+
+// "0000000000401000 0000000000000020 T main", "0000000000402000 T _start",
+// "                 U free"
+static void readSymbolsWithNm(ModuleSymbols *module)
+{
+    const QString nmBinary = QLatin1String("nm");
+    QProcess proc;
+    proc.start(nmBinary, QStringList() << QLatin1String("-D") << QLatin1String("-S")
+        << module->fileName);
+    if (!proc.waitForFinished()) {
+        qWarning("moduleSymbols: Unable to run '%s': %s", qPrintable(nmBinary),
+            qPrintable(proc.errorString()));
+        return;
+    }
+    const QByteArray contents = proc.readAllStandardOutput();
+    foreach (const QByteArray &line, contents.split('\n')) {
+        const QList<QByteArray> fields = line.simplified().split(' ');
+        if (fields.size() < 2 || fields.size() > 4) {
+            if (!line.isEmpty())
+                qWarning("moduleSymbols: unhandled: %s", line.constData());
+            continue;
+        }
+        Symbol symbol;
+        quint64 size = 0;
+        if (fields.size() >= 3)
+            symbol.address = QString::fromLatin1(fields.at(0));
+        if (fields.size() == 4)
+            size = fields.at(1).toULongLong(0, 16);
+        symbol.state = QString::fromLatin1(fields.at(fields.size() - 2));
+        symbol.name = QString::fromLocal8Bit(fields.last());
+        module->symbols.append(symbol);
+        module->sizes.append(size);
+    }
+
+    QStringList mangledNames;
+    foreach (const Symbol &symbol, module->symbols)
+        mangledNames.append(symbol.name);
+    module->names = NameDemangler::demangledNames(mangledNames);
+}
+
+static bool isFunction(const Symbol &symbol)
+{
+    return symbol.state == QLatin1String("T") || symbol.state == QLatin1String("t")
+        || symbol.state == QLatin1String("W") || symbol.state == QLatin1String("w");
+}
+
+static quint64 trigram(const QString &lowerText, int pos)
+{
+    return (quint64(lowerText.at(pos).unicode()) << 32)
+        | (quint64(lowerText.at(pos + 1).unicode()) << 16)
+        | lowerText.at(pos + 2).unicode();
+}
+
+namespace {
+
+struct NameLessThan
+{
+    explicit NameLessThan(const QStringList &names) : names(names) {}
+    bool operator()(int a, int b) const { return names.at(a) < names.at(b); }
+    bool operator()(int a, const QString &b) const { return names.at(a) < b; }
+    const QStringList &names;
+};
+
+} // anonymous namespace
+
+static void buildIndex(ModuleSymbols *module)
+{
+    const int count = module->symbols.size();
+    module->byName.resize(count);
+    for (int i = 0; i != count; ++i)
+        module->byName[i] = i;
+    qSort(module->byName.begin(), module->byName.end(), NameLessThan(module->names));
+
+    QList<QPair<quint64, int> > addresses;
+    for (int i = 0; i != count; ++i) {
+        bool ok;
+        const quint64 address = module->symbols.at(i).address.toULongLong(&ok, 16);
+        if (ok)
+            addresses.append(qMakePair(address, i));
+    }
+    qSort(addresses);
+    module->addresses.resize(addresses.size());
+    module->byAddress.resize(addresses.size());
+    for (int i = 0; i != addresses.size(); ++i) {
+        module->addresses[i] = addresses.at(i).first;
+        module->byAddress[i] = addresses.at(i).second;
+    }
+
+    QVector<quint64> trigrams;
+    for (int i = 0; i != count; ++i) {
+        if (!isFunction(module->symbols.at(i)))
+            continue;
+        const QString name = module->names.at(i).toLower();
+        trigrams.clear();
+        for (int pos = 0; pos + 3 <= name.size(); ++pos)
+            trigrams.append(trigram(name, pos));
+        qSort(trigrams);
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+        foreach (quint64 key, trigrams)
+            module->functionsByTrigram[key].append(i);
+    }
+}
+
+static bool isStale(const ModuleSymbols &module)
+{
+    const QFileInfo fi(module.fileName);
+    return fi.size() != module.size || fi.lastModified() != module.lastModified;
+}
+
+static ModuleSymbolsPtr readModule(const QString &fileName, const QString &cacheDirectory)
+{
+    ModuleSymbolsPtr module(new ModuleSymbols);
+    module->fileName = fileName;
+    const QFileInfo fi(fileName);
+    module->size = fi.size();
+    module->lastModified = fi.lastModified();
+    const QString cacheFile = cacheFileName(cacheDirectory, fileName);
+    bool cached;
+    {
+        QMutexLocker locker(cacheFileMutex());
+        cached = readCacheFile(cacheFile, fi, module.data());
+    }
+    if (!cached) {
+        readSymbolsWithNm(module.data());
+        module->textAddress = readTextAddress(fileName);
+        if (!module->symbols.isEmpty()) {
+            QMutexLocker locker(cacheFileMutex());
+            writeCacheFile(cacheFile, fi, *module);
+        }
+    }
+    buildIndex(module.data());
+    return module;
+}
+
+static void readModules(QFutureInterface<ModuleSymbolsPtr> &future,
+    const QStringList &fileNames, const QString &cacheDirectory)
+{
+    future.setProgressRange(0, fileNames.size());
+    for (int i = 0; i != fileNames.size() && !future.isCanceled(); ++i) {
+        future.reportResult(readModule(fileNames.at(i), cacheDirectory));
+        future.setProgressValue(i + 1);
+    }
+}
+
+//////////////////////////////////////////////////////////////////
+//
+// ModuleSymbolCache
+//
+//////////////////////////////////////////////////////////////////
+
+ModuleSymbolCache::ModuleSymbolCache(QObject *parent)
+  : QObject(parent)
+{
+    m_cacheDirectory =
+        QDesktopServices::storageLocation(QDesktopServices::CacheLocation)
+            + QLatin1String("/debugger-symbols");
+    connect(&m_watcher, SIGNAL(resultReadyAt(int)), this, SLOT(moduleRead(int)));
+    connect(&m_watcher, SIGNAL(finished()), this, SLOT(readingFinished()));
+}
+
+ModuleSymbolCache::~ModuleSymbolCache()
+{
+    m_watcher.cancel();
+    m_watcher.waitForFinished();
+}
+
+void ModuleSymbolCache::loadSymbols(const QList<Module> &modules)
+{
+    foreach (const Module &module, modules) {
+        const QString &fileName = module.moduleName;
+        if (fileName.isEmpty())
+            continue;
+        bool ok;
+        const quint64 textStart = module.startAddress.toULongLong(&ok, 16);
+        if (ok)
+            m_textStarts.insert(fileName, textStart);
+        else
+            m_textStarts.remove(fileName);
+        // Rebuilt modules are read again.
+        const ModuleSymbolsPtr known = m_modules.value(fileName);
+        if (known && isStale(*known))
+            m_modules.remove(fileName);
+        if (!m_modules.contains(fileName) && !m_queued.contains(fileName)
+                && !m_reading.contains(fileName))
+            m_queued.append(fileName);
+    }
+    if (m_reading.isEmpty())
+        startReading();
+}
+
+void ModuleSymbolCache::startReading()
+{
+    if (m_queued.isEmpty())
+        return;
+    m_reading = m_queued;
+    m_queued.clear();
+    m_watcher.setFuture(QtConcurrent::run(&readModules, m_reading, m_cacheDirectory));
+}
+
+void ModuleSymbolCache::moduleRead(int index)
+{
+    const ModuleSymbolsPtr module = m_watcher.resultAt(index);
+    m_modules.insert(module->fileName, module);
+    emit symbolsLoaded(module->fileName);
+}
+
+void ModuleSymbolCache::readingFinished()
+{
+    m_reading.clear();
+    startReading();
+}
+
+QList<Symbol> ModuleSymbolCache::symbols(const QString &fileName)
+{
+    ModuleSymbolsPtr module = m_modules.value(fileName);
+    if (module && !isStale(*module))
+        return module->symbols;
+    module.clear();
+    // A module being read in the background is waited for rather than
+    // read twice. The results come in the order of m_reading.
+    const int index = m_reading.indexOf(fileName);
+    if (index != -1) {
+        module = m_watcher.future().resultAt(index);
+        if (module && isStale(*module))
+            module.clear();
+    }
+    if (!module)
+        module = readModule(fileName, m_cacheDirectory);
+    m_modules.insert(fileName, module);
+    return module->symbols;
+}
+
+QStringList ModuleSymbolCache::completions(const QString &text, int maxCount) const
+{
+    QStringList completions;
+    if (text.isEmpty())
+        return completions;
+    QSet<QString> seen;
+
+    foreach (const ModuleSymbolsPtr &module, m_modules) {
+        QVector<int>::const_iterator it = qLowerBound(module->byName.constBegin(),
+            module->byName.constEnd(), text, NameLessThan(module->names));
+        for (; it != module->byName.constEnd() && completions.size() < maxCount; ++it) {
+            const QString &name = module->names.at(*it);
+            if (!name.startsWith(text))
+                break;
+            if (isFunction(module->symbols.at(*it)) && !seen.contains(name)) {
+                seen.insert(name);
+                completions.append(name);
+            }
+        }
+    }
+
+    // Substrings are looked up by their rarest trigram.
+    if (text.size() < 3)
+        return completions;
+    const QString lowerText = text.toLower();
+    foreach (const ModuleSymbolsPtr &module, m_modules) {
+        const QVector<int> *candidates = 0;
+        for (int pos = 0; pos + 3 <= lowerText.size(); ++pos) {
+            const QHash<quint64, QVector<int> >::const_iterator it =
+                module->functionsByTrigram.constFind(trigram(lowerText, pos));
+            if (it == module->functionsByTrigram.constEnd()) {
+                candidates = 0;
+                break;
+            }
+            if (!candidates || it->size() < candidates->size())
+                candidates = &*it;
+        }
+        if (!candidates)
+            continue;
+        foreach (int i, *candidates) {
+            if (completions.size() >= maxCount)
+                break;
+            const QString &name = module->names.at(i);
+            if (name.contains(text, Qt::CaseInsensitive) && !seen.contains(name)) {
+                seen.insert(name);
+                completions.append(name);
+            }
+        }
+    }
+    return completions;
+}
+
+bool ModuleSymbolCache::findFunction(const QString &fileName, quint64 address,
+    QString *name, quint64 *offset) const
+{
+    const ModuleSymbolsPtr module = m_modules.value(fileName);
+    const quint64 textStart = m_textStarts.value(fileName);
+    if (!module || !module->textAddress || !textStart)
+        return false;
+    // Modules are relocated as a whole, .text moves with everything else.
+    const quint64 fileAddress = address - textStart + module->textAddress;
+    const QVector<quint64>::const_iterator it = qUpperBound(
+        module->addresses.constBegin(), module->addresses.constEnd(), fileAddress);
+    if (it == module->addresses.constBegin())
+        return false;
+    const int index = module->byAddress.at(it - module->addresses.constBegin() - 1);
+    if (!isFunction(module->symbols.at(index)))
+        return false;
+    // The address may be past the end of the closest function, e.g. in
+    // code without a dynamic symbol.
+    const quint64 functionOffset = fileAddress - *(it - 1);
+    const quint64 size = module->sizes.at(index);
+    if (size ? functionOffset >= size : functionOffset != 0)
+        return false;
+    *name = module->names.at(index);
+    *offset = functionOffset;
+    return true;
+}
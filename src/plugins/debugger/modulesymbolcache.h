@@ -0,0 +1,131 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+#ifndef DEBUGGER_MODULESYMBOLCACHE_H
+#define DEBUGGER_MODULESYMBOLCACHE_H
+
+#include "moduleshandler.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+namespace Debugger {
+namespace Internal {
+
+//////////////////////////////////////////////////////////////////
+//
+// ModuleSymbols
+//
+//////////////////////////////////////////////////////////////////
+
+class ModuleSymbols
+{
+public:
+    ModuleSymbols() : size(0), textAddress(0) {}
+
+    QString fileName;
+    qint64 size;                // of the file the symbols were read from
+    QDateTime lastModified;
+    QList<Symbol> symbols;
+    QStringList names;          // demangled where possible, one per symbol
+    QVector<quint64> sizes;     // one per symbol, 0 if unknown
+    QVector<int> byName;        // symbol indices sorted by name
+    QVector<quint64> addresses; // sorted addresses of symbols having one
+    QVector<int> byAddress;     // symbol indices in the order of addresses
+    // Function symbols by the lower case trigrams of their names.
+    QHash<quint64, QVector<int> > functionsByTrigram;
+    quint64 textAddress;        // address of .text in the file, 0 if unknown
+};
+
+typedef QSharedPointer<ModuleSymbols> ModuleSymbolsPtr;
+
+//////////////////////////////////////////////////////////////////
+//
+// ModuleSymbolCache
+//
+//////////////////////////////////////////////////////////////////
+
+/*
+ * Symbols of the modules of the debugged process. They are read with
+ * nm in a background thread and stored on disk, keyed by the path,
+ * size and modification time of the module, so they are only read once
+ * per build of a library. The disk cache is shared by all instances and
+ * trimmed to the most recently written modules.
+ */
+class ModuleSymbolCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ModuleSymbolCache(QObject *parent = 0);
+    ~ModuleSymbolCache();
+
+    // Starts reading the symbols of modules not known yet and records
+    // where their code is loaded.
+    void loadSymbols(const QList<Module> &modules);
+    // Reads the symbols of the module right away if they are not known yet
+    // or the module changed since.
+    QList<Symbol> symbols(const QString &fileName);
+
+    // Names of functions starting with text, followed by names containing
+    // it if there are not enough of those.
+    QStringList completions(const QString &text, int maxCount = 100) const;
+    // Finds the function containing the address in the debugged process
+    // and the offset of the address into it. Functions without a size
+    // only contain their start address.
+    bool findFunction(const QString &fileName, quint64 address,
+        QString *name, quint64 *offset) const;
+
+signals:
+    void symbolsLoaded(const QString &fileName);
+
+private slots:
+    void moduleRead(int index);
+    void readingFinished();
+
+private:
+    void startReading();
+
+    QString m_cacheDirectory;
+    QHash<QString, ModuleSymbolsPtr> m_modules;
+    QHash<QString, quint64> m_textStarts; // where .text is loaded per module
+    QStringList m_queued;
+    QStringList m_reading;
+    QFutureWatcher<ModuleSymbolsPtr> m_watcher;
+};
+
+} // namespace Internal
+} // namespace Debugger
+
+#endif // DEBUGGER_MODULESYMBOLCACHE_H
@@ -32,9 +32,10 @@
 #include <QtCore/QLatin1String>
 #include <QtCore/QMap>
 #include <QtCore/QRegExp>
-#include <QtCore/QSet>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
+#include <QtCore/QThread>
+#include <QtCore/QtConcurrentMap>
 
 #include "name_demangler.h"
 
@@ -60,11 +61,59 @@ public:
     NameDemanglerPrivate();
     ~NameDemanglerPrivate();
 
-    bool demangle(const QString &mangledName);
+    bool demangle(const QByteArray &mangledName);
     const QString &errorString() const { return m_errorString; }
     const QString &demangledName() const { return m_demangledName; }
 
 private:
+    // Set of ASCII characters. The first-sets are looked up for nearly
+    // every input character, so this needs to be cheap.
+    class FirstSet
+    {
+    public:
+        FirstSet() { bits[0] = bits[1] = 0; }
+        bool contains(QChar c) const
+        {
+            const ushort u = c.unicode();
+            return u < 128 && (bits[u >> 6] & (Q_UINT64_C(1) << (u & 63)));
+        }
+        FirstSet &operator<<(char c)
+        {
+            Q_ASSERT(uchar(c) < 128);
+            bits[uchar(c) >> 6] |= Q_UINT64_C(1) << (c & 63);
+            return *this;
+        }
+        FirstSet &operator+=(const FirstSet &other)
+        {
+            bits[0] |= other.bits[0];
+            bits[1] |= other.bits[1];
+            return *this;
+        }
+        FirstSet operator|(const FirstSet &other) const
+        {
+            FirstSet set = *this;
+            return set += other;
+        }
+        FirstSet operator&(const FirstSet &other) const
+        {
+            FirstSet set;
+            set.bits[0] = bits[0] & other.bits[0];
+            set.bits[1] = bits[1] & other.bits[1];
+            return set;
+        }
+        bool isEmpty() const { return !bits[0] && !bits[1]; }
+        int size() const
+        {
+            int count = 0;
+            for (int c = 0; c != 128; ++c)
+                count += contains(QLatin1Char(char(c)));
+            return count;
+        }
+
+    private:
+        quint64 bits[2];
+    };
+
     class Operator
     {
     public:
@@ -256,65 +305,95 @@ private:
     static const QChar eoi;
     bool parseError;
     int pos;
-    QString mangledName;
+    QByteArray mangledName;
     QString m_errorString;
     QString m_demangledName;
     QStringList substitutions;
     QStringList templateParams;
 
     QMap<QString, Operator *> ops;
+    QRegExp funcAnchorRegExp;
+    QRegExp qualAnchorRegExp;
 
     // The first-sets for all non-terminals.
-    QSet<QChar> firstSetArrayType;
-    QSet<QChar> firstSetBareFunctionType;
-    QSet<QChar> firstSetBuiltinType;
-    QSet<QChar> firstSetCallOffset;
-    QSet<QChar> firstSetClassEnumType;
-    QSet<QChar> firstSetDiscriminator;
-    QSet<QChar> firstSetCtorDtorName;
-    QSet<QChar> firstSetCvQualifiers;
-    QSet<QChar> firstSetEncoding;
-    QSet<QChar> firstSetExpression;
-    QSet<QChar> firstSetExprPrimary;
-    QSet<QChar> firstSetFunctionType;
-    QSet<QChar> firstSetLocalName;
-    QSet<QChar> firstSetMangledName;
-    QSet<QChar> firstSetName;
-    QSet<QChar> firstSetNestedName;
-    QSet<QChar> firstSetNonNegativeNumber;
-    QSet<QChar> firstSetNumber;
-    QSet<QChar> firstSetOperatorName;
-    QSet<QChar> firstSetPointerToMemberType;
-    QSet<QChar> firstSetPositiveNumber;
-    QSet<QChar> firstSetPrefix;
-    QSet<QChar> firstSetPrefix2;
-    QSet<QChar> firstSetSeqId;
-    QSet<QChar> firstSetSourceName;
-    QSet<QChar> firstSetSpecialName;
-    QSet<QChar> firstSetSubstitution;
-    QSet<QChar> firstSetTemplateArg;
-    QSet<QChar> firstSetTemplateArgs;
-    QSet<QChar> firstSetTemplateParam;
-    QSet<QChar> firstSetType;
-    QSet<QChar> firstSetUnqualifiedName;
-    QSet<QChar> firstSetUnscopedName;
+    FirstSet firstSetArrayType;
+    FirstSet firstSetBareFunctionType;
+    FirstSet firstSetBuiltinType;
+    FirstSet firstSetCallOffset;
+    FirstSet firstSetClassEnumType;
+    FirstSet firstSetDiscriminator;
+    FirstSet firstSetCtorDtorName;
+    FirstSet firstSetCvQualifiers;
+    FirstSet firstSetEncoding;
+    FirstSet firstSetExpression;
+    FirstSet firstSetExprPrimary;
+    FirstSet firstSetFunctionType;
+    FirstSet firstSetLocalName;
+    FirstSet firstSetMangledName;
+    FirstSet firstSetName;
+    FirstSet firstSetNestedName;
+    FirstSet firstSetNonNegativeNumber;
+    FirstSet firstSetNumber;
+    FirstSet firstSetOperatorName;
+    FirstSet firstSetPointerToMemberType;
+    FirstSet firstSetPositiveNumber;
+    FirstSet firstSetPrefix;
+    FirstSet firstSetPrefix2;
+    FirstSet firstSetSeqId;
+    FirstSet firstSetSourceName;
+    FirstSet firstSetSpecialName;
+    FirstSet firstSetSubstitution;
+    FirstSet firstSetTemplateArg;
+    FirstSet firstSetTemplateArgs;
+    FirstSet firstSetTemplateParam;
+    FirstSet firstSetType;
+    FirstSet firstSetUnqualifiedName;
+    FirstSet firstSetUnscopedName;
 };
 
 
 const QChar NameDemanglerPrivate::eoi('$');
 
 NameDemanglerPrivate::NameDemanglerPrivate()
+    : funcAnchorRegExp(QLatin1String("\\([^*&]")),
+      qualAnchorRegExp(QLatin1String("(\\*|\\&|const|volatile)\\)"))
 {
     setupFirstSets();
     setupOps();
 }
 
+/*
+ * Removes "::" following anything but an identifier, '>' or ')', like
+ * the scope of global names. Same as replacing "([^a-zA-Z\d>)])::"
+ * by "\1", without a regular expression.
+ */
+static void removeGlobalScopes(QString &name)
+{
+    int lastMatchEnd = 0;
+    int to = 0;
+    QChar *data = name.data();
+    for (int from = 0; from < name.size(); ++from) {
+        if (from > lastMatchEnd && data[from] == QLatin1Char(':')
+                && from + 1 < name.size() && data[from + 1] == QLatin1Char(':')) {
+            const QChar c = data[from - 1];
+            if (!(c.unicode() < 128 && (c.isLetterOrNumber()
+                    || c == QLatin1Char('>') || c == QLatin1Char(')')))) {
+                lastMatchEnd = from + 2;
+                ++from;
+                continue;
+            }
+        }
+        data[to++] = data[from];
+    }
+    name.truncate(to);
+}
+
 NameDemanglerPrivate::~NameDemanglerPrivate()
 {
     qDeleteAll(ops);
 }
 
-bool NameDemanglerPrivate::demangle(const QString &mangledName)
+bool NameDemanglerPrivate::demangle(const QByteArray &mangledName)
 {
     this->mangledName = mangledName;
     pos = 0;
@@ -323,8 +402,7 @@ bool NameDemanglerPrivate::demangle(const QString &mangledName)
     substitutions.clear();
     templateParams.clear();
     m_demangledName = parseMangledName();
-    m_demangledName.replace(
-        QRegExp(QLatin1String("([^a-zA-Z\\d>)])::")), QLatin1String("\\1"));
+    removeGlobalScopes(m_demangledName);
     if (m_demangledName.startsWith(QLatin1String("::")))
         m_demangledName.remove(0, 2);
     if (!parseError && pos != mangledName.size())
@@ -349,7 +427,7 @@ const QString NameDemanglerPrivate::parseMangledName()
     FUNC_START();
     QString name;
     if (readAhead(2) != QLatin1String("_Z")) {
-        name = mangledName;
+        name = QString::fromLatin1(mangledName);
         advance(mangledName.size());
     } else {
         advance(2);
@@ -1877,7 +1955,8 @@ const QString NameDemanglerPrivate::parseIdentifier(int len)
 {
     FUNC_START();
 
-    const QString id = mangledName.mid(pos, len);
+    const QString id = QString::fromLatin1(mangledName.constData() + pos,
+        qMin(len, mangledName.size() - pos));
     advance(len);
 
     FUNC_END(id);
@@ -1953,7 +2032,7 @@ QChar NameDemanglerPrivate::peek(int ahead)
 {
     Q_ASSERT(pos >= 0);
     if (pos + ahead < mangledName.size()) {
-        return mangledName[pos + ahead];
+        return QLatin1Char(mangledName.at(pos + ahead));
     } else {
         return eoi;
     }
@@ -1963,7 +2042,7 @@ QChar NameDemanglerPrivate::advance(int steps)
 {
     Q_ASSERT(steps > 0);
     if (pos + steps <= mangledName.size()) {
-        QChar c = mangledName[pos];
+        QChar c = QLatin1Char(mangledName.at(pos));
         pos += steps;
         return c;
     } else {
@@ -1977,7 +2056,7 @@ const QString NameDemanglerPrivate::readAhead(int charCount)
 {
     QString str;
     if (pos + charCount < mangledName.size())
-        str = mangledName.mid(pos, charCount);
+        str = QString::fromLatin1(mangledName.constData() + pos, charCount);
     else
         str.fill(eoi, charCount);
     return str;
@@ -2022,7 +2101,7 @@ void NameDemanglerPrivate::setupFirstSets()
     firstSetPrefix2 = firstSetUnqualifiedName;
     firstSetPrefix = firstSetTemplateParam | firstSetSubstitution
         | firstSetPrefix2;
-    firstSetUnscopedName = firstSetUnqualifiedName | (QSet<QChar>() << 'S');
+    firstSetUnscopedName = firstSetUnqualifiedName | (FirstSet() << 'S');
     firstSetName = firstSetNestedName | firstSetUnscopedName
         | firstSetSubstitution | firstSetLocalName;
 
@@ -2042,14 +2121,6 @@ void NameDemanglerPrivate::setupFirstSets()
     firstSetBareFunctionType = firstSetType;
     ((firstSetTemplateArg += firstSetType) += firstSetExprPrimary)
       << 'X' << 'I' << 's';
-
-#if 0
-    foreach(QChar c, firstSetType)
-        qDebug("'%c'", c.toAscii());
-    qDebug("\n");
-    foreach(QChar c, firstSetExprPrimary)
-        qDebug("'%c'", c.toAscii());
-#endif
 }
 
 void NameDemanglerPrivate::setupOps(){
@@ -2163,9 +2234,8 @@ void NameDemanglerPrivate::addSubstitution(const QString &symbol)
 void NameDemanglerPrivate::insertQualifier(QString &type,
                                            const QString &qualifier)
 {
-    const int funcAnchor = type.indexOf(QRegExp(QLatin1String("\\([^*&]")));
-    const int qualAnchor =
-        type.indexOf(QRegExp(QLatin1String("(\\*|\\&|const|volatile)\\)")));
+    const int funcAnchor = type.indexOf(funcAnchorRegExp);
+    const int qualAnchor = type.indexOf(qualAnchorRegExp);
     int insertionPos;
     QString insertionString = qualifier;
     if (funcAnchor == -1) {
@@ -2200,10 +2270,45 @@ NameDemangler::~NameDemangler()
 }
 
 bool NameDemangler::demangle(const QString &mangledName)
+{
+    return pImpl->demangle(mangledName.toLatin1());
+}
+
+bool NameDemangler::demangle(const QByteArray &mangledName)
 {
     return pImpl->demangle(mangledName);
 }
 
+static QStringList demangleChunk(const QStringList &mangledNames)
+{
+    NameDemangler demangler;
+    QStringList names;
+    foreach (const QString &mangledName, mangledNames) {
+        if (demangler.demangle(mangledName))
+            names.append(demangler.demangledName());
+        else
+            names.append(mangledName);
+    }
+    return names;
+}
+
+QStringList NameDemangler::demangledNames(const QStringList &mangledNames)
+{
+    // One demangler per thread, each working on a consecutive chunk.
+    const int chunkCount = qMax(1, QThread::idealThreadCount());
+    const int chunkSize = mangledNames.size() / chunkCount + 1;
+    QList<QStringList> chunks;
+    for (int i = 0; i < mangledNames.size(); i += chunkSize)
+        chunks.append(mangledNames.mid(i, chunkSize));
+
+    const QList<QStringList> demangledChunks =
+        QtConcurrent::blockingMapped<QList<QStringList> >(chunks, demangleChunk);
+    QStringList names;
+    foreach (const QStringList &chunk, demangledChunks)
+        names += chunk;
+    return names;
+}
+
 const QString &NameDemangler::errorString() const
 {
     return pImpl->errorString();
@@ -31,7 +31,9 @@
 #define NAME_DEMANGLER_H
 
 QT_BEGIN_NAMESPACE
+class QByteArray;
 class QString;
+class QStringList;
 QT_END_NAMESPACE
 
 namespace Debugger {
@@ -52,6 +54,7 @@ public:
      *                  according to the specification.
      */
     bool demangle(const QString &mangledName);
+    bool demangle(const QByteArray &mangledName);
 
     /*
      * A textual description of the error encountered, if there was one. 
@@ -66,6 +69,13 @@ public:
      */
     const QString &demangledName() const;
 
+    /*
+     * Demangles a list of names, e.g. the symbols of a module, using
+     * all available cores. Names that cannot be demangled are returned
+     * unchanged.
+     */
+    static QStringList demangledNames(const QStringList &mangledNames);
+
 private:
     NameDemanglerPrivate *pImpl;
 };
@@ -69,6 +69,7 @@ public:
     int currentIndex() const { return m_currentIndex; }
     StackFrame currentFrame() const;
     int stackSize() const { return m_stackFrames.size(); }
+    bool canExpand() const { return m_canExpand; }
 
     // Called from StackHandler after a new stack list has been received
     void removeAll();
@@ -104,6 +104,8 @@ public:
    
 WatchData::WatchData() :
     hasChildren(false),
+    childCount(-1),
+    childrenOffset(0),
     generation(-1),
     valueEnabled(true),
     valueEditable(true),
@@ -129,6 +131,7 @@ bool WatchData::isEqual(const WatchData &other) const
       && saddr == other.saddr
       && framekey == other.framekey
       && hasChildren == other.hasChildren
+      && childCount == other.childCount
       && valueEnabled == other.valueEnabled
       && valueEditable == other.valueEditable
       && error == other.error;
@@ -360,6 +363,7 @@ WatchModel::WatchModel(WatchHandler *handler, WatchType type)
             m_root->name = WatchHandler::tr("Tooltip");
             break;
     }
+    m_itemsByIName.insert(m_root->iname, m_root);
 }
 
 WatchModel::~WatchModel()
@@ -382,6 +386,8 @@ void WatchModel::reinitialize()
     beginRemoveRows(index, 0, n - 1);
     qDeleteAll(m_root->children);
     m_root->children.clear();
+    m_itemsByIName.clear();
+    m_itemsByIName.insert(m_root->iname, m_root);
     endRemoveRows();
 }
 
@@ -442,10 +448,18 @@ void WatchModel::destroyItem(WatchItem *item)
     //MODEL_DEBUG("NEED TO REMOVE: " << item->iname << "AT" << n);
     beginRemoveRows(index, n, n);
     parent->children.removeAt(n);
+    unregisterItem(item);
     endRemoveRows();
     delete item;
 }
 
+void WatchModel::unregisterItem(WatchItem *item)
+{
+    m_itemsByIName.remove(item->iname);
+    foreach (WatchItem *child, item->children)
+        unregisterItem(child);
+}
+
 static QString parentName(const QString &iname)
 {
     int pos = iname.lastIndexOf(QLatin1Char('.'));
@@ -638,6 +652,29 @@ void WatchModel::fetchMore(const QModelIndex &index)
     }
 }
 
+// The next page of a big container, unless it is already on its way.
+// Requested explicitly by the view, never by QAbstractItemView's own
+// fetchMore() calls, which happen on every relayout.
+bool WatchModel::canFetchNextPage(const WatchItem *item) const
+{
+    return item->fetchTriggered
+        && item->childCount > item->children.size()
+        && !m_handler->m_pendingPages.contains(item->iname);
+}
+
+void WatchModel::fetchNextPage(WatchItem *item)
+{
+    QTC_ASSERT(canFetchNextPage(item), return);
+    const int offset = item->children.size();
+    m_handler->m_childrenLimits[item->iname] =
+        offset + QtDumperHelper::ChildrenPageSize;
+    m_handler->m_pendingPages.insert(item->iname);
+    WatchData data = *item;
+    data.setChildrenNeeded();
+    data.childrenOffset = offset;
+    m_handler->m_manager->updateWatchData(data);
+}
+
 QModelIndex WatchModel::index(int row, int column, const QModelIndex &parent) const
 {
     if (!hasIndex(row, column, parent))
@@ -697,22 +734,12 @@ WatchItem *WatchModel::watchItem(const QModelIndex &idx) const
 
 QModelIndex WatchModel::watchIndex(const WatchItem *item) const
 {
-    return watchIndexHelper(item, m_root, QModelIndex());
-}
-
-QModelIndex WatchModel::watchIndexHelper(const WatchItem *needle, 
-    const WatchItem *parentItem, const QModelIndex &parentIndex) const
-{
-    if (needle == parentItem)
-        return parentIndex;
-    for (int i = parentItem->children.size(); --i >= 0; ) {
-        const WatchItem *childItem = parentItem->children.at(i);
-        QModelIndex childIndex = index(i, 0, parentIndex);
-        QModelIndex idx = watchIndexHelper(needle, childItem, childIndex);
-        if (idx.isValid())
-            return idx;
-    }
-    return QModelIndex();
+    if (!item || item == m_root || !item->parent)
+        return QModelIndex();
+    const int row = item->parent->children.indexOf(const_cast<WatchItem *>(item));
+    if (row == -1)
+        return QModelIndex();
+    return createIndex(row, 0, (void*) item);
 }
 
 void WatchModel::emitDataChanged(int column, const QModelIndex &parentIndex) 
@@ -782,6 +809,9 @@ QVariant WatchModel::data(const QModelIndex &idx, int role) const
             return m_handler->m_expandedINames.contains(data.iname);
             //FIXME return node < 4 || m_expandedINames.contains(data.iname);
 
+        case MoreChildrenRole:
+            return canFetchNextPage(&data);
+
         case ActiveDataRole:
             qDebug() << "ASK FOR" << data.iname;
             return true;
@@ -832,6 +862,9 @@ bool WatchModel::setData(const QModelIndex &index, const QVariant &value, int ro
         } else {
             m_handler->m_individualFormats[data.iname] = format;
         }
+    } else if (role == MoreChildrenRole) {
+        if (value.toBool() && canFetchNextPage(&data))
+            fetchNextPage(&data);
     }
     emit dataChanged(index, index);
     return true;
@@ -929,7 +962,7 @@ void WatchModel::insertData(const WatchData &data)
         x = 1;
     }
     QTC_ASSERT(!data.iname.isEmpty(), qDebug() << data.toString(); return);
-    WatchItem *parent = findItem(parentName(data.iname), m_root);
+    WatchItem *parent = findItem(parentName(data.iname));
     if (!parent) {
         WatchData parent;
         parent.iname = parentName(data.iname);
@@ -939,7 +972,7 @@ void WatchModel::insertData(const WatchData &data)
         return;
     }
     QModelIndex index = watchIndex(parent);
-    if (WatchItem *oldItem = findItem(data.iname, parent)) {
+    if (WatchItem *oldItem = findItem(data.iname)) {
         // overwrite old entry
         //MODEL_DEBUG("OVERWRITE : " << data.iname << data.value);
         bool changed = !data.value.isEmpty()
@@ -960,122 +993,105 @@ void WatchModel::insertData(const WatchData &data)
         int n = findInsertPosition(parent->children, item);
         beginInsertRows(index, n, n);
         parent->children.insert(n, item);
+        m_itemsByIName.insert(item->iname, item);
         endInsertRows();
     }
 }
 
+// Inserts a list of items sharing the same parent. Works like a series of
+// insertData() calls, but existing items only result in a single
+// dataChanged() over the range of modified rows, and new items are
+// inserted in one go per run of adjacent rows.
 void WatchModel::insertBulkData(const QList<WatchData> &list)
 {
-#if 0
-    for (int i = 0; i != list.size(); ++i) 
-        insertData(list.at(i));
-    return;
-#endif
-    // This method does not properly insert items in proper "iname sort
-    // order", leading to random removal of items in removeOutDated();
-
-    //qDebug() << "WMI:" << list.toString();
-    //static int bulk = 0;
-    //foreach (const WatchItem &data, list)
-    //    qDebug() << "BULK: " << ++bulk << data.toString();
     QTC_ASSERT(!list.isEmpty(), return);
-    QString parentIName = parentName(list.at(0).iname);
-    WatchItem *parent = findItem(parentIName, m_root);
+    const QString parentIName = parentName(list.at(0).iname);
+    WatchItem *parent = findItem(parentIName);
     if (!parent) {
         WatchData parent;
         parent.iname = parentIName;
-        insertData(parent);
         MODEL_DEBUG("\nFIXING MISSING PARENT FOR\n" << list.at(0).iname);
+        if (!parent.iname.isEmpty())
+            insertData(parent);
         return;
     }
-    QModelIndex index = watchIndex(parent);
+    const QModelIndex index = watchIndex(parent);
 
+    // Sorted by iname, as the children are.
     QMap<IName, WatchData> newList;
-    typedef QMap<IName, WatchData>::iterator Iterator;
-    foreach (const WatchItem &data, list)
+    foreach (const WatchData &data, list) {
+        QTC_ASSERT(parentName(data.iname) == parentIName,
+            qDebug() << data.toString(); continue);
         newList[data.iname] = data;
-    if (newList.size() != list.size()) {
-        qDebug() << "LIST: ";
-        foreach (const WatchItem &data, list)
-            qDebug() << data.toString();
-        qDebug() << "NEW LIST: ";
-        foreach (const WatchItem &data, newList.values())
-            qDebug() << data.toString();
-        qDebug() << "P->CHILDREN: ";
-        foreach (const WatchItem *item, parent->children)
-            qDebug() << item->toString();
-        qDebug()
-            << "P->CHILDREN.SIZE: " << parent->children.size()
-            << "NEWLIST SIZE: " << newList.size()
-            << "LIST SIZE: " << list.size();
-    }
-    QTC_ASSERT(newList.size() == list.size(), return);
-
-    foreach (WatchItem *oldItem, parent->children) {
-        Iterator it = newList.find(oldItem->iname);
-        if (it == newList.end()) {
-            WatchData data = *oldItem;
-            data.generation = generationCounter;
-            newList[oldItem->iname] = data;
-        } else {
-            bool changed = !it->value.isEmpty()
-                && it->value != oldItem->value
-                && it->value != strNotInScope;
-            it->changed = changed;
-            if (it->generation == -1)
-                it->generation = generationCounter;
-        }
     }
 
-    for (Iterator it = newList.begin(); it != newList.end(); ++it) {
-        qDebug() << "  NEW: " << it->iname;
-    }
+    QHash<const WatchItem *, int> rows;
+    for (int i = parent->children.size(); --i >= 0; )
+        rows.insert(parent->children.at(i), i);
 
     // overwrite existing items
-    Iterator it = newList.begin();
-    QModelIndex idx = watchIndex(parent);
-    const int oldCount = parent->children.size();
-    for (int i = 0; i < oldCount; ++i, ++it) {
-        if (!parent->children[i]->isEqual(*it)) {
-            qDebug() << "REPLACING" << parent->children.at(i)->iname
-                << " WITH " << it->iname << it->generation;
-            parent->children[i]->setData(*it);
-            if (parent->children[i]->generation == -1)
-                parent->children[i]->generation = generationCounter;
-            //emit dataChanged(idx.sibling(i, 0), idx.sibling(i, 2));
-        } else {
-            //qDebug() << "SKIPPING REPLACEMENT" << parent->children.at(i)->iname;
-        }
-    }
-    emit dataChanged(idx.sibling(0, 0), idx.sibling(oldCount - 1, 2));
-
-    // add new items
-    if (oldCount < newList.size()) {
-        beginInsertRows(index, oldCount, newList.size() - 1);
-        //MODEL_DEBUG("INSERT : " << data.iname << data.value);
-        for (int i = oldCount; i < newList.size(); ++i, ++it) {
-            WatchItem *item = new WatchItem(*it);
-            qDebug() << "ADDING" << it->iname;
+    QList<WatchItem *> newItems;
+    int firstChanged = -1;
+    int lastChanged = -1;
+    QMap<IName, WatchData>::const_iterator it = newList.constBegin();
+    for (; it != newList.constEnd(); ++it) {
+        const WatchData &data = *it;
+        WatchItem *oldItem = m_itemsByIName.value(data.iname);
+        if (!oldItem) {
+            WatchItem *item = new WatchItem(data);
             item->parent = parent;
-            if (item->generation == -1)
-                item->generation = generationCounter;
+            item->generation = generationCounter;
             item->changed = true;
-            parent->children.append(item);
+            newItems.append(item);
+            continue;
+        }
+
+        const bool changed = !data.value.isEmpty()
+            && data.value != oldItem->value
+            && data.value != strNotInScope;
+        const bool modified = changed != oldItem->changed || !oldItem->isEqual(data);
+        oldItem->setData(data);
+        oldItem->changed = changed;
+        oldItem->generation = generationCounter;
+        if (modified) {
+            const int row = rows.value(oldItem);
+            firstChanged = firstChanged == -1 ? row : qMin(firstChanged, row);
+            lastChanged = qMax(lastChanged, row);
+        }
+    }
+    if (firstChanged != -1)
+        emit dataChanged(this->index(firstChanged, 0, index),
+            this->index(lastChanged, 2, index));
+
+    // add new items, one insertion per run of adjacent rows
+    QList<WatchItem *> &children = parent->children;
+    int row = 0;
+    for (int i = 0; i < newItems.size(); ) {
+        while (row < children.size()
+                && iNameLess(children.at(row)->iname, newItems.at(i)->iname))
+            ++row;
+        int j = i + 1;
+        if (row == children.size())
+            j = newItems.size();
+        else
+            while (j < newItems.size()
+                    && iNameLess(newItems.at(j)->iname, children.at(row)->iname))
+                ++j;
+
+        beginInsertRows(index, row, row + j - i - 1);
+        for (int k = i; k < j; ++k) {
+            WatchItem *item = newItems.at(k);
+            children.insert(row++, item);
+            m_itemsByIName.insert(item->iname, item);
         }
         endInsertRows();
+        i = j;
     }
-    //qDebug() << "ITEMS: " << parent->children.size();
-    dump();
 }
 
-WatchItem *WatchModel::findItem(const QString &iname, WatchItem *root) const
+WatchItem *WatchModel::findItem(const QString &iname) const
 {
-    if (root->iname == iname)
-        return root;
-    for (int i = root->children.size(); --i >= 0; )
-        if (WatchItem *item = findItem(iname, root->children.at(i)))
-            return item;
-    return 0;
+    return m_itemsByIName.value(iname);
 }
 
 static void debugRecursion(QDebug &d, const WatchItem *item, int depth)
@@ -1118,6 +1134,8 @@ WatchHandler::WatchHandler(DebuggerManager *manager)
 
 void WatchHandler::beginCycle()
 {
+    // Pages still outstanding are covered by the full update.
+    m_pendingPages.clear();
     ++generationCounter;
     m_locals->beginCycle();
     m_watchers->beginCycle();
@@ -1134,6 +1152,8 @@ void WatchHandler::endCycle()
 void WatchHandler::cleanup()
 {
     m_expandedINames.clear();
+    m_childrenLimits.clear();
+    m_pendingPages.clear();
     m_displayedINames.clear();
     m_locals->reinitialize();
     m_tooltips->reinitialize();
@@ -1154,6 +1174,8 @@ void WatchHandler::insertData(const WatchData &data)
         qWarning("%s:%d: Attempt to insert invalid watch item: %s", __FILE__, __LINE__, qPrintable(data.toString()));
         return;
     }
+    // Answer or error for a requested page.
+    m_pendingPages.remove(data.iname);
     if (data.isSomethingNeeded() && data.iname.contains('.')) {
         MODEL_DEBUG("SOMETHING NEEDED: " << data.toString());
         if (!m_manager->currentEngine()->isSynchroneous()) {
@@ -1179,34 +1201,44 @@ void WatchHandler::insertData(const WatchData &data)
 // Bulk-insertion
 void WatchHandler::insertBulkData(const QList<WatchData> &list)
 {
-#if 1
-    foreach (const WatchItem &data, list)
-        insertData(data);
-    return;
-#endif
-
     if (list.isEmpty())
         return;
-    QMap<QString, QList<WatchData> > hash;
 
+    // Group by parent, same filtering as in insertData(). Parents sort
+    // before their children, so they get inserted first.
+    QMap<QString, QList<WatchData> > hash;
     foreach (const WatchData &data, list) {
-        // we insert everything, including incomplete stuff
-        // to reduce the number of row add operations in the model.
-        if (data.isValid()) {
-            hash[parentName(data.iname)].append(data);
-        } else {
+        if (!data.isValid()) {
             qWarning("%s:%d: Attempt to bulk-insert invalid watch item: %s", __FILE__, __LINE__, qPrintable(data.toString()));
+            continue;
+        }
+        m_pendingPages.remove(data.iname);
+        if (data.isSomethingNeeded() && data.iname.contains('.')) {
+            if (!m_manager->currentEngine()->isSynchroneous()) {
+                m_manager->updateWatchData(data);
+            } else {
+                WatchData data1 = data;
+                data1.setAllUnneeded();
+                data1.setValue(QLatin1String("<unavailable synchroneous data>"));
+                data1.setHasChildren(false);
+                hash[parentName(data.iname)].append(data1);
+            }
+        } else {
+            hash[parentName(data.iname)].append(data);
         }
-    }
-    foreach (const QString &parentIName, hash.keys()) {
-        WatchModel *model = modelForIName(parentIName);
-        QTC_ASSERT(model, return);
-        model->insertBulkData(hash[parentIName]);
     }
 
-    foreach (const WatchData &data, list) {
-        if (data.isSomethingNeeded())
-            m_manager->updateWatchData(data);
+    QMap<QString, QList<WatchData> >::const_iterator it = hash.constBegin();
+    for (; it != hash.constEnd(); ++it) {
+        if (it.key().isEmpty()) {
+            // top level items like "local" itself
+            foreach (const WatchData &data, it.value())
+                insertData(data);
+            continue;
+        }
+        WatchModel *model = modelForIName(it.key());
+        QTC_ASSERT(model, return);
+        model->insertBulkData(it.value());
     }
 }
 
@@ -1215,7 +1247,7 @@ void WatchHandler::removeData(const QString &iname)
     WatchModel *model = modelForIName(iname);
     if (!model)
         return;
-    WatchItem *item = model->findItem(iname, model->m_root);
+    WatchItem *item = model->findItem(iname);
     if (item)
         model->destroyItem(item);
 }
@@ -1449,11 +1481,25 @@ WatchModel *WatchHandler::modelForIName(const QString &iname) const
     return 0;
 }
 
+// The number of children to retrieve from a paged container. Grows when
+// the user scrolls down, so the next update fetches all of them again.
+int WatchHandler::childrenLimit(const QString &iname) const
+{
+    return m_childrenLimits.value(iname, QtDumperHelper::ChildrenPageSize);
+}
+
+// A page request that will not be answered, e.g. a failed dumper call.
+// The view may ask for the page again.
+void WatchHandler::cancelPage(const QString &iname)
+{
+    m_pendingPages.remove(iname);
+}
+
 WatchData *WatchHandler::findItem(const QString &iname) const
 {
     const WatchModel *model = modelForIName(iname);
     QTC_ASSERT(model, return 0);
-    return model->findItem(iname, model->m_root);
+    return model->findItem(iname);
 }
 
 QString WatchHandler::watcherEditPlaceHolder()
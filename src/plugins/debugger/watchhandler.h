@@ -135,6 +135,8 @@ public:
     QString framekey;     // key for type cache
     QScriptValue scriptValue; // if needed...
     bool hasChildren;
+    int childCount;       // number of children of paged containers, -1 if all are known
+    int childrenOffset;   // first child to retrieve from paged containers
     int generation;       // when updated?
     bool valueEnabled;    // value will be greyed out or not
     bool valueEditable;   // value will be editable
@@ -158,6 +160,7 @@ enum WatchRoles
     TypeFormatRole,  // used to communicate alternative formats to the view
     IndividualFormatRole,
     AddressRole,     // some memory address related to the object
+    MoreChildrenRole, // more children of a big container can be requested
 };
 
 enum IntegerFormat
@@ -194,23 +197,24 @@ private:
         int role = Qt::DisplayRole) const;
     bool canFetchMore(const QModelIndex &parent) const;
     void fetchMore(const QModelIndex &parent);
+    bool canFetchNextPage(const WatchItem *item) const;
+    void fetchNextPage(WatchItem *item);
 
     friend class WatchHandler;
     friend class GdbEngine;
 
     WatchItem *watchItem(const QModelIndex &) const;
     QModelIndex watchIndex(const WatchItem *needle) const;
-    QModelIndex watchIndexHelper(const WatchItem *needle,
-        const WatchItem *parentItem, const QModelIndex &parentIndex) const;
 
     void insertData(const WatchData &data);
     void insertBulkData(const QList<WatchData> &data);
-    WatchItem *findItem(const QString &iname, WatchItem *root) const;
+    WatchItem *findItem(const QString &iname) const;
     void reinitialize();
     void removeOutdated();
     void removeOutdatedHelper(WatchItem *item);
     WatchItem *rootItem() const;
     void destroyItem(WatchItem *item);
+    void unregisterItem(WatchItem *item);
 
     void emitDataChanged(int column,
         const QModelIndex &parentIndex = QModelIndex());
@@ -228,6 +232,7 @@ private:
     WatchHandler *m_handler;
     WatchType m_type;
     WatchItem *m_root;
+    QHash<QString, WatchItem *> m_itemsByIName; // all items, including m_root
 };
 
 class WatchHandler : public QObject
@@ -264,6 +269,8 @@ public:
         { return m_expandedINames.contains(iname); }
     QSet<QString> expandedINames() const
         { return m_expandedINames; }
+    int childrenLimit(const QString &iname) const;
+    void cancelPage(const QString &iname);
 
     static QString watcherEditPlaceHolder();
 
@@ -290,6 +297,8 @@ private:
 
     void setDisplayedIName(const QString &iname, bool on);
     QSet<QString> m_expandedINames;  // those expanded in the treeview
+    QHash<QString, int> m_childrenLimits; // children retrieved from paged containers
+    QSet<QString> m_pendingPages;    // paged containers waiting for a page
     QSet<QString> m_displayedINames; // those with "external" viewers
 
     WatchModel *m_locals;
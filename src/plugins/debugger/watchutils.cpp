@@ -943,7 +943,7 @@ bool QtDumperHelper::parseQuery(const GdbMi &contents, Debugger debugger)
     m_qtNamespace = QLatin1String(contents.findChild("namespace").data());
     int qtv = 0;
     const GdbMi qtversion = contents.findChild("qtversion");
-    if (qtversion.children().size() == 3) {
+    if (qtversion.childCount() == 3) {
         qtv = (qtversion.childAt(0).data().toInt() << 16)
                     + (qtversion.childAt(1).data().toInt() << 8)
                     + qtversion.childAt(2).data().toInt();
@@ -1101,7 +1101,9 @@ void QtDumperHelper::evaluationParameters(const WatchData &data,
                                           const TypeData &td,
                                           Debugger debugger,
                                           QByteArray *inBuffer,
-                                          QStringList *extraArgsIn) const
+                                          QStringList *extraArgsIn,
+                                          int childrenLimit,
+                                          bool wantsChecksum) const
 {
     enum { maxExtraArgCount = 4 };
 
@@ -1272,6 +1274,16 @@ void QtDumperHelper::evaluationParameters(const WatchData &data,
     inBuffer->append('\0');
     inBuffer->append(data.iname.toUtf8());
     inBuffer->append('\0');
+    // window of children for paged containers, left empty by engines
+    // which cannot fetch further pages
+    if (childrenLimit > 0) {
+        inBuffer->append(QByteArray::number(data.childrenOffset));
+        inBuffer->append(',');
+        inBuffer->append(QByteArray::number(childrenLimit));
+        if (wantsChecksum)
+            inBuffer->append(",1");
+    }
+    inBuffer->append('\0');
 
     if (debug)
         qDebug() << '\n' << Q_FUNC_INFO << '\n' << data.toString() << "\n-->" << outertype << td.type << extraArgs;
@@ -136,6 +136,9 @@ public:
         StdStringType
     };
 
+    // Number of children of QList, QVector and std::vector retrieved at once
+    enum { ChildrenPageSize = 1000 };
+
     // Type/Parameter struct required for building a value query
     struct TypeData {
         TypeData();
@@ -175,7 +178,9 @@ public:
                               const TypeData &td,
                               Debugger debugger,
                               QByteArray *inBuffer,
-                              QStringList *extraParameters) const;
+                              QStringList *extraParameters,
+                              int childrenLimit = -1, // no paging
+                              bool wantsChecksum = false) const;
 
     // Parse the value response (protocol 2) from debuggee buffer.
     // 'data' excludes the leading indicator character.
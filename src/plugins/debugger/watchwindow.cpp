@@ -51,6 +51,7 @@
 #include <QtGui/QLineEdit>
 #include <QtGui/QMenu>
 #include <QtGui/QResizeEvent>
+#include <QtGui/QScrollBar>
 
 using namespace Debugger;
 using namespace Debugger::Internal;
@@ -140,6 +141,8 @@ WatchWindow::WatchWindow(Type type, DebuggerManager *manager, QWidget *parent)
         this, SLOT(expandNode(QModelIndex)));
     connect(this, SIGNAL(collapsed(QModelIndex)),
         this, SLOT(collapseNode(QModelIndex)));
+    connect(verticalScrollBar(), SIGNAL(valueChanged(int)),
+        this, SLOT(prefetchChildren()));
 } 
  
 void WatchWindow::expandNode(const QModelIndex &idx) 
@@ -387,6 +390,21 @@ void WatchWindow::setUpdatesEnabled(bool enable)
     QTreeView::setUpdatesEnabled(enable);
 }
 
+// Retrieve the next page of a big container before the user
+// scrolls to the last child retrieved so far.
+void WatchWindow::prefetchChildren()
+{
+    enum { PrefetchDistance = 100 };
+
+    const QModelIndex idx = indexAt(QPoint(1, viewport()->height() - 1));
+    const QModelIndex parent = idx.parent();
+    if (!parent.isValid())
+        return;
+    if (model()->rowCount(parent) - idx.row() < PrefetchDistance
+            && model()->data(parent, MoreChildrenRole).toBool())
+        model()->setData(parent, true, MoreChildrenRole);
+}
+
 void WatchWindow::resetHelper()
 {
     resetHelper(model()->index(0, 0));
@@ -65,6 +65,7 @@ private:
     Q_SLOT void expandNode(const QModelIndex &idx);
     Q_SLOT void collapseNode(const QModelIndex &idx);
     Q_SLOT void setUpdatesEnabled(bool enable);
+    Q_SLOT void prefetchChildren();
 
     void keyPressEvent(QKeyEvent *ev);
     void contextMenuEvent(QContextMenuEvent *ev);
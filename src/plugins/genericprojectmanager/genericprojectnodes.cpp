@@ -59,68 +59,75 @@ void GenericProjectNode::refresh()
 {
     using namespace ProjectExplorer;
 
-    // remove the existing nodes.
-    removeFileNodes(fileNodes(), this);
-    removeFolderNodes(subFolderNodes(), this);
-
-    //ProjectExplorerPlugin::instance()->setCurrentNode(0); // ### remove me
-
-    FileNode *projectFilesNode = new FileNode(m_project->filesFileName(),
-                                              ProjectFileType,
-                                              /* generated = */ false);
-
-    FileNode *projectIncludesNode = new FileNode(m_project->includesFileName(),
-                                                 ProjectFileType,
-                                                 /* generated = */ false);
-
-    FileNode *projectConfigNode = new FileNode(m_project->configFileName(),
-                                               ProjectFileType,
-                                               /* generated = */ false);
-
-    QStringList files = m_project->files();
-    files.removeAll(m_project->filesFileName());
-    files.removeAll(m_project->includesFileName());
-    files.removeAll(m_project->configFileName());
-
-    addFileNodes(QList<FileNode *>()
-                 << projectFilesNode
-                 << projectIncludesNode
-                 << projectConfigNode,
-                 this);
-
-    QStringList filePaths;
-    QHash<QString, QStringList> filesInPath;
-
-    foreach (const QString &absoluteFileName, files) {
-        QFileInfo fileInfo(absoluteFileName);
-        const QString absoluteFilePath = fileInfo.path();
-
-        QString baseDir = QFileInfo(path()).absolutePath();
-        if (! absoluteFilePath.startsWith(baseDir))
+    QStringList projectFiles;
+    projectFiles << m_project->filesFileName()
+                 << m_project->includesFileName()
+                 << m_project->configFileName();
+
+    const QString baseDir = QFileInfo(path()).absolutePath();
+    QStringList newFilePaths = projectFiles;
+    foreach (const QString &absoluteFileName, m_project->files()) {
+        if (projectFiles.contains(absoluteFileName))
+            continue;
+        if (! QFileInfo(absoluteFileName).path().startsWith(baseDir))
             continue; // `file' is not part of the project.
-
-        const QString relativeFilePath = absoluteFilePath.mid(baseDir.length() + 1);
-
-        if (! filePaths.contains(relativeFilePath))
-            filePaths.append(relativeFilePath);
-
-        filesInPath[relativeFilePath].append(absoluteFileName);
+        newFilePaths.append(absoluteFileName);
     }
 
-    foreach (const QString &filePath, filePaths) {
-        FolderNode *folder = findOrCreateFolderByName(filePath);
+    // Only touch the nodes of files that were added or removed
+    QList<FileNode *> existingFileNodes;
+    collectFileNodes(this, &existingFileNodes);
+    QList<FileNode *> fileNodesToRemove;
+    QStringList filePathsToAdd;
+    compareFilePaths(existingFileNodes, newFilePaths, &fileNodesToRemove, &filePathsToAdd);
+
+    QHash<FolderNode *, QList<FileNode *> > fileNodesByFolder;
+    foreach (FileNode *fileNode, fileNodesToRemove)
+        fileNodesByFolder[fileNode->parentFolderNode()].append(fileNode);
+    QHashIterator<FolderNode *, QList<FileNode *> > removeIt(fileNodesByFolder);
+    while (removeIt.hasNext()) {
+        removeIt.next();
+        removeFileNodes(removeIt.value(), removeIt.key());
+        removeEmptyFolders(removeIt.key());
+    }
 
-        QList<FileNode *> fileNodes;
-        foreach (const QString &file, filesInPath.value(filePath)) {
+    fileNodesByFolder.clear();
+    foreach (const QString &absoluteFileName, filePathsToAdd) {
+        if (projectFiles.contains(absoluteFileName)) {
+            fileNodesByFolder[this].append(new FileNode(absoluteFileName, ProjectFileType,
+                                                        /* generated = */ false));
+        } else {
+            const QString relativeFilePath =
+                    QFileInfo(absoluteFileName).path().mid(baseDir.length() + 1);
+            FolderNode *folder = findOrCreateFolderByName(relativeFilePath);
             FileType fileType = SourceType; // ### FIXME
-            FileNode *fileNode = new FileNode(file, fileType, /*generated = */ false);
-            fileNodes.append(fileNode);
+            fileNodesByFolder[folder].append(new FileNode(absoluteFileName, fileType,
+                                                          /* generated = */ false));
         }
-
-        addFileNodes(fileNodes, folder);
     }
+    QHashIterator<FolderNode *, QList<FileNode *> > addIt(fileNodesByFolder);
+    while (addIt.hasNext()) {
+        addIt.next();
+        addFileNodes(addIt.value(), addIt.key());
+    }
+}
 
-    m_folderByName.clear();
+void GenericProjectNode::collectFileNodes(FolderNode *folder, QList<ProjectExplorer::FileNode *> *fileNodes) const
+{
+    foreach (FolderNode *subFolder, folder->subFolderNodes())
+        collectFileNodes(subFolder, fileNodes);
+    *fileNodes += folder->fileNodes();
+}
+
+void GenericProjectNode::removeEmptyFolders(FolderNode *folder)
+{
+    const QString baseDir = QFileInfo(path()).path();
+    while (folder != this && folder->fileNodes().isEmpty() && folder->subFolderNodes().isEmpty()) {
+        FolderNode *parent = folder->parentFolderNode();
+        m_folderByName.remove(folder->path().mid(baseDir.length() + 1));
+        removeFolderNodes(QList<FolderNode *>() << folder, parent);
+        folder = parent;
+    }
 }
 
 ProjectExplorer::FolderNode *GenericProjectNode::findOrCreateFolderByName(const QStringList &components, int end)
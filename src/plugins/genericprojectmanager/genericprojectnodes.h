@@ -78,6 +78,8 @@ public:
 private:
     FolderNode *findOrCreateFolderByName(const QString &filePath);
     FolderNode *findOrCreateFolderByName(const QStringList &components, int end);
+    void collectFileNodes(FolderNode *folder, QList<ProjectExplorer::FileNode *> *fileNodes) const;
+    void removeEmptyFolders(FolderNode *folder);
 
 private:
     GenericProject *m_project;
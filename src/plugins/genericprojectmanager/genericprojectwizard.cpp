@@ -33,6 +33,7 @@
 #include <coreplugin/mimedatabase.h>
 #include <projectexplorer/projectexplorer.h>
 
+#include <utils/directorycrawler.h>
 #include <utils/filenamevalidatinglineedit.h>
 #include <utils/filewizardpage.h>
 #include <utils/pathchooser.h>
@@ -265,46 +266,30 @@ QWizard *GenericProjectWizard::createWizardDialog(QWidget *parent,
     return wizard;
 }
 
-void GenericProjectWizard::getFileList(const QDir &dir, const QString &projectRoot,
-                                       const QStringList &suffixes,
-                                       QStringList *files, QStringList *paths) const
+QStringList GenericProjectWizard::getFileList(const QString &projectRoot,
+                                              const QStringList &suffixes) const
 {
-    const QFileInfoList fileInfoList = dir.entryInfoList(QDir::Files |
-                                                         QDir::Dirs |
-                                                         QDir::NoDotAndDotDot |
-                                                         QDir::NoSymLinks);
-
-    foreach (const QFileInfo &fileInfo, fileInfoList) {
-        QString filePath = fileInfo.absoluteFilePath();
-        filePath = filePath.mid(projectRoot.length() + 1);
-
-        if (fileInfo.isDir() && isValidDir(fileInfo)) {
-            getFileList(QDir(fileInfo.absoluteFilePath()), projectRoot,
-                        suffixes, files, paths);
-
-            if (! paths->contains(filePath))
-                paths->append(filePath);
-        }
-
-        else if (suffixes.contains(fileInfo.suffix()))
-            files->append(filePath);
-    }
-}
-
-bool GenericProjectWizard::isValidDir(const QFileInfo &fileInfo) const
-{
-    const QString fileName = fileInfo.fileName();
-    const QString suffix = fileInfo.suffix();
-
-    if (fileName.startsWith(QLatin1Char('.')))
-        return false;
-
-    else if (fileName == QLatin1String("CVS"))
-        return false;    
+    QStringList nameFilters;
+    foreach (const QString &suffix, suffixes)
+        nameFilters.append(QLatin1String("*.") + suffix);
 
     // ### user include/exclude
-
-    return true;
+    QStringList ignoredNames;
+    ignoredNames << QLatin1String(".*") << QLatin1String("CVS");
+
+    Utils::DirectoryCrawler crawler;
+    crawler.setRootDirectories(QStringList(projectRoot));
+    crawler.setNameFilters(nameFilters);
+    crawler.setIgnoredNames(ignoredNames);
+    crawler.setCaseSensitivity(Qt::CaseSensitive);
+    // Like QDir::NoSymLinks, leaves out linked files as well as directories
+    crawler.setFollowSymLinks(false);
+
+    const QString root = QDir::cleanPath(QDir::fromNativeSeparators(projectRoot));
+    QStringList files;
+    foreach (const QString &filePath, crawler.crawl())
+        files.append(filePath.mid(root.length() + 1));
+    return files;
 }
 
 Core::GeneratedFiles GenericProjectWizard::generateFiles(const QWizard *w,
@@ -326,23 +311,29 @@ Core::GeneratedFiles GenericProjectWizard::generateFiles(const QWizard *w,
 
     const QStringList suffixes = mimeDatabase->suffixes();
 
-    QStringList sources, paths;
-    getFileList(dir, projectPath, suffixes, &sources, &paths);
+    const QStringList sources = getFileList(projectPath, suffixes);
 
     Core::MimeType headerTy = mimeDatabase->findByType(QLatin1String("text/x-chdr"));
+    const QList<QRegExp> headerPatterns = headerTy.globPatterns();
 
-    QStringList nameFilters;
-    foreach (const QRegExp &rx, headerTy.globPatterns())
-        nameFilters.append(rx.pattern());
-
+    // Every subdirectory containing a header is an include path
     QStringList includePaths;
-    foreach (const QString &path, paths) {
-        QFileInfo fileInfo(dir, path);
-        QDir thisDir(fileInfo.absoluteFilePath());
-
-        if (! thisDir.entryList(nameFilters, QDir::Files).isEmpty())
-            includePaths.append(path);
+    foreach (const QString &source, sources) {
+        const int slash = source.lastIndexOf(QLatin1Char('/'));
+        if (slash == -1)
+            continue;
+        const QString path = source.left(slash);
+        if (!includePaths.isEmpty() && includePaths.last() == path)
+            continue;
+        const QString fileName = source.mid(slash + 1);
+        foreach (const QRegExp &rx, headerPatterns) {
+            if (rx.exactMatch(fileName)) {
+                includePaths.append(path);
+                break;
+            }
+        }
     }
+    includePaths.removeDuplicates();
 
     Core::GeneratedFile generatedCreatorFile(creatorFileName);
     generatedCreatorFile.setContents(QLatin1String("[General]\n"));
@@ -35,9 +35,7 @@
 #include <QtGui/QWizard>
 
 QT_BEGIN_NAMESPACE
-class QDir;
 class QDirModel;
-class QFileInfo;
 class QListView;
 class QModelIndex;
 class QStringList;
@@ -106,12 +104,8 @@ protected:
 
     virtual bool postGenerateFiles(const Core::GeneratedFiles &l, QString *errorMessage);
 
-    bool isValidDir(const QFileInfo &fileInfo) const;
-
-    void getFileList(const QDir &dir, const QString &projectRoot,
-                     const QStringList &suffixes,
-                     QStringList *files,
-                     QStringList *paths) const;
+    QStringList getFileList(const QString &projectRoot,
+                            const QStringList &suffixes) const;
 };
 
 } // end of namespace Internal
@@ -30,7 +30,6 @@
 #include "directoryfilter.h"
 
 #include <QtCore/QDir>
-#include <QtCore/QStack>
 #include <QtGui/QCompleter>
 #include <QtGui/QFileDialog>
 #include <QtGui/QMessageBox>
@@ -59,6 +58,7 @@ QByteArray DirectoryFilter::saveState() const
     out << shortcutString();
     out << isIncludedByDefault();
     out << m_files;
+    out << m_snapshot;
     return value;
 }
 
@@ -77,6 +77,10 @@ bool DirectoryFilter::restoreState(const QByteArray &state)
     in >> shortcut;
     in >> defaultFilter;
     in >> m_files;
+    if (!in.atEnd())
+        in >> m_snapshot;
+    else
+        m_snapshot.clear();
 
     setShortcutString(shortcut);
     setIncludedByDefault(defaultFilter);
@@ -178,78 +182,72 @@ void DirectoryFilter::updateOptionButtons()
     m_ui.removeButton->setEnabled(haveSelectedItem);
 }
 
+namespace {
+
+// Reports the progress of a refresh while the crawler runs
+class FilterCrawler : public Utils::DirectoryCrawler
+{
+public:
+    FilterCrawler(QFutureInterface<void> &future, const QString &name, int maximum)
+        : m_future(future), m_name(name), m_maximum(maximum)
+    {}
+
+protected:
+    void progress(int directoriesDone, int directoriesFound, int filesFound)
+    {
+        if (!m_future.isProgressUpdateNeeded())
+            return;
+        // The number of directories is not known up front, so this only ever approaches the maximum
+        m_future.setProgressValueAndText(qint64(m_maximum) * directoriesDone / (directoriesFound + 1),
+            DirectoryFilter::tr("%1 filter update: %n files", 0, filesFound).arg(m_name));
+    }
+
+private:
+    QFutureInterface<void> &m_future;
+    const QString m_name;
+    const int m_maximum;
+};
+
+} // anonymous namespace
+
 void DirectoryFilter::refresh(QFutureInterface<void> &future)
 {
     const int MAX = 360;
     future.setProgressRange(0, MAX);
-    if (m_directories.count() < 1) {
+
+    QStringList directories;
+    QStringList filters;
+    Utils::DirectorySnapshot snapshot;
+    {
+        QMutexLocker locker(&m_lock);
+        directories = m_directories;
+        filters = m_filters;
+        snapshot = m_snapshot;
+    }
+
+    if (directories.count() < 1) {
         QMutexLocker locker(&m_lock);
         m_files.clear();
+        m_snapshot.clear();
         generateFileNames();
         future.setProgressValueAndText(MAX, tr("%1 filter update: 0 files").arg(m_name));
         return;
     }
-    int progress = 0;
-    int MAX_PER = MAX;
-    QStringList files;
-    QStack<QDir> dirs;
-    QStack<int> progressValues;
-    QStack<bool> processedValues;
-    { // initialize
-        QMutexLocker locker(&m_lock);
-        MAX_PER = MAX/m_directories.count();
-        foreach (const QString &directoryEntry, m_directories) {
-            if (!directoryEntry.isEmpty()) {
-                dirs.push(QDir(directoryEntry));
-                progressValues.push(MAX_PER);
-                processedValues.push(false);
-            }
-        }
-    }
-    while (!dirs.isEmpty() && !future.isCanceled()) {
-        if (future.isProgressUpdateNeeded()) {
-            future.setProgressValueAndText(progress,
-                                           tr("%1 filter update: %n files", 0, files.size()).arg(m_name));
-        }
-        QDir dir = dirs.pop();
-        int dirProgressMax = progressValues.pop();
-        bool processed = processedValues.pop();
-        if (dir.exists()) {
-            QStringList subDirs;
-            if (!processed) {
-                subDirs = dir.entryList(QDir::Dirs|QDir::Hidden|QDir::NoDotAndDotDot,
-                    QDir::Name|QDir::IgnoreCase|QDir::LocaleAware);
-            }
-            if (subDirs.isEmpty()) {
-                QStringList fileEntries = dir.entryList(m_filters,
-                    QDir::Files|QDir::Hidden,
-                    QDir::Name|QDir::IgnoreCase|QDir::LocaleAware);
-                foreach (const QString &file, fileEntries)
-                    files.append(dir.path()+"/"+file);
-                progress += dirProgressMax;
-            } else {
-                int subProgress = dirProgressMax/(subDirs.size()+1);
-                int selfProgress = subProgress + dirProgressMax%(subDirs.size()+1);
-                dirs.push(dir);
-                progressValues.push(selfProgress);
-                processedValues.push(true);
-                foreach (const QString &directory, subDirs) {
-                    dirs.push(QDir(dir.path()+"/"+directory));
-                    progressValues.push(subProgress);
-                    processedValues.push(false);
-                }
-            }
-        } else {
-            progress += dirProgressMax;
-        }
-    }
+
+    // Directories that did not change since the last refresh are not read again
+    FilterCrawler crawler(future, m_name, MAX);
+    crawler.setRootDirectories(directories);
+    crawler.setNameFilters(filters);
+    crawler.setSnapshot(snapshot);
+    const QStringList files = crawler.crawl(&future);
 
     if (!future.isCanceled()) {
         QMutexLocker locker(&m_lock);
         m_files = files;
+        m_snapshot = crawler.snapshot();
         generateFileNames();
         future.setProgressValue(MAX);
     } else {
-        future.setProgressValueAndText(progress, tr("%1 filter update: canceled").arg(m_name));
+        future.setProgressValueAndText(future.progressValue(), tr("%1 filter update: canceled").arg(m_name));
     }
 }
@@ -33,6 +33,8 @@
 #include "ui_directoryfilter.h"
 #include "basefilefilter.h"
 
+#include <utils/directorycrawler.h>
+
 #include <QtCore/QString>
 #include <QtCore/QList>
 #include <QtCore/QByteArray>
@@ -68,6 +70,7 @@ private:
     QString m_name;
     QStringList m_directories;
     QStringList m_filters;
+    Utils::DirectorySnapshot m_snapshot;
     // Our config dialog, uses in addDirectory and editDirectory
     // to give their dialogs the right parent
     QDialog *m_dialog;
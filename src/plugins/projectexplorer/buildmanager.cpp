@@ -36,6 +36,7 @@
 #include "projectexplorer.h"
 #include "project.h"
 #include "projectexplorersettings.h"
+#include "session.h"
 #include "taskwindow.h"
 
 #include <coreplugin/icore.h>
@@ -45,6 +46,7 @@
 #include <utils/qtcassert.h>
 
 #include <QtCore/QDir>
+#include <QtCore/QSet>
 #include <QtCore/QTimer>
 
 #include <qtconcurrent/QtConcurrentTools>
@@ -61,6 +63,32 @@ static inline QString msgProgress(int n, int total)
     return BuildManager::tr("Finished %n of %1 build steps", 0, n).arg(total);
 }
 
+static void reportDroppedOutput(CompileOutputWindow *outputWindow)
+{
+    outputWindow->flush();
+    if (const int dropped = outputWindow->droppedLineCount())
+        outputWindow->appendText(BuildManager::tr("<font color=\"#808080\">%n lines of "
+            "output were dropped, only the last %1 lines are kept.</font>", 0, dropped)
+            .arg(int(CompileOutputWindow::MaxBlockCount)));
+}
+
+// Whether project needs other to be built first, directly or indirectly.
+static bool dependsOn(SessionManager *session, Project *project, Project *other)
+{
+    QList<Project *> todo = session->dependencies(project);
+    QSet<Project *> seen;
+    while (!todo.isEmpty()) {
+        Project *dep = todo.takeFirst();
+        if (dep == other)
+            return true;
+        if (!seen.contains(dep)) {
+            seen.insert(dep);
+            todo += session->dependencies(dep);
+        }
+    }
+    return false;
+}
+
 BuildManager::BuildManager(ProjectExplorerPlugin *parent)
     : QObject(parent)
     , m_running(false)
@@ -72,14 +100,6 @@ BuildManager::BuildManager(ProjectExplorerPlugin *parent)
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     m_projectExplorerPlugin = parent;
 
-    connect(&m_watcher, SIGNAL(finished()),
-            this, SLOT(nextBuildQueue()));
-
-    connect(&m_watcher, SIGNAL(progressValueChanged(int)),
-            this, SLOT(progressChanged()));
-    connect(&m_watcher, SIGNAL(progressRangeChanged(int, int)),
-            this, SLOT(progressChanged()));
-
     m_outputWindow = new CompileOutputWindow(this);
     pm->addObject(m_outputWindow);
 
@@ -115,8 +135,10 @@ void BuildManager::cancel()
 {
     if (m_running) {
         m_canceling = true;
-        m_watcher.cancel();
-        m_watcher.waitForFinished();
+        foreach (BuildStep *bs, m_runningSteps)
+            m_watchers.value(bs)->cancel();
+        foreach (BuildStep *bs, m_runningSteps)
+            m_watchers.value(bs)->waitForFinished();
 
         // The cancel message is added to the output window via a single shot timer
         // since the canceling is likely to have generated new addToOutputWindow signals
@@ -124,11 +146,9 @@ void BuildManager::cancel()
         // (And we want those to be before the cancel message.)
         QTimer::singleShot(0, this, SLOT(emitCancelMessage()));
 
-        disconnect(m_currentBuildStep, SIGNAL(addToTaskWindow(QString, int, int, QString)),
-                   this, SLOT(addToTaskWindow(QString, int, int, QString)));
-        disconnect(m_currentBuildStep, SIGNAL(addToOutputWindow(QString)),
-                   this, SLOT(addToOutputWindow(QString)));
-        decrementActiveBuildSteps(m_currentBuildStep->project());
+        foreach (BuildStep *bs, m_runningSteps)
+            stopBuildStep(bs);
+        m_runningSteps.clear();
 
         m_progressFutureInterface->setProgressValueAndText(m_progress*100, "Build canceled"); //TODO NBS fix in qtconcurrent
         clearBuildQueue();
@@ -149,7 +169,12 @@ void BuildManager::clearBuildQueue()
     m_buildQueue.clear();
     m_configurations.clear();
     m_running = false;
+
+    // No project is building any more, this shows what the steps of the
+    // other projects have written so far.
+    showBufferedOutput();
     m_previousBuildStepProject = 0;
+    reportDroppedOutput(m_outputWindow);
 
     m_progressFutureInterface->reportCanceled();
     m_progressFutureInterface->reportFinished();
@@ -216,6 +241,7 @@ void BuildManager::startBuildQueue()
         // Already running
         m_progressFutureInterface->setProgressRange(0, m_maxProgress * 100);
         m_progressFutureInterface->setProgressValueAndText(m_progress*100, msgProgress(m_progress, m_maxProgress));
+        nextStep();
     }
 }
 
@@ -235,80 +261,151 @@ void BuildManager::addToTaskWindow(const QString &file, int type, int line, cons
 
 void BuildManager::addToOutputWindow(const QString &string)
 {
-    m_outputWindow->appendText(string);
+    // Output of build steps is grouped by project, see appendStepOutput().
+    if (BuildStep *bs = qobject_cast<BuildStep *>(sender()))
+        appendStepOutput(bs, string);
+    else
+        m_outputWindow->appendText(string);
+}
+
+void BuildManager::appendStepOutput(BuildStep *bs, const QString &string)
+{
+    Project *pro = bs->project();
+    if (m_outputOrder.isEmpty() || m_outputOrder.first() == pro
+            || !m_outputOrder.contains(pro))
+        m_outputWindow->appendText(string);
+    else
+        m_bufferedOutput[pro].append(string);
+}
+
+// Lets the next project write to the output window once the current one
+// has no steps running or queued any more, after showing what it buffered
+// meanwhile.
+void BuildManager::showBufferedOutput()
+{
+    while (!m_outputOrder.isEmpty() && !isBuilding(m_outputOrder.first())) {
+        m_outputOrder.removeFirst();
+        if (m_outputOrder.isEmpty())
+            break;
+        Project *next = m_outputOrder.first();
+        if (next != m_previousBuildStepProject) {
+            m_outputWindow->appendText(tr("<b>Running build steps for project %2...</b>")
+                                       .arg(next->name()));
+            m_previousBuildStepProject = next;
+        }
+        foreach (const QString &string, m_bufferedOutput.take(next))
+            m_outputWindow->appendText(string);
+    }
 }
 
-void BuildManager::nextBuildQueue()
+void BuildManager::buildStepFinished()
 {
     if (m_canceling)
         return;
 
-    disconnect(m_currentBuildStep, SIGNAL(addToTaskWindow(QString, int, int, QString)),
-                this, SLOT(addToTaskWindow(QString, int, int, QString)));
-    disconnect(m_currentBuildStep, SIGNAL(addToOutputWindow(QString)),
-               this, SLOT(addToOutputWindow(QString)));
+    QFutureWatcher<bool> *watcher = static_cast<QFutureWatcher<bool> *>(sender());
+    BuildStep *bs = m_watchers.key(watcher);
+    if (!bs)
+        return;
+    const bool result = watcher->result();
+    m_runningSteps.removeOne(bs);
+    stopBuildStep(bs);
 
     ++m_progress;
     m_progressFutureInterface->setProgressValueAndText(m_progress*100, msgProgress(m_progress, m_maxProgress));
 
-    bool result = m_watcher.result();
     if (!result) {
         // Build Failure
-        addToOutputWindow(tr("<font color=\"#ff0000\">Error while building project %1</font>").arg(m_currentBuildStep->project()->name()));
-        addToOutputWindow(tr("<font color=\"#ff0000\">When executing build step '%1'</font>").arg(m_currentBuildStep->displayName()));
+        appendStepOutput(bs, tr("<font color=\"#ff0000\">Error while building project %1</font>").arg(bs->project()->name()));
+        appendStepOutput(bs, tr("<font color=\"#ff0000\">When executing build step '%1'</font>").arg(bs->displayName()));
         // NBS TODO fix in qtconcurrent
-        m_progressFutureInterface->setProgressValueAndText(m_progress*100, tr("Error while building project %1").arg(m_currentBuildStep->project()->name()));
+        m_progressFutureInterface->setProgressValueAndText(m_progress*100, tr("Error while building project %1").arg(bs->project()->name()));
+
+        // The build failed, don't wait for the steps of other projects.
+        foreach (BuildStep *other, m_runningSteps)
+            m_watchers.value(other)->cancel();
+        foreach (BuildStep *other, m_runningSteps) {
+            m_watchers.value(other)->waitForFinished();
+            stopBuildStep(other);
+        }
+        m_runningSteps.clear();
+        clearBuildQueue();
+        return;
     }
 
-    decrementActiveBuildSteps(m_currentBuildStep->project());
-    if (result)
-        nextStep();
-    else
-        clearBuildQueue();
+    showBufferedOutput();
+    nextStep();
+}
+
+void BuildManager::stopBuildStep(BuildStep *bs)
+{
+    disconnect(bs, SIGNAL(addToTaskWindow(QString, int, int, QString)),
+               this, SLOT(addToTaskWindow(QString, int, int, QString)));
+    disconnect(bs, SIGNAL(addToOutputWindow(QString)),
+               this, SLOT(addToOutputWindow(QString)));
+    if (QFutureWatcher<bool> *watcher = m_watchers.take(bs)) {
+        watcher->disconnect(this);
+        watcher->deleteLater();
+    }
+    decrementActiveBuildSteps(bs->project());
 }
 
 void BuildManager::progressChanged()
 {
     if (!m_progressFutureInterface)
         return;
-    int range = m_watcher.progressMaximum() - m_watcher.progressMinimum();
-    if (range != 0) {
-        int percent = (m_watcher.progressValue() - m_watcher.progressMinimum()) * 100 / range;
-        m_progressFutureInterface->setProgressValue(m_progress * 100 + percent);
+    int percent = 0;
+    foreach (BuildStep *bs, m_runningSteps) {
+        const QFutureWatcher<bool> *watcher = m_watchers.value(bs);
+        const int range = watcher->progressMaximum() - watcher->progressMinimum();
+        if (range != 0)
+            percent += (watcher->progressValue() - watcher->progressMinimum()) * 100 / range;
     }
+    m_progressFutureInterface->setProgressValue(m_progress * 100 + percent);
 }
 
+bool BuildManager::canStartBuildStep(BuildStep *bs, const QList<Project *> &busyProjects) const
+{
+    SessionManager *session = m_projectExplorerPlugin->session();
+    Project *pro = bs->project();
+    foreach (Project *busy, busyProjects) {
+        if (busy == pro || dependsOn(session, pro, busy) || dependsOn(session, busy, pro))
+            return false;
+    }
+    return true;
+}
+
+// Starts as many queued steps as the job budget allows. Steps of one
+// project run in order, and so do the steps of projects depending on
+// each other.
 void BuildManager::nextStep()
 {
-    if (!m_buildQueue.empty()) {
-        m_currentBuildStep = m_buildQueue.front();
-        m_currentConfiguration = m_configurations.front();
-        m_buildQueue.pop_front();
-        m_configurations.pop_front();
-
-        connect(m_currentBuildStep, SIGNAL(addToTaskWindow(QString, int, int, QString)),
-                this, SLOT(addToTaskWindow(QString, int, int, QString)));
-        connect(m_currentBuildStep, SIGNAL(addToOutputWindow(QString)),
-                this, SLOT(addToOutputWindow(QString)));
-
-        bool init = m_currentBuildStep->init(m_currentConfiguration);
-        if (!init) {
-            addToOutputWindow(tr("<font color=\"#ff0000\">Error while building project %1</font>").arg(m_currentBuildStep->project()->name()));
-            addToOutputWindow(tr("<font color=\"#ff0000\">When executing build step '%1'</font>").arg(m_currentBuildStep->displayName()));
-            cancel();
-            return;
+    const int maxJobs =
+        qMax(1, m_projectExplorerPlugin->projectExplorerSettings().parallelBuildJobs);
+    QList<Project *> busyProjects;
+    foreach (BuildStep *bs, m_runningSteps)
+        busyProjects << bs->project();
+
+    for (int i = 0; i < m_buildQueue.size() && m_runningSteps.size() < maxJobs; ) {
+        BuildStep *bs = m_buildQueue.at(i);
+        const bool canStart = canStartBuildStep(bs, busyProjects);
+        // Later steps of this project have to wait for this one.
+        busyProjects << bs->project();
+        if (!canStart) {
+            ++i;
+            continue;
         }
+        const QString configuration = m_configurations.at(i);
+        m_buildQueue.removeAt(i);
+        m_configurations.removeAt(i);
+        if (!startBuildStep(bs, configuration))
+            return;
+    }
 
-        if (m_currentBuildStep->project() != m_previousBuildStepProject) {
-            const QString projectName = m_currentBuildStep->project()->name();
-            addToOutputWindow(tr("<b>Running build steps for project %2...</b>")
-                              .arg(projectName));
-            m_previousBuildStepProject = m_currentBuildStep->project();
-        }
-        m_watcher.setFuture(QtConcurrent::run(&BuildStep::run, m_currentBuildStep));
-    } else {
+    if (m_runningSteps.isEmpty() && m_buildQueue.isEmpty()) {
         m_running = false;
-        m_previousBuildStepProject = 0;        
+        m_previousBuildStepProject = 0;
+        reportDroppedOutput(m_outputWindow);
         m_progressFutureInterface->reportFinished();
         m_progressWatcher.setFuture(QFuture<void>());
         delete m_progressFutureInterface;
@@ -318,6 +415,45 @@ void BuildManager::nextStep()
     }
 }
 
+bool BuildManager::startBuildStep(BuildStep *bs, const QString &configuration)
+{
+    connect(bs, SIGNAL(addToTaskWindow(QString, int, int, QString)),
+            this, SLOT(addToTaskWindow(QString, int, int, QString)));
+    connect(bs, SIGNAL(addToOutputWindow(QString)),
+            this, SLOT(addToOutputWindow(QString)));
+
+    bool init = bs->init(configuration);
+    if (!init) {
+        disconnect(bs, 0, this, 0);
+        decrementActiveBuildSteps(bs->project());
+        cancel();
+        m_outputWindow->appendText(tr("<font color=\"#ff0000\">Error while building project %1</font>").arg(bs->project()->name()));
+        m_outputWindow->appendText(tr("<font color=\"#ff0000\">When executing build step '%1'</font>").arg(bs->displayName()));
+        return false;
+    }
+
+    if (m_outputOrder.isEmpty() && bs->project() != m_previousBuildStepProject) {
+        const QString projectName = bs->project()->name();
+        m_outputWindow->appendText(tr("<b>Running build steps for project %2...</b>")
+                          .arg(projectName));
+        m_previousBuildStepProject = bs->project();
+    }
+    if (!m_outputOrder.contains(bs->project()))
+        m_outputOrder.append(bs->project());
+    m_runningSteps.append(bs);
+
+    QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, SIGNAL(finished()),
+            this, SLOT(buildStepFinished()));
+    connect(watcher, SIGNAL(progressValueChanged(int)),
+            this, SLOT(progressChanged()));
+    connect(watcher, SIGNAL(progressRangeChanged(int, int)),
+            this, SLOT(progressChanged()));
+    m_watchers.insert(bs, watcher);
+    watcher->setFuture(QtConcurrent::run(&BuildStep::run, bs));
+    return true;
+}
+
 void BuildManager::buildQueueAppend(BuildStep * bs, const QString &configuration)
 {
     m_buildQueue.append(bs);
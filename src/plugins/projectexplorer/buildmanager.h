@@ -95,7 +95,7 @@ private slots:
     void addToTaskWindow(const QString &file, int type, int line, const QString &description);
     void addToOutputWindow(const QString &string);
 
-    void nextBuildQueue();
+    void buildStepFinished();
     void progressChanged();
     void emitCancelMessage();
     void showBuildResults();
@@ -103,6 +103,11 @@ private slots:
 private:
     void startBuildQueue();
     void nextStep();
+    bool startBuildStep(BuildStep *bs, const QString &configuration);
+    bool canStartBuildStep(BuildStep *bs, const QList<Project *> &busyProjects) const;
+    void stopBuildStep(BuildStep *bs);
+    void appendStepOutput(BuildStep *bs, const QString &string);
+    void showBufferedOutput();
     void clearBuildQueue();
     void buildQueueAppend(BuildStep * bs, const QString &configuration);
     void incrementActiveBuildSteps(Project *pro);
@@ -115,9 +120,16 @@ private:
     QStringList m_configurations; // the corresponding configuration to the m_buildQueue
     ProjectExplorerPlugin *m_projectExplorerPlugin;
     bool m_running;
-    QFutureWatcher<bool> m_watcher;
-    BuildStep *m_currentBuildStep;
-    QString m_currentConfiguration;
+    // Steps of independent projects may run at the same time.
+    QList<BuildStep *> m_runningSteps;
+    QHash<BuildStep *, QFutureWatcher<bool> *> m_watchers;
+    // Projects whose output has not been shown completely yet, in the order
+    // their first step was started. Only the first one writes to the output
+    // window directly, the others buffer their output until all steps of the
+    // projects before them are done, so the output of a project stays in
+    // one piece.
+    QList<Project *> m_outputOrder;
+    QHash<Project *, QStringList> m_bufferedOutput;
     // used to decide if we are building a project to decide when to emit buildStateChanged(Project *)
     QHash<Project *, int>  m_activeBuildSteps;
     Project *m_previousBuildStepProject;
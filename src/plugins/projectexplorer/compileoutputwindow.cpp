@@ -36,18 +36,24 @@
 #include <QtGui/QKeyEvent>
 #include <QtGui/QIcon>
 #include <QtGui/QTextEdit>
+#include <QtGui/QTextCursor>
 #include <QtGui/QScrollBar>
 
 using namespace ProjectExplorer;
 using namespace ProjectExplorer::Internal;
 
 CompileOutputWindow::CompileOutputWindow(BuildManager * /*bm*/)
+  : m_droppedLines(0)
 {
     m_textEdit = new QPlainTextEdit();
     m_textEdit->setWindowTitle(tr("Compile Output"));
     m_textEdit->setWindowIcon(QIcon(":/qt4projectmanager/images/window.png"));
     m_textEdit->setReadOnly(true);
     m_textEdit->setFrameStyle(QFrame::NoFrame);
+    m_textEdit->setMaximumBlockCount(MaxBlockCount);
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(FlushInterval);
+    connect(&m_flushTimer, SIGNAL(timeout()), this, SLOT(flushPendingText()));
     Aggregation::Aggregate *agg = new Aggregation::Aggregate;
     agg->add(m_textEdit);
     agg->add(new Find::BaseTextFind(m_textEdit));
@@ -75,11 +81,59 @@ QWidget *CompileOutputWindow::outputWidget(QWidget *)
 
 void CompileOutputWindow::appendText(const QString &text)
 {
-    m_textEdit->appendHtml(text);
+    m_pendingText.append(text);
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+}
+
+void CompileOutputWindow::flush()
+{
+    m_flushTimer.stop();
+    flushPendingText();
+}
+
+// Laying out the document after each line is what makes huge build
+// logs slow, so all lines collected since the last flush are inserted
+// in one edit block.
+void CompileOutputWindow::flushPendingText()
+{
+    if (m_pendingText.isEmpty())
+        return;
+    // Lines that would be pushed out of the window by this batch anyway
+    // are not inserted at all.
+    const int excess = m_pendingText.size() - MaxBlockCount;
+    if (excess > 0) {
+        m_pendingText.erase(m_pendingText.begin(), m_pendingText.begin() + excess);
+        m_droppedLines += excess;
+    }
+    const int blocksBefore = m_textEdit->document()->isEmpty()
+        ? 0 : m_textEdit->blockCount();
+    m_droppedLines +=
+        qMax(0, blocksBefore + m_pendingText.size() - MaxBlockCount);
+
+    QScrollBar *scrollBar = m_textEdit->verticalScrollBar();
+    const bool atBottom = scrollBar->value() == scrollBar->maximum();
+    QTextCursor cursor(m_textEdit->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.beginEditBlock();
+    bool first = m_textEdit->document()->isEmpty();
+    foreach (const QString &text, m_pendingText) {
+        if (!first)
+            cursor.insertBlock();
+        first = false;
+        cursor.insertHtml(text);
+    }
+    cursor.endEditBlock();
+    m_pendingText.clear();
+    if (atBottom)
+        scrollBar->setValue(scrollBar->maximum());
 }
 
 void CompileOutputWindow::clearContents()
 {
+    m_flushTimer.stop();
+    m_pendingText.clear();
+    m_droppedLines = 0;
     m_textEdit->clear();
 }
 
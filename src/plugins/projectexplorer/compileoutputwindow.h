@@ -32,6 +32,8 @@
 
 #include <coreplugin/ioutputpane.h>
 
+#include <QtCore/QStringList>
+#include <QtCore/QTimer>
 #include <QtGui/QPlainTextEdit>
 
 namespace ProjectExplorer {
@@ -52,7 +54,11 @@ public:
     int priorityInStatusBar() const;
     void clearContents();
     void visibilityChanged(bool visible);
+    // Text is collected and shown in batches, only the last
+    // MaxBlockCount lines are kept.
     void appendText(const QString &text);
+    void flush();
+    int droppedLineCount() const { return m_droppedLines; }
     bool canFocus();
     bool hasFocus();
     void setFocus();
@@ -63,8 +69,16 @@ public:
     void goToPrev();
     bool canNavigate();
 
+    enum { MaxBlockCount = 100000, FlushInterval = 100 };
+
+private slots:
+    void flushPendingText();
+
 private:
     QPlainTextEdit *m_textEdit;
+    QStringList m_pendingText;
+    QTimer m_flushTimer;
+    int m_droppedLines;
 };
 
 } // namespace Internal
@@ -29,76 +29,53 @@
 
 #include "filewatcher.h"
 
-#include <QtCore/QDebug>
-#include <QtCore/QDir>
-#include <QtCore/QFileInfo>
-#include <QtCore/QFileSystemWatcher>
-#include <QtCore/QTimer>
+#include <coreplugin/filechangewatcher.h>
 
-enum { debugWatcher = 0 };
+#include <QtCore/QFileInfo>
 
 using namespace ProjectExplorer;
 
-int FileWatcher::m_objectCount = 0;
-QHash<QString,int> FileWatcher::m_fileCount;
-QFileSystemWatcher *FileWatcher::m_watcher = 0;
-
 FileWatcher::FileWatcher(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    m_watcher(new Core::FileChangeWatcher(this))
 {
-    if (!m_watcher)
-        m_watcher = new QFileSystemWatcher();
-    ++m_objectCount;
-    connect(m_watcher, SIGNAL(fileChanged(QString)),
-            this, SLOT(slotFileChanged(QString)));
+    connect(m_watcher, SIGNAL(filesChanged(QStringList)),
+            this, SLOT(slotFilesChanged(QStringList)));
 }
 
 FileWatcher::~FileWatcher()
 {
-    QStringList keys = m_files.keys();
-    foreach(const QString &file, keys)
-        removeFile(file);
-
-    if (--m_objectCount == 0) {
-        delete m_watcher;
-        m_watcher = 0;
-    }
 }
 
-void FileWatcher::slotFileChanged(const QString &file)
+void FileWatcher::slotFilesChanged(const QStringList &files)
 {
-    if (m_files.contains(file)) {
-        QDateTime lastModified = QFileInfo(file).lastModified();
-        if (lastModified != m_files.value(file)) {
-            m_files[file] = lastModified;
-            emit fileChanged(file);
+    QStringList changedFiles;
+    foreach (const QString &file, files) {
+        QMap<QString, QDateTime>::iterator it = m_files.find(file);
+        if (it == m_files.end())
+            continue;
+        const QDateTime lastModified = QFileInfo(file).lastModified();
+        if (lastModified != it.value()) {
+            it.value() = lastModified;
+            changedFiles.append(file);
         }
     }
+    if (changedFiles.isEmpty())
+        return;
+
+    foreach (const QString &file, changedFiles)
+        emit fileChanged(file);
+    emit filesChanged(changedFiles);
 }
 
 void FileWatcher::addFile(const QString &file)
 {
-    const int count = ++m_fileCount[file];
-    Q_ASSERT(count > 0);
-
     m_files.insert(file, QFileInfo(file).lastModified());
-
-    if (count == 1)
-        m_watcher->addPath(file);
+    m_watcher->addFile(file);
 }
 
 void FileWatcher::removeFile(const QString &file)
 {
-    if (!m_files.contains(file))
-        return;
-
-    const int count = --m_fileCount[file];
-    Q_ASSERT(count >= 0);
-
-    m_files.remove(file);
-
-    if (!count) {
-        m_watcher->removePath(file);
-        m_fileCount.remove(file);
-    }
+    if (m_files.remove(file))
+        m_watcher->removeFile(file);
 }
@@ -33,19 +33,18 @@
 #include "projectexplorer_export.h"
 
 #include <QtCore/QDateTime>
-#include <QtCore/QHash>
+#include <QtCore/QMap>
 #include <QtCore/QObject>
 #include <QtCore/QStringList>
-#include <QtCore/QDateTime>
-#include <QtCore/QMap>
 
-QT_BEGIN_NAMESPACE
-class QTimer;
-class QFileSystemWatcher;
-QT_END_NAMESPACE
+namespace Core {
+class FileChangeWatcher;
+}
 
 namespace ProjectExplorer {
 
+// Reports files whose modification time changed, on top of the
+// shared Core::FileChangeWatcher service
 class PROJECTEXPLORER_EXPORT FileWatcher : public QObject
 {
     Q_DISABLE_COPY(FileWatcher)
@@ -58,15 +57,15 @@ public:
     void removeFile(const QString &file);
 signals:
     void fileChanged(const QString &path);
+    // All files of one burst of changes
+    void filesChanged(const QStringList &paths);
     void debugOutout(const QString &path);
 
 private slots:
-    void slotFileChanged(const QString&);
+    void slotFilesChanged(const QStringList &files);
 
 private:
-    static int m_objectCount;
-    static QHash<QString, int> m_fileCount;
-    static QFileSystemWatcher *m_watcher;
+    Core::FileChangeWatcher *m_watcher;
     QMap<QString, QDateTime> m_files;
 };
 
@@ -34,6 +34,42 @@
 
 using namespace ProjectExplorer;
 
+// Most lines of a build log match none of the patterns below. The regular
+// expressions are therefore only tried on lines that contain what the
+// respective pattern cannot match without, which is collected in a single
+// pass over the line.
+enum LineFeature {
+    ParenColon = 0x1,      // "):", needed by m_regExpLinker
+    ColonDigit = 0x2,      // ":<digit>", needed by m_regExp
+    IncludedSuffix = 0x4   // "<digit>," or "<digit>:" at the end, needed by m_regExpIncluded
+};
+
+static int lineFeatures(const QString &line)
+{
+    const int size = line.size();
+    const QChar *c = line.constData();
+    int features = 0;
+    for (int i = 0; i < size; ++i) {
+        if (c[i] != QLatin1Char(':'))
+            continue;
+        if (i > 0 && c[i - 1] == QLatin1Char(')'))
+            features |= ParenColon;
+        if (i + 1 < size && c[i + 1].isDigit())
+            features |= ColonDigit;
+    }
+    if (size >= 2 && c[size - 2].isDigit()
+            && (c[size - 1] == QLatin1Char(',') || c[size - 1] == QLatin1Char(':')))
+        features |= IncludedSuffix;
+    return features;
+}
+
+static inline bool isMakeDirectoryLine(const QString &line)
+{
+    return (line.startsWith(QLatin1String("make"))
+            || line.startsWith(QLatin1String("mingw32-make")))
+        && line.contains(QLatin1String(" directory "));
+}
+
 GccParser::GccParser()
 {
     m_regExp.setPattern("^([^\\(\\)]+[^\\d]):(\\d+):(\\d+:)*(\\s(warning|error):)?\\s(.+)$");
@@ -59,7 +95,7 @@ void GccParser::stdOutput(const QString & line)
 {
     QString lne = line.trimmed();
 
-    if (m_makeDir.indexIn(lne) > -1) {
+    if (isMakeDirectoryLine(lne) && m_makeDir.indexIn(lne) > -1) {
         if (m_makeDir.cap(1) == "Leaving")
                 emit leaveDirectory(m_makeDir.cap(2));
             else
@@ -70,7 +106,13 @@ void GccParser::stdOutput(const QString & line)
 void GccParser::stdError(const QString & line)
 {
     QString lne = line.trimmed();
-     if (m_regExpLinker.indexIn(lne) > -1) {
+    if (lne.startsWith(QLatin1String("collect2:"))) {
+        emit addToTaskWindow("", ProjectExplorer::BuildParserInterface::Error, -1, lne);
+        return;
+    }
+
+    const int features = lineFeatures(lne);
+    if ((features & ParenColon) && m_regExpLinker.indexIn(lne) > -1) {
         QString description = m_regExpLinker.cap(2);
         emit addToTaskWindow(
             m_regExpLinker.cap(1), //filename
@@ -78,7 +120,7 @@ void GccParser::stdError(const QString & line)
             -1, //linenumber
             description);
         //qDebug()<<"m_regExpLinker"<<m_regExpLinker.cap(2);
-    } else if (m_regExp.indexIn(lne) > -1) {
+    } else if ((features & ColonDigit) && m_regExp.indexIn(lne) > -1) {
         ProjectExplorer::BuildParserInterface::PatternType type;
         if (m_regExp.cap(5) == "warning")
             type = ProjectExplorer::BuildParserInterface::Warning;
@@ -96,7 +138,7 @@ void GccParser::stdError(const QString & line)
             type,
             m_regExp.cap(2).toInt(), //line number
             description);
-    } else if (m_regExpIncluded.indexIn(lne) > -1) {
+    } else if ((features & IncludedSuffix) && m_regExpIncluded.indexIn(lne) > -1) {
         emit addToTaskWindow(
             m_regExpIncluded.cap(1), //filename
             ProjectExplorer::BuildParserInterface::Unknown,
@@ -104,6 +146,5 @@ void GccParser::stdError(const QString & line)
             lne //description
             );
         //qDebug()<<"m_regExpInclude"<<m_regExpIncluded.cap(1)<<m_regExpIncluded.cap(2);
-    } else if (lne.startsWith(QLatin1String("collect2:"))) {
-        emit addToTaskWindow("", ProjectExplorer::BuildParserInterface::Error, -1, lne);
-    }}
+    }
+}
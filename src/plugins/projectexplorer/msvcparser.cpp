@@ -35,6 +35,30 @@
 
 using namespace ProjectExplorer;
 
+// Both patterns need a colon preceded by white space ("file(12) : error",
+// "LINK : fatal error"), the compile pattern additionally a closing
+// parenthesis in front of that. Checking for this in one pass over the
+// line spares running the regular expressions on the bulk of the output.
+enum LineFeature {
+    SpaceColon = 0x1,
+    ParenSpaceColon = 0x2
+};
+
+static int lineFeatures(const QString &line)
+{
+    const int size = line.size();
+    const QChar *c = line.constData();
+    int features = 0;
+    for (int i = 1; i < size; ++i) {
+        if (c[i] != QLatin1Char(':') || !c[i - 1].isSpace())
+            continue;
+        features |= SpaceColon;
+        if (i > 1 && c[i - 2] == QLatin1Char(')'))
+            return features | ParenSpaceColon;
+    }
+    return features;
+}
+
 MsvcParser::MsvcParser()
 {
     m_compileRegExp.setPattern("^([^\\(]+)\\((\\d+)\\)+\\s:[^:\\d]+(\\d+):(.*)$");
@@ -57,7 +81,12 @@ void MsvcParser::stdError(const QString & line)
 void MsvcParser::stdOutput(const QString & line)
 {
     QString lne = line.trimmed();
-    if (m_compileRegExp.indexIn(lne) > -1 && m_compileRegExp.numCaptures() == 4) {
+    const int features = lineFeatures(lne);
+    if (!features)
+        return;
+
+    if ((features & ParenSpaceColon)
+            && m_compileRegExp.indexIn(lne) > -1 && m_compileRegExp.numCaptures() == 4) {
         emit addToTaskWindow(
             QDir::cleanPath(m_compileRegExp.cap(1)), //filename
             toType(m_compileRegExp.cap(3).toInt()), // PatternType
@@ -36,12 +36,14 @@ namespace Internal {
 struct ProjectExplorerSettings
 {
     ProjectExplorerSettings() : buildBeforeRun(true), saveBeforeBuild(false),
-                                showCompilerOutput(false), useJom(true) {}
+                                showCompilerOutput(false), useJom(true),
+                                parallelBuildJobs(1) {}
 
     bool buildBeforeRun;
     bool saveBeforeBuild;
     bool showCompilerOutput;
     bool useJom;
+    int parallelBuildJobs; // build steps of independent projects run at once
 };
 
 inline bool operator==(const ProjectExplorerSettings &p1, const ProjectExplorerSettings &p2)
@@ -49,7 +51,8 @@ inline bool operator==(const ProjectExplorerSettings &p1, const ProjectExplorerS
     return p1.buildBeforeRun == p2.buildBeforeRun
             && p1.saveBeforeBuild == p2.saveBeforeBuild
             && p1.showCompilerOutput == p2.showCompilerOutput
-            && p1.useJom == p2.useJom;
+            && p1.useJom == p2.useJom
+            && p1.parallelBuildJobs == p2.parallelBuildJobs;
 }
 
 
@@ -74,6 +74,7 @@ QWidget *ProjectExplorerSettingsPage::createPage(QWidget *parent)
     m_ui.buildProjectBeforeRunCheckBox->setChecked(pes.buildBeforeRun);
     m_ui.saveAllFilesCheckBox->setChecked(pes.saveBeforeBuild);
     m_ui.showCompileOutputCheckBox->setChecked(pes.showCompilerOutput);
+    m_ui.parallelBuildJobsSpinBox->setValue(pes.parallelBuildJobs);
 #ifdef Q_OS_WIN
     m_ui.jomCheckbox->setChecked(pes.useJom);
 #else
@@ -89,6 +90,7 @@ void ProjectExplorerSettingsPage::apply()
     pes.buildBeforeRun = m_ui.buildProjectBeforeRunCheckBox->isChecked();
     pes.saveBeforeBuild = m_ui.saveAllFilesCheckBox->isChecked();
     pes.showCompilerOutput = m_ui.showCompileOutputCheckBox->isChecked();
+    pes.parallelBuildJobs = m_ui.parallelBuildJobsSpinBox->value();
 #ifdef Q_OS_WIN
     pes.useJom = m_ui.jomCheckbox->isChecked();
 #endif
@@ -51,6 +51,23 @@ using Core::FileIconProvider;
 
 namespace {
 
+// compares the file name parts of two paths, without the QFileInfo overhead
+int compareFileNames(const QString &filePath1, const QString &filePath2)
+{
+    const int start1 = filePath1.lastIndexOf(QLatin1Char('/')) + 1;
+    const int start2 = filePath2.lastIndexOf(QLatin1Char('/')) + 1;
+    const int length1 = filePath1.length() - start1;
+    const int length2 = filePath2.length() - start2;
+    const QChar *c1 = filePath1.constData() + start1;
+    const QChar *c2 = filePath2.constData() + start2;
+    const int length = qMin(length1, length2);
+    for (int i = 0; i < length; ++i) {
+        if (c1[i] != c2[i])
+            return c1[i].unicode() - c2[i].unicode();
+    }
+    return length1 - length2;
+}
+
 // sorting helper function
 bool sortNodes(Node *n1, Node *n2)
 {
@@ -64,11 +81,9 @@ bool sortNodes(Node *n1, Node *n2)
     FileNode *file2 = qobject_cast<FileNode*>(n2);
     if (file1 && file1->fileType() == ProjectFileType) {
         if (file2 && file2->fileType() == ProjectFileType) {
-            const QString fileName1 = QFileInfo(file1->path()).fileName();
-            const QString fileName2 = QFileInfo(file2->path()).fileName();
-
-            if (fileName1 != fileName2)
-                return fileName1 < fileName2;
+            const int result = compareFileNames(file1->path(), file2->path());
+            if (result != 0)
+                return result < 0;
             else
                 return file1 < file2;
         } else {
@@ -118,11 +133,9 @@ bool sortNodes(Node *n1, Node *n2)
         const QString filePath1 = n1->path();
         const QString filePath2 = n2->path();
 
-        const QString fileName1 = QFileInfo(filePath1).fileName();
-        const QString fileName2 = QFileInfo(filePath2).fileName();
-
-        if (fileName1 != fileName2) {
-            return fileName1 < fileName2; // sort by file names
+        const int result = compareFileNames(filePath1, filePath2);
+        if (result != 0) {
+            return result < 0; // sort by file names
         } else {
             if (filePath1 != filePath2) {
                 return filePath1 < filePath2; // sort by path names
@@ -1013,11 +1026,7 @@ void FlatModel::added(FolderNode* parentNode, const QList<Node*> &newNodeList)
                 int count = newIter - startOfBlock;
                 if (count > 0) {
                     beginInsertRows(parentIndex, pos, pos+count-1);
-                    while (startOfBlock != newIter) {
-                        oldNodeList.insert(pos, *startOfBlock);
-                        ++pos;
-                        ++startOfBlock;
-                    }
+                    oldNodeList += newNodeList.mid(startOfBlock - newNodeList.constBegin());
                     m_childNodes.insert(parentNode, oldNodeList);
                     endInsertRows();
                 }
@@ -1035,11 +1044,11 @@ void FlatModel::added(FolderNode* parentNode, const QList<Node*> &newNodeList)
         int pos = oldIter - oldNodeList.constBegin();
         int count = newIter - startOfBlock;
         beginInsertRows(parentIndex, pos, pos + count - 1);
-        while (startOfBlock != newIter) {
-            oldNodeList.insert(pos, *startOfBlock);
-            ++pos;
-            ++startOfBlock;
-        }
+        // insert the whole block at once instead of shifting the tail per node
+        oldNodeList = oldNodeList.mid(0, pos)
+                      + newNodeList.mid(startOfBlock - newNodeList.constBegin(), count)
+                      + oldNodeList.mid(pos);
+        pos += count;
         m_childNodes.insert(parentNode, oldNodeList);
         endInsertRows();
         oldIter = oldNodeList.constBegin() + pos;
@@ -1083,10 +1092,7 @@ void FlatModel::removed(FolderNode* parentNode, const QList<Node*> &newNodeList)
                 int count = oldIter - startOfBlock;
                 if (count > 0) {
                     beginRemoveRows(parentIndex, pos, pos+count-1);
-                    while (startOfBlock != oldIter) {
-                        ++startOfBlock;
-                        oldNodeList.removeAt(pos);
-                    }
+                    oldNodeList.erase(oldNodeList.begin() + pos, oldNodeList.end());
 
                     m_childNodes.insert(parentNode, oldNodeList);
                     endRemoveRows();
@@ -1105,10 +1111,7 @@ void FlatModel::removed(FolderNode* parentNode, const QList<Node*> &newNodeList)
         int pos = startOfBlock - oldNodeList.constBegin();
         int count = oldIter - startOfBlock;
         beginRemoveRows(parentIndex, pos, pos + count - 1);
-        while (startOfBlock != oldIter) {
-            ++startOfBlock;
-            oldNodeList.removeAt(pos);
-        }
+        oldNodeList.erase(oldNodeList.begin() + pos, oldNodeList.begin() + pos + count);
         m_childNodes.insert(parentNode, oldNodeList);
         endRemoveRows();
         oldIter = oldNodeList.constBegin() + pos;
@@ -36,12 +36,64 @@
 #include <utils/qtcassert.h>
 
 #include <QtCore/QFileInfo>
+#include <QtCore/QSet>
 #include <QtGui/QApplication>
 #include <QtGui/QIcon>
 #include <QtGui/QStyle>
 
 using namespace ProjectExplorer;
 
+namespace {
+
+// Merges nodes into the list of sorted nodes in linear time.
+// Nodes with equal paths are inserted after the existing ones.
+template <class T>
+void insertSorted(QList<T*> *sortedNodes, QList<T*> nodes)
+{
+    qStableSort(nodes.begin(), nodes.end(), ProjectNode::sortNodesByPath);
+    if (sortedNodes->isEmpty() || !ProjectNode::sortNodesByPath(nodes.first(), sortedNodes->last())) {
+        *sortedNodes += nodes;
+        return;
+    }
+
+    QList<T*> merged;
+    merged.reserve(sortedNodes->size() + nodes.size());
+    typename QList<T*>::const_iterator oldIt = sortedNodes->constBegin();
+    typename QList<T*>::const_iterator newIt = nodes.constBegin();
+    while (oldIt != sortedNodes->constEnd() && newIt != nodes.constEnd()) {
+        if (ProjectNode::sortNodesByPath(*newIt, *oldIt))
+            merged.append(*newIt++);
+        else
+            merged.append(*oldIt++);
+    }
+    while (oldIt != sortedNodes->constEnd())
+        merged.append(*oldIt++);
+    while (newIt != nodes.constEnd())
+        merged.append(*newIt++);
+    *sortedNodes = merged;
+}
+
+// Removes and deletes nodes from the list in linear time, returns
+// the number of nodes that were not part of the list
+template <class T>
+int removeAndDelete(QList<T*> *list, const QList<T*> &nodes)
+{
+    const QSet<T*> toRemove = nodes.toSet();
+    QList<T*> remaining;
+    remaining.reserve(list->size());
+    foreach (T *node, *list) {
+        if (toRemove.contains(node))
+            delete node;
+        else
+            remaining.append(node);
+    }
+    const int missing = toRemove.size() - (list->size() - remaining.size());
+    *list = remaining;
+    return missing;
+}
+
+} // namespace anon
+
 /*!
   \class FileNode
 
@@ -391,29 +443,11 @@ void ProjectNode::addFolderNodes(const QList<FolderNode*> &subFolders, FolderNod
             folder->setParentFolderNode(parentFolder);
             folder->setProjectNode(this);
 
-            // Find the correct place to insert
-            if (parentFolder->m_subFolderNodes.count() == 0 || sortNodesByPath(parentFolder->m_subFolderNodes.last(), folder)) {
-                // empty list or greater then last node
-                parentFolder->m_subFolderNodes.append(folder);
-            } else {
-                // Binary Search for insertion point
-                int l = 0;
-                int r = parentFolder->m_subFolderNodes.count();
-                while (l != r) {
-                    int i = (l + r) / 2;
-                    if (sortNodesByPath(folder, parentFolder->m_subFolderNodes.at(i))) {
-                        r = i;
-                    } else {
-                        l = i + 1;
-                    }
-                }
-                parentFolder->m_subFolderNodes.insert(l, folder);
-            }
-
             // project nodes have to be added via addProjectNodes
             QTC_ASSERT(folder->nodeType() != ProjectNodeType,
                 qDebug("project nodes have to be added via addProjectNodes"));
         }
+        insertSorted(&parentFolder->m_subFolderNodes, subFolders);
 
         if (emitSignals)
             foreach (NodesWatcher *watcher, m_watchers)
@@ -440,19 +474,11 @@ void ProjectNode::removeFolderNodes(const QList<FolderNode*> &subFolders,
             foreach (NodesWatcher *watcher, m_watchers)
                 emit watcher->foldersAboutToBeRemoved(parentFolder, toRemove);
 
-        QList<FolderNode*>::const_iterator toRemoveIter = toRemove.constBegin();
-        QList<FolderNode*>::iterator folderIter = parentFolder->m_subFolderNodes.begin();
-        for (; toRemoveIter != toRemove.constEnd(); ++toRemoveIter) {
-            QTC_ASSERT((*toRemoveIter)->nodeType() != ProjectNodeType,
+        foreach (FolderNode *folder, toRemove)
+            QTC_ASSERT(folder->nodeType() != ProjectNodeType,
                 qDebug("project nodes have to be removed via removeProjectNodes"));
-            while ((*folderIter)->path() != (*toRemoveIter)->path()) {
-                ++folderIter;
-                QTC_ASSERT(folderIter != parentFolder->m_subFolderNodes.end(),
-                    qDebug("Folder to remove is not part of specified folder!"));
-            }
-            delete *folderIter;
-            folderIter = parentFolder->m_subFolderNodes.erase(folderIter);
-        }
+        const int missing = removeAndDelete(&parentFolder->m_subFolderNodes, toRemove);
+        QTC_ASSERT(!missing, qDebug("Folder to remove is not part of specified folder!"));
 
         if (emitSignals)
             foreach (NodesWatcher *watcher, m_watchers)
@@ -481,25 +507,8 @@ void ProjectNode::addFileNodes(const QList<FileNode*> &files, FolderNode *folder
 
             file->setParentFolderNode(folder);
             file->setProjectNode(this);
-            // Now find the correct place to insert file
-            if (folder->m_fileNodes.count() == 0 || sortNodesByPath(folder->m_fileNodes.last(), file)) {
-                // empty list or greater then last node
-                folder->m_fileNodes.append(file);
-            } else {
-                // Binary Search for insertion point
-                int l = 0;
-                int r = folder->m_fileNodes.count();
-                while (l != r) {
-                    int i = (l + r) / 2;
-                    if (sortNodesByPath(file, folder->m_fileNodes.at(i))) {
-                        r = i;
-                    } else {
-                        l = i + 1;
-                    }
-                }
-                folder->m_fileNodes.insert(l, file);
-            }
         }
+        insertSorted(&folder->m_fileNodes, files);
 
         if (emitSignals)
             foreach (NodesWatcher *watcher, m_watchers)
@@ -526,17 +535,8 @@ void ProjectNode::removeFileNodes(const QList<FileNode*> &files, FolderNode *fol
             foreach (NodesWatcher *watcher, m_watchers)
                 emit watcher->filesAboutToBeRemoved(folder, toRemove);
 
-        QList<FileNode*>::const_iterator toRemoveIter = toRemove.constBegin();
-        QList<FileNode*>::iterator filesIter = folder->m_fileNodes.begin();
-        for (; toRemoveIter != toRemove.constEnd(); ++toRemoveIter) {
-            while ((*filesIter)->path() != (*toRemoveIter)->path()) {
-                ++filesIter;
-                QTC_ASSERT(filesIter != folder->m_fileNodes.end(),
-                    qDebug("File to remove is not part of specified folder!"));
-            }
-            delete *filesIter;
-            filesIter = folder->m_fileNodes.erase(filesIter);
-        }
+        const int missing = removeAndDelete(&folder->m_fileNodes, toRemove);
+        QTC_ASSERT(!missing, qDebug("File to remove is not part of specified folder!"));
 
         if (emitSignals)
             foreach (NodesWatcher *watcher, m_watchers)
@@ -562,6 +562,41 @@ bool ProjectNode::sortFolderNodesByName(FolderNode *f1, FolderNode *f2)
     return f1->name() < f2->name();
 }
 
+/*!
+  Compares the paths of \a existingNodes with \a newPaths. Nodes whose path is not in
+  \a newPaths are appended to \a nodesToRemove, paths without a node to \a pathsToAdd,
+  both sorted by path.
+  */
+void ProjectNode::compareFilePaths(const QList<FileNode*> &existingNodes, const QStringList &newPaths,
+                                   QList<FileNode*> *nodesToRemove, QStringList *pathsToAdd)
+{
+    QList<FileNode*> oldNodes = existingNodes;
+    qSort(oldNodes.begin(), oldNodes.end(), sortNodesByPath);
+    QStringList paths = newPaths;
+    paths.removeDuplicates();
+    qSort(paths);
+
+    QList<FileNode*>::const_iterator oldIt = oldNodes.constBegin();
+    QStringList::const_iterator newIt = paths.constBegin();
+    while (oldIt != oldNodes.constEnd() && newIt != paths.constEnd()) {
+        const QString &oldPath = (*oldIt)->path();
+        if (oldPath < *newIt) {
+            nodesToRemove->append(*oldIt);
+            ++oldIt;
+        } else if (*newIt < oldPath) {
+            pathsToAdd->append(*newIt);
+            ++newIt;
+        } else {
+            ++oldIt;
+            ++newIt;
+        }
+    }
+    for (; oldIt != oldNodes.constEnd(); ++oldIt)
+        nodesToRemove->append(*oldIt);
+    for (; newIt != paths.constEnd(); ++newIt)
+        pathsToAdd->append(*newIt);
+}
+
 /*!
   \class SessionNode
 */
@@ -195,6 +195,11 @@ public:
     static bool sortNodesByPath(Node *n1, Node *n2);
     static bool sortFolderNodesByName(FolderNode *f1, FolderNode *f2);
 
+    // Compares the paths of existing nodes with a new list of paths in O(n log n),
+    // returning the nodes whose path is gone and the paths that have no node yet
+    static void compareFilePaths(const QList<FileNode*> &existingNodes, const QStringList &newPaths,
+                                 QList<FileNode*> *nodesToRemove, QStringList *pathsToAdd);
+
 protected:
     // this is just the in-memory representation, a subclass
     // will add the persistent stuff
@@ -41,12 +41,14 @@
 #include <projectexplorerconstants.h>
 
 #include <QtCore/QDir>
+#include <QtCore/QSet>
+#include <QtCore/QVector>
+#include <QtCore/QtAlgorithms>
 #include <QtGui/QKeyEvent>
 #include <QtGui/QHeaderView>
 #include <QtGui/QListView>
 #include <QtGui/QPainter>
 #include <QtCore/QAbstractItemModel>
-#include <QtGui/QSortFilterProxyModel>
 #include <QtGui/QApplication>
 #include <QtGui/QClipboard>
 #include <QtGui/QFont>
@@ -66,6 +68,19 @@ struct TaskItem
     ProjectExplorer::BuildParserInterface::PatternType type;
 };
 
+// Identical diagnostics, e.g. a warning in a header included by many
+// files, are only listed once.
+static inline bool operator==(const TaskItem &t1, const TaskItem &t2)
+{
+    return t1.line == t2.line && t1.type == t2.type
+        && t1.file == t2.file && t1.description == t2.description;
+}
+
+static inline uint qHash(const TaskItem &task)
+{
+    return qHash(task.file) ^ qHash(task.description) ^ uint(task.line);
+}
+
 class ProjectExplorer::Internal::TaskModel : public QAbstractItemModel
 {
 public:
@@ -77,8 +92,14 @@ public:
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
     void clear();
-    void addTask(ProjectExplorer::BuildParserInterface::PatternType type,
+    // Tasks are collected and only become rows on insertPendingTasks().
+    bool addTask(ProjectExplorer::BuildParserInterface::PatternType type,
                          const QString &description, const QString &file, int line);
+    bool insertPendingTasks();
+    int taskCount() const { return m_items.size() + m_pendingItems.size(); }
+    int taskCount(ProjectExplorer::BuildParserInterface::PatternType type) const;
+    ProjectExplorer::BuildParserInterface::PatternType taskType(int row) const
+        { return m_items.at(row).type; }
     int sizeOfFile();
     int sizeOfLineNumber();
     void setFileNotFound(const QModelIndex &index, bool b);
@@ -88,32 +109,65 @@ public:
     QIcon iconFor(ProjectExplorer::BuildParserInterface::PatternType type);
 private:
     QList<TaskItem> m_items;
+    QList<TaskItem> m_pendingItems;
+    QSet<TaskItem> m_knownItems;
+    int m_typeCount[3];
+    QFontMetrics m_fontMetrics;
+    QSet<QString> m_measuredFileNames;
+    int m_measuredItems;
     int m_maxSizeOfFileName;
+    int m_sizeOfLineNumber;
     QIcon m_errorIcon;
     QIcon m_warningIcon;
     QIcon m_unspecifiedIcon;
 };
 
-class ProjectExplorer::Internal::TaskFilterModel : public QSortFilterProxyModel
+// Tasks are only ever appended to the TaskModel, so instead of a
+// QSortFilterProxyModel a plain list of the accepted source rows is kept,
+// which grows with the source model and is only rebuilt when the filter
+// changes.
+class ProjectExplorer::Internal::TaskFilterModel : public QAbstractItemModel
 {
+    Q_OBJECT
+
 public:
     TaskFilterModel(TaskModel *sourceModel, QObject *parent = 0);
 
     TaskModel *taskModel() const;
 
     bool filterIncludesUnknowns() const { return m_includeUnknowns; }
-    void setFilterIncludesUnknowns(bool b) { m_includeUnknowns = b; invalidateFilter(); }
+    void setFilterIncludesUnknowns(bool b)
+        { setFilterIncludesType(ProjectExplorer::BuildParserInterface::Unknown, &m_includeUnknowns, b); }
 
     bool filterIncludesWarnings() const { return m_includeWarnings; }
-    void setFilterIncludesWarnings(bool b) { m_includeWarnings = b; invalidateFilter(); }
+    void setFilterIncludesWarnings(bool b)
+        { setFilterIncludesType(ProjectExplorer::BuildParserInterface::Warning, &m_includeWarnings, b); }
 
     bool filterIncludesErrors() const { return m_includeErrors; }
-    void setFilterIncludesErrors(bool b) { m_includeErrors = b; invalidateFilter(); }
+    void setFilterIncludesErrors(bool b)
+        { setFilterIncludesType(ProjectExplorer::BuildParserInterface::Error, &m_includeErrors, b); }
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
+    QModelIndex parent(const QModelIndex &child) const;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
 
-protected:
-    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const;
+    QModelIndex mapToSource(const QModelIndex &index) const;
+
+private slots:
+    void invalidateFilter();
+    void handleRowsInserted(const QModelIndex &parent, int first, int last);
+    void handleDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
 
 private:
+    void setFilterIncludesType(ProjectExplorer::BuildParserInterface::PatternType type,
+                               bool *include, bool b);
+    bool filterAcceptsTask(int sourceRow) const;
+
+    TaskModel *m_sourceModel;
+    QVector<int> m_mapping;
+
     // These correspond to ProjectExplorer::BuildParserInterface::PatternType.
     bool m_includeUnknowns;
     bool m_includeWarnings;
@@ -156,15 +210,19 @@ void TaskView::keyPressEvent(QKeyEvent *e)
 /////
 
 TaskModel::TaskModel()
+    : m_fontMetrics(QFont())
 {
+    m_typeCount[0] = m_typeCount[1] = m_typeCount[2] = 0;
+    m_measuredItems = 0;
     m_maxSizeOfFileName = 0;
+    m_sizeOfLineNumber = m_fontMetrics.width("8888");
     m_errorIcon = QIcon(":/projectexplorer/images/compile_error.png");
     m_warningIcon = QIcon(":/projectexplorer/images/compile_warning.png");
     m_unspecifiedIcon = QIcon(":/projectexplorer/images/compile_unspecified.png");
 
 }
 
-void TaskModel::addTask(ProjectExplorer::BuildParserInterface::PatternType type, const QString &description, const QString &file, int line)
+bool TaskModel::addTask(ProjectExplorer::BuildParserInterface::PatternType type, const QString &description, const QString &file, int line)
 {
     TaskItem task;
     task.description = description;
@@ -173,30 +231,45 @@ void TaskModel::addTask(ProjectExplorer::BuildParserInterface::PatternType type,
     task.type = type;
     task.fileNotFound = false;
 
-    beginInsertRows(QModelIndex(), m_items.size(), m_items.size());
-    m_items.append(task);
+    if (m_knownItems.contains(task))
+        return false;
+    m_knownItems.insert(task);
+    m_pendingItems.append(task);
+    if (uint(type) < 3)
+        ++m_typeCount[type];
+    return true;
+}
+
+bool TaskModel::insertPendingTasks()
+{
+    if (m_pendingItems.isEmpty())
+        return false;
+    beginInsertRows(QModelIndex(), m_items.size(), m_items.size() + m_pendingItems.size() - 1);
+    m_items += m_pendingItems;
+    m_pendingItems.clear();
     endInsertRows();
+    return true;
+}
 
-    QFont font;
-    QFontMetrics fm(font);
-    QString filename = task.file;
-    int pos = filename.lastIndexOf("/");
-    if (pos != -1)
-        filename = file.mid(pos +1);
-    m_maxSizeOfFileName = qMax(m_maxSizeOfFileName, fm.width(filename));
+int TaskModel::taskCount(ProjectExplorer::BuildParserInterface::PatternType type) const
+{
+    return uint(type) < 3 ? m_typeCount[type] : 0;
 }
 
 void TaskModel::clear()
 {
+    m_pendingItems.clear();
+    m_knownItems.clear();
+    m_typeCount[0] = m_typeCount[1] = m_typeCount[2] = 0;
+    m_measuredFileNames.clear();
+    m_measuredItems = 0;
+    m_maxSizeOfFileName = 0;
     if (m_items.isEmpty())
         return;
-    beginRemoveRows(QModelIndex(), 0, m_items.size() -1);
     m_items.clear();
-    endRemoveRows();
-    m_maxSizeOfFileName = 0;
+    reset();
 }
 
-
 QModelIndex TaskModel::index(int row, int column, const QModelIndex &parent) const
 {
     if (parent.isValid())
@@ -250,14 +323,24 @@ QIcon TaskModel::iconFor(ProjectExplorer::BuildParserInterface::PatternType type
 
 int TaskModel::sizeOfFile()
 {
+    // File names are measured when the view needs the width, and every
+    // name only once.
+    for (; m_measuredItems < m_items.size(); ++m_measuredItems) {
+        QString filename = m_items.at(m_measuredItems).file;
+        const int pos = filename.lastIndexOf(QLatin1Char('/'));
+        if (pos != -1)
+            filename = filename.mid(pos + 1);
+        if (m_measuredFileNames.contains(filename))
+            continue;
+        m_measuredFileNames.insert(filename);
+        m_maxSizeOfFileName = qMax(m_maxSizeOfFileName, m_fontMetrics.width(filename));
+    }
     return m_maxSizeOfFileName;
 }
 
 int TaskModel::sizeOfLineNumber()
 {
-    QFont font;
-    QFontMetrics fm(font);
-    return fm.width("8888");
+    return m_sizeOfLineNumber;
 }
 
 void TaskModel::setFileNotFound(const QModelIndex &idx, bool b)
@@ -273,23 +356,109 @@ void TaskModel::setFileNotFound(const QModelIndex &idx, bool b)
 /////
 
 TaskFilterModel::TaskFilterModel(TaskModel *sourceModel, QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : QAbstractItemModel(parent), m_sourceModel(sourceModel)
 {
-    setSourceModel(sourceModel);
-    setDynamicSortFilter(true);
     m_includeUnknowns = m_includeWarnings = m_includeErrors = true;
+    connect(m_sourceModel, SIGNAL(rowsInserted(QModelIndex,int,int)),
+            this, SLOT(handleRowsInserted(QModelIndex,int,int)));
+    connect(m_sourceModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
+            this, SLOT(handleDataChanged(QModelIndex,QModelIndex)));
+    connect(m_sourceModel, SIGNAL(modelReset()), this, SLOT(invalidateFilter()));
+    invalidateFilter();
 }
 
 TaskModel *TaskFilterModel::taskModel() const
 {
-    return static_cast<TaskModel*>(sourceModel());
+    return m_sourceModel;
 }
 
-bool TaskFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+QModelIndex TaskFilterModel::index(int row, int column, const QModelIndex &parent) const
 {
-    QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
-    ProjectExplorer::BuildParserInterface::PatternType type = ProjectExplorer::BuildParserInterface::PatternType(index.data(TaskModel::Type).toInt());
-    switch (type) {
+    if (parent.isValid() || row < 0 || row >= m_mapping.size())
+        return QModelIndex();
+    return createIndex(row, column, 0);
+}
+
+QModelIndex TaskFilterModel::parent(const QModelIndex &child) const
+{
+    Q_UNUSED(child)
+    return QModelIndex();
+}
+
+int TaskFilterModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_mapping.size();
+}
+
+int TaskFilterModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 1;
+}
+
+QVariant TaskFilterModel::data(const QModelIndex &index, int role) const
+{
+    return m_sourceModel->data(mapToSource(index), role);
+}
+
+QModelIndex TaskFilterModel::mapToSource(const QModelIndex &index) const
+{
+    if (!index.isValid() || index.row() >= m_mapping.size())
+        return QModelIndex();
+    return m_sourceModel->index(m_mapping.at(index.row()), index.column());
+}
+
+void TaskFilterModel::invalidateFilter()
+{
+    const int count = m_sourceModel->rowCount();
+    m_mapping.clear();
+    m_mapping.reserve(count);
+    for (int row = 0; row < count; ++row)
+        if (filterAcceptsTask(row))
+            m_mapping.append(row);
+    reset();
+}
+
+void TaskFilterModel::handleRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+    QVector<int> accepted;
+    for (int row = first; row <= last; ++row)
+        if (filterAcceptsTask(row))
+            accepted.append(row);
+    if (accepted.isEmpty())
+        return;
+    beginInsertRows(QModelIndex(), m_mapping.size(), m_mapping.size() + accepted.size() - 1);
+    m_mapping += accepted;
+    endInsertRows();
+}
+
+void TaskFilterModel::handleDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    const QVector<int>::const_iterator begin =
+        qLowerBound(m_mapping.constBegin(), m_mapping.constEnd(), topLeft.row());
+    const QVector<int>::const_iterator end =
+        qUpperBound(begin, m_mapping.constEnd(), bottomRight.row());
+    if (begin == end)
+        return;
+    emit dataChanged(index(begin - m_mapping.constBegin(), 0),
+                     index(end - m_mapping.constBegin() - 1, 0));
+}
+
+void TaskFilterModel::setFilterIncludesType(ProjectExplorer::BuildParserInterface::PatternType type,
+                                            bool *include, bool b)
+{
+    if (*include == b)
+        return;
+    *include = b;
+    // No need to go through all tasks if none of them is affected.
+    if (m_sourceModel->taskCount(type))
+        invalidateFilter();
+}
+
+bool TaskFilterModel::filterAcceptsTask(int sourceRow) const
+{
+    switch (m_sourceModel->taskType(sourceRow)) {
     case ProjectExplorer::BuildParserInterface::Unknown:
         return m_includeUnknowns;
 
@@ -332,6 +501,7 @@ TaskWindow::TaskWindow()
     m_listview = new TaskView;
 
     m_listview->setModel(m_filter);
+    m_listview->setLayoutMode(QListView::Batched);
     m_listview->setFrameStyle(QFrame::NoFrame);
     m_listview->setWindowTitle(tr("Build Issues"));
     m_listview->setSelectionMode(QAbstractItemView::SingleSelection);
@@ -363,7 +533,10 @@ TaskWindow::TaskWindow()
                                                 tr("Show Warnings"), m_model,
                                                 this, SLOT(setShowWarnings(bool)));
 
-    m_errorCount = 0;
+    m_insertTimer.setSingleShot(true);
+    m_insertTimer.setInterval(50);
+    connect(&m_insertTimer, SIGNAL(timeout()), this, SLOT(insertPendingTasks()));
+
     m_currentTask = -1;
 }
 
@@ -388,10 +561,11 @@ QWidget *TaskWindow::outputWidget(QWidget *)
 
 void TaskWindow::clearContents()
 {
-    m_errorCount = 0;
+    m_insertTimer.stop();
     m_currentTask = -1;
     m_model->clear();
     m_copyAction->setEnabled(false);
+    updateFilterButton();
     emit tasksChanged();
     navigateStateChanged();
 }
@@ -403,15 +577,32 @@ void TaskWindow::visibilityChanged(bool /* b */)
 void TaskWindow::addItem(ProjectExplorer::BuildParserInterface::PatternType type,
                          const QString &description, const QString &file, int line)
 {
-    m_model->addTask(type, description, file, line);
-    if (type == ProjectExplorer::BuildParserInterface::Error)
-        ++m_errorCount;
+    if (m_model->addTask(type, description, file, line) && !m_insertTimer.isActive())
+        m_insertTimer.start();
+}
+
+// Tasks arriving in a burst are shown together, so the views are
+// updated once per batch instead of once per task.
+void TaskWindow::insertPendingTasks()
+{
+    const bool hadTasks = m_model->rowCount() > 0;
+    if (!m_model->insertPendingTasks())
+        return;
     m_copyAction->setEnabled(true);
+    updateFilterButton();
     emit tasksChanged();
-    if (m_model->rowCount() == 1)
+    if (!hadTasks)
         navigateStateChanged();
 }
 
+void TaskWindow::updateFilterButton()
+{
+    const int count = m_model->taskCount(ProjectExplorer::BuildParserInterface::Warning)
+        + m_model->taskCount(ProjectExplorer::BuildParserInterface::Unknown);
+    m_filterWarningsButton->setToolTip(count ? tr("Show Warnings (%1)").arg(count)
+                                             : tr("Show Warnings"));
+}
+
 void TaskWindow::showTaskInFile(const QModelIndex &index)
 {
     if (!index.isValid())
@@ -427,7 +618,7 @@ void TaskWindow::showTaskInFile(const QModelIndex &index)
         Core::EditorManager::instance()->ensureEditorManagerVisible();
     }
     else
-        m_model->setFileNotFound(index, true);
+        m_model->setFileNotFound(m_filter->mapToSource(index), true);
     m_listview->selectionModel()->setCurrentIndex(index, QItemSelectionModel::Select);
     m_listview->selectionModel()->select(index, QItemSelectionModel::ClearAndSelect);
 }
@@ -459,12 +650,12 @@ void TaskWindow::setShowWarnings(bool show)
 
 int TaskWindow::numberOfTasks() const
 {
-    return m_model->rowCount(QModelIndex());
+    return m_model->taskCount();
 }
 
 int TaskWindow::numberOfErrors() const
 {
-    return m_errorCount;
+    return m_model->taskCount(ProjectExplorer::BuildParserInterface::Error);
 }
 
 int TaskWindow::priorityInStatusBar() const
@@ -727,3 +918,4 @@ QWidget *TaskWindowContext::widget()
     return m_taskList;
 }
 
+#include "taskwindow.moc"
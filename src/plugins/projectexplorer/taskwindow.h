@@ -35,6 +35,7 @@
 #include <coreplugin/ioutputpane.h>
 #include <coreplugin/icontext.h>
 
+#include <QtCore/QTimer>
 #include <QtGui/QTreeWidget>
 #include <QtGui/QStyledItemDelegate>
 #include <QtGui/QListView>
@@ -87,11 +88,12 @@ private slots:
     void showTaskInFile(const QModelIndex &index);
     void copy();
     void setShowWarnings(bool);
+    void insertPendingTasks();
 
 private:
     int sizeHintForColumn(int column) const;
+    void updateFilterButton();
 
-    int m_errorCount;
     int m_currentTask;
 
     TaskModel *m_model;
@@ -100,6 +102,7 @@ private:
     TaskWindowContext *m_taskWindowContext;
     QAction *m_copyAction;
     QToolButton *m_filterWarningsButton;
+    QTimer m_insertTimer;
 };
 
 class TaskView : public QListView
@@ -45,7 +45,7 @@ using namespace Qt4ProjectManager;
 using namespace Qt4ProjectManager::Internal;
 
 MakeStep::MakeStep(Qt4Project * project)
-    : AbstractMakeStep(project)
+    : AbstractMakeStep(project), m_scriptTemplate(false)
 {
 
 }
@@ -63,6 +63,14 @@ bool MakeStep::init(const QString &name)
     setEnvironment(name, environment);
 
     Qt4Project *qt4project = qobject_cast<Qt4Project *>(project());
+    if (!qt4project->isInitialEvaluationDone()) {
+        emit addToOutputWindow(tr("<font color=\"#ff0000\">The project is still being parsed, "\
+                                  "try again once it is loaded</font>"));
+        return false;
+    }
+    // run() happens in a worker thread and must not look at the project tree
+    m_scriptTemplate = qt4project->rootProjectNode()->projectType() == ScriptTemplate;
+
     QString workingDirectory = qt4project->buildDirectory(bc);
     setWorkingDirectory(name, workingDirectory);
 
@@ -123,7 +131,7 @@ bool MakeStep::init(const QString &name)
 
 void MakeStep::run(QFutureInterface<bool> & fi)
 {
-    if (qobject_cast<Qt4Project *>(project())->rootProjectNode()->projectType() == ScriptTemplate) {
+    if (m_scriptTemplate) {
         fi.reportResult(true);
         return;
     }
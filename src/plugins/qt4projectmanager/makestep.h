@@ -77,6 +77,7 @@ signals:
     void changed();
 private:
     QString m_buildConfiguration;
+    bool m_scriptTemplate;
 };
 
 class MakeStepConfigWidget : public ProjectExplorer::BuildStepConfigWidget
@@ -42,7 +42,7 @@ ProFileReader::ProFileReader() : ProFileEvaluator(&m_option)
 ProFileReader::~ProFileReader()
 {
     foreach (ProFile *pf, m_proFiles)
-        delete pf;
+        pf->deref();
 }
 
 void ProFileReader::setQtVersion(QtVersion *qtVersion) {
@@ -52,16 +52,17 @@ void ProFileReader::setQtVersion(QtVersion *qtVersion) {
         m_option.properties.clear();
 }
 
+// Readers sharing a cache must not modify the parsed files
+void ProFileReader::setCache(ProFileCache *cache)
+{
+    m_option.cache = cache;
+}
+
 bool ProFileReader::readProFile(const QString &fileName)
 {
-    //disable caching -> list of include files is not updated otherwise
-    ProFile *pro = new ProFile(fileName);
-    if (!queryProFile(pro)) {
-        delete pro;
+    ProFile *pro = parsedProFile(fileName);
+    if (!pro)
         return false;
-    }
-    m_includeFiles.insert(fileName, pro);
-    m_proFiles.append(pro);
     return accept(pro);
 }
 
@@ -48,6 +48,7 @@ public:
     ~ProFileReader();
 
     void setQtVersion(QtVersion *qtVersion);
+    void setCache(ProFileCache *cache);
     bool readProFile(const QString &fileName);
     QList<ProFile*> includeFiles() const;
 
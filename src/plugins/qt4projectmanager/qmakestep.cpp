@@ -48,7 +48,7 @@ using namespace Qt4ProjectManager::Internal;
 using namespace ProjectExplorer;
 
 QMakeStep::QMakeStep(Qt4Project *project)
-    : AbstractProcessStep(project), m_pro(project), m_forced(false)
+    : AbstractProcessStep(project), m_pro(project), m_forced(false), m_scriptTemplate(false)
 {
 }
 
@@ -99,6 +99,14 @@ bool QMakeStep::init(const QString &name)
     const QtVersion *qtVersion = m_pro->qtVersion(bc);
 
 
+    if (!m_pro->isInitialEvaluationDone()) {
+        emit addToOutputWindow(tr("\n<font color=\"#ff0000\"><b>The project is still being parsed, "
+                                  "try again once it is loaded</b></font>\n"));
+        return false;
+    }
+    // run() happens in a worker thread and must not look at the project tree
+    m_scriptTemplate = m_pro->rootProjectNode()->projectType() == ScriptTemplate;
+
     if (!qtVersion->isValid()) {
 #if defined(Q_WS_MAC)
         emit addToOutputWindow(tr("\n<font color=\"#ff0000\"><b>No valid Qt version set. Set one in Preferences </b></font>\n"));
@@ -137,7 +145,7 @@ bool QMakeStep::init(const QString &name)
 
 void QMakeStep::run(QFutureInterface<bool> &fi)
 {
-    if (qobject_cast<Qt4Project *>(project())->rootProjectNode()->projectType() == ScriptTemplate) {
+    if (m_scriptTemplate) {
         fi.reportResult(true);
         return;
     }
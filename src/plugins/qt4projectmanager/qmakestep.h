@@ -92,6 +92,7 @@ private:
     QString m_buildConfiguration;
     QStringList m_lastEnv;
     bool m_forced;
+    bool m_scriptTemplate;
 };
 
 
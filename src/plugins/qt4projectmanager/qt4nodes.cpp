@@ -29,6 +29,7 @@
 
 #include "proeditormodel.h"
 
+#include "profilecache.h"
 #include "profilereader.h"
 #include "prowriter.h"
 #include "qt4nodes.h"
@@ -60,6 +61,7 @@
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QTimer>
+#include <QtCore/QtConcurrentRun>
 
 #include <QtGui/QPainter>
 #include <QtGui/QMainWindow>
@@ -109,7 +111,7 @@ Qt4PriFileNode::Qt4PriFileNode(Qt4Project *project, Qt4ProFileNode* qt4ProFileNo
     setIcon(dirIcon);
     m_fileWatcher->addFile(filePath);
     connect(m_fileWatcher, SIGNAL(fileChanged(QString)),
-            this, SLOT(scheduleUpdate()));
+            this, SLOT(projectFileChanged(QString)));
 }
 
 void Qt4PriFileNode::scheduleUpdate()
@@ -117,6 +119,13 @@ void Qt4PriFileNode::scheduleUpdate()
     m_qt4ProFileNode->scheduleUpdate();
 }
 
+void Qt4PriFileNode::projectFileChanged(const QString &fileName)
+{
+    // Don't rely on the modification time, it might not have changed within its resolution
+    m_project->qt4ProjectManager()->proFileCache()->discardFile(QDir::cleanPath(fileName));
+    m_qt4ProFileNode->scheduleUpdate();
+}
+
 namespace Qt4ProjectManager {
 namespace Internal {
     struct InternalNode
@@ -295,34 +304,12 @@ namespace Internal {
             }
 
             QList<FileNode*> filesToRemove;
-            QList<FileNode*> filesToAdd;
-
-            qSort(files);
-            qSort(existingFileNodes.begin(), existingFileNodes.end(), ProjectNode::sortNodesByPath);
+            QStringList pathsToAdd;
+            ProjectNode::compareFilePaths(existingFileNodes, files, &filesToRemove, &pathsToAdd);
 
-            QList<FileNode*>::const_iterator existingNodeIter = existingFileNodes.constBegin();
-            QList<QString>::const_iterator newPathIter = files.constBegin();
-            while (existingNodeIter != existingFileNodes.constEnd()
-                   && newPathIter != files.constEnd()) {
-                if ((*existingNodeIter)->path() < *newPathIter) {
-                    filesToRemove << *existingNodeIter;
-                    ++existingNodeIter;
-                } else if ((*existingNodeIter)->path() > *newPathIter) {
-                    filesToAdd << new FileNode(*newPathIter, type, false);
-                    ++newPathIter;
-                } else { // *existingNodeIter->path() == *newPathIter
-                    ++existingNodeIter;
-                    ++newPathIter;
-                }
-            }
-            while (existingNodeIter != existingFileNodes.constEnd()) {
-                filesToRemove << *existingNodeIter;
-                ++existingNodeIter;
-            }
-            while (newPathIter != files.constEnd()) {
-                filesToAdd << new FileNode(*newPathIter, type, false);
-                ++newPathIter;
-            }
+            QList<FileNode*> filesToAdd;
+            foreach (const QString &path, pathsToAdd)
+                filesToAdd << new FileNode(path, type, false);
 
             if (!filesToRemove.isEmpty())
                 projectNode->removeFileNodes(filesToRemove, folder);
@@ -758,7 +745,11 @@ Qt4ProFileNode::Qt4ProFileNode(Qt4Project *project,
                                QObject *parent)
         : Qt4PriFileNode(project, this, filePath),
           // own stuff
-          m_projectType(InvalidProject)
+          m_projectType(InvalidProject),
+          m_readerInFlight(0),
+          m_evaluatedReader(0),
+          m_evaluationSucceeded(false),
+          m_updatePending(false)
 {
     if (parent)
         setParent(parent);
@@ -770,6 +761,8 @@ Qt4ProFileNode::Qt4ProFileNode(Qt4Project *project,
             this, SLOT(update()));
     connect(&m_updateTimer, SIGNAL(timeout()),
             this, SLOT(update()));
+    connect(&m_evaluateWatcher, SIGNAL(finished()),
+            this, SLOT(evaluationFinished()));
 
     connect(ProjectExplorer::ProjectExplorerPlugin::instance()->buildManager(), SIGNAL(buildStateChanged(ProjectExplorer::Project*)),
             this, SLOT(buildStateChanged(ProjectExplorer::Project*)));
@@ -785,6 +778,12 @@ Qt4ProFileNode::~Qt4ProFileNode()
         modelManager->removeEditorSupport(it.value());
         delete it.value();
     }
+    if (m_readerInFlight) {
+        m_evaluateWatcher.waitForFinished();
+        delete m_readerInFlight;
+        m_project->decrementPendingEvaluations();
+    }
+    delete m_evaluatedReader;
 }
 
 void Qt4ProFileNode::buildStateChanged(ProjectExplorer::Project *project)
@@ -815,10 +814,56 @@ void Qt4ProFileNode::scheduleUpdate()
     m_updateTimer.start();
 }
 
+static bool evaluateProFile(ProFileReader *reader, const QString &fileName)
+{
+    return reader->readProFile(fileName);
+}
+
 void Qt4ProFileNode::update()
 {
-    ProFileReader *reader = createProFileReader();
-    if (!reader->readProFile(m_projectFilePath)) {
+    // Changes coming in while the file is evaluated are picked up by
+    // evaluating it once more when the running evaluation is done.
+    if (m_readerInFlight) {
+        m_updatePending = true;
+        return;
+    }
+    m_updatePending = false;
+    delete m_evaluatedReader;
+    m_evaluatedReader = 0;
+
+    m_readerInFlight = createProFileReader();
+    m_readerInFlight->setCache(m_project->qt4ProjectManager()->proFileCache());
+    m_project->incrementPendingEvaluations();
+    m_evaluateWatcher.setFuture(QtConcurrent::run(evaluateProFile, m_readerInFlight,
+                                                  m_projectFilePath));
+}
+
+void Qt4ProFileNode::evaluationFinished()
+{
+    ProFileReader *reader = m_readerInFlight;
+    m_readerInFlight = 0;
+    if (m_updatePending) {
+        delete reader;
+        update();
+    } else {
+        m_evaluatedReader = reader;
+        m_evaluationSucceeded = m_evaluateWatcher.result();
+        if (m_project->showPartialProjectTree())
+            applyEvaluation();
+        else
+            m_project->queueEvaluatedProFile(this);
+    }
+    m_project->decrementPendingEvaluations();
+}
+
+void Qt4ProFileNode::applyEvaluation()
+{
+    ProFileReader *reader = m_evaluatedReader;
+    if (!reader)
+        return;
+    m_evaluatedReader = 0;
+
+    if (!m_evaluationSucceeded) {
         m_project->proFileParseError(tr("Error while parsing file %1. Giving up.").arg(m_projectFilePath));
         delete reader;
         invalidate();
@@ -33,6 +33,7 @@
 #include <projectexplorer/projectnodes.h>
 #include <projectexplorer/project.h>
 
+#include <QtCore/QFutureWatcher>
 #include <QtCore/QHash>
 #include <QtCore/QStringList>
 #include <QtCore/QTimer>
@@ -154,6 +155,7 @@ protected:
 
 private slots:
     void scheduleUpdate();
+    void projectFileChanged(const QString &fileName);
 
 private:
     void save(ProFile *includeFile);
@@ -196,11 +198,17 @@ public:
 
     void updateCodeModelSupportFromBuild(const QStringList &files);
     void updateCodeModelSupportFromEditor(const QString &uiFileName, Designer::FormWindowEditor *fw);
+    // Applies the result of the last evaluation of the .pro file to the
+    // node tree, called by the project once evaluations are batched.
+    void applyEvaluation();
+
 public slots:
     void scheduleUpdate();
+    // Evaluates the .pro file in a worker thread.
     void update();
 private slots:
     void buildStateChanged(ProjectExplorer::Project*);
+    void evaluationFinished();
 
 private:
     void createUiCodeModelSupport();
@@ -219,6 +227,12 @@ private:
     QTimer m_updateTimer;
 
     QMap<QString, QDateTime> m_uitimestamps;
+
+    QFutureWatcher<bool> m_evaluateWatcher;
+    ProFileReader *m_readerInFlight;
+    ProFileReader *m_evaluatedReader;
+    bool m_evaluationSucceeded;
+    bool m_updatePending;
     friend class Qt4NodeHierarchy;
 };
 
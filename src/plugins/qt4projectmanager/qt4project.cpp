@@ -59,6 +59,7 @@
 
 #include <QtCore/QDebug>
 #include <QtCore/QDir>
+#include <QtCore/QSettings>
 #include <QtGui/QFileDialog>
 #include <QtGui/QInputDialog>
 
@@ -310,17 +311,30 @@ Qt4Project::Qt4Project(Qt4Manager *manager, const QString& fileName) :
     m_fileInfo(new Qt4ProjectFile(this, fileName, this)),
     m_isApplication(true),
     m_projectFiles(new Qt4ProjectFiles),
-    m_toolChain(0)
+    m_toolChain(0),
+    m_pendingEvaluations(0),
+    m_initialEvaluationDone(false),
+    m_addDefaultRunConfigurations(false)
 {
     m_manager->registerProject(this);
 
     m_updateCodeModelTimer.setSingleShot(true);
     m_updateCodeModelTimer.setInterval(20);
     connect(&m_updateCodeModelTimer, SIGNAL(timeout()), this, SLOT(updateCodeModel()));
+
+    m_applyEvaluationsTimer.setSingleShot(true);
+    m_applyEvaluationsTimer.setInterval(0);
+    connect(&m_applyEvaluationsTimer, SIGNAL(timeout()), this, SLOT(applyEvaluatedProFiles()));
+
+    m_showPartialProjectTree = Core::ICore::instance()->settings()->value(
+            QLatin1String("Qt4ProjectManager/ShowPartialProjectTree"), false).toBool();
 }
 
 Qt4Project::~Qt4Project()
 {
+    // The nodes wait for their running evaluations and report back.
+    delete m_rootProjectNode;
+    m_rootProjectNode = 0;
     m_manager->unregisterProject(this);
     delete m_projectFiles;
     delete m_toolChain;
@@ -347,6 +361,9 @@ void Qt4Project::qtVersionsChanged()
 
 void Qt4Project::updateFileList()
 {
+    // Done once all evaluations are finished.
+    if (isEvaluating())
+        return;
     Qt4ProjectFiles newFiles;
     ProjectFilesVisitor::findProjectFiles(m_rootProjectNode, &newFiles);
     if (newFiles != *m_projectFiles) {
@@ -384,31 +401,48 @@ bool Qt4Project::restoreSettingsImpl(PersistentSettingsReader &settingsReader)
 
     // restored old runconfigurations
     if (runConfigurations().isEmpty()) {
-        // Oha no runConfigurations, add some
+        // Oha no runConfigurations. The application sub projects are only
+        // known once the .pro files are evaluated, until then a custom
+        // executable run configuration stands in.
+        QSharedPointer<RunConfiguration> rc(new ProjectExplorer::CustomExecutableRunConfiguration(this));
+        addRunConfiguration(rc);
+        setActiveRunConfiguration(rc);
+        m_addDefaultRunConfigurations = true;
+    }
+
+    // Now connect
+    QtVersionManager *vm = QtVersionManager::instance();
+    connect(vm, SIGNAL(defaultQtVersionChanged()),
+            this, SLOT(defaultQtVersionChanged()));
+    connect(vm, SIGNAL(qtVersionsChanged()),
+            this, SLOT(qtVersionsChanged()));
+    return true;
+}
+
+void Qt4Project::initialEvaluationFinished()
+{
+    if (m_addDefaultRunConfigurations) {
+        m_addDefaultRunConfigurations = false;
         QList<Qt4ProFileNode *> list;
         collectApplicationProFiles(list, m_rootProjectNode);
 
         if (!list.isEmpty()) {
+            QSharedPointer<RunConfiguration> placeholder = activeRunConfiguration();
+            QSharedPointer<RunConfiguration> first;
             foreach (Qt4ProFileNode *node, list) {
                 QSharedPointer<RunConfiguration> rc(new Qt4RunConfiguration(this, node->path()));
                 addRunConfiguration(rc);
+                if (!first)
+                    first = rc;
             }
-            setActiveRunConfiguration(runConfigurations().first());
+            setActiveRunConfiguration(first);
+            removeRunConfiguration(placeholder);
         } else {
-            QSharedPointer<RunConfiguration> rc(new ProjectExplorer::CustomExecutableRunConfiguration(this));
-            addRunConfiguration(rc);
-            setActiveRunConfiguration(rc);
             m_isApplication = false;
         }
     }
 
-    // Now connect
-    QtVersionManager *vm = QtVersionManager::instance();
-    connect(vm, SIGNAL(defaultQtVersionChanged()),
-            this, SLOT(defaultQtVersionChanged()));
-    connect(vm, SIGNAL(qtVersionsChanged()),
-            this, SLOT(qtVersionsChanged()));
-
+    // Changes of the project structure are tracked from now on
 
     connect(m_nodesWatcher, SIGNAL(foldersAboutToBeAdded(FolderNode *, const QList<FolderNode*> &)),
             this, SLOT(foldersAboutToBeAdded(FolderNode *, const QList<FolderNode*> &)));
@@ -425,7 +459,6 @@ bool Qt4Project::restoreSettingsImpl(PersistentSettingsReader &settingsReader)
 
     connect(m_nodesWatcher, SIGNAL(proFileUpdated(Qt4ProjectManager::Internal::Qt4ProFileNode *)),
             this, SLOT(proFileUpdated(Qt4ProjectManager::Internal::Qt4ProFileNode *)));
-    return true;
 }
 
 void Qt4Project::saveSettingsImpl(ProjectExplorer::PersistentSettingsWriter &writer)
@@ -491,7 +524,10 @@ namespace {
 
 void Qt4Project::scheduleUpdateCodeModel(Qt4ProjectManager::Internal::Qt4ProFileNode *pro)
 {
-    m_updateCodeModelTimer.start();
+    // While .pro files are evaluated the code model is updated only once,
+    // after the last one.
+    if (!isEvaluating())
+        m_updateCodeModelTimer.start();
     m_proFilesForCodeModelUpdate.append(pro);
 }
 
@@ -873,6 +909,66 @@ Qt4ProFileNode *Qt4Project::rootProjectNode() const
     return m_rootProjectNode;
 }
 
+void Qt4Project::incrementPendingEvaluations()
+{
+    ++m_pendingEvaluations;
+}
+
+void Qt4Project::decrementPendingEvaluations()
+{
+    QTC_ASSERT(m_pendingEvaluations > 0, return);
+    if (--m_pendingEvaluations == 0)
+        m_applyEvaluationsTimer.start();
+}
+
+bool Qt4Project::isEvaluating() const
+{
+    return m_pendingEvaluations > 0;
+}
+
+bool Qt4Project::isInitialEvaluationDone() const
+{
+    return m_initialEvaluationDone;
+}
+
+// Unless partial trees are shown, evaluated .pro files are applied to the
+// tree together once no evaluation is running anymore. Sub projects found
+// in them start the next round of evaluations.
+bool Qt4Project::showPartialProjectTree() const
+{
+    return m_showPartialProjectTree;
+}
+
+void Qt4Project::queueEvaluatedProFile(Qt4ProFileNode *node)
+{
+    m_evaluatedProFiles.append(node);
+}
+
+void Qt4Project::applyEvaluatedProFiles()
+{
+    if (isEvaluating())
+        return;
+    const QList<QPointer<Qt4ProFileNode> > nodes = m_evaluatedProFiles;
+    m_evaluatedProFiles.clear();
+    foreach (const QPointer<Qt4ProFileNode> &node, nodes)
+        if (node)
+            node->applyEvaluation();
+    if (!isEvaluating())
+        evaluationsFinished();
+}
+
+void Qt4Project::evaluationsFinished()
+{
+    updateFileList();
+    if (!m_proFilesForCodeModelUpdate.isEmpty())
+        m_updateCodeModelTimer.start();
+    if (!m_initialEvaluationDone) {
+        m_initialEvaluationDone = true;
+        initialEvaluationFinished();
+    }
+    emit evaluationFinished();
+}
+
 QString Qt4Project::buildDirectory(BuildConfiguration *configuration) const
 {
     QString workingDirectory;
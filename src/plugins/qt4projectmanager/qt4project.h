@@ -173,6 +173,17 @@ public:
 
     Internal::Qt4ProFileNode *rootProjectNode() const;
 
+    // The .pro files are evaluated in worker threads, the project keeps
+    // track of the running evaluations for its Qt4ProFileNodes.
+    void incrementPendingEvaluations();
+    void decrementPendingEvaluations();
+    bool isEvaluating() const;
+    // The tree reflects the .pro files once this is true,
+    // evaluationFinished() is emitted after every round.
+    bool isInitialEvaluationDone() const;
+    bool showPartialProjectTree() const;
+    void queueEvaluatedProFile(Internal::Qt4ProFileNode *node);
+
     virtual QStringList files(FilesMode fileMode) const;
 
     //building environment
@@ -239,6 +250,7 @@ public:
 signals:
     void targetInformationChanged();
     void qtVersionChanged(ProjectExplorer::BuildConfiguration *);
+    void evaluationFinished();
 
 public slots:
     void update();
@@ -247,6 +259,7 @@ public slots:
 
 private slots:
     void updateCodeModel();
+    void applyEvaluatedProFiles();
     void defaultQtVersionChanged();
     void qtVersionsChanged();
     void updateFileList();
@@ -268,6 +281,9 @@ private:
     static void findProFile(const QString& fileName, Internal::Qt4ProFileNode *root, QList<Internal::Qt4ProFileNode *> &list);
     static bool hasSubNode(Internal::Qt4PriFileNode *root, const QString &path);
 
+    void evaluationsFinished();
+    void initialEvaluationFinished();
+
     // called by Qt4ProjectConfigWidget
     // TODO remove once there's a setBuildDirectory call
     void emitBuildDirectoryChanged();
@@ -298,6 +314,13 @@ private:
     QTimer m_updateCodeModelTimer;
     QList<Qt4ProjectManager::Internal::Qt4ProFileNode *> m_proFilesForCodeModelUpdate;
 
+    int m_pendingEvaluations;
+    QList<QPointer<Internal::Qt4ProFileNode> > m_evaluatedProFiles;
+    QTimer m_applyEvaluationsTimer;
+    bool m_showPartialProjectTree;
+    bool m_initialEvaluationDone;
+    bool m_addDefaultRunConfigurations;
+
     QMap<QString, Internal::CodeModelInfo> m_codeModelInfo;
     mutable ProjectExplorer::ToolChain *m_toolChain;
 
@@ -34,7 +34,9 @@
 #include "qt4nodes.h"
 #include "qt4project.h"
 #include "profilereader.h"
+#include "profilecache.h"
 #include "qmakestep.h"
+#include "qtversionmanager.h"
 
 #include <coreplugin/icore.h>
 #include <coreplugin/basefilewizard.h>
@@ -85,7 +87,8 @@ Qt4Manager::Qt4Manager(Qt4ProjectManagerPlugin *plugin)
     m_contextProject(0),
     m_languageID(0),
     m_lastEditor(0),
-    m_dirty(false)
+    m_dirty(false),
+    m_proFileCache(new ProFileCache)
 {
     m_languageID = Core::UniqueIDManager::instance()->
                    uniqueIdentifier(ProjectExplorer::Constants::LANG_CXX);
@@ -93,6 +96,7 @@ Qt4Manager::Qt4Manager(Qt4ProjectManagerPlugin *plugin)
 
 Qt4Manager::~Qt4Manager()
 {
+    delete m_proFileCache;
 }
 
 void Qt4Manager::registerProject(Qt4Project *project)
@@ -107,6 +111,8 @@ void Qt4Manager::unregisterProject(Qt4Project *project)
 
 void Qt4Manager::notifyChanged(const QString &name)
 {
+    // The file was just written, its modification time may not show it.
+    proFileCache()->discardFile(QDir::cleanPath(name));
     foreach (Qt4Project *pro, m_projects)
         pro->notifyChanged(name);
 }
@@ -119,6 +125,20 @@ void Qt4Manager::init()
 
     connect(Core::EditorManager::instance(), SIGNAL(currentEditorChanged(Core::IEditor*)),
             this, SLOT(editorChanged(Core::IEditor*)));
+
+    // The mkspecs of a changed Qt version need to be read again
+    connect(QtVersionManager::instance(), SIGNAL(qtVersionsChanged()),
+            this, SLOT(clearProFileCache()));
+}
+
+ProFileCache *Qt4Manager::proFileCache() const
+{
+    return m_proFileCache;
+}
+
+void Qt4Manager::clearProFileCache()
+{
+    m_proFileCache->clear();
 }
 
 void Qt4Manager::editorChanged(Core::IEditor *editor)
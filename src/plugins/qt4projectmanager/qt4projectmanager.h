@@ -36,6 +36,10 @@
 
 #include <QtCore/QModelIndex>
 
+QT_BEGIN_NAMESPACE
+class ProFileCache;
+QT_END_NAMESPACE
+
 namespace Core {
     class IEditor;
 }
@@ -92,6 +96,9 @@ public:
     // Return the id string of a file
     static QString fileTypeId(ProjectExplorer::FileType type);
 
+    // Parsed .pro files and mkspecs shared by all project evaluations
+    ProFileCache *proFileCache() const;
+
 public slots:
     void runQMake();
     void runQMakeContextMenu();
@@ -100,6 +107,7 @@ private slots:
     void editorAboutToClose(Core::IEditor *editor);
     void uiEditorContentsChanged();
     void editorChanged(Core::IEditor*);
+    void clearProFileCache();
 
 private:
     QList<Qt4Project *> m_projects;
@@ -115,6 +123,7 @@ private:
     int m_languageID;
     Core::IEditor *m_lastEditor;
     bool m_dirty;
+    ProFileCache *m_proFileCache;
 };
 
 } // namespace Qt4ProjectManager
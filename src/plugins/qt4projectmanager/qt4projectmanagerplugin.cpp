@@ -70,6 +70,8 @@
 
 #ifdef WITH_TESTS
 #include <QTest>
+#include <QtCore/QEventLoop>
+#include <QtCore/QTimer>
 #endif
 
 using namespace Qt4ProjectManager::Internal;
@@ -246,6 +248,15 @@ void Qt4ProjectManagerPlugin::testBasicProjectLoading()
     QVERIFY(!m_projectExplorer->session()->projects().isEmpty());
     Qt4Project *qt4project = qobject_cast<Qt4Project *>(m_projectExplorer->session()->projects().first());
     QVERIFY(qt4project);
+
+    // The .pro files are evaluated in worker threads
+    if (!qt4project->isInitialEvaluationDone()) {
+        QEventLoop loop;
+        connect(qt4project, SIGNAL(evaluationFinished()), &loop, SLOT(quit()));
+        QTimer::singleShot(30000, &loop, SLOT(quit()));
+        loop.exec();
+    }
+    QVERIFY(qt4project->isInitialEvaluationDone());
     QVERIFY(qt4project->rootProjectNode()->projectType() == ApplicationTemplate);
     QVERIFY(m_projectExplorer->currentProject() != 0);
 }
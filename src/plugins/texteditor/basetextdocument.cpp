@@ -30,11 +30,16 @@
 #include "basetextdocument.h"
 #include "basetexteditor.h"
 #include "storagesettings.h"
+#include "texteditorconstants.h"
 
+#include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
 #include <QtCore/QTextStream>
 #include <QtCore/QTextCodec>
+#include <QtCore/QtConcurrentRun>
 #include <QtGui/QMainWindow>
 #include <QtGui/QSyntaxHighlighter>
 #include <QtGui/QApplication>
@@ -42,12 +47,190 @@
 #ifndef TEXTEDITOR_STANDALONE
 #include <utils/reloadpromptutils.h>
 #include <coreplugin/icore.h>
+#include <coreplugin/messagemanager.h>
 #include <coreplugin/editormanager/editormanager.h>
+#include <coreplugin/progressmanager/progressmanager.h>
 #endif
+#include <qtconcurrent/runextensions.h>
 #include <utils/qtcassert.h>
 
 using namespace TextEditor;
 
+namespace {
+
+enum {
+    // Files are read and decoded in chunks of this size. Bigger files are
+    // loaded in a worker thread while the document is filled chunk by chunk.
+    ChunkSize = 1024 * 1024,
+    // Decoded chunks waiting for the GUI thread, the worker blocks beyond.
+    MaxQueuedChunks = 4
+};
+
+/*
+ * Decodes a file chunk by chunk. A single QTextDecoder carries its state
+ * across chunk boundaries and remembers failures, so no second pass over
+ * the text is needed to detect decoding errors.
+ */
+class FileDecoder
+{
+public:
+    FileDecoder(QTextCodec *codec)
+        : m_codec(codec), m_decoder(0), m_verify(false), m_hasDecodingError(false)
+    { }
+
+    ~FileDecoder()
+    { delete m_decoder; }
+
+    QString decode(const QByteArray &chunk)
+    {
+        if (! m_decoder) {
+            detectCodec(chunk);
+            m_decoder = m_codec->makeDecoder();
+            // The "System" codec does not report failures, keep the old
+            // encode-and-compare check for it.
+            m_verify = (m_codec->name() == "System");
+
+            if (m_verify) {
+                int p = chunk.indexOf('\n', 16384);
+                m_decodingErrorSample = p < 0 ? chunk : chunk.left(p);
+            }
+        }
+
+        const QString text = m_decoder->toUnicode(chunk);
+
+        if (m_verify) {
+            m_bytes += chunk;
+            m_text += text;
+        } else if (! m_hasDecodingError && m_decoder->hasFailure()) {
+            setDecodingError(chunk);
+        }
+
+        return text;
+    }
+
+    void finish()
+    {
+        if (! m_verify)
+            return;
+
+        QByteArray verifyBuf = m_codec->fromUnicode(m_text); // slow
+        // the minSize trick lets us ignore unicode headers
+        int minSize = qMin(verifyBuf.size(), m_bytes.size());
+        m_hasDecodingError = (minSize < m_bytes.size()- 4
+                              || memcmp(verifyBuf.constData() + verifyBuf.size() - minSize,
+                                        m_bytes.constData() + m_bytes.size() - minSize, minSize));
+        if (! m_hasDecodingError)
+            m_decodingErrorSample.clear();
+        m_bytes.clear();
+        m_text.clear();
+    }
+
+    QTextCodec *codec() const { return m_codec; }
+    bool hasDecodingError() const { return m_hasDecodingError; }
+    QByteArray decodingErrorSample() const { return m_decodingErrorSample; }
+
+private:
+    void detectCodec(const QByteArray &buf)
+    {
+        const int bytesRead = buf.size();
+
+        // code taken from qtextstream
+        if (bytesRead >= 4 && ((uchar(buf[0]) == 0xff && uchar(buf[1]) == 0xfe && uchar(buf[2]) == 0 && uchar(buf[3]) == 0)
+                               || (uchar(buf[0]) == 0 && uchar(buf[1]) == 0 && uchar(buf[2]) == 0xfe && uchar(buf[3]) == 0xff))) {
+            m_codec = QTextCodec::codecForName("UTF-32");
+        } else if (bytesRead >= 2 && ((uchar(buf[0]) == 0xff && uchar(buf[1]) == 0xfe)
+                                      || (uchar(buf[0]) == 0xfe && uchar(buf[1]) == 0xff))) {
+            m_codec = QTextCodec::codecForName("UTF-16");
+        } else if (!m_codec) {
+            m_codec = QTextCodec::codecForLocale();
+        }
+        // end code taken from qtextstream
+    }
+
+    void setDecodingError(const QByteArray &chunk)
+    {
+        m_hasDecodingError = true;
+        int p = chunk.indexOf('\n', 16384);
+        if (p < 0)
+            m_decodingErrorSample = chunk;
+        else
+            m_decodingErrorSample = chunk.left(p);
+    }
+
+    QTextCodec *m_codec;
+    QTextDecoder *m_decoder;
+    bool m_verify;
+    bool m_hasDecodingError;
+    QByteArray m_decodingErrorSample;
+    QByteArray m_bytes;
+    QString m_text;
+};
+
+} // anonymous namespace
+
+namespace TextEditor {
+namespace Internal {
+
+// State shared between the document and the worker thread reading a file.
+struct FileLoad
+{
+    FileLoad(QTextCodec *codec) : decoder(codec), finished(false) {}
+
+    FileDecoder decoder;     // used by the worker until finished is set
+    QMutex mutex;
+    QWaitCondition chunkTaken;
+    QList<QString> chunks;
+    bool finished;
+    QString errorString;
+};
+
+} // namespace Internal
+} // namespace TextEditor
+
+namespace {
+
+using TextEditor::Internal::FileLoad;
+
+// Runs in a worker thread, queues the decoded text chunk by chunk and
+// tells the document through a queued call.
+void readFile(QFutureInterface<void> &future, QString fileName, FileLoad *load, QObject *document)
+{
+    QFile file(fileName);
+    QString errorString;
+    if (file.open(QIODevice::ReadOnly)) {
+        future.setProgressRange(0, int(file.size() / ChunkSize) + 1);
+
+        while (! file.atEnd() && ! future.isCanceled()) {
+            const QByteArray bytes = file.read(ChunkSize);
+            if (file.error() != QFile::NoError) {
+                errorString = file.errorString();
+                break;
+            }
+            const QString text = load->decoder.decode(bytes);
+
+            QMutexLocker locker(&load->mutex);
+            while (load->chunks.size() >= MaxQueuedChunks && ! future.isCanceled())
+                load->chunkTaken.wait(&load->mutex);
+            load->chunks.append(text);
+            if (load->chunks.size() == 1)
+                QMetaObject::invokeMethod(document, "insertLoadedChunks", Qt::QueuedConnection);
+            future.setProgressValue(int(file.pos() / ChunkSize));
+        }
+    } else {
+        errorString = file.errorString();
+    }
+
+    if (errorString.isEmpty())
+        load->decoder.finish();
+
+    QMutexLocker locker(&load->mutex);
+    load->errorString = errorString;
+    load->finished = true;
+    QMetaObject::invokeMethod(document, "insertLoadedChunks", Qt::QueuedConnection);
+}
+
+} // anonymous namespace
+
 DocumentMarker::DocumentMarker(QTextDocument *doc)
   : ITextMarkable(doc), document(doc)
 {
@@ -60,13 +243,19 @@ BaseTextDocument::BaseTextDocument()
     m_documentMarker = new DocumentMarker(m_document);
     m_lineTerminatorMode = NativeLineTerminator;
     m_fileIsReadOnly = false;
+    m_isLargeFile = false;
     m_isBinaryData = false;
     m_codec = QTextCodec::codecForLocale();
     m_hasDecodingError = false;
+    m_hasReadError = false;
+    m_reloadPending = false;
+    m_load = 0;
 }
 
 BaseTextDocument::~BaseTextDocument()
 {
+    cancelLoading();
+
     QTextBlock block = m_document->begin();
     while (block.isValid()) {
         if (TextBlockUserData *data = static_cast<TextBlockUserData *>(block.userData()))
@@ -89,10 +278,14 @@ void BaseTextDocument::setMimeType(const QString &mt)
 
 bool BaseTextDocument::save(const QString &fileName)
 {
+    // Never overwrite a file with what we could read of it
+    if (isLoading() || m_hasReadError)
+        return false;
+
     QTextCursor cursor(m_document);
 
     cursor.beginEditBlock();
-    if (m_storageSettings.m_cleanWhitespace)
+    if (m_storageSettings.m_cleanWhitespace && !m_isLargeFile)
         cleanWhitespace(cursor, m_storageSettings.m_cleanIndentation, m_storageSettings.m_inEntireDocument);
     if (m_storageSettings.m_addFinalNewLine)
         ensureFinalNewLine(cursor);
@@ -132,7 +325,7 @@ bool BaseTextDocument::save(const QString &fileName)
 
 bool BaseTextDocument::isReadOnly() const
 {
-    if (m_isBinaryData || m_hasDecodingError)
+    if (m_isBinaryData || m_hasDecodingError || isLoading() || m_hasReadError)
         return true;
     if (m_fileName.isEmpty()) //have no corresponding file, so editing is ok
         return false;
@@ -156,6 +349,9 @@ void BaseTextDocument::checkPermissions()
 
 bool BaseTextDocument::open(const QString &fileName)
 {
+    cancelLoading();
+    m_hasReadError = false;
+
     QString title = tr("untitled");
     if (!fileName.isEmpty()) {
         const QFileInfo fi(fileName);
@@ -168,64 +364,30 @@ bool BaseTextDocument::open(const QString &fileName)
 
         title = fi.fileName();
 
-        QByteArray buf = file.readAll();
-        int bytesRead = buf.size();
-
-        QTextCodec *codec = m_codec;
-
-        // code taken from qtextstream
-        if (bytesRead >= 4 && ((uchar(buf[0]) == 0xff && uchar(buf[1]) == 0xfe && uchar(buf[2]) == 0 && uchar(buf[3]) == 0)
-                               || (uchar(buf[0]) == 0 && uchar(buf[1]) == 0 && uchar(buf[2]) == 0xfe && uchar(buf[3]) == 0xff))) {
-            codec = QTextCodec::codecForName("UTF-32");
-        } else if (bytesRead >= 2 && ((uchar(buf[0]) == 0xff && uchar(buf[1]) == 0xfe)
-                                      || (uchar(buf[0]) == 0xfe && uchar(buf[1]) == 0xff))) {
-            codec = QTextCodec::codecForName("UTF-16");
-        } else if (!codec) {
-            codec = QTextCodec::codecForLocale();
-        }
-        // end code taken from qtextstream
-
-        m_codec = codec;
-
-#if 0 // should work, but does not, Qt bug with "system" codec
-        QTextDecoder *decoder = m_codec->makeDecoder();
-        QString text = decoder->toUnicode(buf);
-        m_hasDecodingError = (decoder->hasFailure());
-        delete decoder;
-#else
-        QString text = m_codec->toUnicode(buf);
-        QByteArray verifyBuf = m_codec->fromUnicode(text); // slow
-        // the minSize trick lets us ignore unicode headers
-        int minSize = qMin(verifyBuf.size(), buf.size());
-        m_hasDecodingError = (minSize < buf.size()- 4
-                              || memcmp(verifyBuf.constData() + verifyBuf.size() - minSize,
-                                        buf.constData() + buf.size() - minSize, minSize));
-#endif
+        m_document->setModified(false);
 
-        if (m_hasDecodingError) {
-            int p = buf.indexOf('\n', 16384);
-            if (p < 0)
-                m_decodingErrorSample = buf;
+        if (file.size() > LargeFileSize)
+            setLargeFile(true);
+
+        if (file.size() <= ChunkSize) {
+            const QByteArray bytes = file.readAll();
+            if (file.error() != QFile::NoError)
+                return false;
+            FileDecoder decoder(m_codec);
+            const QString text = decoder.decode(bytes);
+            decoder.finish();
+            setDecodingResult(decoder.codec(), decoder.hasDecodingError(), decoder.decodingErrorSample());
+            detectLineTerminatorMode(text);
+
+            if (m_isBinaryData)
+                m_document->setHtml(tr("<em>Binary data</em>"));
             else
-                m_decodingErrorSample = buf.left(p);
+                m_document->setPlainText(text);
         } else {
-            m_decodingErrorSample.clear();
+            file.close();
+            startLoading(fi);
         }
 
-        int lf = text.indexOf('\n');
-        if (lf > 0 && text.at(lf-1) == QLatin1Char('\r')) {
-            m_lineTerminatorMode = CRLFLineTerminator;
-        } else if (lf >= 0) {
-            m_lineTerminatorMode = LFLineTerminator;
-        } else {
-            m_lineTerminatorMode = NativeLineTerminator;
-        }
-
-        m_document->setModified(false);
-        if (m_isBinaryData)
-            m_document->setHtml(tr("<em>Binary data</em>"));
-        else
-            m_document->setPlainText(text);
         TextEditDocumentLayout *documentLayout = qobject_cast<TextEditDocumentLayout*>(m_document->documentLayout());
         QTC_ASSERT(documentLayout, return true);
         documentLayout->lastSaveRevision = m_document->revision();
@@ -236,6 +398,130 @@ bool BaseTextDocument::open(const QString &fileName)
     return true;
 }
 
+// Reads the file in a worker thread. The chunks are appended to the
+// document as they arrive, without blocking the event loop in between.
+void BaseTextDocument::startLoading(const QFileInfo &fi)
+{
+    m_document->setUndoRedoEnabled(false);
+    m_document->clear();
+
+    m_load = new Internal::FileLoad(m_codec);
+    m_loadFuture = QtConcurrent::run(&readFile, fi.absoluteFilePath(), m_load,
+                                     static_cast<QObject *>(this));
+
+#ifndef TEXTEDITOR_STANDALONE
+    if (Core::ICore *core = Core::ICore::instance())
+        core->progressManager()->addTask(m_loadFuture, tr("Opening %1").arg(fi.fileName()),
+                                         Constants::TASK_OPEN_FILE,
+                                         Core::ProgressManager::CloseOnSuccess);
+#endif
+}
+
+void BaseTextDocument::insertLoadedChunks()
+{
+    if (!m_load)
+        return; // left over from a canceled load
+
+    QList<QString> chunks;
+    bool finished;
+    {
+        QMutexLocker locker(&m_load->mutex);
+        chunks = m_load->chunks;
+        m_load->chunks.clear();
+        finished = m_load->finished;
+        m_load->chunkTaken.wakeAll();
+    }
+
+    if (!chunks.isEmpty()) {
+        QTextCursor cursor(m_document);
+        cursor.movePosition(QTextCursor::End);
+        cursor.beginEditBlock();
+        foreach (const QString &chunk, chunks) {
+            if (m_document->isEmpty())
+                detectLineTerminatorMode(chunk);
+            cursor.insertText(chunk);
+        }
+        cursor.endEditBlock();
+    }
+
+    if (finished)
+        finishLoading();
+}
+
+void BaseTextDocument::finishLoading()
+{
+    // The worker is past its last access to the shared state
+    m_loadFuture.waitForFinished();
+    Internal::FileLoad *load = m_load;
+    m_load = 0;
+    m_loadFuture = QFuture<void>();
+    const QString errorString = load->errorString;
+    setDecodingResult(load->decoder.codec(), load->decoder.hasDecodingError(),
+                      load->decoder.decodingErrorSample());
+    delete load;
+
+    m_hasReadError = !errorString.isEmpty();
+    if (m_hasReadError) {
+#ifndef TEXTEDITOR_STANDALONE
+        if (Core::ICore *core = Core::ICore::instance())
+            core->messageManager()->printToOutputPanePopup(
+                tr("Could not read %1: %2").arg(QDir::toNativeSeparators(m_fileName), errorString));
+#endif
+    } else if (m_isBinaryData) {
+        m_document->setHtml(tr("<em>Binary data</em>"));
+    }
+
+    m_document->setUndoRedoEnabled(true);
+    if (TextEditDocumentLayout *documentLayout = qobject_cast<TextEditDocumentLayout*>(m_document->documentLayout()))
+        documentLayout->lastSaveRevision = m_document->revision();
+    m_document->setModified(false);
+
+    emit loadingFinished(!m_hasReadError);
+    emit changed();
+    if (m_reloadPending) {
+        m_reloadPending = false;
+        if (!m_hasReadError)
+            emit reloaded();
+    }
+}
+
+void BaseTextDocument::cancelLoading()
+{
+    if (!m_load)
+        return;
+    m_loadFuture.cancel();
+    {
+        QMutexLocker locker(&m_load->mutex);
+        m_load->chunkTaken.wakeAll();
+    }
+    m_loadFuture.waitForFinished();
+    m_loadFuture = QFuture<void>();
+    delete m_load;
+    m_load = 0;
+    m_reloadPending = false;
+    m_document->setUndoRedoEnabled(true);
+}
+
+void BaseTextDocument::setDecodingResult(QTextCodec *codec, bool hasDecodingError,
+                                         const QByteArray &decodingErrorSample)
+{
+    m_codec = codec;
+    m_hasDecodingError = hasDecodingError;
+    m_decodingErrorSample = decodingErrorSample;
+}
+
+void BaseTextDocument::detectLineTerminatorMode(const QString &text)
+{
+    int lf = text.indexOf('\n');
+    if (lf > 0 && text.at(lf-1) == QLatin1Char('\r')) {
+        m_lineTerminatorMode = CRLFLineTerminator;
+    } else if (lf >= 0) {
+        m_lineTerminatorMode = LFLineTerminator;
+    } else {
+        m_lineTerminatorMode = NativeLineTerminator;
+    }
+}
+
 void BaseTextDocument::reload(QTextCodec *codec)
 {
     QTC_ASSERT(codec, return);
@@ -246,8 +532,13 @@ void BaseTextDocument::reload(QTextCodec *codec)
 void BaseTextDocument::reload()
 {
     emit aboutToReload();
-    if (open(m_fileName))
-        emit reloaded();
+    if (open(m_fileName)) {
+        // The cursor is restored once the text is there
+        if (isLoading())
+            m_reloadPending = true;
+        else
+            emit reloaded();
+    }
 }
 
 void BaseTextDocument::modified(Core::IFile::ReloadBehavior *behavior)
@@ -296,7 +587,20 @@ void BaseTextDocument::setSyntaxHighlighter(QSyntaxHighlighter *highlighter)
         delete m_highlighter;
     m_highlighter = highlighter;
     m_highlighter->setParent(this);
-    m_highlighter->setDocument(m_document);
+    m_highlighter->setDocument(m_isLargeFile ? 0 : m_document);
+}
+
+void BaseTextDocument::setLargeFile(bool largeFile)
+{
+    if (m_isLargeFile == largeFile)
+        return;
+
+    m_isLargeFile = largeFile;
+
+    if (m_highlighter)
+        m_highlighter->setDocument(m_isLargeFile ? 0 : m_document);
+
+    emit largeFileChanged(m_isLargeFile);
 }
 
 
@@ -37,7 +37,10 @@
 
 #include <coreplugin/ifile.h>
 
+#include <QtCore/QFuture>
+
 QT_BEGIN_NAMESPACE
+class QFileInfo;
 class QTextCursor;
 class QTextDocument;
 class QSyntaxHighlighter;
@@ -45,6 +48,10 @@ QT_END_NAMESPACE
 
 namespace TextEditor {
 
+namespace Internal {
+struct FileLoad;
+}
+
 class DocumentMarker : public ITextMarkable
 {
     Q_OBJECT
@@ -111,12 +118,31 @@ public:
 
     void reload(QTextCodec *codec);
 
+    // Files bigger than this are opened in large file mode.
+    enum { LargeFileSize = 16 * 1024 * 1024 };
+
+    // In large file mode the syntax highlighter is not attached to the
+    // document, the editors only highlight the blocks they show.
+    inline bool isLargeFile() const { return m_isLargeFile; }
+    void setLargeFile(bool largeFile);
+
+    // Files bigger than one chunk are loaded in the background after
+    // open() returned. The document is read-only until then, and stays
+    // so if reading failed.
+    inline bool isLoading() const { return m_load != 0; }
+    inline bool hasReadError() const { return m_hasReadError; }
+
     void cleanWhitespace(const QTextCursor &cursor);
 
 signals:
     void titleChanged(QString title);
     void aboutToReload();
     void reloaded();
+    void largeFileChanged(bool largeFile);
+    void loadingFinished(bool success);
+
+private slots:
+    void insertLoadedChunks();
 
 private:
     QString m_fileName;
@@ -143,9 +169,21 @@ private:
     QTextCodec *m_codec;
 
     bool m_fileIsReadOnly;
+    bool m_isLargeFile;
     bool m_isBinaryData;
     bool m_hasDecodingError;
+    bool m_hasReadError;
+    bool m_reloadPending;
     QByteArray m_decodingErrorSample;
+    Internal::FileLoad *m_load;
+    QFuture<void> m_loadFuture;
+
+    void startLoading(const QFileInfo &fi);
+    void finishLoading();
+    void cancelLoading();
+    void setDecodingResult(QTextCodec *codec, bool hasDecodingError,
+                           const QByteArray &decodingErrorSample);
+    void detectLineTerminatorMode(const QString &text);
 
     void cleanWhitespace(QTextCursor& cursor, bool cleanIndentation, bool inEntireDocument);
     void ensureFinalNewLine(QTextCursor& cursor);
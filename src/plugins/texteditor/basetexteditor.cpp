@@ -37,6 +37,7 @@
 #include "basetextdocument.h"
 #include "basetexteditor_p.h"
 #include "codecselector.h"
+#include "textblocknestingindex.h"
 
 #ifndef TEXTEDITOR_STANDALONE
 #include <aggregation/aggregate.h>
@@ -218,6 +219,11 @@ BaseTextEditor::BaseTextEditor(QWidget *parent)
     d->m_highlightBlocksTimer->setSingleShot(true);
     connect(d->m_highlightBlocksTimer, SIGNAL(timeout()), this, SLOT(_q_highlightBlocks()));
 
+    d->m_visibleBlocksHighlightTimer = new QTimer(this);
+    d->m_visibleBlocksHighlightTimer->setSingleShot(true);
+    d->m_visibleBlocksHighlightTimer->setInterval(0);
+    connect(d->m_visibleBlocksHighlightTimer, SIGNAL(timeout()), this, SLOT(_q_highlightVisibleBlocks()));
+
     d->m_animator = 0;
 
     d->m_searchResultFormat.setBackground(QColor(0xffef0b));
@@ -602,7 +608,7 @@ bool BaseTextEditor::open(const QString &fileName)
 {
     if (d->m_document->open(fileName)) {
         moveCursor(QTextCursor::Start);
-        setReadOnly(d->m_document->hasDecodingError());
+        _q_loadingFinished();
         return true;
     }
     return false;
@@ -620,6 +626,9 @@ void BaseTextEditor::editorContentsChange(int position, int charsRemoved, int ch
 
     d->m_contentsChanged = true;
 
+    if (d->m_document->isLargeFile())
+        d->m_visibleBlocksHighlightTimer->start();
+
     // Keep the line numbers and the block information for the text marks updated
     if (charsRemoved != 0) {
         d->updateMarksLineNumber();
@@ -1161,6 +1170,12 @@ void BaseTextEditor::setTextCursor(const QTextCursor &cursor)
 
 void BaseTextEditor::gotoLine(int line, int column)
 {
+    if (d->m_document->isLoading()) {
+        d->m_pendingState.clear();
+        d->m_pendingLine = line;
+        d->m_pendingColumn = column;
+        return;
+    }
     d->m_lastCursorChangeWasInteresting = false; // avoid adding the previous position to history
     const int blockNumber = line - 1;
     const QTextBlock &block = document()->findBlockByNumber(blockNumber);
@@ -1304,6 +1319,11 @@ QByteArray BaseTextEditor::saveState() const
 
 bool BaseTextEditor::restoreState(const QByteArray &state)
 {
+    if (d->m_document->isLoading()) {
+        d->m_pendingState = state;
+        d->m_pendingLine = -1;
+        return true;
+    }
     int version;
     int vval;
     int hval;
@@ -1462,6 +1482,8 @@ BaseTextEditorPrivate::BaseTextEditorPrivate()
     m_contentsChanged(false),
     m_lastCursorChangeWasInteresting(false),
     m_document(new BaseTextDocument()),
+    m_pendingLine(-1),
+    m_pendingColumn(0),
     m_parenthesesMatchingEnabled(false),
     m_extraArea(0),
     m_mouseOnCollapsedMarker(false),
@@ -1482,7 +1504,12 @@ BaseTextEditorPrivate::BaseTextEditorPrivate()
     m_lastEventWasBlockSelectionEvent(false),
     m_blockSelectionExtraX(0),
     m_moveLineUndoHack(false),
-    m_cursorBlockNumber(-1)
+    m_cursorBlockNumber(-1),
+    m_visibleBlocksHighlightTimer(0),
+    m_visibleBlocksDocument(0),
+    m_highlightedFirstBlockNumber(-1),
+    m_highlightedLastBlockNumber(-1),
+    m_highlightedRevision(-1)
 {
 }
 
@@ -1522,6 +1549,8 @@ void BaseTextEditorPrivate::setupDocumentSignals(BaseTextDocument *document)
     QObject::connect(document, SIGNAL(titleChanged(QString)), q, SLOT(setDisplayName(const QString &)));
     QObject::connect(document, SIGNAL(aboutToReload()), q, SLOT(memorizeCursorPosition()));
     QObject::connect(document, SIGNAL(reloaded()), q, SLOT(restoreCursorPosition()));
+    QObject::connect(document, SIGNAL(largeFileChanged(bool)), q, SLOT(_q_largeFileChanged()));
+    QObject::connect(document, SIGNAL(loadingFinished(bool)), q, SLOT(_q_loadingFinished()));
     q->slotUpdateExtraAreaWidth();
 }
 
@@ -1598,6 +1627,15 @@ int TextBlockUserData::braceDepthDelta() const
     return delta;
 }
 
+Internal::TextBlockNestingIndex *TextEditDocumentLayout::nestingIndex(const QTextBlock &block)
+{
+    if (const QTextDocument *document = block.document()) {
+        if (TextEditDocumentLayout *layout = qobject_cast<TextEditDocumentLayout*>(document->documentLayout()))
+            return layout->m_nestingIndex;
+    }
+    return 0;
+}
+
 void TextEditDocumentLayout::setParentheses(const QTextBlock &block, const Parentheses &parentheses)
 {
     if (parentheses.isEmpty()) {
@@ -1606,6 +1644,8 @@ void TextEditDocumentLayout::setParentheses(const QTextBlock &block, const Paren
     } else {
         userData(block)->setParentheses(parentheses);
     }
+    if (Internal::TextBlockNestingIndex *index = nestingIndex(block))
+        index->invalidate(block);
 }
 
 Parentheses TextEditDocumentLayout::parentheses(const QTextBlock &block)
@@ -1654,13 +1694,18 @@ void TextEditDocumentLayout::changeBraceDepth(QTextBlock &block, int delta)
 
 bool TextEditDocumentLayout::setIfdefedOut(const QTextBlock &block)
 {
+    if (Internal::TextBlockNestingIndex *index = nestingIndex(block))
+        index->invalidate(block);
     return userData(block)->setIfdefedOut();
 }
 
 bool TextEditDocumentLayout::clearIfdefedOut(const QTextBlock &block)
 {
-    if (TextBlockUserData *userData = testUserData(block))
+    if (TextBlockUserData *userData = testUserData(block)) {
+        if (Internal::TextBlockNestingIndex *index = nestingIndex(block))
+            index->invalidate(block);
         return userData->clearIfdefedOut();
+    }
     return false;
 }
 
@@ -1672,14 +1717,51 @@ bool TextEditDocumentLayout::ifdefedOut(const QTextBlock &block)
 }
 
 
+QTextBlock TextEditDocumentLayout::findClosingBlock(const QTextBlock &block, ParenthesesKind kind, int *depth)
+{
+    if (Internal::TextBlockNestingIndex *index = nestingIndex(block))
+        return index->findClosingBlock(block, kind, depth);
+
+    for (QTextBlock next = block.next(); next.isValid(); next = next.next()) {
+        const Internal::TextBlockNestingIndex::Excess e = Internal::TextBlockNestingIndex::excess(next, kind);
+        if (e.closed >= *depth)
+            return next;
+        *depth += e.opened - e.closed;
+    }
+    return QTextBlock();
+}
+
+QTextBlock TextEditDocumentLayout::findOpeningBlock(const QTextBlock &block, ParenthesesKind kind, int *depth)
+{
+    if (Internal::TextBlockNestingIndex *index = nestingIndex(block))
+        return index->findOpeningBlock(block, kind, depth);
+
+    for (QTextBlock previous = block.previous(); previous.isValid(); previous = previous.previous()) {
+        const Internal::TextBlockNestingIndex::Excess e = Internal::TextBlockNestingIndex::excess(previous, kind);
+        if (e.opened >= *depth)
+            return previous;
+        *depth += e.closed - e.opened;
+    }
+    return QTextBlock();
+}
+
 TextEditDocumentLayout::TextEditDocumentLayout(QTextDocument *doc)
     :QPlainTextDocumentLayout(doc) {
     lastSaveRevision = 0;
     hasMarks = 0;
+    m_nestingIndex = new Internal::TextBlockNestingIndex(doc);
 }
 
 TextEditDocumentLayout::~TextEditDocumentLayout()
 {
+    delete m_nestingIndex;
+}
+
+void TextEditDocumentLayout::documentChanged(int from, int charsRemoved, int charsAdded)
+{
+    QPlainTextDocumentLayout::documentChanged(from, charsRemoved, charsAdded);
+    // the highlighter might not have run yet, the blocks are re-read lazily
+    m_nestingIndex->documentChanged(from, charsAdded);
 }
 
 QRectF TextEditDocumentLayout::blockBoundingRect(const QTextBlock &block) const
@@ -2762,6 +2844,9 @@ void BaseTextEditor::slotUpdateRequest(const QRect &r, int dy)
 
     if (r.contains(viewport()->rect()))
         slotUpdateExtraAreaWidth();
+
+    if (d->m_document->isLargeFile())
+        d->m_visibleBlocksHighlightTimer->start();
 }
 
 void BaseTextEditor::saveCurrentCursorPositionForNavigation()
@@ -3607,17 +3692,15 @@ TextBlockUserData::MatchType TextBlockUserData::checkOpenParenthesis(QTextCursor
             }
         }
 
-        if (i >= parenList.count()) {
-            for (;;) {
-                closedParenParag = closedParenParag.next();
-                if (!closedParenParag.isValid())
-                    return NoMatch;
-                if (TextEditDocumentLayout::hasParentheses(closedParenParag)
-                    && !TextEditDocumentLayout::ifdefedOut(closedParenParag)) {
-                    parenList = TextEditDocumentLayout::parentheses(closedParenParag);
-                    break;
-                }
-            }
+        while (i >= parenList.count()) {
+            int depth = ignore + 1;
+            closedParenParag = TextEditDocumentLayout::findClosingBlock(closedParenParag,
+                                                                        TextEditDocumentLayout::AllParentheses,
+                                                                        &depth);
+            if (!closedParenParag.isValid())
+                return NoMatch;
+            parenList = TextEditDocumentLayout::parentheses(closedParenParag);
+            ignore = depth - 1;
             i = 0;
         }
 
@@ -3676,18 +3759,15 @@ TextBlockUserData::MatchType TextBlockUserData::checkClosedParenthesis(QTextCurs
             }
         }
 
-        if (i < 0) {
-            for (;;) {
-                openParenParag = openParenParag.previous();
-                if (!openParenParag.isValid())
-                    return NoMatch;
-
-                if (TextEditDocumentLayout::hasParentheses(openParenParag)
-                    && !TextEditDocumentLayout::ifdefedOut(openParenParag)) {
-                    parenList = TextEditDocumentLayout::parentheses(openParenParag);
-                    break;
-                }
-            }
+        while (i < 0) {
+            int depth = ignore + 1;
+            openParenParag = TextEditDocumentLayout::findOpeningBlock(openParenParag,
+                                                                      TextEditDocumentLayout::AllParentheses,
+                                                                      &depth);
+            if (!openParenParag.isValid())
+                return NoMatch;
+            parenList = TextEditDocumentLayout::parentheses(openParenParag);
+            ignore = depth - 1;
             i = parenList.count() - 1;
         }
 
@@ -3741,7 +3821,9 @@ bool TextBlockUserData::findPreviousOpenParenthesis(QTextCursor *cursor, bool se
                 }
             }
         }
-        block = block.previous();
+        int depth = ignore + 1;
+        block = TextEditDocumentLayout::findOpeningBlock(block, TextEditDocumentLayout::AllParentheses, &depth);
+        ignore = depth - 1;
     }
     return false;
 }
@@ -3777,7 +3859,9 @@ bool TextBlockUserData::findPreviousBlockOpenParenthesis(QTextCursor *cursor, bo
                 }
             }
         }
-        block = block.previous();
+        int depth = ignore + 1;
+        block = TextEditDocumentLayout::findOpeningBlock(block, TextEditDocumentLayout::BlockParentheses, &depth);
+        ignore = depth - 1;
     }
     return false;
 }
@@ -3805,7 +3889,9 @@ bool TextBlockUserData::findNextClosingParenthesis(QTextCursor *cursor, bool sel
                 }
             }
         }
-        block = block.next();
+        int depth = ignore + 1;
+        block = TextEditDocumentLayout::findClosingBlock(block, TextEditDocumentLayout::AllParentheses, &depth);
+        ignore = depth - 1;
     }
     return false;
 }
@@ -3837,7 +3923,9 @@ bool TextBlockUserData::findNextBlockClosingParenthesis(QTextCursor *cursor)
                 }
             }
         }
-        block = block.next();
+        int depth = ignore + 1;
+        block = TextEditDocumentLayout::findClosingBlock(block, TextEditDocumentLayout::BlockParentheses, &depth);
+        ignore = depth - 1;
     }
     return false;
 }
@@ -4089,7 +4177,9 @@ void BaseTextEditor::_q_highlightBlocks()
 {
     BaseTextEditorPrivateHighlightBlocks highlightBlocksInfo;
 
-    if (d->extraAreaHighlightCollapseBlockNumber >= 0) {
+    // Finding the enclosing blocks may walk the whole document, which is
+    // not affordable for large files.
+    if (d->extraAreaHighlightCollapseBlockNumber >= 0 && !d->m_document->isLargeFile()) {
         QTextBlock block = document()->findBlockByNumber(d->extraAreaHighlightCollapseBlockNumber);
         if (block.isValid()) {
             QTextCursor cursor(block);
@@ -4117,6 +4207,138 @@ void BaseTextEditor::_q_highlightBlocks()
     }
 }
 
+static bool sameFormats(const QList<QTextLayout::FormatRange> &a, const QList<QTextLayout::FormatRange> &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (int i = 0; i < a.size(); ++i) {
+        const QTextLayout::FormatRange &ra = a.at(i);
+        const QTextLayout::FormatRange &rb = b.at(i);
+        if (ra.start != rb.start || ra.length != rb.length || ra.format != rb.format)
+            return false;
+    }
+    return true;
+}
+
+/*
+  In large file mode the syntax highlighter is not attached to the
+  document. Instead, the blocks around the viewport are copied into a
+  small private document the highlighter works on, and the resulting
+  formats, parentheses and folding information are copied back. Blocks
+  that are never shown are never highlighted.
+*/
+void BaseTextEditor::_q_highlightVisibleBlocks()
+{
+    QSyntaxHighlighter *highlighter = d->m_document->syntaxHighlighter();
+    if (!d->m_document->isLargeFile() || !highlighter)
+        return;
+
+    // Highlight some blocks before the viewport as well, so multi-line
+    // constructs starting above it get a chance to be recognized.
+    enum { Margin = 50 };
+
+    QTextDocument *doc = document();
+    const int firstVisible = firstVisibleBlock().blockNumber();
+    const int lastVisible = cursorForPosition(viewport()->rect().bottomLeft()).blockNumber();
+    const int firstNumber = qMax(0, firstVisible - Margin);
+    const int lastNumber = qMin(doc->blockCount() - 1, lastVisible + Margin / 2);
+
+    if (firstNumber == d->m_highlightedFirstBlockNumber
+        && lastNumber == d->m_highlightedLastBlockNumber
+        && doc->revision() == d->m_highlightedRevision)
+        return;
+
+    d->m_highlightedFirstBlockNumber = firstNumber;
+    d->m_highlightedLastBlockNumber = lastNumber;
+    d->m_highlightedRevision = doc->revision();
+
+    const QTextBlock begin = doc->findBlockByNumber(firstNumber);
+    const QTextBlock end = doc->findBlockByNumber(lastNumber);
+
+    QTextCursor cursor(begin);
+    cursor.setPosition(end.position() + end.length() - 1, QTextCursor::KeepAnchor);
+    QString text = cursor.selectedText();
+    convertToPlainText(text);
+
+    if (!d->m_visibleBlocksDocument) {
+        d->m_visibleBlocksDocument = new QTextDocument(this);
+        d->m_visibleBlocksDocument->setDocumentLayout(new QPlainTextDocumentLayout(d->m_visibleBlocksDocument));
+    }
+    if (highlighter->document() != d->m_visibleBlocksDocument)
+        highlighter->setDocument(d->m_visibleBlocksDocument);
+
+    // the highlighter runs on the contents change
+    d->m_visibleBlocksDocument->setPlainText(text);
+
+    int dirtyBegin = -1;
+    int dirtyEnd = -1;
+    QTextBlock source = d->m_visibleBlocksDocument->begin();
+    for (QTextBlock block = begin; block.isValid() && source.isValid();
+         block = block.next(), source = source.next()) {
+        const QList<QTextLayout::FormatRange> formats = source.layout()->additionalFormats();
+        if (!sameFormats(formats, block.layout()->additionalFormats())) {
+            block.layout()->setAdditionalFormats(formats);
+            if (dirtyBegin < 0)
+                dirtyBegin = block.position();
+            dirtyEnd = block.position() + block.length();
+        }
+
+        // The parentheses go through the layout, which keeps the nesting
+        // index up to date.
+        if (TextBlockUserData *sourceData = TextEditDocumentLayout::testUserData(source)) {
+            TextEditDocumentLayout::setParentheses(block, sourceData->parentheses());
+            TextBlockUserData *data = TextEditDocumentLayout::userData(block);
+            data->setCollapseMode(sourceData->collapseMode());
+            data->setClosingCollapseMode(sourceData->closingCollapseMode());
+            data->setCollapseIncludesClosure(sourceData->collapseIncludesClosure());
+        } else if (TextBlockUserData *data = TextEditDocumentLayout::testUserData(block)) {
+            TextEditDocumentLayout::setParentheses(block, Parentheses());
+            data->setCollapseMode(TextBlockUserData::NoCollapse);
+            data->setClosingCollapseMode(TextBlockUserData::NoClosingCollapse);
+        }
+        block.setUserState(source.userState());
+
+        if (block == end)
+            break;
+    }
+
+    if (dirtyBegin >= 0)
+        doc->markContentsDirty(dirtyBegin, dirtyEnd - dirtyBegin);
+    d->m_extraArea->update();
+}
+
+// Also called right after open(), while big files are still loading
+void BaseTextEditor::_q_loadingFinished()
+{
+    setReadOnly(d->m_document->hasDecodingError() || d->m_document->isLoading()
+                || d->m_document->hasReadError());
+    if (d->m_document->isLoading())
+        return;
+    if (!d->m_pendingState.isEmpty()) {
+        const QByteArray state = d->m_pendingState;
+        d->m_pendingState.clear();
+        restoreState(state);
+    } else if (d->m_pendingLine != -1) {
+        const int line = d->m_pendingLine;
+        d->m_pendingLine = -1;
+        gotoLine(line, d->m_pendingColumn);
+    }
+}
+
+void BaseTextEditor::_q_largeFileChanged()
+{
+    // Wrapping needs the layout of the whole document.
+    const bool largeFile = d->m_document->isLargeFile();
+    setLineWrapMode(d->m_displaySettings.m_textWrapping && !largeFile
+                    ? QPlainTextEdit::WidgetWidth : QPlainTextEdit::NoWrap);
+
+    d->m_highlightedFirstBlockNumber = d->m_highlightedLastBlockNumber = -1;
+    if (largeFile) {
+        d->m_highlightBlocksInfo = BaseTextEditorPrivateHighlightBlocks();
+        d->m_visibleBlocksHighlightTimer->start();
+    }
+}
+
 void BaseTextEditor::setActionHack(QObject *hack)
 {
     d->m_actionHack = hack;
@@ -4451,7 +4673,8 @@ void BaseTextEditor::setTabSettings(const TabSettings &ts)
 
 void BaseTextEditor::setDisplaySettings(const DisplaySettings &ds)
 {
-    setLineWrapMode(ds.m_textWrapping ? QPlainTextEdit::WidgetWidth : QPlainTextEdit::NoWrap);
+    setLineWrapMode(ds.m_textWrapping && !d->m_document->isLargeFile()
+                    ? QPlainTextEdit::WidgetWidth : QPlainTextEdit::NoWrap);
     setLineNumbersVisible(ds.m_displayLineNumbers);
     setVisibleWrapColumn(ds.m_showWrapColumn ? ds.m_wrapColumn : 0);
     setCodeFoldingVisible(ds.m_displayFoldingMarkers);
@@ -52,6 +52,7 @@ namespace TextEditor {
 
 namespace Internal {
     class BaseTextEditorPrivate;
+    class TextBlockNestingIndex;
 }
 
 class ITextMark;
@@ -218,6 +219,10 @@ public:
     static void setBraceDepth(QTextBlock &block, int depth);
     static void changeBraceDepth(QTextBlock &block, int delta);
 
+    enum ParenthesesKind { AllParentheses, BlockParentheses };
+    static QTextBlock findClosingBlock(const QTextBlock &block, ParenthesesKind kind, int *depth);
+    static QTextBlock findOpeningBlock(const QTextBlock &block, ParenthesesKind kind, int *depth);
+
     static TextBlockUserData *testUserData(const QTextBlock &block) {
         return static_cast<TextBlockUserData*>(block.userData());
     }
@@ -232,6 +237,14 @@ public:
     void emitDocumentSizeChanged() { emit documentSizeChanged(documentSize()); }
     int lastSaveRevision;
     bool hasMarks;
+
+protected:
+    void documentChanged(int from, int charsRemoved, int charsAdded);
+
+private:
+    static Internal::TextBlockNestingIndex *nestingIndex(const QTextBlock &block);
+
+    Internal::TextBlockNestingIndex *m_nestingIndex;
 };
 
 
@@ -604,6 +617,9 @@ private:
 private slots:
     void _q_matchParentheses();
     void _q_highlightBlocks();
+    void _q_highlightVisibleBlocks();
+    void _q_largeFileChanged();
+    void _q_loadingFinished();
     void slotSelectionChanged();
     void _q_animateUpdate(int position, QPointF lastPos, QRectF rect);
 };
@@ -161,6 +161,12 @@ public:
     QByteArray m_tempState;
     QByteArray m_tempNavigationState;
 
+    // Positions requested while the document is still loading,
+    // applied once it is done.
+    QByteArray m_pendingState;
+    int m_pendingLine;
+    int m_pendingColumn;
+
     QString m_displayName;
     bool m_parenthesesMatchingEnabled;
     bool m_autoParenthesesEnabled;
@@ -245,6 +251,13 @@ public:
     QPointer<BaseTextEditorAnimator> m_animator;
     int m_cursorBlockNumber;
 
+    // large file mode, see _q_highlightVisibleBlocks()
+    QTimer *m_visibleBlocksHighlightTimer;
+    QTextDocument *m_visibleBlocksDocument;
+    int m_highlightedFirstBlockNumber;
+    int m_highlightedLastBlockNumber;
+    int m_highlightedRevision;
+
 };
 
 } // namespace Internal
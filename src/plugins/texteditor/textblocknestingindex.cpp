@@ -0,0 +1,426 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+#include "textblocknestingindex.h"
+
+#include <QtCore/QList>
+#include <QtGui/QTextDocument>
+
+using namespace TextEditor;
+using namespace TextEditor::Internal;
+
+namespace {
+
+typedef TextBlockNestingIndex::Excess Excess;
+
+inline bool isBlockParenthesis(QChar c)
+{
+    return c == QLatin1Char('{') || c == QLatin1Char('}')
+        || c == QLatin1Char('+') || c == QLatin1Char('-')
+        || c == QLatin1Char('[') || c == QLatin1Char(']');
+}
+
+inline Excess combine(const Excess &left, const Excess &right)
+{
+    const int matched = qMin(left.opened, right.closed);
+    Excess e;
+    e.closed = left.closed + right.closed - matched;
+    e.opened = left.opened + right.opened - matched;
+    return e;
+}
+
+} // anonymous namespace
+
+TextBlockNestingIndex::TextBlockNestingIndex(QTextDocument *document)
+    : m_document(document),
+      m_root(0)
+{
+}
+
+TextBlockNestingIndex::~TextBlockNestingIndex()
+{
+    destroy(m_root);
+}
+
+Excess TextBlockNestingIndex::excess(const QTextBlock &block,
+                                     TextEditDocumentLayout::ParenthesesKind kind)
+{
+    Excess e;
+    const TextBlockUserData *userData = TextEditDocumentLayout::testUserData(block);
+    if (!userData || userData->ifdefedOut())
+        return e;
+
+    const Parentheses &parentheses = userData->parentheses();
+    for (int i = 0; i < parentheses.size(); ++i) {
+        const Parenthesis &paren = parentheses.at(i);
+        if (kind == TextEditDocumentLayout::BlockParentheses && !isBlockParenthesis(paren.chr))
+            continue;
+        if (paren.type == Parenthesis::Opened)
+            ++e.opened;
+        else if (e.opened > 0)
+            --e.opened;
+        else
+            ++e.closed;
+    }
+    return e;
+}
+
+void TextBlockNestingIndex::documentChanged(int from, int charsAdded)
+{
+    if (!m_root)
+        return; // the next query reads the whole document anyway
+
+    const QTextBlock first = m_document->findBlock(from);
+    QTextBlock last = m_document->findBlock(from + charsAdded);
+    if (!last.isValid())
+        last = m_document->lastBlock();
+
+    const int firstNumber = first.blockNumber();
+    const int delta = m_document->blockCount() - m_root->size;
+
+    if (!first.isValid() || firstNumber + 1 > m_root->size) {
+        destroy(m_root);
+        m_root = 0;
+        m_dirtyNodes.clear();
+        return;
+    }
+
+    // The blocks that got split off or merged into the first changed block
+    // are the ones after it.
+    if (delta > 0) {
+        Node *before;
+        Node *after;
+        split(m_root, firstNumber + 1, &before, &after);
+        Node *inserted = build(delta);
+        m_root = merge(merge(before, inserted), after);
+    } else if (delta < 0) {
+        Node *before;
+        Node *rest;
+        Node *removed;
+        Node *after;
+        split(m_root, firstNumber + 1, &before, &rest);
+        split(rest, -delta, &removed, &after);
+        destroy(removed);
+        m_root = merge(before, after);
+    }
+
+    const int lastNumber = qMin(qMax(last.blockNumber(), firstNumber + delta),
+                                size(m_root) - 1);
+    for (int i = firstNumber; i <= lastNumber; ++i)
+        markDirty(nodeAt(i));
+}
+
+void TextBlockNestingIndex::invalidate(const QTextBlock &block)
+{
+    const int blockNumber = block.blockNumber();
+    if (m_root && blockNumber >= 0 && blockNumber < m_root->size)
+        markDirty(nodeAt(blockNumber));
+}
+
+void TextBlockNestingIndex::markDirty(Node *node)
+{
+    if (!node->dirty) {
+        node->dirty = true;
+        m_dirtyNodes.insert(node);
+    }
+}
+
+void TextBlockNestingIndex::readNode(Node *node)
+{
+    const QTextBlock block = m_document->findBlockByNumber(blockNumber(node));
+    node->block[TextEditDocumentLayout::AllParentheses]
+            = excess(block, TextEditDocumentLayout::AllParentheses);
+    node->block[TextEditDocumentLayout::BlockParentheses]
+            = excess(block, TextEditDocumentLayout::BlockParentheses);
+    node->dirty = false;
+    for (; node; node = node->parent)
+        updateNode(node);
+}
+
+void TextBlockNestingIndex::update()
+{
+    if (!m_root || m_root->size != m_document->blockCount()) {
+        rebuild();
+        return;
+    }
+
+    foreach (Node *node, m_dirtyNodes)
+        readNode(node);
+    m_dirtyNodes.clear();
+}
+
+void TextBlockNestingIndex::rebuild()
+{
+    destroy(m_root);
+    m_dirtyNodes.clear();
+    m_root = build(m_document->blockCount());
+
+    // In order, reading the blocks one after another
+    Node *node = m_root;
+    while (node->left)
+        node = node->left;
+    for (QTextBlock block = m_document->begin(); block.isValid() && node; block = block.next()) {
+        for (int kind = 0; kind < 2; ++kind)
+            node->block[kind] = excess(block, TextEditDocumentLayout::ParenthesesKind(kind));
+        if (node->right) {
+            node = node->right;
+            while (node->left)
+                node = node->left;
+        } else {
+            while (node->parent && node->parent->right == node)
+                node = node->parent;
+            node = node->parent;
+        }
+    }
+
+    // Children before parents
+    QList<Node *> stack;
+    QList<Node *> postOrder;
+    stack.append(m_root);
+    while (!stack.isEmpty()) {
+        Node *n = stack.takeLast();
+        postOrder.append(n);
+        if (n->left)
+            stack.append(n->left);
+        if (n->right)
+            stack.append(n->right);
+    }
+    for (int i = postOrder.size() - 1; i >= 0; --i)
+        updateNode(postOrder.at(i));
+}
+
+void TextBlockNestingIndex::updateNode(Node *node)
+{
+    node->size = 1 + size(node->left) + size(node->right);
+    for (int kind = 0; kind < 2; ++kind) {
+        Excess e = node->block[kind];
+        if (node->left)
+            e = combine(node->left->subtree[kind], e);
+        if (node->right)
+            e = combine(e, node->right->subtree[kind]);
+        node->subtree[kind] = e;
+    }
+    if (node->left)
+        node->left->parent = node;
+    if (node->right)
+        node->right->parent = node;
+}
+
+// Builds a tree of count empty nodes in O(count), keeping the heap order
+// of the priorities along the right spine.
+TextBlockNestingIndex::Node *TextBlockNestingIndex::build(int count)
+{
+    QList<Node *> spine;
+    for (int i = 0; i < count; ++i) {
+        Node *node = new Node;
+        Node *last = 0;
+        while (!spine.isEmpty() && spine.last()->priority < node->priority) {
+            last = spine.takeLast();
+            updateNode(last);
+        }
+        node->left = last;
+        if (!spine.isEmpty())
+            spine.last()->right = node;
+        spine.append(node);
+    }
+    while (spine.size() > 1)
+        updateNode(spine.takeLast());
+    if (spine.isEmpty())
+        return 0;
+    Node *root = spine.first();
+    updateNode(root);
+    root->parent = 0;
+    return root;
+}
+
+// Splits off the first count blocks.
+void TextBlockNestingIndex::split(Node *node, int count, Node **left, Node **right)
+{
+    if (!node) {
+        *left = *right = 0;
+        return;
+    }
+    if (size(node->left) < count) {
+        split(node->right, count - size(node->left) - 1, &node->right, right);
+        *left = node;
+    } else {
+        split(node->left, count, left, &node->left);
+        *right = node;
+    }
+    updateNode(node);
+    node->parent = 0;
+    if (*left)
+        (*left)->parent = 0;
+    if (*right)
+        (*right)->parent = 0;
+}
+
+TextBlockNestingIndex::Node *TextBlockNestingIndex::merge(Node *left, Node *right)
+{
+    if (!left)
+        return right;
+    if (!right)
+        return left;
+    if (left->priority > right->priority) {
+        left->right = merge(left->right, right);
+        updateNode(left);
+        left->parent = 0;
+        return left;
+    }
+    right->left = merge(left, right->left);
+    updateNode(right);
+    right->parent = 0;
+    return right;
+}
+
+void TextBlockNestingIndex::destroy(Node *node)
+{
+    if (!node)
+        return;
+    destroy(node->left);
+    destroy(node->right);
+    m_dirtyNodes.remove(node);
+    delete node;
+}
+
+TextBlockNestingIndex::Node *TextBlockNestingIndex::nodeAt(int blockNumber) const
+{
+    Node *node = m_root;
+    while (node) {
+        const int leftSize = size(node->left);
+        if (blockNumber < leftSize) {
+            node = node->left;
+        } else if (blockNumber == leftSize) {
+            return node;
+        } else {
+            blockNumber -= leftSize + 1;
+            node = node->right;
+        }
+    }
+    return 0;
+}
+
+int TextBlockNestingIndex::blockNumber(const Node *node)
+{
+    int number = size(node->left);
+    for (; node->parent; node = node->parent) {
+        if (node->parent->right == node)
+            number += size(node->parent->left) + 1;
+    }
+    return number;
+}
+
+int TextBlockNestingIndex::findForward(const Node *node, int offset, int from, int kind, int *depth) const
+{
+    if (!node || offset + node->size <= from)
+        return -1;
+
+    const Excess &e = node->subtree[kind];
+    if (offset >= from && e.closed < *depth) {
+        // the whole subtree is skipped
+        *depth += e.opened - e.closed;
+        return -1;
+    }
+
+    const int result = findForward(node->left, offset, from, kind, depth);
+    if (result != -1)
+        return result;
+
+    const int position = offset + size(node->left);
+    if (position >= from) {
+        const Excess &b = node->block[kind];
+        if (b.closed >= *depth)
+            return position;
+        *depth += b.opened - b.closed;
+    }
+    return findForward(node->right, position + 1, from, kind, depth);
+}
+
+int TextBlockNestingIndex::findBackward(const Node *node, int offset, int to, int kind, int *depth) const
+{
+    if (!node || offset > to)
+        return -1;
+
+    const Excess &e = node->subtree[kind];
+    if (offset + node->size - 1 <= to && e.opened < *depth) {
+        *depth += e.closed - e.opened;
+        return -1;
+    }
+
+    const int position = offset + size(node->left);
+    const int result = findBackward(node->right, position + 1, to, kind, depth);
+    if (result != -1)
+        return result;
+
+    if (position <= to) {
+        const Excess &b = node->block[kind];
+        if (b.opened >= *depth)
+            return position;
+        *depth += b.closed - b.opened;
+    }
+    return findBackward(node->left, offset, to, kind, depth);
+}
+
+/*
+ * Returns the first block after \a block that closes \a depth opened
+ * parentheses, and sets \a depth to the number of parentheses still open
+ * when entering that block.
+ */
+QTextBlock TextBlockNestingIndex::findClosingBlock(const QTextBlock &block,
+                                                   TextEditDocumentLayout::ParenthesesKind kind,
+                                                   int *depth)
+{
+    update();
+
+    const int blockNumber = findForward(m_root, 0, block.blockNumber() + 1, kind, depth);
+    if (blockNumber == -1)
+        return QTextBlock();
+    return m_document->findBlockByNumber(blockNumber);
+}
+
+/*
+ * Returns the first block before \a block that opens \a depth closed
+ * parentheses, and sets \a depth to the number of parentheses still closed
+ * when entering that block from its end.
+ */
+QTextBlock TextBlockNestingIndex::findOpeningBlock(const QTextBlock &block,
+                                                   TextEditDocumentLayout::ParenthesesKind kind,
+                                                   int *depth)
+{
+    update();
+
+    const int to = block.blockNumber() - 1;
+    if (to < 0)
+        return QTextBlock();
+
+    const int blockNumber = findBackward(m_root, 0, to, kind, depth);
+    if (blockNumber == -1)
+        return QTextBlock();
+    return m_document->findBlockByNumber(blockNumber);
+}
@@ -0,0 +1,125 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+#ifndef TEXTBLOCKNESTINGINDEX_H
+#define TEXTBLOCKNESTINGINDEX_H
+
+#include "basetexteditor.h"
+
+#include <QtCore/QSet>
+#include <QtGui/QTextBlock>
+
+namespace TextEditor {
+namespace Internal {
+
+/*
+ * Per document index of the parentheses nesting, used for brace matching,
+ * block highlighting and folding.
+ *
+ * Every block is summarized by the number of closing parentheses it leaves
+ * unmatched at its start and the number of opening parentheses it leaves
+ * unmatched at its end. The summaries are kept in a balanced binary tree
+ * (a treap) ordered by block position, where each node also summarizes its
+ * subtree. The block that matches a given nesting depth is found in
+ * O(log n) instead of walking all blocks in between, and inserting or
+ * removing blocks costs O(log n) as well, since block numbers are implied
+ * by the subtree sizes rather than stored.
+ *
+ * The highlighters store the parentheses in the block user data at any
+ * time, so changed blocks are only marked dirty and re-read on the next
+ * query.
+ */
+class TextBlockNestingIndex
+{
+public:
+    TextBlockNestingIndex(QTextDocument *document);
+    ~TextBlockNestingIndex();
+
+    void documentChanged(int from, int charsAdded);
+    void invalidate(const QTextBlock &block);
+
+    QTextBlock findClosingBlock(const QTextBlock &block,
+                                TextEditDocumentLayout::ParenthesesKind kind, int *depth);
+    QTextBlock findOpeningBlock(const QTextBlock &block,
+                                TextEditDocumentLayout::ParenthesesKind kind, int *depth);
+
+    struct Excess
+    {
+        Excess() : closed(0), opened(0) {}
+
+        int closed;
+        int opened;
+    };
+
+    static Excess excess(const QTextBlock &block, TextEditDocumentLayout::ParenthesesKind kind);
+
+private:
+    Q_DISABLE_COPY(TextBlockNestingIndex)
+
+    struct Node
+    {
+        Node() : left(0), right(0), parent(0), priority(qrand()), size(1), dirty(false) {}
+
+        Node *left;
+        Node *right;
+        Node *parent;
+        int priority;
+        int size;
+        bool dirty;
+        Excess block[2];    // this block
+        Excess subtree[2];  // all blocks of the subtree, in order
+    };
+
+    void update();
+    void rebuild();
+    void markDirty(Node *node);
+    void readNode(Node *node);
+
+    static int size(const Node *node) { return node ? node->size : 0; }
+    static void updateNode(Node *node);
+    static Node *build(int count);
+    static void split(Node *node, int count, Node **left, Node **right);
+    static Node *merge(Node *left, Node *right);
+    void destroy(Node *node);
+    Node *nodeAt(int blockNumber) const;
+    static int blockNumber(const Node *node);
+
+    int findForward(const Node *node, int offset, int from, int kind, int *depth) const;
+    int findBackward(const Node *node, int offset, int to, int kind, int *depth) const;
+
+private:
+    QTextDocument *m_document;
+    Node *m_root;
+    QSet<Node *> m_dirtyNodes;
+};
+
+} // namespace Internal
+} // namespace TextEditor
+
+#endif // TEXTBLOCKNESTINGINDEX_H
@@ -20,6 +20,7 @@ SOURCES += texteditorplugin.cpp \
     displaysettingspage.cpp \
     fontsettings.cpp \
     textblockiterator.cpp \
+    textblocknestingindex.cpp \
     linenumberfilter.cpp \
     basetextmark.cpp \
     findinfiles.cpp \
@@ -50,6 +51,7 @@ HEADERS += texteditorplugin.h \
     displaysettingspage.h \
     fontsettings.h \
     textblockiterator.h \
+    textblocknestingindex.h \
     itexteditable.h \
     itexteditor.h \
     linenumberfilter.h \
@@ -64,6 +64,7 @@ const char * const SELECT_ENCODING       = "TextEditor.SelectEncoding";
 const char * const REWRAP_PARAGRAPH       =  "TextEditor.RewrapParagraph";
 const char * const GOTO_OPENING_PARENTHESIS = "TextEditor.GotoOpeningParenthesis";
 const char * const GOTO_CLOSING_PARENTHESIS = "TextEditor.GotoClosingParenthesis";
+const char * const TASK_OPEN_FILE        = "TextEditor.Task.OpenFile";
 const char * const C_TEXTEDITOR_MIMETYPE_TEXT = "text/plain";
 const char * const C_TEXTEDITOR_MIMETYPE_XML = "application/xml";
 
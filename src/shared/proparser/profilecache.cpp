@@ -0,0 +1,205 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+
+#include "profilecache.h"
+#include "proitems.h"
+
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QStringList>
+
+QT_BEGIN_NAMESPACE
+
+static void refFunctions(const QHash<QString, ProBlock *> &blocks)
+{
+    foreach (ProBlock *itm, blocks)
+        itm->ref();
+}
+
+static void derefFunctions(const QHash<QString, ProBlock *> &blocks)
+{
+    foreach (ProBlock *itm, blocks)
+        itm->deref();
+}
+
+ProFileCache::ProFileCache()
+{
+}
+
+ProFileCache::~ProFileCache()
+{
+    clear();
+}
+
+ProFile *ProFileCache::proFile(const QString &fileName, const QDateTime &modified)
+{
+    QMutexLocker locker(&m_mutex);
+    QHash<QString, ProFileEntry>::iterator it = m_proFiles.find(fileName);
+    if (it == m_proFiles.end())
+        return 0;
+    if (it->modified != modified) {
+        it->proFile->deref();
+        m_proFiles.erase(it);
+        return 0;
+    }
+    it->proFile->ref();
+    return it->proFile;
+}
+
+void ProFileCache::addProFile(ProFile *pro, const QDateTime &modified)
+{
+    QMutexLocker locker(&m_mutex);
+    // Another thread might have parsed the same file meanwhile
+    if (m_proFiles.contains(pro->fileName()))
+        return;
+    ProFileEntry entry;
+    entry.proFile = pro;
+    entry.modified = modified;
+    pro->ref();
+    m_proFiles.insert(pro->fileName(), entry);
+}
+
+QString ProFileCache::baseValuesKey(const ProFileEvaluator::Option &option,
+                                    const QString &cacheFile)
+{
+    QString key = option.qmakespec;
+    key += QLatin1Char('\n');
+    key += cacheFile;
+    key += QLatin1Char('\n');
+    key += QString::number(option.target_mode);
+    QStringList properties = option.properties.keys();
+    properties.sort();
+    foreach (const QString &property, properties) {
+        key += QLatin1Char('\n');
+        key += property;
+        key += QLatin1Char('=');
+        key += option.properties.value(property);
+    }
+    return key;
+}
+
+bool ProFileCache::baseValues(const QString &key, ProFileEvaluator::Option *option)
+{
+    QMutexLocker locker(&m_mutex);
+    QHash<QString, BaseValuesEntry>::iterator it = m_baseValues.find(key);
+    if (it == m_baseValues.end())
+        return false;
+    if (!isUpToDate(*it)) {
+        releaseEntry(*it);
+        m_baseValues.erase(it);
+        return false;
+    }
+    option->base_valuemap = it->valuemap;
+    option->base_functions = it->functions;
+    refFunctions(option->base_functions.testFunctions);
+    refFunctions(option->base_functions.replaceFunctions);
+    option->qmakespec = it->qmakespec;
+    option->cachefile = it->cachefile;
+    return true;
+}
+
+void ProFileCache::addBaseValues(const QString &key, const ProFileEvaluator::Option &option)
+{
+    BaseValuesEntry entry;
+    entry.valuemap = option.base_valuemap;
+    entry.functions = option.base_functions;
+    entry.qmakespec = option.qmakespec;
+    entry.cachefile = option.cachefile;
+    QStringList dependencies;
+    if (!option.qmakespec.isEmpty())
+        dependencies.append(option.qmakespec + QLatin1String("/qmake.conf"));
+    if (!option.cachefile.isEmpty())
+        dependencies.append(option.cachefile);
+    foreach (const QString &fileName, dependencies)
+        entry.dependencies.append(qMakePair(fileName, QFileInfo(fileName).lastModified()));
+
+    QMutexLocker locker(&m_mutex);
+    if (m_baseValues.contains(key))
+        return;
+    refFunctions(entry.functions.testFunctions);
+    refFunctions(entry.functions.replaceFunctions);
+    m_baseValues.insert(key, entry);
+}
+
+void ProFileCache::discardFile(const QString &fileName)
+{
+    QMutexLocker locker(&m_mutex);
+    QHash<QString, ProFileEntry>::iterator it = m_proFiles.find(fileName);
+    if (it != m_proFiles.end()) {
+        it->proFile->deref();
+        m_proFiles.erase(it);
+    }
+
+    QHash<QString, BaseValuesEntry>::iterator bit = m_baseValues.begin();
+    while (bit != m_baseValues.end()) {
+        bool depends = false;
+        for (int i = 0; i < bit->dependencies.size(); ++i) {
+            if (bit->dependencies.at(i).first == fileName) {
+                depends = true;
+                break;
+            }
+        }
+        if (depends) {
+            releaseEntry(*bit);
+            bit = m_baseValues.erase(bit);
+        } else {
+            ++bit;
+        }
+    }
+}
+
+void ProFileCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    foreach (const ProFileEntry &entry, m_proFiles)
+        entry.proFile->deref();
+    m_proFiles.clear();
+    foreach (const BaseValuesEntry &entry, m_baseValues)
+        releaseEntry(entry);
+    m_baseValues.clear();
+}
+
+bool ProFileCache::isUpToDate(const BaseValuesEntry &entry)
+{
+    for (int i = 0; i < entry.dependencies.size(); ++i) {
+        const QPair<QString, QDateTime> &dependency = entry.dependencies.at(i);
+        if (QFileInfo(dependency.first).lastModified() != dependency.second)
+            return false;
+    }
+    return true;
+}
+
+void ProFileCache::releaseEntry(const BaseValuesEntry &entry)
+{
+    derefFunctions(entry.functions.testFunctions);
+    derefFunctions(entry.functions.replaceFunctions);
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,94 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+
+#ifndef PROFILECACHE_H
+#define PROFILECACHE_H
+
+#include "profileevaluator.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QPair>
+#include <QtCore/QString>
+
+QT_BEGIN_NAMESPACE
+
+class ProFile;
+
+// Process wide cache of parsed ProFiles and of the values every evaluation
+// starts with (qmake.conf, .qmake.cache and default_pre.prf). Parsed files
+// are validated against their modification time on each lookup.
+// All functions are thread-safe.
+class ProFileCache
+{
+public:
+    ProFileCache();
+    ~ProFileCache();
+
+    // Returns a referenced ProFile or 0, the caller has to deref() it.
+    ProFile *proFile(const QString &fileName, const QDateTime &modified);
+    void addProFile(ProFile *pro, const QDateTime &modified);
+
+    static QString baseValuesKey(const ProFileEvaluator::Option &option, const QString &cacheFile);
+    bool baseValues(const QString &key, ProFileEvaluator::Option *option);
+    void addBaseValues(const QString &key, const ProFileEvaluator::Option &option);
+
+    void discardFile(const QString &fileName);
+    void clear();
+
+private:
+    Q_DISABLE_COPY(ProFileCache)
+
+    struct ProFileEntry {
+        ProFile *proFile;
+        QDateTime modified;
+    };
+
+    struct BaseValuesEntry {
+        QHash<QString, QStringList> valuemap;
+        ProFileEvaluator::FunctionDefs functions;
+        QString qmakespec;
+        QString cachefile;
+        QList<QPair<QString, QDateTime> > dependencies;
+    };
+
+    static bool isUpToDate(const BaseValuesEntry &entry);
+    static void releaseEntry(const BaseValuesEntry &entry);
+
+    QMutex m_mutex;
+    QHash<QString, ProFileEntry> m_proFiles;
+    QHash<QString, BaseValuesEntry> m_baseValues;
+};
+
+QT_END_NAMESPACE
+
+#endif // PROFILECACHE_H
@@ -28,8 +28,10 @@
 **************************************************************************/
 
 #include "profileevaluator.h"
+#include "profilecache.h"
 #include "proitems.h"
 
+#include <QtCore/QAtomicInt>
 #include <QtCore/QByteArray>
 #include <QtCore/QDateTime>
 #include <QtCore/QDebug>
@@ -37,12 +39,14 @@
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QList>
+#include <QtCore/QPair>
 #include <QtCore/QRegExp>
 #include <QtCore/QSet>
 #include <QtCore/QStack>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
 #include <QtCore/QTextStream>
+#include <QtCore/QVector>
 
 #ifdef Q_OS_UNIX
 #include <unistd.h>
@@ -82,6 +86,222 @@ static void clearFunctions(ProFileEvaluator::FunctionDefs *defs)
     clearFunctions(&defs->testFunctions);
 }
 
+enum ExpandFunc { E_MEMBER=1, E_FIRST, E_LAST, E_CAT, E_FROMFILE, E_EVAL, E_LIST,
+                  E_SPRINTF, E_JOIN, E_SPLIT, E_BASENAME, E_DIRNAME, E_SECTION,
+                  E_FIND, E_SYSTEM, E_UNIQUE, E_QUOTE, E_ESCAPE_EXPAND,
+                  E_UPPER, E_LOWER, E_FILES, E_PROMPT, E_RE_ESCAPE,
+                  E_REPLACE };
+
+enum TestFunc { T_REQUIRES=1, T_GREATERTHAN, T_LESSTHAN, T_EQUALS,
+                T_EXISTS, T_EXPORT, T_CLEAR, T_UNSET, T_EVAL, T_CONFIG, T_SYSTEM,
+                T_RETURN, T_BREAK, T_NEXT, T_DEFINED, T_CONTAINS, T_INFILE,
+                T_COUNT, T_ISEMPTY, T_INCLUDE, T_LOAD, T_DEBUG, T_MESSAGE, T_IF,
+                T_FOR, T_DEFINE_TEST, T_DEFINE_REPLACE };
+
+enum BuiltinVariable { V_LITERAL_WHITESPACE=1, V_LITERAL_DOLLAR, V_LITERAL_HASH, V_OUT_PWD,
+                       V_PWD, V_DIR_SEPARATOR, V_DIRLIST_SEPARATOR, V_LINE, V_FILE, V_DATE,
+                       V_PRO_FILE, V_PRO_FILE_PWD, V_QMAKE_CACHE };
+
+// Evaluators may run in several threads at once, so the function tables
+// are filled when the first Option is created instead of on first use.
+static QHash<QString, int> expandFunctions;
+static QHash<QString, int> testFunctions;
+static QHash<QString, int> builtinVariables;
+static QAtomicInt listVariableCounter;
+
+static void initFunctionTables()
+{
+    if (!expandFunctions.isEmpty())
+        return;
+    expandFunctions.insert(QLatin1String("member"), E_MEMBER);
+    expandFunctions.insert(QLatin1String("first"), E_FIRST);
+    expandFunctions.insert(QLatin1String("last"), E_LAST);
+    expandFunctions.insert(QLatin1String("cat"), E_CAT);
+    expandFunctions.insert(QLatin1String("fromfile"), E_FROMFILE);
+    expandFunctions.insert(QLatin1String("eval"), E_EVAL);
+    expandFunctions.insert(QLatin1String("list"), E_LIST);
+    expandFunctions.insert(QLatin1String("sprintf"), E_SPRINTF);
+    expandFunctions.insert(QLatin1String("join"), E_JOIN);
+    expandFunctions.insert(QLatin1String("split"), E_SPLIT);
+    expandFunctions.insert(QLatin1String("basename"), E_BASENAME);
+    expandFunctions.insert(QLatin1String("dirname"), E_DIRNAME);
+    expandFunctions.insert(QLatin1String("section"), E_SECTION);
+    expandFunctions.insert(QLatin1String("find"), E_FIND);
+    expandFunctions.insert(QLatin1String("system"), E_SYSTEM);
+    expandFunctions.insert(QLatin1String("unique"), E_UNIQUE);
+    expandFunctions.insert(QLatin1String("quote"), E_QUOTE);
+    expandFunctions.insert(QLatin1String("escape_expand"), E_ESCAPE_EXPAND);
+    expandFunctions.insert(QLatin1String("upper"), E_UPPER);
+    expandFunctions.insert(QLatin1String("lower"), E_LOWER);
+    expandFunctions.insert(QLatin1String("re_escape"), E_RE_ESCAPE);
+    expandFunctions.insert(QLatin1String("files"), E_FILES);
+    expandFunctions.insert(QLatin1String("prompt"), E_PROMPT); // interactive, so cannot be implemented
+    expandFunctions.insert(QLatin1String("replace"), E_REPLACE);
+    testFunctions.insert(QLatin1String("requires"), T_REQUIRES);
+    testFunctions.insert(QLatin1String("greaterThan"), T_GREATERTHAN);
+    testFunctions.insert(QLatin1String("lessThan"), T_LESSTHAN);
+    testFunctions.insert(QLatin1String("equals"), T_EQUALS);
+    testFunctions.insert(QLatin1String("isEqual"), T_EQUALS);
+    testFunctions.insert(QLatin1String("exists"), T_EXISTS);
+    testFunctions.insert(QLatin1String("export"), T_EXPORT);
+    testFunctions.insert(QLatin1String("clear"), T_CLEAR);
+    testFunctions.insert(QLatin1String("unset"), T_UNSET);
+    testFunctions.insert(QLatin1String("eval"), T_EVAL);
+    testFunctions.insert(QLatin1String("CONFIG"), T_CONFIG);
+    testFunctions.insert(QLatin1String("if"), T_IF);
+    testFunctions.insert(QLatin1String("isActiveConfig"), T_CONFIG);
+    testFunctions.insert(QLatin1String("system"), T_SYSTEM);
+    testFunctions.insert(QLatin1String("return"), T_RETURN);
+    testFunctions.insert(QLatin1String("break"), T_BREAK);
+    testFunctions.insert(QLatin1String("next"), T_NEXT);
+    testFunctions.insert(QLatin1String("defined"), T_DEFINED);
+    testFunctions.insert(QLatin1String("contains"), T_CONTAINS);
+    testFunctions.insert(QLatin1String("infile"), T_INFILE);
+    testFunctions.insert(QLatin1String("count"), T_COUNT);
+    testFunctions.insert(QLatin1String("isEmpty"), T_ISEMPTY);
+    testFunctions.insert(QLatin1String("load"), T_LOAD);         //v
+    testFunctions.insert(QLatin1String("include"), T_INCLUDE);   //v
+    testFunctions.insert(QLatin1String("debug"), T_DEBUG);
+    testFunctions.insert(QLatin1String("message"), T_MESSAGE);   //v
+    testFunctions.insert(QLatin1String("warning"), T_MESSAGE);   //v
+    testFunctions.insert(QLatin1String("error"), T_MESSAGE);     //v
+    testFunctions.insert(QLatin1String("for"), T_FOR);     //v
+    testFunctions.insert(QLatin1String("defineTest"), T_DEFINE_TEST);        //v
+    testFunctions.insert(QLatin1String("defineReplace"), T_DEFINE_REPLACE);  //v
+    builtinVariables.insert(QLatin1String("LITERAL_WHITESPACE"), V_LITERAL_WHITESPACE);
+    builtinVariables.insert(QLatin1String("LITERAL_DOLLAR"), V_LITERAL_DOLLAR);
+    builtinVariables.insert(QLatin1String("LITERAL_HASH"), V_LITERAL_HASH);
+    builtinVariables.insert(QLatin1String("OUT_PWD"), V_OUT_PWD);
+    builtinVariables.insert(QLatin1String("PWD"), V_PWD);
+    builtinVariables.insert(QLatin1String("IN_PWD"), V_PWD);
+    builtinVariables.insert(QLatin1String("DIR_SEPARATOR"), V_DIR_SEPARATOR);
+    builtinVariables.insert(QLatin1String("DIRLIST_SEPARATOR"), V_DIRLIST_SEPARATOR);
+    builtinVariables.insert(QLatin1String("_LINE_"), V_LINE);
+    builtinVariables.insert(QLatin1String("_FILE_"), V_FILE);
+    builtinVariables.insert(QLatin1String("_DATE_"), V_DATE);
+    builtinVariables.insert(QLatin1String("_PRO_FILE_"), V_PRO_FILE);
+    builtinVariables.insert(QLatin1String("_PRO_FILE_PWD_"), V_PRO_FILE_PWD);
+    builtinVariables.insert(QLatin1String("_QMAKE_CACHE_"), V_QMAKE_CACHE);
+}
+
+///////////////////////////////////////////////////////////////////////
+//
+// ProValueMap
+//
+///////////////////////////////////////////////////////////////////////
+
+// The variables of an evaluation. Calling a function opens a new scope which
+// shares all values with the calling scope and stores only the variables the
+// function modifies, so function calls don't copy the whole map. The values
+// per include file are kept the same way, keyed by file and variable.
+template <typename Key>
+class ProScopedValues
+{
+public:
+    typedef QHash<Key, QStringList> Hash;
+
+    ProScopedValues() : m_scopes(1) {}
+    ProScopedValues(const Hash &values) : m_scopes(1)
+        { m_scopes.first().values = values; }
+
+    QStringList value(const Key &name) const;
+    bool contains(const Key &name) const { return find(name) != 0; }
+    QStringList &operator[](const Key &name);
+    bool remove(const Key &name);
+    void exportValue(const Key &name);
+
+    void pushScope() { m_scopes.resize(m_scopes.size() + 1); }
+    void popScope() { m_scopes.resize(m_scopes.size() - 1); }
+    int scopeCount() const { return m_scopes.size(); }
+
+    Hash toHash() const;
+
+private:
+    struct Scope {
+        Hash values;
+        QSet<Key> removed; // Variables unset in this scope
+    };
+
+    const QStringList *find(const Key &name) const;
+
+    QVector<Scope> m_scopes;
+};
+
+typedef ProScopedValues<QString> ProValueMap;
+typedef ProScopedValues<QPair<const ProFile *, QString> > ProFileValueMap;
+
+template <typename Key>
+const QStringList *ProScopedValues<Key>::find(const Key &name) const
+{
+    for (int i = m_scopes.size() - 1; i >= 0; --i) {
+        const Scope &scope = m_scopes.at(i);
+        typename Hash::const_iterator it = scope.values.constFind(name);
+        if (it != scope.values.constEnd())
+            return &it.value();
+        if (scope.removed.contains(name))
+            return 0;
+    }
+    return 0;
+}
+
+template <typename Key>
+QStringList ProScopedValues<Key>::value(const Key &name) const
+{
+    if (const QStringList *values = find(name))
+        return *values;
+    return QStringList();
+}
+
+template <typename Key>
+QStringList &ProScopedValues<Key>::operator[](const Key &name)
+{
+    Scope &top = m_scopes.last();
+    typename Hash::iterator it = top.values.find(name);
+    if (it != top.values.end())
+        return it.value();
+    // Copy the value of the calling scope on first write
+    const QStringList inherited = value(name);
+    top.removed.remove(name);
+    return top.values.insert(name, inherited).value();
+}
+
+template <typename Key>
+bool ProScopedValues<Key>::remove(const Key &name)
+{
+    if (!contains(name))
+        return false;
+    Scope &top = m_scopes.last();
+    top.values.remove(name);
+    if (m_scopes.size() > 1)
+        top.removed.insert(name);
+    return true;
+}
+
+template <typename Key>
+void ProScopedValues<Key>::exportValue(const Key &name)
+{
+    const QStringList values = value(name);
+    for (int i = 0; i < m_scopes.size(); ++i) {
+        m_scopes[i].values.insert(name, values);
+        m_scopes[i].removed.remove(name);
+    }
+}
+
+template <typename Key>
+typename ProScopedValues<Key>::Hash ProScopedValues<Key>::toHash() const
+{
+    Hash values = m_scopes.first().values;
+    for (int i = 1; i < m_scopes.size(); ++i) {
+        const Scope &scope = m_scopes.at(i);
+        foreach (const Key &name, scope.removed)
+            values.remove(name);
+        typename Hash::const_iterator it = scope.values.constBegin();
+        for (; it != scope.values.constEnd(); ++it)
+            values.insert(it.key(), it.value());
+    }
+    return values;
+}
+
 
 ///////////////////////////////////////////////////////////////////////
 //
@@ -110,7 +330,11 @@ ProFileEvaluator::Option::Option()
     target_mode = TARG_UNIX_MODE;
 #endif
 
-    field_sep = QLatin1String(" ");
+    cache = 0;
+
+    if (field_sep.isEmpty())
+        field_sep = QLatin1String(" ");
+    initFunctionTables();
 }
 
 ProFileEvaluator::Option::~Option()
@@ -175,11 +399,11 @@ public:
     void visitProOperator(ProOperator *oper);
     void visitProCondition(ProCondition *condition);
 
-    QStringList valuesDirect(const QString &variableName) const { return m_valuemap[variableName]; }
+    QStringList valuesDirect(const QString &variableName) const { return m_valuemap.value(variableName); }
     QStringList values(const QString &variableName) const;
     QStringList values(const QString &variableName, const ProFile *pro) const;
-    QStringList values(const QString &variableName, const QHash<QString, QStringList> &place,
-                       const ProFile *pro) const;
+    bool builtinValues(const QString &variableName, const ProFile *pro, QStringList *result) const;
+    QStringList withDefaultValues(const QString &variableName, const QStringList &values) const;
     QString propertyValue(const QString &val, bool complain = true) const;
 
     QStringList split_value_list(const QString &vals, bool do_semicolon = false);
@@ -195,9 +419,12 @@ public:
 
     QString currentFileName() const;
     QString currentDirectory() const;
+    QString resolvePath(const QString &fileName) const;
     ProFile *currentProFile() const;
 
     ProItem::ProItemReturn evaluateConditionalFunction(const QString &function, const QString &arguments);
+    void evaluateBaseValues(const QString &qmake_cache);
+    ProFile *parseFile(const QString &fileName);
     bool evaluateFile(const QString &fileName);
     bool evaluateFeatureFile(const QString &fileName,
                              QHash<QString, QStringList> *values = 0, FunctionDefs *defs = 0);
@@ -222,7 +449,6 @@ public:
     bool m_hadCondition; // Nested calls set it on return, so no need for it to be in State
     int m_skipLevel;
     bool m_cumulative;
-    QStack<QString> m_oldPathStack;                 // To restore the current path to the path
     QStack<ProFile*> m_profileStack;                // To handle 'include(a.pri), so we can track back to 'a.pro' when finished with 'a.pri'
     struct ProLoop {
         QString variable;
@@ -233,16 +459,14 @@ public:
     };
     QStack<ProLoop> m_loopStack;
 
-    QHash<QString, QStringList> m_valuemap;         // VariableName must be us-ascii, the content however can be non-us-ascii.
-    QHash<const ProFile*, QHash<QString, QStringList> > m_filevaluemap; // Variables per include file
+    ProValueMap m_valuemap;                         // VariableName must be us-ascii, the content however can be non-us-ascii.
+    ProFileValueMap m_filevaluemap;                 // Variables per include file
     QString m_outputDir;
 
     bool m_definingTest;
     QString m_definingFunc;
     FunctionDefs m_functionDefs;
     QStringList m_returnValue;
-    QStack<QHash<QString, QStringList> > m_valuemapStack;
-    QStack<QHash<const ProFile*, QHash<QString, QStringList> > > m_filevaluemapStack;
 
     QStringList m_addUserConfigCmdArgs;
     QStringList m_removeUserConfigCmdArgs;
@@ -840,21 +1064,17 @@ QStringList ProFileEvaluator::Private::split_value_list(const QString &vals, boo
     return ret;
 }
 
-static void insertUnique(QHash<QString, QStringList> *map,
-    const QString &key, const QStringList &value)
+static void insertUnique(QStringList *varlist, const QStringList &value)
 {
-    QStringList &sl = (*map)[key];
     foreach (const QString &str, value)
-        if (!sl.contains(str))
-            sl.append(str);
+        if (!varlist->contains(str))
+            varlist->append(str);
 }
 
-static void removeEach(QHash<QString, QStringList> *map,
-    const QString &key, const QStringList &value)
+static void removeEach(QStringList *varlist, const QStringList &value)
 {
-    QStringList &sl = (*map)[key];
     foreach (const QString &str, value)
-        sl.removeAll(str);
+        varlist->removeAll(str);
 }
 
 static void replaceInList(QStringList *varlist,
@@ -1010,31 +1230,31 @@ void ProFileEvaluator::Private::visitEndProVariable(ProVariable *variable)
             if (!m_cumulative) {
                 if (!m_skipLevel) {
                     m_valuemap[varName] = m_sts.varVal;
-                    m_filevaluemap[currentProFile()][varName] = m_sts.varVal;
+                    m_filevaluemap[qMakePair(currentProFile(), varName)] = m_sts.varVal;
                 }
             } else {
                 // We are greedy for values.
                 m_valuemap[varName] += m_sts.varVal;
-                m_filevaluemap[currentProFile()][varName] += m_sts.varVal;
+                m_filevaluemap[qMakePair(currentProFile(), varName)] += m_sts.varVal;
             }
             break;
         case ProVariable::UniqueAddOperator:    // *=
             if (!m_skipLevel || m_cumulative) {
-                insertUnique(&m_valuemap, varName, m_sts.varVal);
-                insertUnique(&m_filevaluemap[currentProFile()], varName, m_sts.varVal);
+                insertUnique(&m_valuemap[varName], m_sts.varVal);
+                insertUnique(&m_filevaluemap[qMakePair(currentProFile(), varName)], m_sts.varVal);
             }
             break;
         case ProVariable::AddOperator:          // +=
             if (!m_skipLevel || m_cumulative) {
                 m_valuemap[varName] += m_sts.varVal;
-                m_filevaluemap[currentProFile()][varName] += m_sts.varVal;
+                m_filevaluemap[qMakePair(currentProFile(), varName)] += m_sts.varVal;
             }
             break;
         case ProVariable::RemoveOperator:       // -=
             if (!m_cumulative) {
                 if (!m_skipLevel) {
-                    removeEach(&m_valuemap, varName, m_sts.varVal);
-                    removeEach(&m_filevaluemap[currentProFile()], varName, m_sts.varVal);
+                    removeEach(&m_valuemap[varName], m_sts.varVal);
+                    removeEach(&m_filevaluemap[qMakePair(currentProFile(), varName)], m_sts.varVal);
                 }
             } else {
                 // We are stingy with our values, too.
@@ -1074,7 +1294,7 @@ void ProFileEvaluator::Private::visitEndProVariable(ProVariable *variable)
                     // We could make a union of modified and unmodified values,
                     // but this will break just as much as it fixes, so leave it as is.
                     replaceInList(&m_valuemap[varName], regexp, replace, global);
-                    replaceInList(&m_filevaluemap[currentProFile()][varName], regexp, replace, global);
+                    replaceInList(&m_filevaluemap[qMakePair(currentProFile(), varName)], regexp, replace, global);
 
                 }
             }
@@ -1102,15 +1322,84 @@ void ProFileEvaluator::Private::visitProCondition(ProCondition *cond)
     m_invertNext = false;
 }
 
+// Evaluates qmake.conf, .qmake.cache and default_pre.prf into the option's base values
+void ProFileEvaluator::Private::evaluateBaseValues(const QString &qmake_cache)
+{
+    if (!qmake_cache.isEmpty()) {
+        QHash<QString, QStringList> cache_valuemap;
+        if (evaluateFileInto(qmake_cache, &cache_valuemap, 0)) {
+            m_option->cachefile = qmake_cache;
+            if (m_option->qmakespec.isEmpty()) {
+                const QStringList &vals = cache_valuemap.value(QLatin1String("QMAKESPEC"));
+                if (!vals.isEmpty())
+                    m_option->qmakespec = vals.first();
+            }
+        }
+    }
+
+    QStringList mkspec_roots = qmakeMkspecPaths();
+
+    QString qmakespec = expandEnvVars(m_option->qmakespec);
+    if (qmakespec.isEmpty()) {
+        foreach (const QString &root, mkspec_roots) {
+            QString mkspec = root + QLatin1String("/default");
+            QFileInfo default_info(mkspec);
+            if (default_info.exists() && default_info.isDir()) {
+                qmakespec = mkspec;
+                break;
+            }
+        }
+        if (qmakespec.isEmpty()) {
+            errorMessage(format("Could not find qmake configuration directory"));
+            // Unlike in qmake, not finding the spec is not critical ...
+        }
+    }
+
+    if (QDir::isRelativePath(qmakespec)) {
+        if (QFile::exists(resolvePath(qmakespec) + QLatin1String("/qmake.conf"))) {
+            qmakespec = resolvePath(qmakespec);
+        } else if (!m_outputDir.isEmpty()
+                   && QFile::exists(m_outputDir + QLatin1Char('/') + qmakespec
+                                    + QLatin1String("/qmake.conf"))) {
+            qmakespec = m_outputDir + QLatin1Char('/') + qmakespec;
+        } else {
+            foreach (const QString &root, mkspec_roots) {
+                QString mkspec = root + QLatin1Char('/') + qmakespec;
+                if (QFile::exists(mkspec)) {
+                    qmakespec = mkspec;
+                    goto cool;
+                }
+            }
+            errorMessage(format("Could not find qmake configuration file"));
+            // Unlike in qmake, a missing config is not critical ...
+            qmakespec.clear();
+          cool: ;
+        }
+    }
+
+    if (!qmakespec.isEmpty()) {
+        m_option->qmakespec = QDir::cleanPath(qmakespec);
+
+        QString spec = m_option->qmakespec + QLatin1String("/qmake.conf");
+        if (!evaluateFileInto(spec,
+                              &m_option->base_valuemap, &m_option->base_functions)) {
+            errorMessage(format("Could not read qmake configuration file %1").arg(spec));
+        } else if (!m_option->cachefile.isEmpty()) {
+            evaluateFileInto(m_option->cachefile,
+                             &m_option->base_valuemap, &m_option->base_functions);
+        }
+    }
+
+    evaluateFeatureFile(QLatin1String("default_pre.prf"),
+                        &m_option->base_valuemap, &m_option->base_functions);
+}
+
 ProItem::ProItemReturn ProFileEvaluator::Private::visitBeginProFile(ProFile * pro)
 {
     m_lineNo = pro->lineNumber();
 
-    m_oldPathStack.push(QDir::currentPath());
-    if (!QDir::setCurrent(pro->directoryName())) {
-        m_oldPathStack.pop();
+    if (!QFileInfo(pro->directoryName()).isDir())
         return ProItem::ReturnFalse;
-    }
 
     m_profileStack.push(pro);
     if (m_profileStack.count() == 1) {
@@ -1138,74 +1427,22 @@ ProItem::ProItemReturn ProFileEvaluator::Private::visitBeginProFile(ProFile * pr
                         }
                     }
                 }
-                if (!qmake_cache.isEmpty()) {
+                if (!qmake_cache.isEmpty())
                     qmake_cache = QDir::cleanPath(qmake_cache);
-                    QHash<QString, QStringList> cache_valuemap;
-                    if (evaluateFileInto(qmake_cache, &cache_valuemap, 0)) {
-                        m_option->cachefile = qmake_cache;
-                        if (m_option->qmakespec.isEmpty()) {
-                            const QStringList &vals = cache_valuemap.value(QLatin1String("QMAKESPEC"));
-                            if (!vals.isEmpty())
-                                m_option->qmakespec = vals.first();
-                        }
-                    }
-                }
 
-                QStringList mkspec_roots = qmakeMkspecPaths();
-
-                QString qmakespec = expandEnvVars(m_option->qmakespec);
-                if (qmakespec.isEmpty()) {
-                    foreach (const QString &root, mkspec_roots) {
-                        QString mkspec = root + QLatin1String("/default");
-                        QFileInfo default_info(mkspec);
-                        if (default_info.exists() && default_info.isDir()) {
-                            qmakespec = mkspec;
-                            break;
-                        }
-                    }
-                    if (qmakespec.isEmpty()) {
-                        errorMessage(format("Could not find qmake configuration directory"));
-                        // Unlike in qmake, not finding the spec is not critical ...
-                    }
+                // All subprojects sharing a spec and .qmake.cache start from the same values
+                ProFileCache *cache = m_option->cache;
+                // ... unless the spec is relative to the evaluated file
+                if (!m_option->qmakespec.isEmpty()
+                    && QDir::isRelativePath(expandEnvVars(m_option->qmakespec)))
+                    cache = 0;
+                const QString baseKey = cache
+                        ? ProFileCache::baseValuesKey(*m_option, qmake_cache) : QString();
+                if (!cache || !cache->baseValues(baseKey, m_option)) {
+                    evaluateBaseValues(qmake_cache);
+                    if (cache)
+                        cache->addBaseValues(baseKey, *m_option);
                 }
-
-                if (QDir::isRelativePath(qmakespec)) {
-                    if (QFile::exists(qmakespec + QLatin1String("/qmake.conf"))) {
-                        qmakespec = QFileInfo(qmakespec).absoluteFilePath();
-                    } else if (!m_outputDir.isEmpty()
-                               && QFile::exists(m_outputDir + QLatin1Char('/') + qmakespec
-                                                + QLatin1String("/qmake.conf"))) {
-                        qmakespec = m_outputDir + QLatin1Char('/') + qmakespec;
-                    } else {
-                        foreach (const QString &root, mkspec_roots) {
-                            QString mkspec = root + QLatin1Char('/') + qmakespec;
-                            if (QFile::exists(mkspec)) {
-                                qmakespec = mkspec;
-                                goto cool;
-                            }
-                        }
-                        errorMessage(format("Could not find qmake configuration file"));
-                        // Unlike in qmake, a missing config is not critical ...
-                        qmakespec.clear();
-                      cool: ;
-                    }
-                }
-
-                if (!qmakespec.isEmpty()) {
-                    m_option->qmakespec = QDir::cleanPath(qmakespec);
-
-                    QString spec = m_option->qmakespec + QLatin1String("/qmake.conf");
-                    if (!evaluateFileInto(spec,
-                                          &m_option->base_valuemap, &m_option->base_functions)) {
-                        errorMessage(format("Could not read qmake configuration file %1").arg(spec));
-                    } else if (!m_option->cachefile.isEmpty()) {
-                        evaluateFileInto(m_option->cachefile,
-                                         &m_option->base_valuemap, &m_option->base_functions);
-                    }
-                }
-
-                evaluateFeatureFile(QLatin1String("default_pre.prf"),
-                                    &m_option->base_valuemap, &m_option->base_functions);
             }
 
             m_valuemap = m_option->base_valuemap;
@@ -1258,7 +1495,7 @@ ProItem::ProItemReturn ProFileEvaluator::Private::visitEndProFile(ProFile * pro)
     }
     m_profileStack.pop();
 
-    return returnBool(QDir::setCurrent(m_oldPathStack.pop()));
+    return ProItem::ReturnTrue;
 }
 
 void ProFileEvaluator::Private::visitProValue(ProValue *value)
@@ -1429,6 +1666,16 @@ QString ProFileEvaluator::Private::currentDirectory() const
     return cur->directoryName();
 }
 
+// Relative paths are taken relative to the file being evaluated. The
+// process' working directory is left alone, so that several evaluators
+// can run at the same time.
+QString ProFileEvaluator::Private::resolvePath(const QString &fileName) const
+{
+    if (fileName.isEmpty() || QDir::isAbsolutePath(fileName) || m_profileStack.isEmpty())
+        return fileName;
+    return QDir::cleanPath(currentDirectory() + QLatin1Char('/') + fileName);
+}
+
 void ProFileEvaluator::Private::doVariableReplace(QString *str)
 {
     *str = expandVariableReferences(*str).join(Option::field_sep);
@@ -1684,13 +1931,13 @@ QStringList ProFileEvaluator::Private::evaluateFunction(
     bool oki;
     QStringList ret;
 
-    if (m_valuemapStack.count() >= 100) {
+    if (m_valuemap.scopeCount() > 100) {
         errorMessage(format("ran into infinite recursion (depth > 100)."));
         oki = false;
     } else {
         State sts = m_sts;
-        m_valuemapStack.push(m_valuemap);
-        m_filevaluemapStack.push(m_filevaluemap);
+        m_valuemap.pushScope();
+        m_filevaluemap.pushScope();
 
         QStringList args;
         for (int i = 0; i < argumentsList.count(); ++i) {
@@ -1702,8 +1949,8 @@ QStringList ProFileEvaluator::Private::evaluateFunction(
         ret = m_returnValue;
         m_returnValue.clear();
 
-        m_valuemap = m_valuemapStack.pop();
-        m_filevaluemap = m_filevaluemapStack.pop();
+        m_valuemap.popScope();
+        m_filevaluemap.popScope();
         m_sts = sts;
     }
     if (ok)
@@ -1724,40 +1971,7 @@ QStringList ProFileEvaluator::Private::evaluateExpandFunction(const QString &fun
     foreach (const QStringList &arg, args_list)
         args += arg.join(Option::field_sep);
 
-    enum ExpandFunc { E_MEMBER=1, E_FIRST, E_LAST, E_CAT, E_FROMFILE, E_EVAL, E_LIST,
-                      E_SPRINTF, E_JOIN, E_SPLIT, E_BASENAME, E_DIRNAME, E_SECTION,
-                      E_FIND, E_SYSTEM, E_UNIQUE, E_QUOTE, E_ESCAPE_EXPAND,
-                      E_UPPER, E_LOWER, E_FILES, E_PROMPT, E_RE_ESCAPE,
-                      E_REPLACE };
-
-    static QHash<QString, int> expands;
-    if (expands.isEmpty()) {
-        expands.insert(QLatin1String("member"), E_MEMBER);
-        expands.insert(QLatin1String("first"), E_FIRST);
-        expands.insert(QLatin1String("last"), E_LAST);
-        expands.insert(QLatin1String("cat"), E_CAT);
-        expands.insert(QLatin1String("fromfile"), E_FROMFILE);
-        expands.insert(QLatin1String("eval"), E_EVAL);
-        expands.insert(QLatin1String("list"), E_LIST);
-        expands.insert(QLatin1String("sprintf"), E_SPRINTF);
-        expands.insert(QLatin1String("join"), E_JOIN);
-        expands.insert(QLatin1String("split"), E_SPLIT);
-        expands.insert(QLatin1String("basename"), E_BASENAME);
-        expands.insert(QLatin1String("dirname"), E_DIRNAME);
-        expands.insert(QLatin1String("section"), E_SECTION);
-        expands.insert(QLatin1String("find"), E_FIND);
-        expands.insert(QLatin1String("system"), E_SYSTEM);
-        expands.insert(QLatin1String("unique"), E_UNIQUE);
-        expands.insert(QLatin1String("quote"), E_QUOTE);
-        expands.insert(QLatin1String("escape_expand"), E_ESCAPE_EXPAND);
-        expands.insert(QLatin1String("upper"), E_UPPER);
-        expands.insert(QLatin1String("lower"), E_LOWER);
-        expands.insert(QLatin1String("re_escape"), E_RE_ESCAPE);
-        expands.insert(QLatin1String("files"), E_FILES);
-        expands.insert(QLatin1String("prompt"), E_PROMPT); // interactive, so cannot be implemented
-        expands.insert(QLatin1String("replace"), E_REPLACE);
-    }
-    ExpandFunc func_t = ExpandFunc(expands.value(func.toLower()));
+    ExpandFunc func_t = ExpandFunc(expandFunctions.value(func.toLower()));
 
     QStringList ret;
 
@@ -1912,7 +2126,7 @@ QStringList ProFileEvaluator::Private::evaluateExpandFunction(const QString &fun
                 if (args.count() > 1)
                     singleLine = (!args[1].compare(QLatin1String("true"), Qt::CaseInsensitive));
 
-                QFile qfile(file);
+                QFile qfile(resolvePath(file));
                 if (qfile.open(QIODevice::ReadOnly)) {
                     QTextStream stream(&qfile);
                     while (!stream.atEnd()) {
@@ -1929,7 +2143,7 @@ QStringList ProFileEvaluator::Private::evaluateExpandFunction(const QString &fun
                 logMessage(format("fromfile(file, variable) requires two arguments."));
             } else {
                 QHash<QString, QStringList> vars;
-                if (evaluateFileInto(args.at(0), &vars, 0))
+                if (evaluateFileInto(resolvePath(args.at(0)), &vars, 0))
                     ret = vars.value(args.at(1));
             }
             break;
@@ -1941,9 +2155,9 @@ QStringList ProFileEvaluator::Private::evaluateExpandFunction(const QString &fun
             }
             break;
         case E_LIST: {
-            static int x = 0;
             QString tmp;
-            tmp.sprintf(".QMAKE_INTERNAL_TMP_variableName_%d", x++);
+            tmp.sprintf(".QMAKE_INTERNAL_TMP_variableName_%d",
+                        listVariableCounter.fetchAndAddRelaxed(1));
             ret = QStringList(tmp);
             QStringList lst;
             foreach (const QString &arg, args)
@@ -1966,7 +2180,18 @@ QStringList ProFileEvaluator::Private::evaluateExpandFunction(const QString &fun
                     logMessage(format("system(execute) requires one or two arguments."));
                 } else {
                     char buff[256];
-                    FILE *proc = QT_POPEN(args[0].toLatin1(), "r");
+                    // Run the command where qmake would run it.
+#ifdef Q_OS_WIN
+                    const QString command = QLatin1String("cd /d \"")
+                        + QDir::toNativeSeparators(currentDirectory())
+                        + QLatin1String("\" && ") + args[0];
+#else
+                    QString directory = currentDirectory();
+                    directory.replace(QLatin1Char('\''), QLatin1String("'\\''"));
+                    const QString command = QLatin1String("cd '") + directory
+                        + QLatin1String("' && ") + args[0];
+#endif
+                    FILE *proc = QT_POPEN(command.toLatin1(), "r");
                     bool singleLine = true;
                     if (args.count() > 1)
                         singleLine = (!args[1].compare(QLatin1String("true"), Qt::CaseInsensitive));
@@ -2068,12 +2293,12 @@ QStringList ProFileEvaluator::Private::evaluateExpandFunction(const QString &fun
                     if (!dir.isEmpty() && !dir.endsWith(m_option->dir_sep))
                         dir += QLatin1Char('/');
 
-                    QDir qdir(dir);
+                    QDir qdir(dir.isEmpty() ? currentDirectory() : resolvePath(dir));
                     for (int i = 0; i < (int)qdir.count(); ++i) {
                         if (qdir[i] == QLatin1String(".") || qdir[i] == QLatin1String(".."))
                             continue;
                         QString fname = dir + qdir[i];
-                        if (QFileInfo(fname).isDir()) {
+                        if (QFileInfo(resolvePath(fname)).isDir()) {
                             if (recursive)
                                 dirs.append(fname);
                         }
@@ -2140,48 +2365,7 @@ ProItem::ProItemReturn ProFileEvaluator::Private::evaluateConditionalFunction(
     foreach (const QStringList &arg, args_list)
         args += arg.join(Option::field_sep);
 
-    enum TestFunc { T_REQUIRES=1, T_GREATERTHAN, T_LESSTHAN, T_EQUALS,
-                    T_EXISTS, T_EXPORT, T_CLEAR, T_UNSET, T_EVAL, T_CONFIG, T_SYSTEM,
-                    T_RETURN, T_BREAK, T_NEXT, T_DEFINED, T_CONTAINS, T_INFILE,
-                    T_COUNT, T_ISEMPTY, T_INCLUDE, T_LOAD, T_DEBUG, T_MESSAGE, T_IF,
-                    T_FOR, T_DEFINE_TEST, T_DEFINE_REPLACE };
-
-    static QHash<QString, int> functions;
-    if (functions.isEmpty()) {
-        functions.insert(QLatin1String("requires"), T_REQUIRES);
-        functions.insert(QLatin1String("greaterThan"), T_GREATERTHAN);
-        functions.insert(QLatin1String("lessThan"), T_LESSTHAN);
-        functions.insert(QLatin1String("equals"), T_EQUALS);
-        functions.insert(QLatin1String("isEqual"), T_EQUALS);
-        functions.insert(QLatin1String("exists"), T_EXISTS);
-        functions.insert(QLatin1String("export"), T_EXPORT);
-        functions.insert(QLatin1String("clear"), T_CLEAR);
-        functions.insert(QLatin1String("unset"), T_UNSET);
-        functions.insert(QLatin1String("eval"), T_EVAL);
-        functions.insert(QLatin1String("CONFIG"), T_CONFIG);
-        functions.insert(QLatin1String("if"), T_IF);
-        functions.insert(QLatin1String("isActiveConfig"), T_CONFIG);
-        functions.insert(QLatin1String("system"), T_SYSTEM);
-        functions.insert(QLatin1String("return"), T_RETURN);
-        functions.insert(QLatin1String("break"), T_BREAK);
-        functions.insert(QLatin1String("next"), T_NEXT);
-        functions.insert(QLatin1String("defined"), T_DEFINED);
-        functions.insert(QLatin1String("contains"), T_CONTAINS);
-        functions.insert(QLatin1String("infile"), T_INFILE);
-        functions.insert(QLatin1String("count"), T_COUNT);
-        functions.insert(QLatin1String("isEmpty"), T_ISEMPTY);
-        functions.insert(QLatin1String("load"), T_LOAD);         //v
-        functions.insert(QLatin1String("include"), T_INCLUDE);   //v
-        functions.insert(QLatin1String("debug"), T_DEBUG);
-        functions.insert(QLatin1String("message"), T_MESSAGE);   //v
-        functions.insert(QLatin1String("warning"), T_MESSAGE);   //v
-        functions.insert(QLatin1String("error"), T_MESSAGE);     //v
-        functions.insert(QLatin1String("for"), T_FOR);     //v
-        functions.insert(QLatin1String("defineTest"), T_DEFINE_TEST);        //v
-        functions.insert(QLatin1String("defineReplace"), T_DEFINE_REPLACE);  //v
-    }
-
-    TestFunc func_t = (TestFunc)functions.value(function);
+    TestFunc func_t = (TestFunc)testFunctions.value(function);
 
     switch (func_t) {
         case T_DEFINE_TEST:
@@ -2219,7 +2403,7 @@ ProItem::ProItemReturn ProFileEvaluator::Private::evaluateConditionalFunction(
             // they cannot be used to terminate loops anyway.
             if (m_skipLevel || m_cumulative)
                 return ProItem::ReturnTrue;
-            if (m_valuemapStack.isEmpty()) {
+            if (m_valuemap.scopeCount() == 1) {
                 logMessage(format("unexpected return()."));
                 return ProItem::ReturnFalse;
             }
@@ -2231,18 +2415,15 @@ ProItem::ProItemReturn ProFileEvaluator::Private::evaluateConditionalFunction(
                 logMessage(format("export(variable) requires one argument."));
                 return ProItem::ReturnFalse;
             }
-            for (int i = 0; i < m_valuemapStack.size(); ++i) {
-                m_valuemapStack[i][args[0]] = m_valuemap.value(args[0]);
-                m_filevaluemapStack[i][currentProFile()][args[0]] =
-                        m_filevaluemap.value(currentProFile()).value(args[0]);
-            }
+            m_valuemap.exportValue(args[0]);
+            m_filevaluemap.exportValue(qMakePair(currentProFile(), args[0]));
             return ProItem::ReturnTrue;
         case T_INFILE:
             if (args.count() < 2 || args.count() > 3) {
                 logMessage(format("infile(file, var, [values]) requires two or three arguments."));
             } else {
                 QHash<QString, QStringList> vars;
-                if (!evaluateFileInto(args.at(0), &vars, 0))
+                if (!evaluateFileInto(resolvePath(args.at(0)), &vars, 0))
                     return ProItem::ReturnFalse;
                 if (args.count() == 2)
                     return returnBool(vars.contains(args.at(1)));
@@ -2525,10 +2706,9 @@ ProItem::ProItemReturn ProFileEvaluator::Private::evaluateConditionalFunction(
                 logMessage(format("%1(variable) requires one argument.").arg(function));
                 return ProItem::ReturnFalse;
             }
-            QHash<QString, QStringList>::Iterator it = m_valuemap.find(args[0]);
-            if (it == m_valuemap.end())
+            if (!m_valuemap.contains(args[0]))
                 return ProItem::ReturnFalse;
-            it->clear();
+            m_valuemap[args[0]].clear();
             return ProItem::ReturnTrue;
         }
         case T_UNSET: {
@@ -2538,11 +2718,7 @@ ProItem::ProItemReturn ProFileEvaluator::Private::evaluateConditionalFunction(
                 logMessage(format("%1(variable) requires one argument.").arg(function));
                 return ProItem::ReturnFalse;
             }
-            QHash<QString, QStringList>::Iterator it = m_valuemap.find(args[0]);
-            if (it == m_valuemap.end())
-                return ProItem::ReturnFalse;
-            m_valuemap.erase(it);
-            return ProItem::ReturnTrue;
+            return returnBool(m_valuemap.remove(args[0]));
         }
         case T_INCLUDE: {
             if (m_skipLevel && !m_cumulative)
@@ -2625,14 +2801,14 @@ ProItem::ProItemReturn ProFileEvaluator::Private::evaluateConditionalFunction(
             QString file = args.first();
             file = fixPathToLocalOS(file);
 
-            if (QFile::exists(file)) {
+            if (QFile::exists(resolvePath(file))) {
                 return ProItem::ReturnTrue;
             }
             //regular expression I guess
             QString dirstr = currentDirectory();
             int slsh = file.lastIndexOf(m_option->dir_sep);
             if (slsh != -1) {
-                dirstr = file.left(slsh+1);
+                dirstr = resolvePath(file.left(slsh+1));
                 file = file.right(file.length() - slsh - 1);
             }
             if (file.contains(QLatin1Char('*')) || file.contains(QLatin1Char('?')))
@@ -2650,37 +2826,53 @@ ProItem::ProItemReturn ProFileEvaluator::Private::evaluateConditionalFunction(
     }
 }
 
-QStringList ProFileEvaluator::Private::values(const QString &variableName,
-                                              const QHash<QString, QStringList> &place,
-                                              const ProFile *pro) const
-{
-    if (variableName == QLatin1String("LITERAL_WHITESPACE")) //a real space in a token
-        return QStringList(QLatin1String("\t"));
-    if (variableName == QLatin1String("LITERAL_DOLLAR")) //a real $
-        return QStringList(QLatin1String("$"));
-    if (variableName == QLatin1String("LITERAL_HASH")) //a real #
-        return QStringList(QLatin1String("#"));
-    if (variableName == QLatin1String("OUT_PWD")) //the out going dir
-        return QStringList(m_outputDir);
-    if (variableName == QLatin1String("PWD") ||  //current working dir (of _FILE_)
-        variableName == QLatin1String("IN_PWD"))
-        return QStringList(currentDirectory());
-    if (variableName == QLatin1String("DIR_SEPARATOR"))
-        return QStringList(m_option->dir_sep);
-    if (variableName == QLatin1String("DIRLIST_SEPARATOR"))
-        return QStringList(m_option->dirlist_sep);
-    if (variableName == QLatin1String("_LINE_")) //parser line number
-        return QStringList(QString::number(m_lineNo));
-    if (variableName == QLatin1String("_FILE_")) //parser file; qmake is a bit weird here
-        return QStringList(m_profileStack.size() == 1 ? pro->fileName() : QFileInfo(pro->fileName()).fileName());
-    if (variableName == QLatin1String("_DATE_")) //current date/time
-        return QStringList(QDateTime::currentDateTime().toString());
-    if (variableName == QLatin1String("_PRO_FILE_"))
-        return QStringList(m_profileStack.first()->fileName());
-    if (variableName == QLatin1String("_PRO_FILE_PWD_"))
-        return  QStringList(QFileInfo(m_profileStack.first()->fileName()).absolutePath());
-    if (variableName == QLatin1String("_QMAKE_CACHE_"))
-        return QStringList(m_option->cachefile);
+// Returns true if variableName is a variable the evaluator provides itself
+bool ProFileEvaluator::Private::builtinValues(const QString &variableName, const ProFile *pro,
+                                              QStringList *result) const
+{
+    switch (builtinVariables.value(variableName)) {
+    case V_LITERAL_WHITESPACE: //a real space in a token
+        *result = QStringList(QLatin1String("\t"));
+        return true;
+    case V_LITERAL_DOLLAR: //a real $
+        *result = QStringList(QLatin1String("$"));
+        return true;
+    case V_LITERAL_HASH: //a real #
+        *result = QStringList(QLatin1String("#"));
+        return true;
+    case V_OUT_PWD: //the out going dir
+        *result = QStringList(m_outputDir);
+        return true;
+    case V_PWD: //current working dir (of _FILE_)
+        *result = QStringList(currentDirectory());
+        return true;
+    case V_DIR_SEPARATOR:
+        *result = QStringList(m_option->dir_sep);
+        return true;
+    case V_DIRLIST_SEPARATOR:
+        *result = QStringList(m_option->dirlist_sep);
+        return true;
+    case V_LINE: //parser line number
+        *result = QStringList(QString::number(m_lineNo));
+        return true;
+    case V_FILE: //parser file; qmake is a bit weird here
+        *result = QStringList(m_profileStack.size() == 1 ? pro->fileName() : QFileInfo(pro->fileName()).fileName());
+        return true;
+    case V_DATE: //current date/time
+        *result = QStringList(QDateTime::currentDateTime().toString());
+        return true;
+    case V_PRO_FILE:
+        *result = QStringList(m_profileStack.first()->fileName());
+        return true;
+    case V_PRO_FILE_PWD:
+        *result = QStringList(QFileInfo(m_profileStack.first()->fileName()).absolutePath());
+        return true;
+    case V_QMAKE_CACHE:
+        *result = QStringList(m_option->cachefile);
+        return true;
+    default:
+        break;
+    }
     if (variableName.startsWith(QLatin1String("QMAKE_HOST."))) {
         QString ret, type = variableName.mid(11);
 #if defined(Q_OS_WIN32)
@@ -2751,10 +2943,16 @@ QStringList ProFileEvaluator::Private::values(const QString &variableName,
                 ret = QString::fromLatin1(name.machine);
         }
 #endif
-        return QStringList(ret);
+        *result = QStringList(ret);
+        return true;
     }
+    return false;
+}
 
-    QStringList result = place.value(variableName);
+QStringList ProFileEvaluator::Private::withDefaultValues(const QString &variableName,
+                                                         const QStringList &values) const
+{
+    QStringList result = values;
     if (result.isEmpty()) {
         if (variableName == QLatin1String("TEMPLATE")) {
             result.append(QLatin1String("app"));
@@ -2767,33 +2965,56 @@ QStringList ProFileEvaluator::Private::values(const QString &variableName,
 
 QStringList ProFileEvaluator::Private::values(const QString &variableName) const
 {
-    return values(variableName, m_valuemap, currentProFile());
+    QStringList result;
+    if (builtinValues(variableName, currentProFile(), &result))
+        return result;
+    return withDefaultValues(variableName, m_valuemap.value(variableName));
 }
 
 QStringList ProFileEvaluator::Private::values(const QString &variableName, const ProFile *pro) const
 {
-    return values(variableName, m_filevaluemap[pro], pro);
+    QStringList result;
+    if (builtinValues(variableName, pro, &result))
+        return result;
+    return withDefaultValues(variableName, m_filevaluemap.value(qMakePair(pro, variableName)));
 }
 
 // virtual
 ProFile *ProFileEvaluator::parsedProFile(const QString &fileName)
 {
-    ProFile *pro = new ProFile(fileName);
-    if (d->read(pro))
-        return pro;
-    delete pro;
-    return 0;
+    return d->parseFile(fileName);
 }
 
 // virtual
 void ProFileEvaluator::releaseParsedProFile(ProFile *proFile)
 {
-    delete proFile;
+    proFile->deref();
+}
+
+// Returns a referenced ProFile, shared with other evaluations if there is a cache
+ProFile *ProFileEvaluator::Private::parseFile(const QString &fileName)
+{
+    ProFileCache *cache = m_option->cache;
+    QDateTime modified;
+    if (cache) {
+        modified = QFileInfo(fileName).lastModified();
+        if (ProFile *pro = cache->proFile(fileName, modified))
+            return pro;
+    }
+
+    ProFile *pro = new ProFile(fileName);
+    if (!read(pro)) {
+        delete pro;
+        return 0;
+    }
+    if (cache)
+        cache->addProFile(pro, modified);
+    return pro;
 }
 
 bool ProFileEvaluator::Private::evaluateFile(const QString &fileName)
 {
-    QFileInfo fi(fileName);
+    QFileInfo fi(resolvePath(fileName));
     if (!fi.exists())
         return false;
     QString fn = QDir::cleanPath(fi.absoluteFilePath());
@@ -2819,7 +3040,7 @@ bool ProFileEvaluator::Private::evaluateFeatureFile(
     if (!fn.endsWith(QLatin1String(".prf")))
         fn += QLatin1String(".prf");
 
-    if (!fileName.contains((ushort)'/') || !QFile::exists(fn)) {
+    if (!fileName.contains((ushort)'/') || !QFile::exists(resolvePath(fn))) {
         if (m_option->feature_roots.isEmpty())
             m_option->feature_roots = qmakeFeaturePaths();
         int start_root = 0;
@@ -2847,7 +3068,7 @@ bool ProFileEvaluator::Private::evaluateFeatureFile(
             return true;
         already.append(fn);
     } else {
-        fn = QDir::cleanPath(fn);
+        fn = QDir::cleanPath(resolvePath(fn));
     }
 
     if (values) {
@@ -2858,10 +3079,11 @@ bool ProFileEvaluator::Private::evaluateFeatureFile(
 
         // Don't use evaluateFile() here to avoid the virtual parsedProFile().
         // The path is fully normalized already.
-        ProFile pro(fn);
         bool ok = false;
-        if (read(&pro))
-            ok = (pro.Accept(this) == ProItem::ReturnTrue);
+        if (ProFile *pro = parseFile(fn)) {
+            ok = (pro->Accept(this) == ProItem::ReturnTrue);
+            pro->deref();
+        }
 
         m_cumulative = cumulative;
         return ok;
@@ -2880,7 +3102,7 @@ bool ProFileEvaluator::Private::evaluateFileInto(
         visitor.d->m_functionDefs = *funcs;
     if (!visitor.d->evaluateFile(fileName))
         return false;
-    *values = visitor.d->m_valuemap;
+    *values = visitor.d->m_valuemap.toHash();
     if (funcs) {
         *funcs = visitor.d->m_functionDefs;
         // So they are not unref'd
@@ -40,6 +40,8 @@
 
 QT_BEGIN_NAMESPACE
 
+class ProFileCache;
+
 class ProFileEvaluator
 {
     class Private;
@@ -84,9 +86,12 @@ public:
         //QString pro_ext;
         //QString res_ext;
 
+        ProFileCache *cache; // Shared parsed files and base values, default is none
+
       private:
         friend class ProFileEvaluator;
         friend class ProFileEvaluator::Private;
+        friend class ProFileCache;
         static QString field_sep; // Just a cache for quick construction
         QHash<QString, QStringList> base_valuemap; // Cached results of qmake.conf, .qmake.cache & default_pre.prf
         FunctionDefs base_functions;
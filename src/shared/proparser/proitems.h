@@ -32,6 +32,7 @@
 
 #include <QtCore/QString>
 #include <QtCore/QList>
+#include <QtCore/QAtomicInt>
 
 QT_BEGIN_NAMESPACE
 
@@ -101,8 +102,9 @@ public:
     void setParent(ProBlock *parent);
     ProBlock *parent() const;
 
-    void ref() { ++m_refCount; }
-    void deref() { if (!--m_refCount) delete this; }
+    // Blocks are shared between evaluations running in different threads
+    void ref() { m_refCount.ref(); }
+    void deref() { if (!m_refCount.deref()) delete this; }
 
     ProItem::ProItemKind kind() const;
 
@@ -112,7 +114,7 @@ protected:
 private:
     ProBlock *m_parent;
     int m_blockKind;
-    int m_refCount;
+    QAtomicInt m_refCount;
 };
 
 class ProVariable : public ProBlock
@@ -10,6 +10,7 @@ HEADERS += \
         procommandmanager.h \
         proeditor.h \
         proeditormodel.h \
+        profilecache.h \
         profileevaluator.h \
         proiteminfo.h \
         proitems.h \
@@ -22,6 +23,7 @@ SOURCES += \
         procommandmanager.cpp \
         proeditor.cpp \
         proeditormodel.cpp \
+        profilecache.cpp \
         profileevaluator.cpp \
         proiteminfo.cpp \
         proitems.cpp \
@@ -3,6 +3,8 @@ TEMPLATE = subdirs
 SUBDIRS += \
     cplusplus \
     debugger \
+    directorycrawler \
     fakevim \
+    filechangewatcher \
 #    profilereader \
     aggregation
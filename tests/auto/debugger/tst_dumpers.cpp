@@ -145,6 +145,7 @@ private slots:
     void dumpQImageData();
     void dumpQLinkedList();
     void dumpQList_int();
+    void dumpQList_int_paged();
     void dumpQList_int_star();
     void dumpQList_char();
     void dumpQList_QString();
@@ -164,6 +165,7 @@ private slots:
     void dumpQPixmap();
     void dumpQSharedPointer();
     void dumpQString();
+    void dumpQString_checksum();
     void dumpQTextCodec();
     void dumpQVariant_invalid();
     void dumpQVariant_QString();
@@ -382,11 +384,12 @@ void tst_Debugger::niceType_data()
 
 static void testDumper(QByteArray expected0, const void *data, QByteArray outertype,
     bool dumpChildren, QByteArray innertype = "", QByteArray exp = "",
-    int extraInt0 = 0, int extraInt1 = 0, int extraInt2 = 0, int extraInt3 = 0)
+    int extraInt0 = 0, int extraInt1 = 0, int extraInt2 = 0, int extraInt3 = 0,
+    const char *childrenRange = "")
 {
-    sprintf(xDumpInBuffer, "%s%c%s%c%s%c%s%c%s%c",
+    sprintf(xDumpInBuffer, "%s%c%s%c%s%c%s%c%s%c%s%c",
         outertype.data(), 0, "iname", 0, exp.data(), 0,
-        innertype.data(), 0, "iname", 0);
+        innertype.data(), 0, "iname", 0, childrenRange, 0);
     //qDebug() << "FIXME qDumpObjectData440 signature to use const void *";
     void *res = qDumpObjectData440(2, 42, data, dumpChildren,
         extraInt0, extraInt1, extraInt2, extraInt3);
@@ -1400,6 +1403,22 @@ void tst_Debugger::dumpQList_int()
         &ilist, NS"QList", true, "int");
 }
 
+void tst_Debugger::dumpQList_int_paged()
+{
+    QList<int> ilist;
+    for (int i = 0; i != 5; ++i)
+        ilist.append(i);
+    testDumper("value='<5 items>',valueeditable='false',numchild='5',"
+        "internal='1',childrenoffset='2',childtype='int',childnumchild='0',children=["
+        "{addr='" + str(&ilist.at(2)) + "',value='2'},"
+        "{addr='" + str(&ilist.at(3)) + "',value='3'}]",
+        &ilist, NS"QList", true, "int", "", 0, 0, 0, 0, "2,2");
+    testDumper("value='<5 items>',valueeditable='false',numchild='5',"
+        "internal='1',childrenoffset='4',childtype='int',childnumchild='0',children=["
+        "{addr='" + str(&ilist.at(4)) + "',value='4'}]",
+        &ilist, NS"QList", true, "int", "", 0, 0, 0, 0, "4,1000");
+}
+
 void tst_Debugger::dumpQList_int_star()
 {
     QList<int *> ilist;
@@ -2268,6 +2287,32 @@ void tst_Debugger::dumpQString()
         &s, NS"QString", false);
 }
 
+// FNV-1a as used by the dumpers to report the inspected memory.
+static uint checksum(const void *p, int size, uint hash)
+{
+    const uchar *data = reinterpret_cast<const uchar *>(p);
+    for (int i = 0; i != size; ++i) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void tst_Debugger::dumpQString_checksum()
+{
+    QString s = "abc";
+    const int headerSize = 3 * sizeof(int);
+    uint hash = checksum(&s, sizeof(QString), 2166136261u);
+    hash = checksum(deref(&s), headerSize, hash);
+    hash = checksum(s.unicode(), 8, hash);
+    testDumper("value='YQBiAGMA',valueencoded='2',type='$T',numchild='0',"
+        "checksum='" + QByteArray::number(hash) + "',checkranges=["
+        "{addr='" + str(&s) + "',size='" + QByteArray::number(int(sizeof(QString))) + "'},"
+        "{addr='" + str(deref(&s)) + "',size='" + QByteArray::number(headerSize) + "'},"
+        "{addr='" + str(s.unicode()) + "',size='8'}]",
+        &s, NS"QString", false, "", "", 0, 0, 0, 0, "0,1000,1");
+}
+
 void tst_Debugger::dumpQVariant_invalid()
 {
     QVariant v;
@@ -0,0 +1,15 @@
+CONFIG += qtestlib
+TEMPLATE = app
+CONFIG -= app_bundle
+QT -= gui
+DEFINES += QTCREATOR_UTILS_LIB
+
+LIBS_PATH = ../../../src/libs
+
+INCLUDEPATH += $$LIBS_PATH
+# Input
+SOURCES += tst_directorycrawler.cpp \
+    $$LIBS_PATH/utils/directorycrawler.cpp
+HEADERS += $$LIBS_PATH/utils/directorycrawler.h
+
+TARGET=tst_$$TARGET
@@ -0,0 +1,243 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+#include <utils/directorycrawler.h>
+
+#include <QtTest/QtTest>
+
+#ifdef Q_OS_UNIX
+#  include <sys/types.h>
+#  include <utime.h>
+#  include <time.h>
+#endif
+
+using Utils::DirectoryCrawler;
+using Utils::DirectorySnapshot;
+
+class tst_DirectoryCrawler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void nameFiltersAndIgnoredNames();
+    void snapshotReuse();
+    void symLinkLoop();
+    void symLinksNotFollowed();
+
+private:
+    QString path(const QString &relativePath) const;
+    void touch(const QString &relativePath);
+    QStringList crawl(DirectoryCrawler *crawler) const;
+    static void removeRecursively(const QString &path);
+#ifdef Q_OS_UNIX
+    void ageDirectories();
+#endif
+
+    QString m_directory;
+};
+
+void tst_DirectoryCrawler::init()
+{
+    m_directory = QDir::tempPath() + QString::fromLatin1("/tst_directorycrawler_%1")
+                  .arg(QCoreApplication::applicationPid());
+    removeRecursively(m_directory);
+    QVERIFY(QDir().mkpath(m_directory + QLatin1String("/sub")));
+    QVERIFY(QDir().mkpath(m_directory + QLatin1String("/.hidden")));
+    QVERIFY(QDir().mkpath(m_directory + QLatin1String("/CVS")));
+    touch(QLatin1String("a.cpp"));
+    touch(QLatin1String("b.h"));
+    touch(QLatin1String("c.o"));
+    touch(QLatin1String("sub/d.cpp"));
+    touch(QLatin1String(".hidden/e.cpp"));
+    touch(QLatin1String("CVS/f.cpp"));
+}
+
+void tst_DirectoryCrawler::cleanup()
+{
+    removeRecursively(m_directory);
+}
+
+QString tst_DirectoryCrawler::path(const QString &relativePath) const
+{
+    return m_directory + QLatin1Char('/') + relativePath;
+}
+
+void tst_DirectoryCrawler::touch(const QString &relativePath)
+{
+    QFile file(path(relativePath));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("x");
+}
+
+QStringList tst_DirectoryCrawler::crawl(DirectoryCrawler *crawler) const
+{
+    crawler->setRootDirectories(QStringList(m_directory));
+    crawler->setNameFilters(QStringList() << QLatin1String("*.cpp") << QLatin1String("*.h"));
+    crawler->setIgnoredNames(QStringList() << QLatin1String(".*") << QLatin1String("CVS"));
+    crawler->setCaseSensitivity(Qt::CaseSensitive);
+    return crawler->crawl();
+}
+
+// Links are removed, not followed
+void tst_DirectoryCrawler::removeRecursively(const QString &path)
+{
+    QDir dir(path);
+    foreach (const QFileInfo &info, dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot
+                                                      | QDir::Hidden | QDir::System)) {
+        if (info.isDir() && !info.isSymLink())
+            removeRecursively(info.absoluteFilePath());
+        else
+            QFile::remove(info.absoluteFilePath());
+    }
+    QDir().rmdir(path);
+}
+
+#ifdef Q_OS_UNIX
+// Directories changed in the second of a crawl are never reused, so move
+// their time stamps into the past.
+void tst_DirectoryCrawler::ageDirectories()
+{
+    struct utimbuf times;
+    times.actime = times.modtime = ::time(0) - 60;
+    foreach (const QString &directory, QStringList() << QString() << QLatin1String("sub")
+             << QLatin1String(".hidden") << QLatin1String("CVS"))
+        QCOMPARE(::utime(QFile::encodeName(path(directory)).constData(), &times), 0);
+}
+#endif
+
+void tst_DirectoryCrawler::nameFiltersAndIgnoredNames()
+{
+    DirectoryCrawler crawler;
+    const QStringList expected = QStringList() << path(QLatin1String("a.cpp"))
+        << path(QLatin1String("b.h")) << path(QLatin1String("sub/d.cpp"));
+    QCOMPARE(crawl(&crawler), expected);
+    // The ignored directories are not even read
+    QCOMPARE(crawler.directoriesRead(), 2);
+}
+
+void tst_DirectoryCrawler::snapshotReuse()
+{
+#ifndef Q_OS_UNIX
+    QSKIP("Needs to set directory time stamps", SkipAll);
+#else
+    ageDirectories();
+    DirectoryCrawler crawler;
+    const QStringList files = crawl(&crawler);
+    QCOMPARE(crawler.directoriesRead(), 2);
+    QCOMPARE(crawler.directoriesReused(), 0);
+
+    // Nothing changed, nothing is read again
+    DirectoryCrawler second;
+    second.setSnapshot(crawler.snapshot());
+    QCOMPARE(crawl(&second), files);
+    QCOMPARE(second.directoriesRead(), 0);
+    QCOMPARE(second.directoriesReused(), 2);
+
+    // Only the changed directory is read
+    touch(QLatin1String("sub/g.h"));
+    DirectoryCrawler third;
+    third.setSnapshot(second.snapshot());
+    QVERIFY(crawl(&third).contains(path(QLatin1String("sub/g.h"))));
+    QCOMPARE(third.directoriesRead(), 1);
+    QCOMPARE(third.directoriesReused(), 1);
+
+    // The snapshot only holds what passed the filters, other filters start over
+    DirectoryCrawler fourth;
+    fourth.setSnapshot(third.snapshot());
+    fourth.setRootDirectories(QStringList(m_directory));
+    fourth.setNameFilters(QStringList(QLatin1String("*.o")));
+    QCOMPARE(fourth.crawl(), QStringList(path(QLatin1String("c.o"))));
+    QCOMPARE(fourth.directoriesReused(), 0);
+
+    // It survives being saved
+    QByteArray data;
+    {
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out << third.snapshot();
+    }
+    DirectorySnapshot restored;
+    QDataStream in(data);
+    in >> restored;
+    QCOMPARE(in.status(), QDataStream::Ok);
+    ageDirectories();
+    DirectoryCrawler fifth;
+    fifth.setSnapshot(restored);
+    crawl(&fifth);
+    QCOMPARE(fifth.directoriesReused(), 1);
+#endif
+}
+
+void tst_DirectoryCrawler::symLinkLoop()
+{
+#ifndef Q_OS_UNIX
+    QSKIP("Needs symbolic links", SkipAll);
+#else
+    QVERIFY(QFile::link(m_directory, path(QLatin1String("sub/loop"))));
+    QVERIFY(QFile::link(path(QLatin1String("sub")), path(QLatin1String("sub/self"))));
+
+    DirectoryCrawler crawler;
+    crawler.setThreadCount(4);
+    const QStringList expected = QStringList() << path(QLatin1String("a.cpp"))
+        << path(QLatin1String("b.h")) << path(QLatin1String("sub/d.cpp"));
+    QCOMPARE(crawl(&crawler), expected);
+    QCOMPARE(crawler.directoriesRead(), 2);
+#endif
+}
+
+void tst_DirectoryCrawler::symLinksNotFollowed()
+{
+#ifndef Q_OS_UNIX
+    QSKIP("Needs symbolic links", SkipAll);
+#else
+    QVERIFY(QFile::link(path(QLatin1String("a.cpp")), path(QLatin1String("sub/linked.cpp"))));
+    QVERIFY(QDir().mkpath(path(QLatin1String("other"))));
+    touch(QLatin1String("other/h.cpp"));
+    QVERIFY(QFile::link(path(QLatin1String("other")), path(QLatin1String("sub/linked"))));
+
+    DirectoryCrawler following;
+    QStringList files = crawl(&following);
+    QVERIFY(files.contains(path(QLatin1String("sub/linked.cpp"))));
+    QVERIFY(files.contains(path(QLatin1String("sub/linked/h.cpp"))));
+    QVERIFY(files.contains(path(QLatin1String("other/h.cpp"))));
+
+    DirectoryCrawler notFollowing;
+    notFollowing.setFollowSymLinks(false);
+    files = crawl(&notFollowing);
+    QVERIFY(!files.contains(path(QLatin1String("sub/linked.cpp"))));
+    QVERIFY(!files.contains(path(QLatin1String("sub/linked/h.cpp"))));
+    QVERIFY(files.contains(path(QLatin1String("other/h.cpp"))));
+#endif
+}
+
+QTEST_MAIN(tst_DirectoryCrawler)
+
+#include "tst_directorycrawler.moc"
@@ -0,0 +1,15 @@
+CONFIG += qtestlib
+TEMPLATE = app
+CONFIG -= app_bundle
+DEFINES += CORE_LIBRARY
+
+PLUGINS_PATH = ../../../src/plugins
+LIBS_PATH = ../../../src/libs
+
+INCLUDEPATH += $$PLUGINS_PATH $$LIBS_PATH
+# Input
+SOURCES += tst_filechangewatcher.cpp \
+    $$PLUGINS_PATH/coreplugin/filechangewatcher.cpp
+HEADERS += $$PLUGINS_PATH/coreplugin/filechangewatcher.h
+
+TARGET=tst_$$TARGET
@@ -0,0 +1,256 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+#include <coreplugin/filechangewatcher.h>
+
+#include <QtTest/QtTest>
+
+using Core::FileChangeWatcher;
+
+class tst_FileChangeWatcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void modifiedFile();
+    void unsubscribedFile();
+    void burstIsCoalesced();
+    void recursiveDirectory();
+    void recreatedDirectory();
+    void movedDirectory();
+    void recreatedNestedDirectory();
+    void statistics();
+
+private:
+    QString path(const QString &relativePath) const;
+    void touch(const QString &relativePath, const QByteArray &contents = "x");
+    static bool waitForSignal(QSignalSpy *spy);
+    static void removeRecursively(const QString &path);
+
+    QString m_directory;
+};
+
+void tst_FileChangeWatcher::init()
+{
+    m_directory = QDir::tempPath() + QString::fromLatin1("/tst_filechangewatcher_%1")
+                  .arg(QCoreApplication::applicationPid());
+    removeRecursively(m_directory);
+    QVERIFY(QDir().mkpath(m_directory + QLatin1String("/sub/deeper")));
+}
+
+void tst_FileChangeWatcher::cleanup()
+{
+    removeRecursively(m_directory);
+}
+
+QString tst_FileChangeWatcher::path(const QString &relativePath) const
+{
+    return m_directory + QLatin1Char('/') + relativePath;
+}
+
+void tst_FileChangeWatcher::touch(const QString &relativePath, const QByteArray &contents)
+{
+    QFile file(path(relativePath));
+    QVERIFY(file.open(QIODevice::Append));
+    file.write(contents);
+}
+
+bool tst_FileChangeWatcher::waitForSignal(QSignalSpy *spy)
+{
+    for (int i = 0; i < 50 && spy->isEmpty(); ++i)
+        QTest::qWait(100);
+    return !spy->isEmpty();
+}
+
+void tst_FileChangeWatcher::removeRecursively(const QString &path)
+{
+    QDir dir(path);
+    foreach (const QFileInfo &info, dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden)) {
+        if (info.isDir())
+            removeRecursively(info.absoluteFilePath());
+        else
+            QFile::remove(info.absoluteFilePath());
+    }
+    QDir().rmdir(path);
+}
+
+void tst_FileChangeWatcher::modifiedFile()
+{
+    touch(QLatin1String("a.txt"));
+    FileChangeWatcher watcher;
+    QSignalSpy spy(&watcher, SIGNAL(filesChanged(QStringList)));
+    watcher.addFile(path(QLatin1String("a.txt")));
+
+    touch(QLatin1String("a.txt"));
+    QVERIFY(waitForSignal(&spy));
+    QCOMPARE(spy.first().first().toStringList(), QStringList(path(QLatin1String("a.txt"))));
+}
+
+void tst_FileChangeWatcher::unsubscribedFile()
+{
+    touch(QLatin1String("a.txt"));
+    touch(QLatin1String("b.txt"));
+    FileChangeWatcher watcher;
+    QSignalSpy spy(&watcher, SIGNAL(filesChanged(QStringList)));
+    watcher.addFile(path(QLatin1String("a.txt")));
+    watcher.addFile(path(QLatin1String("b.txt")));
+    watcher.removeFile(path(QLatin1String("b.txt")));
+
+    touch(QLatin1String("b.txt"));
+    touch(QLatin1String("a.txt"));
+    QVERIFY(waitForSignal(&spy));
+    QCOMPARE(spy.first().first().toStringList(), QStringList(path(QLatin1String("a.txt"))));
+}
+
+void tst_FileChangeWatcher::burstIsCoalesced()
+{
+    QStringList files;
+    for (int i = 0; i < 20; ++i) {
+        const QString relativePath = QString::fromLatin1("sub/file%1.txt").arg(i, 2, 10, QLatin1Char('0'));
+        touch(relativePath);
+        files.append(path(relativePath));
+    }
+    FileChangeWatcher watcher;
+    QSignalSpy spy(&watcher, SIGNAL(filesChanged(QStringList)));
+    watcher.addFiles(files);
+
+    for (int i = 0; i < 20; ++i)
+        touch(QString::fromLatin1("sub/file%1.txt").arg(i, 2, 10, QLatin1Char('0')));
+    QVERIFY(waitForSignal(&spy));
+    QTest::qWait(300);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().first().toStringList(), files);
+}
+
+void tst_FileChangeWatcher::recursiveDirectory()
+{
+    FileChangeWatcher flat;
+    FileChangeWatcher recursive;
+    QSignalSpy flatSpy(&flat, SIGNAL(filesChanged(QStringList)));
+    QSignalSpy recursiveSpy(&recursive, SIGNAL(filesChanged(QStringList)));
+    flat.addDirectory(m_directory);
+    recursive.addDirectory(m_directory, true);
+
+    touch(QLatin1String("sub/deeper/new.txt"));
+    QVERIFY(waitForSignal(&recursiveSpy));
+    QVERIFY(recursiveSpy.first().first().toStringList().contains(path(QLatin1String("sub/deeper/new.txt"))));
+    QVERIFY(flatSpy.isEmpty());
+}
+
+void tst_FileChangeWatcher::recreatedDirectory()
+{
+    touch(QLatin1String("sub/a.txt"));
+    FileChangeWatcher watcher;
+    QSignalSpy spy(&watcher, SIGNAL(filesChanged(QStringList)));
+    watcher.addFile(path(QLatin1String("sub/a.txt")));
+
+    removeRecursively(path(QLatin1String("sub")));
+    QVERIFY(waitForSignal(&spy));
+    QVERIFY(QDir().mkpath(path(QLatin1String("sub"))));
+    touch(QLatin1String("sub/a.txt"));
+    QTest::qWait(300);
+    spy.clear();
+
+    // The file is watched again, not just reported once
+    touch(QLatin1String("sub/a.txt"));
+    QVERIFY(waitForSignal(&spy));
+    QVERIFY(spy.last().first().toStringList().contains(path(QLatin1String("sub/a.txt"))));
+}
+
+void tst_FileChangeWatcher::movedDirectory()
+{
+    touch(QLatin1String("sub/a.txt"));
+    FileChangeWatcher watcher;
+    QSignalSpy spy(&watcher, SIGNAL(filesChanged(QStringList)));
+    watcher.addFile(path(QLatin1String("sub/a.txt")));
+
+    QVERIFY(QDir().rename(path(QLatin1String("sub")), path(QLatin1String("moved"))));
+    QVERIFY(waitForSignal(&spy));
+    QVERIFY(spy.first().first().toStringList().contains(path(QLatin1String("sub/a.txt"))));
+    QTest::qWait(300);
+    spy.clear();
+
+    // The moved directory is no longer watched under the old name
+    touch(QLatin1String("moved/a.txt"));
+    QTest::qWait(500);
+    QVERIFY(spy.isEmpty());
+
+    QVERIFY(QDir().mkpath(path(QLatin1String("sub"))));
+    touch(QLatin1String("sub/a.txt"));
+    QVERIFY(waitForSignal(&spy));
+    QVERIFY(spy.last().first().toStringList().contains(path(QLatin1String("sub/a.txt"))));
+}
+
+void tst_FileChangeWatcher::recreatedNestedDirectory()
+{
+    touch(QLatin1String("sub/deeper/a.txt"));
+    FileChangeWatcher watcher;
+    QSignalSpy spy(&watcher, SIGNAL(filesChanged(QStringList)));
+    watcher.addFile(path(QLatin1String("sub/deeper/a.txt")));
+
+    removeRecursively(path(QLatin1String("sub")));
+    QVERIFY(waitForSignal(&spy));
+    QTest::qWait(300);
+    spy.clear();
+
+    // Recreated one level at a time, the file is found below the first
+    QVERIFY(QDir().mkdir(path(QLatin1String("sub"))));
+    QTest::qWait(300);
+    QVERIFY(QDir().mkdir(path(QLatin1String("sub/deeper"))));
+    QTest::qWait(300);
+    touch(QLatin1String("sub/deeper/a.txt"));
+    QVERIFY(waitForSignal(&spy));
+    QVERIFY(spy.last().first().toStringList().contains(path(QLatin1String("sub/deeper/a.txt"))));
+}
+
+void tst_FileChangeWatcher::statistics()
+{
+    QCOMPARE(FileChangeWatcher::statistics().watchers, 0);
+
+    touch(QLatin1String("a.txt"));
+    touch(QLatin1String("sub/b.txt"));
+    {
+        FileChangeWatcher watcher;
+        watcher.addFile(path(QLatin1String("a.txt")));
+        watcher.addFile(path(QLatin1String("sub/b.txt")));
+
+        const FileChangeWatcher::Statistics statistics = FileChangeWatcher::statistics();
+        QCOMPARE(statistics.watchers, 1);
+        QCOMPARE(statistics.subscribedFiles, 2);
+        QCOMPARE(statistics.watchedPaths, 2);
+    }
+    QCOMPARE(FileChangeWatcher::statistics().watchers, 0);
+}
+
+QTEST_MAIN(tst_FileChangeWatcher)
+
+#include "tst_filechangewatcher.moc"
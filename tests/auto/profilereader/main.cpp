@@ -35,7 +35,6 @@
 #include <QtCore/QSet>
 
 using Qt4ProjectManager::Internal::ProFileReader;
-using Qt4ProjectManager::Internal::ProFileCache;
 
 
 class tst_ProFileReader : public QObject
@@ -46,6 +45,7 @@ private slots:
     void readProFile();
     void includeFiles();
     void conditionalScopes();
+    void sharedCache();
 };
 
 void tst_ProFileReader::readProFile()
@@ -72,5 +72,28 @@ void tst_ProFileReader::conditionalScopes()
     QCOMPARE(scopedVariable.first(), QLatin1String("1"));
 }
 
+void tst_ProFileReader::sharedCache()
+{
+    const QString fileName = QLatin1String("data/includefiles/test.pro");
+    ProFileCache cache;
+
+    ProFileReader first;
+    first.setCache(&cache);
+    QCOMPARE(first.readProFile(fileName), true);
+
+    ProFileReader second;
+    second.setCache(&cache);
+    QCOMPARE(second.readProFile(fileName), true);
+    QCOMPARE(second.includeFiles().size(), 2);
+    QCOMPARE(second.values("SCOPED_VARIABLE"), first.values("SCOPED_VARIABLE"));
+    QVERIFY(second.proFileFor(fileName) == first.proFileFor(fileName));
+
+    cache.discardFile(fileName);
+    ProFileReader third;
+    third.setCache(&cache);
+    QCOMPARE(third.readProFile(fileName), true);
+    QVERIFY(third.proFileFor(fileName) != first.proFileFor(fileName));
+}
+
 QTEST_MAIN(tst_ProFileReader)
 #include "main.moc"
@@ -3,6 +3,7 @@ load(qttest_p4)
 SOURCES += \
     proitems.cpp \
     profileevaluator.cpp \
+    profilecache.cpp \
     profilereader.cpp \
     main.cpp
 
@@ -0,0 +1,20 @@
+TEMPLATE = app
+TARGET = tst_buildparser
+QT -= gui
+QT += testlib
+
+PROJECTEXPLORERDIR = ../../../src/plugins/projectexplorer
+
+INCLUDEPATH += $$PROJECTEXPLORERDIR ../../../src/plugins
+DEFINES += PROJECTEXPLORER_LIBRARY
+
+HEADERS += \
+    $$PROJECTEXPLORERDIR/buildparserinterface.h \
+    $$PROJECTEXPLORERDIR/gccparser.h \
+    $$PROJECTEXPLORERDIR/msvcparser.h
+
+SOURCES += \
+    main.cpp \
+    $$PROJECTEXPLORERDIR/buildparserinterface.cpp \
+    $$PROJECTEXPLORERDIR/gccparser.cpp \
+    $$PROJECTEXPLORERDIR/msvcparser.cpp
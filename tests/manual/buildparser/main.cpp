@@ -0,0 +1,140 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+// Measures the build output parsers the way a make step feeds them.
+//
+// A recorded build log, e.g. the output of "make 2>&1", can be replayed by
+// pointing BUILD_LOG to it. As the log does not tell stdout and stderr
+// apart, every line is passed to both. Without a log the output of a
+// large gcc build with a sprinkling of warnings is generated.
+
+#include "gccparser.h"
+#include "msvcparser.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QStringList>
+#include <QtTest/QtTest>
+
+using namespace ProjectExplorer;
+
+class TaskCounter : public QObject
+{
+    Q_OBJECT
+
+public:
+    TaskCounter() : tasks(0), directories(0) {}
+
+    int tasks;
+    int directories;
+
+public slots:
+    void addToTaskWindow(const QString &, int, int, const QString &) { ++tasks; }
+    void enterDirectory(const QString &) { ++directories; }
+    void leaveDirectory(const QString &) { ++directories; }
+};
+
+class tst_BuildParser : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void gcc();
+    void msvc();
+
+private:
+    void run(BuildParserInterface *parser);
+
+    QStringList m_lines;
+};
+
+void tst_BuildParser::initTestCase()
+{
+    const QByteArray log = qgetenv("BUILD_LOG");
+    if (!log.isEmpty()) {
+        QFile file(QString::fromLocal8Bit(log));
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        while (!file.atEnd())
+            m_lines.append(QString::fromLocal8Bit(file.readLine()));
+    } else {
+        for (int dir = 0; dir < 100; ++dir) {
+            const QString path = QString::fromLatin1("/home/user/project/src/module%1").arg(dir);
+            m_lines.append(QString::fromLatin1("make[2]: Entering directory `%1'").arg(path));
+            for (int i = 0; i < 200; ++i) {
+                const QString file = QString::fromLatin1("file%1.cpp").arg(i);
+                m_lines.append(QString::fromLatin1("g++ -c -pipe -g -Wall -W -D_REENTRANT "
+                    "-DQT_GUI_LIB -DQT_CORE_LIB -I/usr/share/qt4/mkspecs/linux-g++ -I. "
+                    "-I/usr/include/qt4/QtCore -I/usr/include/qt4/QtGui -o .obj/%1.o %2")
+                    .arg(i).arg(file));
+                if (i % 50 == 0) {
+                    m_lines.append(QString::fromLatin1("In file included from %1:3:").arg(file));
+                    m_lines.append(QString::fromLatin1("%1:%2: warning: unused parameter 'x'")
+                        .arg(file).arg(i + 10));
+                }
+            }
+            m_lines.append(QString::fromLatin1("make[2]: Leaving directory `%1'").arg(path));
+        }
+    }
+
+    QVERIFY(!m_lines.isEmpty());
+    qDebug() << m_lines.size() << "lines";
+}
+
+void tst_BuildParser::run(BuildParserInterface *parser)
+{
+    TaskCounter counter;
+    connect(parser, SIGNAL(addToTaskWindow(QString,int,int,QString)),
+            &counter, SLOT(addToTaskWindow(QString,int,int,QString)));
+    connect(parser, SIGNAL(enterDirectory(QString)), &counter, SLOT(enterDirectory(QString)));
+    connect(parser, SIGNAL(leaveDirectory(QString)), &counter, SLOT(leaveDirectory(QString)));
+
+    QBENCHMARK {
+        foreach (const QString &line, m_lines) {
+            parser->stdOutput(line);
+            parser->stdError(line);
+        }
+    }
+    qDebug() << counter.tasks << "tasks," << counter.directories << "directory changes";
+}
+
+void tst_BuildParser::gcc()
+{
+    GccParser parser;
+    run(&parser);
+}
+
+void tst_BuildParser::msvc()
+{
+    MsvcParser parser;
+    run(&parser);
+}
+
+QTEST_MAIN(tst_BuildParser)
+
+#include "main.moc"
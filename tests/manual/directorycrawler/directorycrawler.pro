@@ -0,0 +1,16 @@
+TEMPLATE = app
+TARGET = tst_directorycrawler
+QT -= gui
+QT += testlib
+
+UTILSDIR = ../../../src/libs/utils
+
+DEFINES += QTCREATOR_UTILS_LIB
+INCLUDEPATH += $$UTILSDIR ../../../src/libs
+
+HEADERS += \
+    $$UTILSDIR/directorycrawler.h
+
+SOURCES += \
+    main.cpp \
+    $$UTILSDIR/directorycrawler.cpp
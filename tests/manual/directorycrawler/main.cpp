@@ -0,0 +1,129 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+// Measures collecting the C++ files below a directory tree, the way the
+// locator's directory filter does.
+//
+// By default Qt's source tree is crawled, which needs QTDIR to be set.
+// Any other tree can be measured by setting CRAWL_DIR.
+
+#include "directorycrawler.h"
+
+#include <QtCore/QDirIterator>
+#include <QtCore/QFileInfo>
+#include <QtTest/QtTest>
+
+class tst_DirectoryCrawler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void dirIterator();
+    void crawlSingleThread();
+    void crawl();
+    void crawlWithSnapshot();
+
+private:
+    QStringList crawl(Utils::DirectoryCrawler *crawler);
+
+    QString m_directory;
+    QStringList m_nameFilters;
+    int m_fileCount;
+};
+
+void tst_DirectoryCrawler::initTestCase()
+{
+    m_directory = QString::fromLocal8Bit(qgetenv("CRAWL_DIR"));
+    if (m_directory.isEmpty())
+        m_directory = QString::fromLocal8Bit(qgetenv("QTDIR"));
+    if (m_directory.isEmpty())
+        QSKIP("Set CRAWL_DIR or QTDIR", SkipAll);
+    m_directory = QFileInfo(m_directory).absoluteFilePath();
+    QVERIFY(QFileInfo(m_directory).isDir());
+
+    m_nameFilters << QLatin1String("*.h") << QLatin1String("*.cpp")
+                  << QLatin1String("*.ui") << QLatin1String("*.qrc");
+
+    Utils::DirectoryCrawler crawler;
+    m_fileCount = crawl(&crawler).size();
+    qDebug() << m_fileCount << "files below" << m_directory;
+}
+
+QStringList tst_DirectoryCrawler::crawl(Utils::DirectoryCrawler *crawler)
+{
+    crawler->setRootDirectories(QStringList(m_directory));
+    crawler->setNameFilters(m_nameFilters);
+    return crawler->crawl();
+}
+
+void tst_DirectoryCrawler::dirIterator()
+{
+    QBENCHMARK {
+        int count = 0;
+        QDirIterator it(m_directory, m_nameFilters, QDir::Files | QDir::Hidden,
+                        QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+        while (it.hasNext()) {
+            it.next();
+            ++count;
+        }
+        Q_UNUSED(count)
+    }
+}
+
+void tst_DirectoryCrawler::crawlSingleThread()
+{
+    QBENCHMARK {
+        Utils::DirectoryCrawler crawler;
+        crawler.setThreadCount(1);
+        QCOMPARE(crawl(&crawler).size(), m_fileCount);
+    }
+}
+
+void tst_DirectoryCrawler::crawl()
+{
+    QBENCHMARK {
+        Utils::DirectoryCrawler crawler;
+        QCOMPARE(crawl(&crawler).size(), m_fileCount);
+    }
+}
+
+void tst_DirectoryCrawler::crawlWithSnapshot()
+{
+    Utils::DirectoryCrawler crawler;
+    crawl(&crawler);
+    QBENCHMARK {
+        QCOMPARE(crawl(&crawler).size(), m_fileCount);
+    }
+    qDebug() << crawler.directoriesReused() << "directories reused," << crawler.directoriesRead() << "read";
+}
+
+QTEST_MAIN(tst_DirectoryCrawler)
+
+#include "main.moc"
@@ -0,0 +1,12 @@
+TEMPLATE = app
+TARGET = tst_demangler
+QT -= gui
+QT += testlib
+
+DEBUGGERDIR = ../../../../src/plugins/debugger
+
+INCLUDEPATH += $$DEBUGGERDIR
+
+SOURCES += \
+    main.cpp \
+    $$DEBUGGERDIR/name_demangler.cpp \
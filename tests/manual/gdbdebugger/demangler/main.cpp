@@ -0,0 +1,110 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+
+// Measures the NameDemangler on the symbols of a library.
+//
+// Point NM_DUMP to the output of e.g. "nm libQtGui.so" to use real symbols.
+// Without it, a set of generated names is used.
+
+#include "name_demangler.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QStringList>
+#include <QtTest/QtTest>
+
+using namespace Debugger::Internal;
+
+class tst_Demangler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void demangle();
+    void demangleParallel();
+
+private:
+    QStringList m_names;
+};
+
+void tst_Demangler::initTestCase()
+{
+    const QByteArray dump = qgetenv("NM_DUMP");
+    if (!dump.isEmpty()) {
+        QFile file(QString::fromLocal8Bit(dump));
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        while (!file.atEnd()) {
+            // 00000000002a1f30 T _ZN7QWidget6resizeERK5QSize
+            const QByteArray line = file.readLine().trimmed();
+            const int pos = line.lastIndexOf(' ');
+            if (line.mid(pos + 1).startsWith("_Z"))
+                m_names.append(QString::fromLatin1(line.mid(pos + 1)));
+        }
+    } else {
+        for (int i = 0; i < 2000; ++i) {
+            const QString cls = QString::fromLatin1("Class%1").arg(i);
+            const QString prefix = QString::fromLatin1("_ZN%1%2")
+                .arg(cls.size()).arg(cls);
+            m_names.append(prefix + QLatin1String("6resizeERK5QSize"));
+            m_names.append(prefix + QLatin1String("C2EP7QObject"));
+            m_names.append(prefix + QLatin1String("D0Ev"));
+            m_names.append(prefix + QLatin1String("11qt_metacallEN11QMetaObject4CallEiPPv"));
+            m_names.append(prefix + QLatin1String("4dataEv"));
+            m_names.append(prefix + QLatin1String("6insertEiRK7QStringRK5QListIS0_E"));
+        }
+    }
+    QVERIFY(!m_names.isEmpty());
+    qDebug() << m_names.size() << "symbols";
+}
+
+void tst_Demangler::demangle()
+{
+    NameDemangler demangler;
+    int failed = 0;
+    QBENCHMARK {
+        failed = 0;
+        foreach (const QString &name, m_names)
+            failed += !demangler.demangle(name);
+    }
+    qDebug() << failed << "symbols not demangled";
+}
+
+void tst_Demangler::demangleParallel()
+{
+    QStringList names;
+    QBENCHMARK {
+        names = NameDemangler::demangledNames(m_names);
+    }
+    QCOMPARE(names.size(), m_names.size());
+}
+
+QTEST_MAIN(tst_Demangler)
+
+#include "main.moc"
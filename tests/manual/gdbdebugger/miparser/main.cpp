@@ -0,0 +1,137 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+// Measures parsing of gdb/MI records as done by the GdbEngine.
+//
+// A recorded transcript, e.g. the contents of the debugger log window, can
+// be replayed by pointing GDB_TRANSCRIPT to it. Only result and async
+// records are taken into account. Without a transcript a big stack list
+// and a big debugging helper dump are generated.
+
+#include "gdb/gdbmi.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtTest/QtTest>
+
+using namespace Debugger::Internal;
+
+class tst_MiParser : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void parse();
+
+private:
+    void addRecord(const QByteArray &line);
+
+    QList<QByteArray> m_records;
+    int m_size;
+};
+
+// Strips the token and the record class, leaving a tuple the way
+// GdbEngine::handleResponse() parses it.
+void tst_MiParser::addRecord(const QByteArray &line)
+{
+    int pos = 0;
+    while (pos < line.size() && line.at(pos) >= '0' && line.at(pos) <= '9')
+        ++pos;
+    if (pos == line.size())
+        return;
+
+    const char c = line.at(pos);
+    if (c != '^' && c != '*' && c != '=' && c != '+')
+        return;
+
+    const int comma = line.indexOf(',', pos);
+    if (comma == -1)
+        return;
+
+    QByteArray record = line.mid(comma + 1);
+    if (record.endsWith('\r'))
+        record.chop(1);
+    m_records.append('{' + record + '}');
+    m_size += record.size();
+}
+
+void tst_MiParser::initTestCase()
+{
+    m_size = 0;
+
+    const QByteArray transcript = qgetenv("GDB_TRANSCRIPT");
+    if (!transcript.isEmpty()) {
+        QFile file(QString::fromLocal8Bit(transcript));
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        while (!file.atEnd())
+            addRecord(file.readLine().trimmed());
+    } else {
+        QByteArray frames = "12^done,stack=[";
+        for (int i = 0; i < 2000; ++i) {
+            if (i)
+                frames += ',';
+            frames += "frame={level=\"" + QByteArray::number(i)
+                + "\",addr=\"0x00000000004061ca\",func=\"recurse\",file=\"main.cpp\","
+                  "fullname=\"/home/user/project/main.cpp\",line=\""
+                + QByteArray::number(100 + i % 50) + "\"}";
+        }
+        frames += ']';
+        addRecord(frames);
+
+        QByteArray dump = "13^done,data=[{iname=\"local.list\",name=\"list\","
+            "type=\"QList<QString>\",value=\"<5000 items>\",numchild=\"5000\","
+            "childtype=\"QString\",childnumchild=\"0\",children=[";
+        for (int i = 0; i < 5000; ++i) {
+            if (i)
+                dump += ',';
+            dump += "{name=\"" + QByteArray::number(i) + "\",valueencoded=\"7\","
+                "value=\"6100620063006400\\\"\\\\\"}";
+        }
+        dump += "]}]";
+        addRecord(dump);
+    }
+
+    QVERIFY(!m_records.isEmpty());
+    qDebug() << m_records.size() << "records," << m_size << "bytes";
+}
+
+void tst_MiParser::parse()
+{
+    QBENCHMARK {
+        foreach (const QByteArray &record, m_records) {
+            GdbMi data(record);
+            QVERIFY(data.isValid());
+        }
+    }
+}
+
+QTEST_MAIN(tst_MiParser)
+
+#include "main.moc"
@@ -0,0 +1,13 @@
+TEMPLATE = app
+TARGET = tst_miparser
+QT -= gui
+QT += testlib
+
+UTILSDIR    = ../../../../src/libs
+DEBUGGERDIR = ../../../../src/plugins/debugger
+
+INCLUDEPATH += $$DEBUGGERDIR $$UTILSDIR
+
+SOURCES += \
+    main.cpp \
+    $$DEBUGGERDIR/gdb/gdbmi.cpp \
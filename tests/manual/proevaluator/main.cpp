@@ -0,0 +1,130 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+
+// Measures evaluating a .pro file the way the Qt4 project manager does.
+//
+// By default Qt's own src/src.pro is evaluated, which needs QTDIR to point
+// to a Qt source tree. Any other project can be measured by setting PRO_FILE.
+// Run it before and after a change to the proparser to compare.
+
+#include "profilecache.h"
+#include "profileevaluator.h"
+#include "proitems.h"
+
+#include <QtCore/QFileInfo>
+#include <QtCore/QLibraryInfo>
+#include <QtTest/QtTest>
+
+class Evaluator : public ProFileEvaluator
+{
+public:
+    Evaluator(Option *option) : ProFileEvaluator(option) {}
+
+    void logMessage(const QString &) {}
+    void fileMessage(const QString &) {}
+    void errorMessage(const QString &) {}
+};
+
+class tst_ProEvaluator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void evaluate();
+    void evaluateCached();
+
+private:
+    bool run(ProFileCache *cache);
+
+    QString m_fileName;
+    QHash<QString, QString> m_properties;
+};
+
+void tst_ProEvaluator::initTestCase()
+{
+    m_fileName = QString::fromLocal8Bit(qgetenv("PRO_FILE"));
+    if (m_fileName.isEmpty()) {
+        const QString qtDir = QString::fromLocal8Bit(qgetenv("QTDIR"));
+        if (qtDir.isEmpty())
+            QSKIP("Set PRO_FILE or QTDIR", SkipAll);
+        m_fileName = qtDir + QLatin1String("/src/src.pro");
+    }
+    m_fileName = QFileInfo(m_fileName).absoluteFilePath();
+    QVERIFY(QFileInfo(m_fileName).exists());
+
+    m_properties.insert(QLatin1String("QT_INSTALL_PREFIX"),
+                        QLibraryInfo::location(QLibraryInfo::PrefixPath));
+    m_properties.insert(QLatin1String("QT_INSTALL_DATA"),
+                        QLibraryInfo::location(QLibraryInfo::DataPath));
+    m_properties.insert(QLatin1String("QT_INSTALL_HEADERS"),
+                        QLibraryInfo::location(QLibraryInfo::HeadersPath));
+    m_properties.insert(QLatin1String("QT_INSTALL_LIBS"),
+                        QLibraryInfo::location(QLibraryInfo::LibrariesPath));
+    m_properties.insert(QLatin1String("QT_INSTALL_BINS"),
+                        QLibraryInfo::location(QLibraryInfo::BinariesPath));
+    m_properties.insert(QLatin1String("QT_VERSION"), QLatin1String(qVersion()));
+}
+
+bool tst_ProEvaluator::run(ProFileCache *cache)
+{
+    ProFileEvaluator::Option option;
+    option.properties = m_properties;
+    option.cache = cache;
+
+    Evaluator evaluator(&option);
+    evaluator.setOutputDir(QFileInfo(m_fileName).absolutePath());
+    ProFile *pro = evaluator.parsedProFile(m_fileName);
+    if (!pro)
+        return false;
+    const bool ok = evaluator.accept(pro);
+    evaluator.releaseParsedProFile(pro);
+    return ok;
+}
+
+void tst_ProEvaluator::evaluate()
+{
+    QBENCHMARK {
+        QVERIFY(run(0));
+    }
+}
+
+void tst_ProEvaluator::evaluateCached()
+{
+    ProFileCache cache;
+    QVERIFY(run(&cache));
+    QBENCHMARK {
+        QVERIFY(run(&cache));
+    }
+}
+
+QTEST_MAIN(tst_ProEvaluator)
+
+#include "main.moc"
@@ -0,0 +1,20 @@
+TEMPLATE = app
+TARGET = tst_proevaluator
+QT -= gui
+QT += testlib
+
+PROPARSERDIR = ../../../src/shared/proparser
+
+INCLUDEPATH += $$PROPARSERDIR ../../../src/shared
+
+HEADERS += \
+    $$PROPARSERDIR/abstractproitemvisitor.h \
+    $$PROPARSERDIR/profilecache.h \
+    $$PROPARSERDIR/profileevaluator.h \
+    $$PROPARSERDIR/proitems.h
+
+SOURCES += \
+    main.cpp \
+    $$PROPARSERDIR/profilecache.cpp \
+    $$PROPARSERDIR/profileevaluator.cpp \
+    $$PROPARSERDIR/proitems.cpp
@@ -0,0 +1,11 @@
+TEMPLATE = app
+TARGET = tst_largefile
+QT += testlib
+
+include(../../../../qtcreator.pri)
+include(../../../../src/plugins/texteditor/texteditor.pri)
+
+LIBS += -L$$IDE_PLUGIN_PATH/Nokia -L$$IDE_LIBRARY_PATH
+INCLUDEPATH += $$IDE_SOURCE_TREE/src/plugins $$IDE_SOURCE_TREE/src/libs
+
+SOURCES += main.cpp
@@ -0,0 +1,171 @@
+/**************************************************************************
+**
+** This file is part of Qt Creator
+**
+** Copyright (c) 2009 Nokia Corporation and/or its subsidiary(-ies).
+**
+** Contact: Nokia Corporation (qt-info@nokia.com)
+**
+** Commercial Usage
+**
+** Licensees holding valid Qt Commercial licenses may use this file in
+** accordance with the Qt Commercial License Agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Nokia.
+**
+** GNU Lesser General Public License Usage
+**
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** If you are unsure which license is appropriate for your use, please
+** contact the sales department at http://qt.nokia.com/contact.
+**
+**************************************************************************/
+
+
+// Compares opening and scrolling a big file with the syntax highlighter
+// running over the whole document and in large file mode, where only the
+// blocks around the viewport are highlighted.
+//
+// The size of the generated file (in MB) can be set with LARGEFILE_SIZE.
+// Files above BaseTextDocument::LargeFileSize always open in large file
+// mode, so the full highlighting rows are skipped for them.
+
+#include <texteditor/basetextdocument.h>
+#include <texteditor/basetexteditor.h>
+
+#include <QtCore/QTemporaryFile>
+#include <QtCore/QTextStream>
+#include <QtGui/QApplication>
+#include <QtGui/QScrollBar>
+#include <QtGui/QSyntaxHighlighter>
+#include <QtTest/QtTest>
+
+using namespace TextEditor;
+
+class KeywordHighlighter : public QSyntaxHighlighter
+{
+public:
+    KeywordHighlighter()
+        : QSyntaxHighlighter(static_cast<QObject *>(0)),
+          m_keyword(QLatin1String("\\b(int|return|if|else|for)\\b"))
+    {
+        m_format.setFontWeight(QFont::Bold);
+    }
+
+protected:
+    void highlightBlock(const QString &text)
+    {
+        int index = m_keyword.indexIn(text);
+        while (index >= 0) {
+            setFormat(index, m_keyword.matchedLength(), m_format);
+            index = m_keyword.indexIn(text, index + m_keyword.matchedLength());
+        }
+    }
+
+private:
+    QRegExp m_keyword;
+    QTextCharFormat m_format;
+};
+
+class tst_LargeFile : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void open_data();
+    void open();
+    void scroll_data();
+    void scroll();
+
+private:
+    BaseTextEditor *openEditor(bool largeFile);
+
+    QTemporaryFile m_file;
+};
+
+void tst_LargeFile::initTestCase()
+{
+    int megabytes = qgetenv("LARGEFILE_SIZE").toInt();
+    if (megabytes <= 0)
+        megabytes = BaseTextDocument::LargeFileSize / (1024 * 1024);
+
+    QVERIFY(m_file.open());
+    QTextStream out(&m_file);
+    const QString line = QLatin1String("    if (i > 0) { int j = i * 2; return j; } else { return 0; }\n");
+    const qint64 size = qint64(megabytes) * 1024 * 1024;
+    for (qint64 written = 0; written + line.size() <= size; written += line.size())
+        out << line;
+    out.flush();
+    m_file.close();
+}
+
+BaseTextEditor *tst_LargeFile::openEditor(bool largeFile)
+{
+    BaseTextEditor *editor = new BaseTextEditor(0);
+    editor->resize(800, 600);
+    editor->baseTextDocument()->setSyntaxHighlighter(new KeywordHighlighter);
+    // Either way the file is opened once, highlighted while loading or not
+    editor->baseTextDocument()->setLargeFile(largeFile);
+    editor->open(m_file.fileName());
+    // Big files are still being read when open() returns
+    while (editor->baseTextDocument()->isLoading())
+        QApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    editor->show();
+    QApplication::processEvents();
+    return editor;
+}
+
+void tst_LargeFile::open_data()
+{
+    QTest::addColumn<bool>("largeFile");
+    QTest::newRow("full") << false;
+    QTest::newRow("large file mode") << true;
+}
+
+void tst_LargeFile::open()
+{
+    QFETCH(bool, largeFile);
+    if (!largeFile && m_file.size() > BaseTextDocument::LargeFileSize)
+        QSKIP("The file is too big to be opened with full highlighting", SkipSingle);
+
+    QBENCHMARK_ONCE {
+        delete openEditor(largeFile);
+    }
+}
+
+void tst_LargeFile::scroll_data()
+{
+    open_data();
+}
+
+void tst_LargeFile::scroll()
+{
+    QFETCH(bool, largeFile);
+    if (!largeFile && m_file.size() > BaseTextDocument::LargeFileSize)
+        QSKIP("The file is too big to be opened with full highlighting", SkipSingle);
+
+    BaseTextEditor *editor = openEditor(largeFile);
+    QScrollBar *scrollBar = editor->verticalScrollBar();
+
+    QBENCHMARK {
+        for (int i = 0; i < 200; ++i) {
+            scrollBar->setValue(scrollBar->value() + scrollBar->pageStep());
+            QApplication::processEvents();
+        }
+        scrollBar->setValue(0);
+        QApplication::processEvents();
+    }
+
+    delete editor;
+}
+
+QTEST_MAIN(tst_LargeFile)
+
+#include "main.moc"